@@ -0,0 +1,26 @@
+#!/bin/bash
+# Compares --run with the C translation (--emit-c) built by the C compiler on the loop-heavy
+# programs of tests/compile: C is the translation and the C compiler time, run the executable time
+# usage: bench/backends.sh [PMM] [CC]  (the input of each program can be overridden with PRIMES,
+# COLLATZ and SERIES, compiler flags with CFLAGS)
+PMM=${1:-./pmm}
+CC=${2:-cc}
+CFLAGS=${CFLAGS:-"-std=c17 -O2"}
+DIR=$(dirname "$0")/../tests/compile
+INPUTS="primes:${PRIMES:-3000000} collatz:${COLLATZ:-3000000} series:${SERIES:-200000000}"
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+TIMEFORMAT=%R
+
+printf "%-10s %10s %10s %10s %10s\n" program input --run C run
+for entry in $INPUTS; do
+    name=${entry%%:*}
+    input=${entry#*:}
+    jit=$( { time echo "$input" | "$PMM" --run "$DIR/$name.txt" > "$work/jit.out"; } 2>&1 )
+    build=$( { time { "$PMM" --emit-c="$work/$name.c" "$DIR/$name.txt" > /dev/null &&
+                      $CC $CFLAGS -o "$work/$name" "$work/$name.c" -lm; }; } 2>&1 )
+    native=$( { time echo "$input" | "$work/$name" > "$work/c.out"; } 2>&1 )
+    cmp -s "$work/jit.out" "$work/c.out" || echo "$name: the outputs differ"
+    printf "%-10s %10s %9ss %9ss %9ss\n" "$name" "$input" "$jit" "$build" "$native"
+done
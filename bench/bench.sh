@@ -0,0 +1,32 @@
+#!/bin/bash
+# Runs the compiler on generated programs of every shape and records the results in a CSV file
+# usage: bench/bench.sh [PMM] [GENERATOR] [HARNESS] [CSV]
+# RUNS, SIZES, NESTED_SIZES and ENGINES can be overridden through the environment
+PMM=$(realpath "${1:-./pmm}")
+GENERATOR=${2:-./build/generator}
+HARNESS=$(realpath "${3:-./build/harness}")
+CSV=${4:-./build/bench.csv}
+RUNS=${RUNS:-5}
+SIZES=${SIZES:-"1000 10000"}
+NESTED_SIZES=${NESTED_SIZES:-"100 1000"}
+ENGINES=${ENGINES:-"recursive table"}
+
+workdir=$(mktemp -d)
+trap 'rm -rf "$workdir"' EXIT
+
+echo "shape,size,engine,bytes,tokens,runs,tokens_per_second,peak_rss_kb,p50_ms,p90_ms,p99_ms,max_ms" > "$CSV"
+for shape in long decls procedures comments expressions numbers errors fuzz nested; do
+    sizes=$SIZES
+    [ "$shape" = nested ] && sizes=$NESTED_SIZES
+    for size in $sizes; do
+        "$GENERATOR" "$shape" "$size" > "$workdir/input.txt"
+        bytes=$(wc -c < "$workdir/input.txt")
+        (cd "$workdir" && "$PMM" --tokens=tokens.txt input.txt > /dev/null)
+        tokens=$(wc -l < "$workdir/tokens.txt")
+        for engine in $ENGINES; do
+            # the compiler writes output.txt in the current directory
+            result=$(cd "$workdir" && "$HARNESS" "$RUNS" "$tokens" "$PMM" --engine=$engine input.txt) || exit 1
+            echo "$shape,$size,$engine,$bytes,$tokens,$RUNS,$result" | tee -a "$CSV"
+        done
+    done
+done
@@ -0,0 +1,23 @@
+#!/bin/bash
+# Compares the recursive-descent and the table-driven LL(1) engines on generated programs
+# usage: bench/engines.sh [PMM] [GENERATOR]  (sizes can be overridden with NESTED_SIZES and LONG_SIZES)
+PMM=${1:-./pmm}
+GENERATOR=${2:-./build/generator}
+NESTED_SIZES=${NESTED_SIZES:-"1000 2000 5000"}
+LONG_SIZES=${LONG_SIZES:-"1000 2000 5000"}
+
+input=$(mktemp)
+trap 'rm -f "$input"' EXIT
+TIMEFORMAT=%R
+
+printf "%-8s %8s %12s %12s\n" shape size recursive table
+for shape in nested long; do
+    sizes=$NESTED_SIZES
+    [ "$shape" = long ] && sizes=$LONG_SIZES
+    for size in $sizes; do
+        "$GENERATOR" "$shape" "$size" > "$input"
+        recursive=$( { time "$PMM" --engine=recursive "$input" > /dev/null; } 2>&1 )
+        table=$( { time "$PMM" --engine=table "$input" > /dev/null; } 2>&1 )
+        printf "%-8s %8s %11ss %11ss\n" "$shape" "$size" "$recursive" "$table"
+    done
+done
@@ -0,0 +1,261 @@
+/**
+ * @file generator.c
+ * @brief Generates synthetic P-- programs used by the benchmarks
+ *
+ * usage: generator SHAPE SIZE
+ * shapes: nested      SIZE nested begin/if/while commands and parenthesized expressions
+ *         long        SIZE assignments and calls in a single body
+ *         decls       SIZE constant and variable declarations
+ *         procedures  SIZE procedure declarations with parameters and local variables
+ *         comments    SIZE commands, each one preceded by a long comment
+ *         expressions SIZE assignments and conditions with long arithmetic expressions
+ *         numbers     SIZE assignments of integer and real numbers of every length
+ *         errors      SIZE commands, a fixed pseudo-random part of them with lexer or syntax errors
+ *         fuzz        SIZE pseudo-random tokens and invalid characters, almost every one of them an error
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Writes a program whose commands and expressions are nested depth levels deep
+ *
+ * @param depth nesting depth
+ */
+void generateNested(long depth) {
+    printf("program nested;\nvar x, y: integer;\nbegin\n");
+    for (long i = 0; i < depth; i++) {
+        switch (i % 3) {
+            case 0:
+                printf("begin\n");
+                break;
+            case 1:
+                printf("if x > %ld then\n", i);
+                break;
+            default:
+                printf("while (y < %ld) do\n", i);
+                break;
+        }
+    }
+
+    printf("x := ");
+    for (long i = 0; i < depth; i++)
+        printf("(");
+    printf("y");
+    for (long i = 0; i < depth; i++)
+        printf(" * %ld)", i);
+    printf("\n");
+
+    for (long i = depth - 1; i >= 0; i--)
+        if (i % 3 == 0)
+            printf(";\nend");
+    printf(";\nend.\n");
+}
+
+/**
+ * @brief Writes a program with n commands in its main body
+ *
+ * @param n number of commands
+ */
+void generateLong(long n) {
+    printf("program long;\nvar x, y, z: integer;\nprocedure p(a: integer);\nbegin\nwrite(a);\nend;\nbegin\n");
+    for (long i = 0; i < n; i++) {
+        if (i % 4 == 3)
+            printf("p(x);\n");
+        else
+            printf("x := x * %ld + y - (z / 2);\n", i);
+    }
+    printf("end.\n");
+}
+
+/**
+ * @brief Writes a program with n declarations: constants and long lists of variables
+ *
+ * @param n number of declared identifiers
+ */
+void generateDecls(long n) {
+    printf("program decls;\n");
+    for (long i = 0; i < n / 2; i++)
+        printf("const c%ld = %ld.%ld;\n", i, i, i % 10);
+
+    printf("var v0");
+    for (long i = 1; i < n - n / 2; i++)
+        printf((i % 8 == 0) ? ",\n    v%ld" : ", v%ld", i);
+    printf(": real;\nbegin\nv0 := c0;\nend.\n");
+}
+
+/**
+ * @brief Writes a program with n procedures
+ *
+ * @param n number of procedures
+ */
+void generateProcedures(long n) {
+    printf("program procedures;\nvar x, y: integer;\n");
+    for (long i = 0; i < n; i++) {
+        printf("procedure p%ld(a, b: integer; c: real);\nvar t%ld, u%ld: integer;\nbegin\n", i, i, i);
+        printf("t%ld := a * b + %ld;\nif t%ld >= c then u%ld := t%ld - 1 else write(t%ld);\n", i, i, i, i, i, i);
+        if (i > 0)
+            printf("p%ld(t%ld; u%ld);\n", i - 1, i, i);
+        printf("end;\n");
+    }
+    printf("begin\nread(x, y);\np%ld(x; y);\nend.\n", (n > 0) ? n - 1 : 0);
+}
+
+/**
+ * @brief Writes a program with n commands, each one preceded by a comment
+ *
+ * @param n number of commands
+ */
+void generateComments(long n) {
+    printf("program comments;\n{ variables used by the commands below }\nvar x: integer;\nbegin\n");
+    for (long i = 0; i < n; i++) {
+        printf("{ command %ld: the comments are skipped by the lexer, so this shape measures the cost of\n"
+               "  reading characters that never become tokens; x is incremented once per command }\n",
+               i);
+        printf("x := x + %ld;\n", i);
+    }
+    printf("end.\n");
+}
+
+/**
+ * @brief Writes a program with n commands whose expressions have 16 operands each: identifiers
+ * and numbers with unary, additive and multiplicative operators and parenthesized subexpressions
+ *
+ * @param n number of commands
+ */
+void generateExpressions(long n) {
+    static const char* operands[] = {"x", "y", "z", "2", "3.5", "(x - y)", "(y * z + 1)", "(-x + 4)"};
+    static const char* operators[] = {" + ", " * ", " - ", " / "};
+    printf("program expressions;\nvar x, y, z: real;\nbegin\n");
+    for (long i = 0; i < n; i++) {
+        if (i % 4 == 3)
+            printf("if x + %ld < ", i);
+        else
+            printf("x := ");
+        for (int j = 0; j < 16; j++) {
+            // after a ')' the lexer reads + and - as unary operators, so only * and / may follow it
+            if (j > 0 && operands[(i * 3 + j - 1) % 8][0] == '(')
+                printf("%s", operators[1 + 2 * ((i + j) % 2)]);
+            else if (j > 0)
+                printf("%s", operators[(i + j) % 4]);
+            printf("%s", operands[(i * 3 + j) % 8]);
+        }
+        printf((i % 4 == 3) ? " then y := z;\n" : ";\n");
+    }
+    printf("end.\n");
+}
+
+/**
+ * @brief Writes a program with n assignments of numbers: integers of 1 to 18 digits and reals
+ * with 1 to 20 digits before and after the point. Like generateErrors, the output only depends on n.
+ *
+ * @param n number of commands
+ */
+void generateNumbers(long n) {
+    unsigned long seed = 12345;
+    printf("program numbers;\nvar i: integer;\nvar r: real;\nbegin\n");
+    for (long i = 0; i < n; i++) {
+        seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+        unsigned long digits = seed >> 11;
+        if (i % 2 == 0) {
+            printf("i := %lu;\n", digits % 1000000000000000000ul >> (seed >> 58));
+        } else {
+            seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+            printf("r := %lu.%0*lu;\n", digits >> (seed >> 58), (int)(1 + (seed >> 33) % 20), (seed >> 20) % 100000000000ul);
+        }
+    }
+    printf("end.\n");
+}
+
+/**
+ * @brief Writes a program with n commands, about a third of them with lexer or syntax errors.
+ * The errors are chosen by a linear congruential generator with a fixed seed, so the output
+ * only depends on n.
+ *
+ * @param n number of commands
+ */
+void generateErrors(long n) {
+    unsigned long seed = 12345;
+    printf("program errors;\nvar x, y: integer;\nbegin\n");
+    for (long i = 0; i < n; i++) {
+        seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+        switch ((seed >> 33) % 12) {
+            case 0:
+                printf("x := x + %ld\n", i);  // missing ;
+                break;
+            case 1:
+                printf("x := @ %ld;\n", i);  // invalid character
+                break;
+            case 2:
+                printf("x := (y * %ld;\n", i);  // unbalanced parenthesis
+                break;
+            case 3:
+                printf("if x then y := %ld;\n", i);  // missing relation
+                break;
+            default:
+                printf("x := y * %ld;\n", i);
+                break;
+        }
+    }
+    printf("end.\n");
+}
+
+/**
+ * @brief Writes n pseudo-random words: keywords, symbols, identifiers, numbers and invalid characters,
+ * without any grammatical structure, so the compiler spends its time in error recovery. Like
+ * generateErrors, the output only depends on n.
+ *
+ * @param n number of words
+ */
+void generateFuzz(long n) {
+    static const char* words[] = {"program", "var",   "const", "procedure", "begin", "end", "if",    "then",
+                                  "else",    "while", "do",    "read",      "write", ":=",  ":",     ";",
+                                  ",",       ".",     "(",     ")",         "=",     "<>",  ">=",    "<=",
+                                  "+",       "-",     "*",     "/",         "x",     "42",  "3.14",  "integer",
+                                  "@",       "!",     "#",     "$",         "2.",    "{ }", "real",  "y"};
+    unsigned long seed = 12345;
+    for (long i = 0; i < n; i++) {
+        seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+        printf((i % 16 == 15) ? "%s\n" : "%s ", words[(seed >> 33) % (sizeof(words) / sizeof(words[0]))]);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Benchmark input generator
+ *
+ * @param argc number of command line arguments
+ * @param argv commmand line arguments ( expects {executable name, shape, size} )
+ * @return int
+ */
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        printf("Error: usage: %s nested|long|decls|procedures|comments|expressions|numbers|errors|fuzz SIZE\n", argv[0]);
+        return -1;
+    }
+
+    long size = atol(argv[2]);
+    if (!strcmp(argv[1], "nested")) {
+        generateNested(size);
+    } else if (!strcmp(argv[1], "long")) {
+        generateLong(size);
+    } else if (!strcmp(argv[1], "decls")) {
+        generateDecls(size);
+    } else if (!strcmp(argv[1], "procedures")) {
+        generateProcedures(size);
+    } else if (!strcmp(argv[1], "comments")) {
+        generateComments(size);
+    } else if (!strcmp(argv[1], "expressions")) {
+        generateExpressions(size);
+    } else if (!strcmp(argv[1], "numbers")) {
+        generateNumbers(size);
+    } else if (!strcmp(argv[1], "errors")) {
+        generateErrors(size);
+    } else if (!strcmp(argv[1], "fuzz")) {
+        generateFuzz(size);
+    } else {
+        printf("Error: unknown shape '%s'\n", argv[1]);
+        return -1;
+    }
+    return 0;
+}
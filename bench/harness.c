@@ -0,0 +1,122 @@
+/**
+ * @file harness.c
+ * @brief Runs a command several times and measures its latency and peak memory
+ *
+ * usage: harness RUNS TOKENS COMMAND [ARGS...]
+ * Prints one CSV fragment: tokens_per_second,peak_rss_kb,p50_ms,p90_ms,p99_ms,max_ms
+ * (tokens/s is computed from the median latency). The command output is discarded.
+ */
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Compares two latencies (qsort callback)
+ *
+ * @param a first latency
+ * @param b second latency
+ * @return int negative, zero or positive as a is smaller, equal or greater than b
+ */
+int compareLatencies(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Returns a percentile of sorted latencies (nearest rank)
+ *
+ * @param latencies sorted latencies
+ * @param count number of latencies
+ * @param percentile percentile between 0 and 100
+ * @return double the latency
+ */
+double percentile(const double* latencies, int count, double percentile) {
+    int rank = (int)(percentile / 100.0 * count + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    if (rank > count)
+        rank = count;
+    return latencies[rank - 1];
+}
+
+/**
+ * @brief Runs the command once
+ *
+ * @param argv command and arguments
+ * @param latency elapsed time in milliseconds
+ * @param peakRss peak resident set size in kilobytes
+ * @return int exit status of the command or -1 if it couldn't run
+ */
+int run(char** argv, double* latency, long* peakRss) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pid_t pid = fork();
+    if (pid == -1)
+        return -1;
+    if (pid == 0) {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == -1)
+        return -1;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    *latency = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    *peakRss = usage.ru_maxrss;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @brief Benchmark harness
+ *
+ * @param argc number of command line arguments
+ * @param argv commmand line arguments ( expects {executable name, runs, tokens, command, [args]} )
+ * @return int
+ */
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        printf("Error: usage: %s RUNS TOKENS COMMAND [ARGS...]\n", argv[0]);
+        return -1;
+    }
+
+    int runs = atoi(argv[1]);
+    double tokens = atof(argv[2]);
+    if (runs < 1)
+        runs = 1;
+
+    double* latencies = (double*)malloc(runs * sizeof(double));
+    long peakRss = 0;
+    for (int i = 0; i < runs; i++) {
+        long rss;
+        int status = run(argv + 3, &latencies[i], &rss);
+        if (status == 127 || status == -1) {
+            printf("Error: couldn't run %s\n", argv[3]);
+            free(latencies);
+            return -1;
+        }
+        if (rss > peakRss)
+            peakRss = rss;
+    }
+
+    qsort(latencies, runs, sizeof(double), compareLatencies);
+    double median = percentile(latencies, runs, 50);
+    printf("%.0f,%ld,%.3f,%.3f,%.3f,%.3f\n", (median > 0) ? tokens / (median / 1e3) : 0, peakRss, median,
+           percentile(latencies, runs, 90), percentile(latencies, runs, 99), latencies[runs - 1]);
+
+    free(latencies);
+    return 0;
+}
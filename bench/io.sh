@@ -0,0 +1,61 @@
+#!/bin/bash
+# Times read and write: --run of a program that reads NUMBERS numbers (integers and reals in turn)
+# and writes them back, against the same loop in C with scanf and printf (built with CC)
+# usage: bench/io.sh [PMM] [CC]  (NUMBERS is 10000000 by default, compiler flags are CFLAGS)
+PMM=${1:-./pmm}
+CC=${2:-cc}
+CFLAGS=${CFLAGS:-"-std=c17 -O2"}
+NUMBERS=${NUMBERS:-10000000}
+PAIRS=$((NUMBERS / 2))
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+TIMEFORMAT=%R
+
+cat > "$work/echo.txt" << 'END'
+program echo;
+{writes back pairs of an integer and a real}
+var n, i, k: integer;
+var x: real;
+begin
+    read(n);
+    for i := 1 to n do
+    begin
+        read(k);
+        read(x);
+        write(k, x);
+    end;
+end.
+END
+
+cat > "$work/echo.c" << 'END'
+#include <stdio.h>
+
+int main(void) {
+    long n, k;
+    double x;
+    if (scanf("%ld", &n) != 1)
+        return 1;
+    for (long i = 0; i < n; i++) {
+        if (scanf("%ld %lf", &k, &x) != 2)
+            return 1;
+        printf("%ld %.17g\n", k, x);
+    }
+    return 0;
+}
+END
+$CC $CFLAGS -o "$work/echo" "$work/echo.c" || exit 1
+
+# integers of up to 10 digits with a sign, reals with up to 9 significant digits
+awk -v pairs="$PAIRS" 'BEGIN {
+    srand(1);
+    print pairs;
+    for (i = 0; i < pairs; i++)
+        printf "%d %.*g\n", int(rand() * 4294967296) - 2147483648, 1 + int(rand() * 9), rand() * 10 ^ int(rand() * 8 - 3);
+}' > "$work/input"
+
+run=$( { time "$PMM" --run "$work/echo.txt" < "$work/input" > "$work/run.out"; } 2>&1 )
+native=$( { time "$work/echo" < "$work/input" > "$work/c.out"; } 2>&1 )
+cmp -s <(cut -d' ' -f1 "$work/run.out") <(cut -d' ' -f1 "$work/c.out") || echo "the integers written differ"
+printf "%-10s %12s %10s\n" numbers --run "scanf/printf"
+printf "%-10s %11ss %9ss\n" "$NUMBERS" "$run" "$native"
@@ -0,0 +1,19 @@
+#!/bin/bash
+# Compares the direct-coded and the table-driven lexer automata on generated programs
+# usage: bench/lexers.sh [PMM] [GENERATOR]  (shapes and sizes can be overridden with SHAPES and SIZE)
+PMM=${1:-./pmm}
+GENERATOR=${2:-./build/generator}
+SHAPES=${SHAPES:-"comments decls long expressions fuzz"}
+SIZE=${SIZE:-200000}
+
+input=$(mktemp)
+trap 'rm -f "$input"' EXIT
+TIMEFORMAT=%R
+
+printf "%-12s %8s %12s %12s\n" shape size direct table
+for shape in $SHAPES; do
+    "$GENERATOR" "$shape" "$SIZE" > "$input"
+    direct=$( { time "$PMM" --lexer=direct "$input" > /dev/null; } 2>&1 )
+    table=$( { time "$PMM" --lexer=table "$input" > /dev/null; } 2>&1 )
+    printf "%-12s %8s %11ss %11ss\n" "$shape" "$SIZE" "$direct" "$table"
+done
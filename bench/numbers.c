@@ -0,0 +1,153 @@
+/**
+ * @file numbers.c
+ * @brief Compares the conversion of the numbers of src/number.c with strtol and strtod: every
+ * number must have the same value (bit for bit for reals), then both are timed
+ *
+ * usage: numbers COUNT
+ * The numbers are pseudo-random P-- integers (1 to 20 digits) and reals: short ones (1 to 8 digits
+ * before and after the point) and long ones (up to 24), with leading zeros, so every path of
+ * numberParseReal is taken.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../header/number.h"
+
+#define NUMBER_SIZE 64  // room for a number and its NUL
+
+/**
+ * @brief Returns the time in seconds
+ *
+ * @return double the time of a monotonic clock
+ */
+double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Writes a pseudo-random string of digits
+ *
+ * @param text where the digits are written
+ * @param count number of digits
+ * @param seed state of the generator
+ * @return char* the end of the digits
+ */
+char* writeDigits(char* text, int count, unsigned long* seed) {
+    for (int i = 0; i < count; i++) {
+        *seed = *seed * 6364136223846793005ul + 1442695040888963407ul;
+        // a few runs of zeros and nines exercise ties and carries
+        unsigned long draw = (*seed >> 33) % 14;
+        *text++ = (draw >= 10) ? ((draw & 1) ? '9' : '0') : (char)('0' + draw);
+    }
+    return text;
+}
+
+/**
+ * @brief Converts the numbers, checks them and prints the timings
+ *
+ * @param argc number of command line arguments
+ * @param argv commmand line arguments ( expects {executable name, count} )
+ * @return int 0 if every value matched
+ */
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        printf("Error: usage: %s COUNT\n", argv[0]);
+        return -1;
+    }
+
+    long count = atol(argv[1]);
+    char(*integers)[NUMBER_SIZE] = malloc(count * sizeof *integers);
+    char(*reals)[NUMBER_SIZE] = malloc(count * sizeof *reals);
+    unsigned long* sizes = malloc(2 * count * sizeof(unsigned long));
+    if (integers == NULL || reals == NULL || sizes == NULL) {
+        printf("Error: out of memory\n");
+        return -1;
+    }
+
+    unsigned long seed = 12345;
+    for (long i = 0; i < count; i++) {
+        seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+        char* end = writeDigits(integers[i], 1 + (seed >> 33) % 20, &seed);
+        *end = '\0';
+        sizes[2 * i] = end - integers[i];
+
+        // even reals have the few digits of most programs, odd ones up to 48 digits
+        seed = seed * 6364136223846793005ul + 1442695040888963407ul;
+        int limit = (i % 2) ? 24 : 8;
+        int before = 1 + (seed >> 33) % limit;
+        int after = 1 + (seed >> 43) % limit;
+        int zeros = (seed >> 53) % 8;  // leading zeros after the point
+        if (zeros > after - 1)
+            zeros = after - 1;
+        end = writeDigits(reals[i], before, &seed);
+        *end++ = '.';
+        for (int j = 0; j < zeros; j++)
+            *end++ = '0';
+        end = writeDigits(end, after - zeros, &seed);
+        *end = '\0';
+        sizes[2 * i + 1] = end - reals[i];
+    }
+
+    // every value must be the one of the C library
+    long mismatches = 0;
+    for (long i = 0; i < count; i++) {
+        long value;
+        bool overflow = numberParseInteger(integers[i], sizes[2 * i], &value);
+        errno = 0;
+        long expected = strtol(integers[i], NULL, 10);
+        if (value != expected || overflow != (errno == ERANGE))
+            mismatches++;
+
+        double real = numberParseReal(reals[i], sizes[2 * i + 1]);
+        double expectedReal = strtod(reals[i], NULL);
+        if (memcmp(&real, &expectedReal, sizeof real)) {
+            if (mismatches < 10)
+                printf("mismatch: %s %.17g %.17g\n", reals[i], real, expectedReal);
+            mismatches++;
+        }
+    }
+
+    long integerSum = 0;
+    double realSum = 0;
+    double start = now();
+    for (long i = 0; i < count; i++) {
+        long value;
+        numberParseInteger(integers[i], sizes[2 * i], &value);
+        integerSum += value;
+    }
+    double integerTime = now() - start;
+    start = now();
+    for (long i = 0; i < count; i++)
+        integerSum -= strtol(integers[i], NULL, 10);
+    double strtolTime = now() - start;
+    double realTimes[2] = {0, 0};
+    double strtodTimes[2] = {0, 0};
+    for (int parity = 0; parity < 2; parity++) {
+        start = now();
+        for (long i = parity; i < count; i += 2)
+            realSum += numberParseReal(reals[i], sizes[2 * i + 1]);
+        realTimes[parity] = now() - start;
+        start = now();
+        for (long i = parity; i < count; i += 2)
+            realSum -= strtod(reals[i], NULL);
+        strtodTimes[parity] = now() - start;
+    }
+
+    printf("%ld numbers, %ld mismatches (checksums %ld %g)\n", count, mismatches, integerSum, realSum);
+    printf("integers:    numberParseInteger %.1f ns, strtol %.1f ns\n", integerTime * 1e9 / count, strtolTime * 1e9 / count);
+    printf("short reals: numberParseReal %.1f ns, strtod %.1f ns\n", realTimes[0] * 2e9 / count, strtodTimes[0] * 2e9 / count);
+    printf("long reals:  numberParseReal %.1f ns, strtod %.1f ns\n", realTimes[1] * 2e9 / count, strtodTimes[1] * 2e9 / count);
+
+    free(integers);
+    free(reals);
+    free(sizes);
+    return mismatches > 0;
+}
@@ -0,0 +1,29 @@
+#!/bin/bash
+# Compiles a program with a million statements and one with a million procedures with both engines
+# (and the procedures with --jobs), which must all succeed without overflowing the stack
+# usage: bench/stress.sh [PMM] [GENERATOR]  (the size can be overridden with STRESS_SIZE)
+PMM=${1:-./pmm}
+GENERATOR=${2:-./build/generator}
+STRESS_SIZE=${STRESS_SIZE:-1000000}
+
+input=$(mktemp)
+trap 'rm -f "$input" "$input.out"' EXIT
+TIMEFORMAT=%R
+
+status=0
+for kind in long procedures; do
+    "$GENERATOR" $kind "$STRESS_SIZE" > "$input"
+    options=("--engine=recursive" "--engine=table")
+    [ $kind = procedures ] && options+=("--jobs=0")
+    for option in "${options[@]}"; do
+        seconds=$( { time "$PMM" $option "$input" > "$input.out"; } 2>&1 )
+        if tail -n 1 "$input.out" | grep -q "compiled successfully"; then
+            echo "$kind $option: $STRESS_SIZE compiled in ${seconds}s"
+        else
+            echo "$kind $option: FAILED on $STRESS_SIZE"
+            status=1
+        fi
+        rm -f "$input.out"
+    done
+done
+exit $status
@@ -0,0 +1,96 @@
+/**
+ * @file driver.c
+ * @brief Standalone driver of the fuzz targets, for compilers without libFuzzer (gcc, afl-gcc)
+ *
+ * usage: fuzz-TARGET [-runs=N] [FILE...]
+ * Runs the target on each file, or on stdin when there is none (AFL, in persistent mode when
+ * built with afl-clang-fast). With -runs=N every file is run N times and the number of
+ * executions per second is printed.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/**
+ * @brief Reads a whole stream
+ *
+ * @param stream the stream
+ * @param size number of bytes read
+ * @return uint8_t* the bytes (must be freed)
+ */
+uint8_t* readAll(FILE* stream, size_t* size) {
+    size_t capacity = 1 << 12;
+    uint8_t* data = (uint8_t*)malloc(capacity);
+    *size = 0;
+    size_t read;
+    while ((read = fread(data + *size, 1, capacity - *size, stream)) > 0) {
+        *size += read;
+        if (*size == capacity) {
+            capacity *= 2;
+            data = (uint8_t*)realloc(data, capacity);
+        }
+    }
+    return data;
+}
+
+/**
+ * @brief Fuzz target driver
+ *
+ * @param argc number of command line arguments
+ * @param argv commmand line arguments ( expects {executable name, [-runs=N], [files]} )
+ * @return int
+ */
+int main(int argc, char** argv) {
+    long runs = 1;
+    int first = 1;
+    if (argc > 1 && !strncmp(argv[1], "-runs=", 6)) {
+        runs = atol(argv[1] + 6);
+        first = 2;
+    }
+
+    size_t size;
+    uint8_t* data;
+    if (first == argc) {
+#ifdef __AFL_LOOP
+        while (__AFL_LOOP(10000)) {
+#endif
+            data = readAll(stdin, &size);
+            LLVMFuzzerTestOneInput(data, size);
+            free(data);
+#ifdef __AFL_LOOP
+        }
+#endif
+        return 0;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long executions = 0;
+    for (int i = first; i < argc; i++) {
+        FILE* file = fopen(argv[i], "rb");
+        if (file == NULL) {
+            printf("Error: couldn't open %s\n", argv[i]);
+            return -1;
+        }
+        data = readAll(file, &size);
+        fclose(file);
+
+        for (long run = 0; run < runs; run++)
+            LLVMFuzzerTestOneInput(data, size);
+        executions += runs;
+        free(data);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (runs > 1) {
+        double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        printf("%ld executions in %.3f s (%.0f executions/s)\n", executions, seconds, executions / seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file lexer.c
+ * @brief Fuzz target of the lexer: lexes the input until its end and renders the diagnostics, then
+ * lexes it again with the transition matrix interpreter and checks that the tokens, their values
+ * and the errors are the same. Values of numbers are checked against strtol and strtod. The parallel
+ * lexer has its own target (parallellexer.c), which starts threads on every input.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../header/diagnostics.h"
+#include "../header/lexer.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+void _lexAll(const uint8_t* data, size_t size, int automaton, String* tokens, String* report);
+void _appendToken(String* tokens, Lexer* lexer);
+void _checkValue(Lexer* lexer);
+
+/**
+ * @brief Runs the lexer on one input
+ *
+ * @param data input bytes
+ * @param size number of bytes
+ * @return int always 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    String tokens;
+    stringInit(&tokens);
+    String report;
+    stringInit(&report);
+    _lexAll(data, size, AUTOMATON_DIRECT, &tokens, &report);
+
+    String tableTokens;
+    stringInit(&tableTokens);
+    String tableReport;
+    stringInit(&tableReport);
+    _lexAll(data, size, AUTOMATON_TABLE, &tableTokens, &tableReport);
+    if (tokens.size != tableTokens.size || memcmp(tokens.str, tableTokens.str, tokens.size) ||
+        strcmp(report.str, tableReport.str))
+        abort();
+    stringDestroy(&tableReport);
+    stringDestroy(&tableTokens);
+    stringDestroy(&report);
+    stringDestroy(&tokens);
+    return 0;
+}
+
+/**
+ * @brief Lexes the input until its end with an automaton and renders the diagnostics
+ *
+ * @param data input bytes
+ * @param size number of bytes
+ * @param automaton AUTOMATON used by the lexer
+ * @param tokens string where the tokens are appended
+ * @param report string where the diagnostics are rendered
+ */
+void _lexAll(const uint8_t* data, size_t size, int automaton, String* tokens, String* report) {
+    Diagnostics diagnostics;
+    diagnosticsInit(&diagnostics, FORMAT_JSON, 0);
+
+    Lexer lexer;
+    if (!lexerInitBuffer(&lexer, (const char*)data, size)) {
+        lexer.automaton = automaton;
+        do {
+            nextToken(&lexer, &diagnostics);
+            _checkValue(&lexer);
+            _appendToken(tokens, &lexer);
+        } while (lexer.tokenClass != LAMBDA);
+        lexerDestroy(&lexer);
+    }
+
+    diagnosticsRender(&diagnostics, report, NULL);
+    diagnosticsDestroy(&diagnostics);
+}
+
+/**
+ * @brief Appends the current token of the lexer (class, offset, end of file flag, lexeme and value)
+ *
+ * @param tokens string where the token is appended
+ * @param lexer a lexer instance
+ */
+void _appendToken(String* tokens, Lexer* lexer) {
+    stringAppendInt(tokens, lexer->tokenClass);
+    stringAppendChar(tokens, ' ');
+    stringAppendLong(tokens, lexer->tokenStart);
+    stringAppendCstr(tokens, lexer->fscanfFlag == EOF ? " eof " : " ");
+    stringAppend(tokens, lexer->buffer.str, lexer->buffer.size);
+    if (lexer->tokenClass == N_INTEGER || lexer->tokenClass == N_REAL) {
+        unsigned long bits;
+        memcpy(&bits, &lexer->value, sizeof bits);
+        stringAppendChar(tokens, ' ');
+        stringAppendLong(tokens, bits);
+    }
+    stringAppendChar(tokens, '\n');
+}
+
+/**
+ * @brief Checks the value of a number token against the C library conversions
+ *
+ * @param lexer a lexer instance
+ */
+void _checkValue(Lexer* lexer) {
+    if (lexer->tokenClass == N_INTEGER) {
+        errno = 0;
+        long value = strtol(lexer->buffer.str, NULL, 10);
+        if (value != lexer->value.integer && !(errno == ERANGE && lexer->value.integer == LONG_MAX))
+            abort();
+    } else if (lexer->tokenClass == N_REAL) {
+        double value = strtod(lexer->buffer.str, NULL);
+        if (memcmp(&value, &lexer->value.real, sizeof value))
+            abort();
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ * @file parallellexer.c
+ * @brief Fuzz target of the parallel lexer: lexes the input as a stream and in parallel chunks and
+ * checks that the tokens, their values and the errors are the same. The chunk count depends on the
+ * input, tiny chunks exercise the stitching. Threads are started on every input, so this target is
+ * slower than the others.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../header/diagnostics.h"
+#include "../header/lexer.h"
+#include "../header/parallellexer.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+void _appendToken(String* tokens, Lexer* lexer);
+
+/**
+ * @brief Lexes one input sequentially and in parallel
+ *
+ * @param data input bytes
+ * @param size number of bytes
+ * @return int always 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    Diagnostics diagnostics;
+    diagnosticsInit(&diagnostics, FORMAT_JSON, 0);
+    String tokens;
+    stringInit(&tokens);
+    Lexer lexer;
+    if (!lexerInitBuffer(&lexer, (const char*)data, size)) {
+        do {
+            nextToken(&lexer, &diagnostics);
+            _appendToken(&tokens, &lexer);
+        } while (lexer.tokenClass != LAMBDA);
+        lexerDestroy(&lexer);
+    }
+    String report;
+    stringInit(&report);
+    diagnosticsRender(&diagnostics, &report, NULL);
+
+    Diagnostics parallelDiagnostics;
+    diagnosticsInit(&parallelDiagnostics, FORMAT_JSON, 0);
+    String parallelTokens;
+    stringInit(&parallelTokens);
+    ParallelLexer lexed;
+    parallelLexerRun(&lexed, (const char*)data, size, 1 + size % 8);
+    if (!lexerInitBuffer(&lexer, (const char*)data, size)) {
+        do {
+            parallelLexerNext(&lexed, &lexer, &parallelDiagnostics);
+            _appendToken(&parallelTokens, &lexer);
+        } while (lexer.tokenClass != LAMBDA);
+        lexerDestroy(&lexer);
+    }
+    parallelLexerDestroy(&lexed);
+
+    String parallelReport;
+    stringInit(&parallelReport);
+    diagnosticsRender(&parallelDiagnostics, &parallelReport, NULL);
+    if (tokens.size != parallelTokens.size || memcmp(tokens.str, parallelTokens.str, tokens.size) ||
+        strcmp(report.str, parallelReport.str))
+        abort();
+
+    stringDestroy(&parallelReport);
+    stringDestroy(&parallelTokens);
+    diagnosticsDestroy(&parallelDiagnostics);
+    stringDestroy(&report);
+    stringDestroy(&tokens);
+    diagnosticsDestroy(&diagnostics);
+    return 0;
+}
+
+/**
+ * @brief Appends the current token of the lexer (class, offset, end of file flag, lexeme and value)
+ *
+ * @param tokens string where the token is appended
+ * @param lexer a lexer instance
+ */
+void _appendToken(String* tokens, Lexer* lexer) {
+    stringAppendInt(tokens, lexer->tokenClass);
+    stringAppendChar(tokens, ' ');
+    stringAppendLong(tokens, lexer->tokenStart);
+    stringAppendCstr(tokens, lexer->fscanfFlag == EOF ? " eof " : " ");
+    stringAppend(tokens, lexer->buffer.str, lexer->buffer.size);
+    if (lexer->tokenClass == N_INTEGER || lexer->tokenClass == N_REAL) {
+        unsigned long bits;
+        memcpy(&bits, &lexer->value, sizeof bits);
+        stringAppendChar(tokens, ' ');
+        stringAppendLong(tokens, bits);
+    }
+    stringAppendChar(tokens, '\n');
+}
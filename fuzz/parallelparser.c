@@ -0,0 +1,105 @@
+/**
+ * @file parallelparser.c
+ * @brief Fuzz target of the parallel parser: compiles the input with the recursive engine, then
+ * compiles it again with the tokens lexed in parallel and the procedures parsed in parallel and
+ * checks that the diagnostics are the same, and that the tokens recorded for the semantic analysis
+ * are the same when there is no error. Threads are started on every input, so this target is
+ * slower than the others.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../header/diagnostics.h"
+#include "../header/parallellexer.h"
+#include "../header/parser.h"
+#include "../header/pmm.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+bool _sameTokens(const ProgramTokens* tokens, const ProgramTokens* parallelTokens);
+
+/**
+ * @brief Compiles one input sequentially and in parallel
+ *
+ * @param data input bytes
+ * @param size number of bytes
+ * @return int always 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // recursive engine, through the in-memory entry point
+    Diagnostics diagnostics;
+    diagnosticsInit(&diagnostics, FORMAT_JSON, 0);
+    pmmCompileBuffer((const char*)data, size, &diagnostics);
+    String report;
+    stringInit(&report);
+    diagnosticsRender(&diagnostics, &report, NULL);
+    diagnosticsDestroy(&diagnostics);
+
+    // recursive engine, recording the tokens
+    diagnosticsInit(&diagnostics, FORMAT_JSON, 0);
+    ProgramTokens tokens;
+    programTokensInit(&tokens);
+    Parser parser;
+    if (!parserInitBuffer(&parser, (const char*)data, size, &diagnostics)) {
+        parser.recorded = &tokens;
+        compile(&parser);
+        parserDestroy(&parser);
+    }
+    diagnosticsDestroy(&diagnostics);
+
+    // recursive engine, tokens lexed in parallel and procedures parsed in parallel
+    diagnosticsInit(&diagnostics, FORMAT_JSON, 0);
+    ProgramTokens parallelTokens;
+    programTokensInit(&parallelTokens);
+    ParallelLexer lexed;
+    parallelLexerRun(&lexed, (const char*)data, size, 1 + size % 4);
+    int errorCount = 1;
+    if (!parserInitBuffer(&parser, (const char*)data, size, &diagnostics)) {
+        parser.lexed = &lexed;
+        parser.jobs = 2 + size % 3;
+        parser.recorded = &parallelTokens;
+        compile(&parser);
+        errorCount = parser.errorCount;
+        parser.lexed = NULL;  // destroyed below
+        parserDestroy(&parser);
+    }
+    parallelLexerDestroy(&lexed);
+    String parallelReport;
+    stringInit(&parallelReport);
+    diagnosticsRender(&diagnostics, &parallelReport, NULL);
+    if (strcmp(report.str, parallelReport.str) || (errorCount == 0 && !_sameTokens(&tokens, &parallelTokens)))
+        abort();
+
+    programTokensDestroy(&parallelTokens);
+    programTokensDestroy(&tokens);
+    stringDestroy(&parallelReport);
+    stringDestroy(&report);
+    diagnosticsDestroy(&diagnostics);
+    return 0;
+}
+
+/**
+ * @brief Compares the tokens recorded by two compilations: classes, values of the numbers, lexemes
+ * and positions
+ *
+ * @param tokens tokens of the sequential compilation
+ * @param parallelTokens tokens of the parallel compilation
+ * @return true if they are the same
+ * @return false otherwise
+ */
+bool _sameTokens(const ProgramTokens* tokens, const ProgramTokens* parallelTokens) {
+    if (tokens->size != parallelTokens->size)
+        return false;
+    for (unsigned long i = 0; i < tokens->size; i++) {
+        const ProgramToken* token = &tokens->list[i];
+        const ProgramToken* parallelToken = &parallelTokens->list[i];
+        bool number = token->tokenClass == N_INTEGER || token->tokenClass == N_REAL;  // only numbers have a value
+        if (token->tokenClass != parallelToken->tokenClass ||
+            (number && memcmp(&token->value, &parallelToken->value, sizeof(TokenValue))) ||
+            strcmp(tokens->lexemes.str + token->text, parallelTokens->lexemes.str + parallelToken->text) ||
+            memcmp(&token->position, &parallelToken->position, sizeof(SourcePosition)))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file parser.c
+ * @brief Fuzz target of the parser: compiles the input with both engines and renders the
+ * diagnostics in every format. The parallel parser has its own target (parallelparser.c), which
+ * starts threads on every input.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../header/diagnostics.h"
+#include "../header/parser.h"
+#include "../header/pmm.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/**
+ * @brief Renders the diagnostics in every format
+ *
+ * @param diagnostics recorded diagnostics
+ */
+void renderAll(Diagnostics* diagnostics) {
+    const int formats[] = {FORMAT_TEXT, FORMAT_JSON, FORMAT_SARIF};
+    for (unsigned long i = 0; i < sizeof(formats) / sizeof(int); i++) {
+        String report;
+        stringInit(&report);
+        diagnostics->format = formats[i];
+        diagnosticsRender(diagnostics, &report, "fuzz.pmm");
+        stringDestroy(&report);
+    }
+}
+
+/**
+ * @brief Compiles one input
+ *
+ * @param data input bytes
+ * @param size number of bytes
+ * @return int always 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // recursive engine, through the in-memory entry point
+    Diagnostics diagnostics;
+    diagnosticsInit(&diagnostics, FORMAT_TEXT, 0);
+    pmmCompileBuffer((const char*)data, size, &diagnostics);
+    renderAll(&diagnostics);
+    diagnosticsDestroy(&diagnostics);
+
+    // table-driven engine
+    diagnosticsInit(&diagnostics, FORMAT_TEXT, 0);
+    Parser parser;
+    if (!parserInitBuffer(&parser, (const char*)data, size, &diagnostics)) {
+        parser.engine = ENGINE_TABLE;
+        compile(&parser);
+        parserDestroy(&parser);
+    }
+    diagnosticsDestroy(&diagnostics);
+    return 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file cgen.h
+ * @brief C code generation (--emit-c): the checked tree of a program is translated to a single
+ * portable C file, with its runtime included, that a C compiler turns into a native executable
+ * behaving like --run (same output, same runtime errors).
+ */
+#ifndef CGEN_H
+#define CGEN_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "../header/program.h"
+
+typedef struct {
+    const Program* program;
+    FILE* output;
+    int depth;  // indentation level
+    int loops;  // nesting of for loops, names their final values
+    bool* called;  // procedures reachable from the program body, the only ones written
+    int* chain;    // stack of the expression chains being written (from an operator down its first operands)
+    int chainSize;
+    int chainCapacity;
+} CGen;
+
+bool cgenEmit(const Program* program, const char* sourcePath, const char* outputPath);  // returns true on error
+
+// auxiliary functions
+void _cgenRuntime(CGen* cgen);
+void _cgenCalls(CGen* cgen, int node, int* pending, int* count);  // marks the procedures called by a list of commands
+void _cgenProcedure(CGen* cgen, int procedure, bool prototype);
+void _cgenIndent(CGen* cgen);
+void _cgenBody(CGen* cgen, int node);  // commands of a block, or a single command
+void _cgenCommand(CGen* cgen, int node);
+void _cgenFor(CGen* cgen, int node);
+void _cgenExpression(CGen* cgen, int node);
+int _cgenPrecedence(const Node* node);  // of an infix operator, 0 for other nodes
+void _cgenVariable(CGen* cgen, int symbol);
+void _cgenDeclaration(CGen* cgen, int symbol);  // type and name
+
+#endif  // CGEN_H
@@ -0,0 +1,51 @@
+/**
+ * @file dataflow.h
+ * @brief Definite assignment analysis (--warn-uninitialized): a forward data flow over the checked
+ * tree of each procedure and of the program body, with the assigned variables as bit vectors,
+ * warns about the variables that may be read before any read or := assigns them.
+ */
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <stdint.h>
+
+#include "../header/diagnostics.h"
+#include "../header/program.h"
+
+typedef struct {
+    const Program* program;
+    const ProgramTokens* tokens;  // positions of the warnings
+    Diagnostics* diagnostics;
+    int scope;          // function being analyzed (GLOBAL_SCOPE for the program body)
+    int words;          // words of a bit vector of the function: the globals, then its parameters and locals
+    int globalWords;    // words of a bit vector of the globals
+    uint64_t* states;   // assigned variables: the current state, then the saved ones
+    int depth;          // saved states in use
+    int stateCapacity;  // saved states allocated
+    uint64_t* assigned; // globals each procedure assigns on every path, with the ones its callees assign
+    uint64_t* entries;  // globals assigned at every call of each procedure
+    uint64_t* anywhere; // globals assigned somewhere in the program
+    uint64_t* reported; // variables already reported in the function
+    bool warn;          // false while the summaries of the procedures are computed
+    const Node** pending;  // reads to warn about, recorded in source order at the end
+    int pendingCapacity;
+    int warnings;
+} Dataflow;
+
+int dataflowCheck(const Program* program, const ProgramTokens* tokens, Diagnostics* diagnostics);  // returns the number of warnings
+
+// auxiliary functions
+void _dataflowFunction(Dataflow* dataflow, int scope, int body, const uint64_t* entry);
+int _dataflowVariable(const Dataflow* dataflow, int symbol);  // bit of a variable
+int _dataflowSave(Dataflow* dataflow);  // pushes a copy of the current state, returns its level
+void _dataflowMerge(Dataflow* dataflow, int level, bool intersect);  // the current state becomes a saved one, or its intersection with it
+void _dataflowCommands(Dataflow* dataflow, int node);
+void _dataflowCall(Dataflow* dataflow, int callee);
+void _dataflowAssign(Dataflow* dataflow, int symbol);
+void _dataflowUse(Dataflow* dataflow, int node);  // reads of an expression
+void _dataflowWarn(Dataflow* dataflow, int node);
+void _dataflowReport(Dataflow* dataflow);
+int _dataflowCompare(const void* a, const void* b);  // orders the warnings by position
+const ProgramToken* _dataflowToken(const Dataflow* dataflow, int line, int col);
+
+#endif  // DATAFLOW_H
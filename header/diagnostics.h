@@ -0,0 +1,79 @@
+/**
+ * @file diagnostics.h
+ * @brief Buffered compiler diagnostics (errors are recorded during compilation and rendered once at the end)
+ */
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "../header/input.h"
+#include "../header/string.h"
+
+#define NO_TEXT ((unsigned long)-1)  // diagnostic has no offending lexeme (unexpected end of file)
+
+// kinds of recorded diagnostics
+enum DIAGNOSTIC_KIND { DIAGNOSTIC_LEXER,
+                       DIAGNOSTIC_PARSER,
+                       DIAGNOSTIC_EOF,
+                       DIAGNOSTIC_SEMANTIC,
+                       DIAGNOSTIC_WARNING };  // variable that may be read before it is assigned
+
+// available output formats
+enum DIAGNOSTIC_FORMAT { FORMAT_TEXT,
+                         FORMAT_JSON,
+                         FORMAT_SARIF };
+
+// a single compact diagnostic record
+typedef struct {
+    char kind;           // DIAGNOSTIC_KIND
+    int line;            // line on P-- source code file
+    int col;             // column on P-- source code file
+    unsigned long offset;      // byte offset of the error (or NO_OFFSET)
+    unsigned long lineOffset;  // byte offset of the beginning of its line (or NO_OFFSET)
+    int code;            // lexer: automaton state, parser: expected token class, semantic: SEMANTIC_ERROR, warning: 0
+    unsigned long text;  // offset of the offending lexeme in the text pool (or NO_TEXT)
+} Diagnostic;
+
+// diagnostics sink
+typedef struct {
+    Diagnostic* list;
+    unsigned long size;
+    unsigned long capacity;
+    String textPool;  // '\0' separated lexemes referenced by the diagnostics
+    String scratch;   // messages and source lines while rendering (freed with the diagnostics)
+
+    int format;              // DIAGNOSTIC_FORMAT
+    int maxErrors;           // maximum number of recorded errors (0 means no limit)
+    bool snippets;           // text errors are followed by the source line with a caret underline
+    unsigned long errors;    // number of recorded errors
+    unsigned long dropped;   // number of errors not recorded because of maxErrors
+    unsigned long warnings;  // number of recorded warnings (they aren't errors, nor limited)
+} Diagnostics;
+
+void diagnosticsInit(Diagnostics* diagnostics, int format, int maxErrors);
+void diagnosticsDestroy(Diagnostics* diagnostics);
+void diagnosticsClear(Diagnostics* diagnostics);  // forgets the recorded diagnostics
+
+void diagnosticsLexerError(Diagnostics* diagnostics, const SourcePosition* position, const char* lexeme, int state);
+void diagnosticsParserError(Diagnostics* diagnostics, const SourcePosition* position, int expectedTokenClass, const char* found);
+void diagnosticsEOF(Diagnostics* diagnostics);
+void diagnosticsSemanticError(Diagnostics* diagnostics, const SourcePosition* position, int code, const char* name);
+void diagnosticsWarning(Diagnostics* diagnostics, const SourcePosition* position, const char* name);
+
+void diagnosticsRender(Diagnostics* diagnostics, String* report, const char* sourcePath);  // renders all diagnostics in the selected format
+bool diagnosticsFlush(Diagnostics* diagnostics, const char* sourcePath, FILE* stream, const char* outputFilePath);
+int diagnosticsParseFormat(const char* name);  // returns the DIAGNOSTIC_FORMAT given its name or -1
+
+// auxiliary functions used during rendering
+Diagnostic* _diagnosticsNew(Diagnostics* diagnostics, int kind);
+void _diagnosticsMessage(Diagnostics* diagnostics, const Diagnostic* diagnostic, String* message);
+void _diagnosticsRenderText(Diagnostics* diagnostics, String* report, const char* sourcePath);
+void _diagnosticsSnippet(const Diagnostic* diagnostic, const char* lexeme, FILE* source, String* line, String* report);
+void _diagnosticsRenderJson(Diagnostics* diagnostics, String* report);
+void _diagnosticsRenderSarif(Diagnostics* diagnostics, String* report, const char* sourcePath);
+int _diagnosticsCodePoints(const Diagnostic* diagnostic, FILE* source);  // SARIF column, 0 if unknown
+void _appendJsonString(String* s, const char* cstr);
+
+#endif  // DIAGNOSTICS_H
@@ -0,0 +1,57 @@
+/**
+ * @file inliner.h
+ * @brief Procedure inlining: on the checked tree, the calls of small procedures that aren't
+ * recursive become blocks that assign the arguments to fresh copies of the parameters and run a
+ * copy of the body, so every back end (--run, --emit-c, --emit-ir) saves the call overhead.
+ */
+#ifndef INLINER_H
+#define INLINER_H
+
+#include <stdio.h>
+
+#include "../header/program.h"
+
+#define INLINER_MAX_SIZE 40     // nodes of the largest body inlined
+#define INLINER_MIN_BUDGET 400  // nodes a function can grow by, or its own size if larger
+
+// decisions on a call site
+enum INLINER_DECISION { INLINER_INLINED,
+                        INLINER_RECURSIVE,
+                        INLINER_TOO_LARGE,
+                        INLINER_BUDGET };
+
+typedef struct {
+    Program* program;
+    FILE* report;      // where the decisions are printed (NULL if they aren't)
+    int* callees;      // call graph: the procedures each one calls, from calleeStart[p] to calleeStart[p + 1]
+    int* calleeStart;
+    int calleeCount;
+    int calleeCapacity;
+    bool* recursive;   // procedures in a cycle of the call graph
+    int* order;        // procedures, the callees before their callers
+    int* sizes;        // nodes of each body once its own calls are inlined
+    int* map;          // fresh variable of each parameter and local of the procedure inlined
+    int mapCapacity;
+    int budget;        // nodes the function being processed can still grow by
+    int variables;     // fresh variables, they number their names
+    int inlined;
+    int kept;
+} Inliner;
+
+void inlinerRun(Program* program, FILE* report);  // the decisions are printed to report if not NULL
+
+// auxiliary functions
+void _inlinerCalls(Inliner* inliner, int node);  // adds the procedures called by a list of commands to the graph
+void _inlinerCycles(Inliner* inliner);            // finds the recursive procedures and the order
+void _inlinerFunction(Inliner* inliner, int scope, int body);
+void _inlinerSites(Inliner* inliner, int scope, int node, int loops);
+int _inlinerDecide(Inliner* inliner, int callee, int cost);
+void _inlinerReport(Inliner* inliner, int scope, int node, int decision, int size);
+void _inlinerInline(Inliner* inliner, int scope, int node, int callee, bool reset);
+int _inlinerVariable(Inliner* inliner, int scope, int original);
+int _inlinerNode(Inliner* inliner, int from);  // appends a copy of a node without its children
+int _inlinerCopy(Inliner* inliner, int node, int callee);
+int _inlinerCopyChain(Inliner* inliner, int node, int callee);  // a node and its children, without its next node
+int _inlinerSize(const Program* program, int node);
+
+#endif  // INLINER_H
@@ -0,0 +1,108 @@
+/**
+ * @file input.h
+ * @brief Streaming source code input (ring buffer with one character pushback). Positions are
+ * byte offsets; lines and columns are only computed when asked for, by a cursor that scans the
+ * newlines with memchr (lines are indexed lazily, in order, without storing every line start).
+ */
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define INPUT_BUFFER_SIZE (1 << 16)  // ring buffer size (must be a power of two)
+#define INPUT_MASK (INPUT_BUFFER_SIZE - 1)
+#define NO_OFFSET ((unsigned long)-1)  // position without a byte offset (token streams)
+
+// position on the source code
+typedef struct {
+    unsigned long offset;      // byte offset (or NO_OFFSET)
+    unsigned long lineOffset;  // byte offset of the beginning of the line (or NO_OFFSET)
+    int line;
+    int col;  // in code points, a tab counts as 4 columns
+} SourcePosition;
+
+// source code being read, memory usage doesn't depend on the input size
+typedef struct {
+    FILE* file;                   // NULL when there is no source code or it is in memory
+    const unsigned char* memory;  // in-memory source code (NULL when it is read from a file)
+    unsigned long memorySize;
+    bool ownsFile;      // whether the file must be closed (stdin isn't)
+    bool eof;           // the end of the input was reached
+    unsigned long head; // number of consumed bytes (offset of the next char)
+    unsigned long tail; // number of bytes read from the file
+    SourcePosition cursor;  // lines before the cursor are indexed, it only moves forward
+    unsigned long mark;     // start of the token being read, set by inputMark before a refill
+    SourcePosition marked;  // position of mark, saved when a refill moves the cursor past it
+    unsigned char ring[INPUT_BUFFER_SIZE];
+} Input;
+
+bool inputOpen(Input* input, const char* path);  // opens a file or stdin if path is "-"
+void inputOpenBuffer(Input* input, const char* source, unsigned long size);
+void inputClose(Input* input);
+void inputPosition(Input* input, unsigned long offset, SourcePosition* position);  // line and column of a byte offset
+bool _inputRefill(Input* input);
+void _inputReset(Input* input);
+void _inputAdvance(Input* input, unsigned long offset);
+
+/**
+ * @brief Reads the next char
+ *
+ * @param input an input instance
+ * @return int the char or EOF
+ */
+static inline int inputGetc(Input* input) {
+    if (input->head == input->tail && _inputRefill(input))
+        return EOF;
+    return input->ring[input->head++ & INPUT_MASK];
+}
+
+/**
+ * @brief Marks the start of the token being read, whose position must be kept if the next refill
+ * overwrites it (tokens longer than half of the ring buffer). Called before reading past the
+ * readable bytes.
+ *
+ * @param input an input instance
+ * @param offset byte offset of the first char of the token (the head when no token was started)
+ */
+static inline void inputMark(Input* input, unsigned long offset) {
+    input->mark = offset;
+}
+
+/**
+ * @brief Retreats one char (the last char read is always kept in the ring buffer)
+ *
+ * @param input an input instance
+ */
+static inline void inputUngetc(Input* input) {
+    input->head--;
+}
+
+/**
+ * @brief Returns the bytes that can be read without refilling the ring buffer (none when every
+ * byte read was consumed). They are consumed with inputSkip.
+ *
+ * @param input an input instance
+ * @param end set to the end of the readable bytes
+ * @return const unsigned char* the next char
+ */
+static inline const unsigned char* inputSpan(Input* input, const unsigned char** end) {
+    unsigned long index = input->head & INPUT_MASK;
+    unsigned long size = input->tail - input->head;
+    if (size > INPUT_BUFFER_SIZE - index)  // the readable bytes wrap around the ring
+        size = INPUT_BUFFER_SIZE - index;
+    *end = input->ring + index + size;
+    return input->ring + index;
+}
+
+/**
+ * @brief Consumes chars returned by inputSpan
+ *
+ * @param input an input instance
+ * @param count number of chars
+ */
+static inline void inputSkip(Input* input, unsigned long count) {
+    input->head += count;
+}
+
+#endif  // INPUT_H
@@ -0,0 +1,188 @@
+/**
+ * @file ir.h
+ * @brief SSA intermediate representation (--emit-ir): each procedure and the program body of a
+ * checked tree become a control flow graph of basic blocks whose instructions define a value once,
+ * with phi instructions where the values of a variable meet after if, while and for. The
+ * optimizations (global value numbering with constant folding, dead store and dead code
+ * elimination) work on this form.
+ */
+#ifndef IR_H
+#define IR_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "../header/program.h"
+
+// operations of the instructions, the fields they use are listed after them
+enum IR_OP { IR_CONST,     // value
+             IR_PARAM,     // symbol (parameter)
+             IR_LOAD,      // symbol (global variable), its value in memory
+             IR_STORE,     // symbol (global variable) := a, before calls and returns
+             IR_NEGATE,    // -a
+             IR_TO_REAL,   // a, an integer converted to real
+             IR_ADD,       // a + b, in the order of NODE_ADD to NODE_DIVIDE
+             IR_SUBTRACT,  // a - b
+             IR_MULTIPLY,  // a * b
+             IR_DIVIDE,    // a / b, line and col of the operator
+             IR_COMPARE,   // a relation b
+             IR_READ,      // symbol (variable), line and col of the read
+             IR_WRITE,     // a, last is set on the last value of a write
+             IR_CALL,      // symbol (procedure), arguments
+             IR_PHI,       // arguments, one per predecessor of the block in the same order
+             IR_JUMP,      // to the successor of the block
+             IR_BRANCH,    // a condition (IR_COMPARE), to the first successor if true
+             IR_RETURN };
+
+typedef struct {
+    char op;           // IR_OP
+    char type;         // TYPE of the value (of the operands of IR_COMPARE)
+    char relation;     // RELATION_OP of IR_COMPARE
+    char last;         // IR_WRITE of the last value
+    bool removed;      // deleted by an optimization
+    int replacement;   // value that replaces it (itself if none)
+    int block;
+    int a, b;          // operands
+    int symbol;
+    int arguments;     // first argument of IR_CALL and IR_PHI in the argument pool
+    int argumentCount;
+    TokenValue value;  // IR_CONST
+    int line, col;
+} IrInstruction;
+
+// flags of the globals referenced by a function
+enum IR_GLOBAL { IR_REFERENCED = 1,
+                 IR_WRITTEN = 2 };
+
+// control flow is structured: blocks have at most two predecessors and two successors
+typedef struct {
+    int* instructions;  // phis first, the terminator last
+    int count;
+    int capacity;
+    int predecessors[2];
+    int predecessorCount;
+    int successors[2];
+    int successorCount;
+} IrBlock;
+
+typedef struct {
+    int procedure;  // index in the procedures of the program, -1 for the program body
+    IrInstruction* instructions;
+    int instructionCount;
+    int instructionCapacity;
+    IrBlock* blocks;  // block 0 is the entry
+    int blockCount;
+    int blockCapacity;
+    int* arguments;
+    int argumentCount;
+    int argumentCapacity;
+
+    int before;     // instructions after the construction
+    int numbered;   // removed by value numbering (equal to a dominating value)
+    int deadStores;
+    int dead;       // unused values
+} IrFunction;
+
+// an assignment undone when leaving a branch: variable and its previous (or final) value
+typedef struct {
+    int variable;
+    int value;
+} IrChange;
+
+// a variable assigned in a loop: its value before the loop, its phi at the loop header and its
+// value where a for loop leaves from its last iteration
+typedef struct {
+    int variable;
+    int entry;
+    int phi;
+    int exit;
+} IrLoopVariable;
+
+typedef struct {
+    const Program* program;
+    IrFunction* functions;  // the procedures, then the program body
+    int functionCount;
+
+    // construction of the current function, variables are its parameters and locals and then the globals
+    IrFunction* function;
+    int block;          // block being filled
+    int localCount;     // parameters and locals
+    int variableCount;
+    int* current;       // value of each variable at the end of the block
+    int* stamps;        // marks of the variables already seen by a pass over a list
+    int* joined;        // values of the variables at the end of the then branch of an if
+    int stamp;
+    char* globals;      // IR_GLOBAL flags of each global (by index)
+    int* referenced;    // symbols of the globals used or assigned by the function
+    int referencedCount;
+    int* written;       // symbols of the globals assigned by the function
+    int writtenCount;
+    int* setStart;      // variables assigned by each loop node: first one in sets
+    int* setLength;
+    int* sets;
+    int setCount;
+    int setCapacity;
+    IrChange* log;      // previous values of the assignments, in order
+    int logSize;
+    int logCapacity;
+    IrChange* changes;  // values at the end of the branches of the ifs being built
+    int changeCount;
+    int changeCapacity;
+    IrLoopVariable* loops;  // variables of the loops being built
+    int loopCount;
+    int loopCapacity;
+    int* chain;             // nodes of the expressions being built, from an operator down its first operands
+    int chainSize;
+    int chainCapacity;
+} Ir;
+
+void irBuild(Ir* ir, const Program* program);
+void irOptimize(Ir* ir);
+void irPrint(Ir* ir, FILE* output);  // the optimized functions and the instruction counts
+void irDestroy(Ir* ir);
+
+// auxiliary functions: construction
+void* _irGrow(void* array, int* capacity, int count, unsigned long size);  // room for one more element
+void _irFunction(Ir* ir, int procedure);
+void _irScan(Ir* ir, int node);  // globals referenced and written
+void _irGlobal(Ir* ir, int symbol, bool write);
+int _irVariable(const Ir* ir, int symbol);
+int _irBlock(Ir* ir);
+void _irEdge(Ir* ir, int to);  // from the current block
+int _irEmit(Ir* ir, int block, int op, int type, int a, int b);
+int _irArguments(Ir* ir, int count);  // returns the first one
+int _irPhi(Ir* ir, int block, int type);
+void _irPhiOperand(Ir* ir, int phi, int predecessor, int value);
+int _irMerge(Ir* ir, int first, int firstBlock, int second, int secondBlock);
+void _irSet(Ir* ir, int variable, int value);
+void _irRestore(Ir* ir, int mark);
+void _irCollect(Ir* ir, int mark);  // pushes the variables assigned since the mark with their values
+void _irLoopSets(Ir* ir, int node);
+void _irAssigned(Ir* ir, int node);
+void _irAssignedVariable(Ir* ir, int variable);
+void _irLoopVariable(Ir* ir, int variable);
+void _irMemory(Ir* ir, bool load);   // loads the referenced globals or stores the written ones
+void _irCommand(Ir* ir, int node);
+void _irCall(Ir* ir, int node);
+void _irIf(Ir* ir, int node);
+void _irWhile(Ir* ir, int node);
+void _irFor(Ir* ir, int node);
+int _irExpression(Ir* ir, int node);
+int _irCompare(Ir* ir, int relation, int a, int b);
+
+// auxiliary functions: optimization
+int _irResolve(IrFunction* function, int value);
+int _irOrder(const IrFunction* function, int* order, int* position);  // reverse postorder, returns the reachable blocks
+void _irDominators(const IrFunction* function, const int* order, const int* position, int count, int* enter, int* leave);
+void _irDeadStores(IrFunction* function);
+void _irNumber(IrFunction* function);
+bool _irFold(IrFunction* function, int value);
+unsigned long _irHash(const IrInstruction* instruction);
+bool _irSameValue(const IrInstruction* x, const IrInstruction* y);
+int _irSimplifyPhis(IrFunction* function);  // returns the phis removed
+void _irDeadCode(IrFunction* function);
+bool _irEffect(const IrFunction* function, int value);  // kept even if unused
+int _irCount(const IrFunction* function);
+void _irPrintInstruction(Ir* ir, IrFunction* function, int value, FILE* output);
+
+#endif  // IR_H
@@ -0,0 +1,153 @@
+/**
+ * @file jit.h
+ * @brief x86-64 code generation (--run): the checked tree of a program is translated to machine
+ * code in executable memory and run in the compiler process, without assembler or linker. Only
+ * x86-64 hosts with the System V calling convention are supported.
+ */
+#ifndef JIT_H
+#define JIT_H
+
+#include <stdbool.h>
+
+#include "../header/program.h"
+#include "../header/runtime.h"
+
+#define JIT_INTEGER_REGISTERS 4  // integer variables cached in r12 to r15 (r12 to r14 in sandboxed code)
+#define JIT_REAL_REGISTERS 8     // real variables cached in xmm8 to xmm15
+
+// general purpose registers, by encoding (xmm registers are numbered the same way)
+enum JIT_REGISTER { REG_RAX,
+                    REG_RCX,
+                    REG_RDX,
+                    REG_RBX,
+                    REG_RSP,
+                    REG_RBP,
+                    REG_RSI,
+                    REG_RDI,
+                    REG_R8,
+                    REG_R12 = 12,
+                    REG_R15 = 15 };
+
+// integer operations with a register or memory second operand, or an immediate one
+enum JIT_ALU { ALU_ADD,
+               ALU_SUBTRACT,
+               ALU_MULTIPLY,
+               ALU_COMPARE,
+               ALU_MOVE };
+
+// cached variables stored or reloaded around calls
+enum JIT_SPILL { SPILL_INTEGER_GLOBALS = 1,
+                 SPILL_REAL_GLOBALS = 2,
+                 SPILL_REAL_LOCALS = 4 };  // and parameters
+
+// a jump or call to a label, its rel32 is filled in when the code is complete
+typedef struct {
+    unsigned long at;  // offset of the rel32
+    int label;
+} JitFixup;
+
+// out of line call of runtimeFail
+typedef struct {
+    int label;
+    int status;  // RUNTIME_STATUS
+    long where;  // RUNTIME_WHERE
+} JitStub;
+
+// a variable kept in a register by the procedure (or the program) being generated
+typedef struct {
+    int symbol;
+    int reg;
+} JitCached;
+
+typedef struct {
+    const Program* program;
+    bool sandbox;  // steps counted in r15 at loop back-edges and procedure entries, stack checked at entries
+
+    // machine code being generated
+    unsigned char* code;
+    unsigned long size;
+    unsigned long capacity;
+    long* labels;  // offset of each label (-1 while unbound), the first ones are the procedures
+    int labelCount;
+    int labelCapacity;
+    JitFixup* fixups;
+    unsigned long fixupCount;
+    unsigned long fixupCapacity;
+    JitStub* stubs;
+    int stubCount;
+    int stubCapacity;
+
+    // procedure (or program) being generated
+    int scope;
+    int* registers;  // register of each symbol (-1 if it lives in memory)
+    long* weights;   // estimated uses of each symbol
+    int* touched;    // symbols with a weight
+    int touchedCount;
+    JitCached cached[JIT_INTEGER_REGISTERS + JIT_REAL_REGISTERS];
+    int cachedCount;
+    int savedCount;     // callee-saved registers, stored in the first slots of the frame
+    int slots;          // slots of the frame in use
+    int maxSlots;
+    bool realsSpilled;  // the cached reals are in memory, during calls of the runtime
+    int* chain;         // nodes of the expressions being walked, from an operation down its first operands
+    int chainSize;
+    int chainCapacity;
+
+    // result
+    unsigned char* memory;  // executable mapping
+    unsigned long mapped;
+    unsigned long entry;  // offset of the program
+    long* data;           // the runtime and then the global variables
+} Jit;
+
+bool jitCompile(Jit* jit, const Program* program, bool sandbox);  // returns true on error
+int jitRun(Jit* jit, Runtime* runtime);               // returns the RUNTIME_STATUS
+void jitDestroy(Jit* jit);
+
+// auxiliary functions: instruction encoding
+void _jitByte(Jit* jit, int byte);
+void _jitInt32(Jit* jit, long value);
+void _jitInt64(Jit* jit, long value);
+void _jitRex(Jit* jit, int prefix, bool wide, int reg, int rm);  // mandatory prefix and REX
+void _jitOpcode(Jit* jit, int opcode);                             // 1 to 3 bytes
+void _jitRegister(Jit* jit, int prefix, bool wide, int opcode, int reg, int rm);
+void _jitMemory(Jit* jit, int prefix, bool wide, int opcode, int reg, int base, long disp);
+void _jitImmediate(Jit* jit, int reg, long value);
+void _jitRealImmediate(Jit* jit, int reg, double value);
+void _jitCallRuntime(Jit* jit, const void* function);
+int _jitLabel(Jit* jit);
+void _jitBind(Jit* jit, int label);
+void _jitJump(Jit* jit, int condition, int label);  // condition -1 is an unconditional jump
+void _jitCall(Jit* jit, int label);
+void _jitFixup(Jit* jit, int label);  // rel32 of a jump or call
+int _jitStub(Jit* jit, int status, long where);    // returns the label of the stub
+void _jitTick(Jit* jit, long where, bool entry);     // a step of the sandbox, entry of a procedure or loop back-edge
+
+// auxiliary functions: code generation
+void _jitUnit(Jit* jit, int scope, int body, int label);
+void _jitAllocate(Jit* jit, int body);
+void _jitCount(Jit* jit, int node, long weight);
+void _jitPush(Jit* jit, int node);  // on the chain stack
+void _jitHome(const Jit* jit, int symbol, int* base, long* disp);
+void _jitSpill(Jit* jit, int set);
+void _jitReload(Jit* jit, int set);
+void _jitLoad(Jit* jit, int reg, int symbol);
+void _jitStore(Jit* jit, int reg, int symbol);
+int _jitSlot(Jit* jit);  // temporary slot of the frame
+void _jitCommand(Jit* jit, int node);
+void _jitAssign(Jit* jit, int node);
+void _jitFor(Jit* jit, int node);
+void _jitForTest(Jit* jit, int node, int slot);
+void _jitProcedureCall(Jit* jit, int node);
+void _jitReadWrite(Jit* jit, int node);
+void _jitCondition(Jit* jit, int node, int label, bool when);
+void _jitExpression(Jit* jit, int node);
+bool _jitChained(const Jit* jit, int node);  // the first operand is generated first
+void _jitOperation(Jit* jit, int node, bool evaluated);
+bool _jitSimple(const Jit* jit, int node);
+bool _jitIntegerOperand(Jit* jit, int alu, int reg, int node);  // false if node isn't simple
+void _jitIntegerBinary(Jit* jit, int alu, int left, int right, bool evaluated);
+void _jitDivide(Jit* jit, int node, bool evaluated);
+int _jitRealBinary(Jit* jit, int left, int right, bool commutative, bool evaluated);  // returns the register of the other operand
+
+#endif  // JIT_H
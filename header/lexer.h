@@ -10,11 +10,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../header/diagnostics.h"
+#include "../header/input.h"
 #include "../header/string.h"
 
-#define NUMBER_OF_STATES 32                    // number of states of the lexic analyser automaton
+#define NUMBER_OF_STATES 42                    // number of states of the lexic analyser automaton
 #define NUMBER_OF_STATES_PROTECTED_SYMBOLS 65  // number of states of the protected symbol detection automaton
-#define NUMBER_OF_CHARS 128                    // number of ASCII characters
+#define NUMBER_OF_CHARS 256                    // number of byte values (ASCII and UTF-8 bytes)
 #define NUMBER_OF_LOWER_CASE_LETTERS 26        // number of lower case letters (inputs of the protected symbol detection automaton)
 
 #define COMMENT_STATE 30  // state of the automaton when reading a comment
@@ -23,6 +25,11 @@
 
 #define N_TOKEN_CLASS 33  // number of token classes
 
+#define INTEGER_OVERFLOW_ERROR NUMBER_OF_STATES  // lexer error code of an integer number too large for a long (not a state)
+#define NUMBER_OF_LEXER_ERROR_CODES (NUMBER_OF_STATES + 1)  // automaton states and INTEGER_OVERFLOW_ERROR
+
+#define TOKEN_DUMP_BUFFER_SIZE (1 << 16)  // the token dump is written to the file in blocks of this size
+
 // existing token classes
 enum TOKEN_CLASS { LAMBDA,
                    N_REAL,
@@ -58,17 +65,33 @@ enum TOKEN_CLASS { LAMBDA,
                    WHILE,
                    ERROR };
 
+// implementations of the lexer automaton, they recognize the same tokens
+enum AUTOMATON { AUTOMATON_DIRECT,  // direct-coded automaton generated from the transition matrix by tools/lexgen.c
+                 AUTOMATON_TABLE }; // interpreter of the transition matrix
+
+#define MAX_NESTING 10000  // nested parenthesized factors and compound commands the parsers accept
+
 enum MULTIPLE_EXPECTED { NUMBER = INT_MIN,
                          TYPES,
                          COMMAND,
-                         EQUALS };
+                         EQUALS,
+                         NESTING };  // reported when MAX_NESTING is exceeded
+
+// value of a number token
+typedef union {
+    long integer;  // N_INTEGER
+    double real;   // N_REAL
+} TokenValue;
 
 // defines the structures necessary for lexer operation
 typedef struct {
     String buffer;
-    FILE* sourceCode;
-    FILE* tokenOutput;
+    Input sourceCode;
+    FILE* tokenOutput;  // token dump file (NULL when the dump is disabled)
+    String tokenDump;   // token dump pending to be written
     int tokenClass;
+    TokenValue value;  // value of the current token, if it is a number
+    int automaton;  // AUTOMATON used by nextToken
 
     int transitionMatrix[NUMBER_OF_STATES][NUMBER_OF_CHARS];  // automaton transition matrix
     bool finalState[NUMBER_OF_STATES];                        // whether a state is final or not
@@ -79,20 +102,20 @@ typedef struct {
     // whether a state is final or not and their token class
     char protectedSymbolFinalStates[NUMBER_OF_STATES_PROTECTED_SYMBOLS];
 
-    char currChar;
-    int fscanfFlag;
+    unsigned char currChar;
+    int fscanfFlag;  // EOF once the end of the source code is reached
     int currState;  // current automaton state
-    int currLine;   // current line on P-- source code file
-    int currCol;    // current column on P-- source code file
+    unsigned long tokenStart;  // byte offset of the first char of the current token
 
     bool lastWasNumberOrIdent;  // indicates whether the last token was a number or identifier
 } Lexer;
 
-bool lexerInit(Lexer* lexer, const char* sourceFilePath);
+bool lexerInit(Lexer* lexer, const char* sourceFilePath, const char* tokenOutputPath);
+bool lexerInitBuffer(Lexer* lexer, const char* source, unsigned long size);  // lexes an in-memory source code
 void lexerDestroy(Lexer* lexer);
-int nextToken(Lexer* lexer, FILE* output);  // gets next token
+int nextToken(Lexer* lexer, Diagnostics* diagnostics);  // gets next token
 
-int lexerCurrColWithoutRetreat(Lexer* lexer);                 // return lexer col considering eventual retreats (for readability only)
+void lexerTokenPosition(Lexer* lexer, SourcePosition* position);  // line and column of the current token
 const char* lexerErrorMessage(int currState);                 // return error description given current automaton state
 const char* lexerTokenClassName(int token_class);             // returns token class name given token class number
 const char* lexerTokenClassUserFriendlyName(int tokenClass);  // return user friendly token class name given token class number
@@ -109,10 +132,16 @@ void _fillOther(int transitionMatrix[NUMBER_OF_STATES][NUMBER_OF_CHARS], int sta
 void _fillWord(int protectedSymbolMatrix[NUMBER_OF_STATES_PROTECTED_SYMBOLS][NUMBER_OF_LOWER_CASE_LETTERS], const char word[], int firstState, int secondState);
 
 // auxiliary functions used during lexer operation
+bool _scanWithTable(Lexer* lexer);
+bool _scanDirectCoded(Lexer* lexer);  // generated in build/lexerdirect.inc
 void _nextChar(Lexer* lexer);
 void _dealWithEOF(Lexer* lexer);
 void _nextState(Lexer* lexer);
 void _identifyTokenClass(Lexer* lexer);
 int _checkIfProtectedSymbol(Lexer* lexer);
+bool _convertNumber(Lexer* lexer);
+int _numberError(Lexer* lexer, Diagnostics* diagnostics);
+void _dumpToken(Lexer* lexer);
+void _flushTokenDump(Lexer* lexer);
 
 #endif  // LEXER_H
\ No newline at end of file
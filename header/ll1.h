@@ -0,0 +1,97 @@
+/**
+ * @file ll1.h
+ * @brief Table-driven LL(1) syntax analyser, an alternative to the recursive-descent functions
+ */
+#ifndef LL1_H
+#define LL1_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../header/parser.h"
+
+// nonterminals of the P-- grammar, numbered after the token classes
+enum NONTERMINAL { NT_PROGRAMA = 64,
+                   NT_CORPO,
+                   NT_DC,
+                   NT_DC_C,
+                   NT_DC_V,
+                   NT_TIPO_VAR,
+                   NT_VARIAVEIS,
+                   NT_MAIS_VAR,
+                   NT_DC_P,
+                   NT_PARAMETROS,
+                   NT_LISTA_PAR,
+                   NT_MAIS_PAR,
+                   NT_CORPO_P,
+                   NT_DC_LOC,
+                   NT_LISTA_ARG,
+                   NT_ARGUMENTOS,
+                   NT_MAIS_IDENT,
+                   NT_PFALSA,
+                   NT_COMANDOS,
+                   NT_CMD,
+                   NT_POS_IDENT,
+                   NT_CONDICAO,
+                   NT_RELACAO,
+                   NT_EXPRESSAO,
+                   NT_OP_UN,
+                   NT_OUTROS_TERMOS,
+                   NT_OP_AD,
+                   NT_TERMO,
+                   NT_MAIS_FATORES,
+                   NT_OP_MUL,
+                   NT_FATOR,
+                   NT_NUMERO,
+                   NT_END };
+
+#define N_NONTERMINALS (NT_END - NT_PROGRAMA)
+
+// an element of the right side of a production
+typedef struct {
+    int symbol;             // token class, MULTIPLE_EXPECTED or NONTERMINAL
+    const int* followers;   // synchronization tokens (NEXTRULE followers for nonterminals, PANICMODE followers for terminals)
+    int followerCount;
+} LL1Item;
+
+// a production of the grammar
+typedef struct {
+    int head;        // nonterminal
+    bool isDefault;  // chosen when no other production of the head starts with the lookahead
+    const LL1Item* items;
+    int size;
+} LL1Production;
+
+// parse table generated from the grammar
+typedef struct {
+    const LL1Production* table[N_NONTERMINALS][N_TOKEN_CLASS];  // production given nonterminal and lookahead
+    const LL1Production* defaults[N_NONTERMINALS];              // production used when the table has no entry
+    uint64_t first[N_NONTERMINALS];                             // FIRST sets (bitmask of token classes)
+} LL1Table;
+
+// a production being recognized
+typedef struct _ll1Frame {
+    const LL1Production* production;
+    int item;  // index of the item being recognized
+} LL1Frame;
+
+// explicit parse stack
+typedef struct {
+    LL1Frame* frames;
+    unsigned long size;
+    unsigned long capacity;
+} LL1Stack;
+
+void ll1Compile(Parser* parser);  // compiles using the table-driven engine
+bool ll1BuildTable(LL1Table* table);
+
+// auxiliary functions used by the table-driven engine
+void _ll1InitTable(void);
+uint64_t _ll1SymbolFirst(const LL1Table* table, int symbol);
+bool _ll1Matches(Parser* parser, int symbol);
+bool _ll1Nests(const LL1Production* production);
+void _ll1Push(LL1Stack* stack, const LL1Production* production);
+uint64_t _ll1SyncMask(const LL1Stack* stack);
+unsigned long _ll1SyncLevel(const LL1Stack* stack, int tokenClass);
+
+#endif  // LL1_H
@@ -0,0 +1,35 @@
+/**
+ * @file memory.h
+ * @brief Memory allocation through a replaceable allocator. Every allocation of the compiler goes
+ * through these functions, which use the allocator selected on the current thread (the C library
+ * one by default), so an embedding application can provide its own per compilation. They never
+ * return NULL: a failed allocation jumps to the target selected with memoryOnFailure, or ends the
+ * process with an error when there is none.
+ */
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <setjmp.h>
+#include <stddef.h>
+
+// caller-provided allocator, userData is passed back on every call
+typedef struct {
+    void* (*malloc)(size_t size, void* userData);
+    void* (*realloc)(void* pointer, size_t size, void* userData);
+    void (*free)(void* pointer, void* userData);
+    void* userData;
+} Allocator;
+
+const Allocator* memoryUse(const Allocator* allocator);  // selects the allocator of the current thread, returns the previous one
+const Allocator* memoryCurrent();                        // allocator of the current thread (NULL for the C library one)
+jmp_buf* memoryOnFailure(jmp_buf* target);               // where a failed allocation of the current thread jumps, returns the previous one
+
+void* memoryAlloc(size_t size);
+void* memoryCalloc(size_t count, size_t size);
+void* memoryRealloc(void* pointer, size_t size);
+void memoryFree(void* pointer);
+
+// auxiliary functions
+void* _memoryChecked(void* pointer, size_t size);  // returns pointer, unless the allocation of size bytes failed
+
+#endif  // MEMORY_H
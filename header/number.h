@@ -0,0 +1,23 @@
+/**
+ * @file number.h
+ * @brief Conversion of the numbers of P-- source code (digits, and for reals a point and more
+ * digits) to their values. Integers are longs; reals are correctly rounded doubles, computed
+ * with integer arithmetic for up to 19 significant digits and 27 decimal places (strtod is
+ * only the fallback of longer numbers).
+ */
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include <stdbool.h>
+
+#define NUMBER_MAX_DIGITS 19           // significant digits that always fit in an unsigned long
+#define NUMBER_MAX_EXACT_POWER 22      // greatest power of ten that is an exact double
+#define NUMBER_MAX_QUOTIENT_POWER 27   // greatest power of five that fits in a long
+
+bool numberParseInteger(const char* text, unsigned long size, long* value);  // returns true on overflow (value is LONG_MAX)
+double numberParseReal(const char* text, unsigned long size);               // text must be NUL terminated after size chars
+
+// auxiliary functions
+double _numberQuotient(unsigned long mantissa, int decimals);
+
+#endif  // NUMBER_H
@@ -0,0 +1,88 @@
+/**
+ * @file parallellexer.h
+ * @brief Multi-threaded lexing of an in-memory source code. The source is split in chunks at line
+ * starts and each chunk is lexed on its own thread as if a token started there. The chunks are
+ * then stitched in order: the sequential lexer state reached at the end of a chunk (offset of the
+ * next nextToken call and lastWasNumberOrIdent) is looked up among the calls of the next chunk,
+ * and when the speculation was wrong (the chunk starts inside a comment or a token) the lexer runs
+ * sequentially from that state until it meets one of them. The replayed tokens and errors are
+ * exactly those of the sequential nextToken loop.
+ */
+#ifndef PARALLELLEXER_H
+#define PARALLELLEXER_H
+
+#include <stdbool.h>
+
+#include "../header/diagnostics.h"
+#include "../header/lexer.h"
+#include "../header/memory.h"
+
+#define PARALLEL_LEXER_MIN_CHUNK (1 << 20)  // smaller chunks aren't worth a thread
+
+// flags of a lexed token
+enum LEXED_FLAG { LEXED_ERROR = 1,     // lexer error record, state holds the automaton state (or INTEGER_OVERFLOW_ERROR)
+                  LEXED_EOF = 2,       // recognized at the end of file (nextToken returned early)
+                  LEXED_CONTEXT = 4 }; // first record of a nextToken call made after a number or an identifier
+
+// a token or lexer error, the lexeme is read back from the source code
+typedef struct {
+    unsigned long offset;  // byte offset of the lexeme
+    unsigned int length;   // lexeme size in bytes
+    unsigned char tokenClass;
+    unsigned char state;  // automaton state of lexer errors (or INTEGER_OVERFLOW_ERROR)
+    unsigned char flags;  // LEXED_FLAG
+} LexedToken;
+
+typedef struct {
+    LexedToken* list;
+    unsigned long size;
+    unsigned long capacity;
+} LexedTokens;
+
+struct _parallelLexer;
+
+// a chunk holds the nextToken calls that start in [begin, end)
+typedef struct {
+    struct _parallelLexer* owner;
+    unsigned long begin;
+    unsigned long end;
+    LexedTokens speculative;  // lexed from begin as if a token started there
+    LexedTokens relexed;      // lexed sequentially until a speculative call matched
+    unsigned long first;      // first speculative record that belongs to the sequential tokens
+    unsigned long head;       // offset of the nextToken call that follows the speculative ones
+    bool context;             // lastWasNumberOrIdent after the speculative calls
+} LexedChunk;
+
+typedef struct _parallelLexer {
+    const char* source;
+    unsigned long size;
+    bool mapped;  // source is a mapping of the file
+    const Allocator* allocator;  // selected by the workers
+
+    LexedChunk* chunks;
+    int chunkCount;
+
+    // replay cursor
+    int chunk;
+    bool inRelexed;
+    unsigned long next;
+    unsigned long position;  // number of records replayed
+} ParallelLexer;
+
+bool parallelLexerOpen(ParallelLexer* lexed, const char* path, int jobs);                          // maps a file and lexes it
+void parallelLexerRun(ParallelLexer* lexed, const char* source, unsigned long size, int chunkCount);  // lexes an in-memory source code
+void parallelLexerDestroy(ParallelLexer* lexed);
+int parallelLexerNext(ParallelLexer* lexed, Lexer* lexer, Diagnostics* diagnostics);  // loads next token into the lexer
+int parallelLexerChunks(unsigned long size, int jobs);  // number of chunks worth lexing in parallel (jobs 0 uses every CPU)
+
+// auxiliary functions
+void _parallelLexerSplit(ParallelLexer* lexed, int chunkCount);
+void* _parallelLexerWorker(void* argument);
+bool _parallelLexerCall(Lexer* lexer, Diagnostics* diagnostics, unsigned long base, LexedTokens* tokens);
+void _parallelLexerStitch(ParallelLexer* lexed);
+bool _parallelLexerSync(const LexedChunk* chunk, unsigned long* index, unsigned long head, bool context);
+const LexedToken* _parallelLexerAdvance(ParallelLexer* lexed);
+void _lexedTokensPush(LexedTokens* tokens, const LexedToken* token);
+bool _lexedTokensDone(const LexedTokens* tokens);  // whether the last call returned the end of file
+
+#endif  // PARALLELLEXER_H
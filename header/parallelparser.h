@@ -0,0 +1,82 @@
+/**
+ * @file parallelparser.h
+ * @brief Multi-threaded parsing of the procedure declarations of the recursive engine. The
+ * synchronization tokens in effect when _dc_p meets a procedure are always the same classes at the
+ * same relative levels, so the parse of a procedure only depends on its tokens. Every procedure
+ * token of the lexed source code is parsed as the beginning of a procedure on a thread pool, each
+ * thread recording its own diagnostics. When the sequential parse reaches one of those tokens in
+ * _dc_p, out of panic mode, the outcome of its parse (errors, next token and panic state) is
+ * replayed instead of parsing it again. Procedure tokens that don't begin a procedure (skipped in
+ * panic mode) are simply never replayed, so the diagnostics are exactly those of the sequential parse.
+ * When the sequential parser records its tokens, each thread records the tokens of its procedures
+ * too, and the replay appends them with their lines and columns.
+ */
+#ifndef PARALLELPARSER_H
+#define PARALLELPARSER_H
+
+#include <stdbool.h>
+
+#include "../header/diagnostics.h"
+#include "../header/parallellexer.h"
+#include "../header/parser.h"
+
+// speculative parse of a procedure
+typedef struct {
+    const LexedToken* token;  // procedure token
+    ParallelLexer start;      // replay cursor after the procedure token
+    ParallelLexer end;        // replay cursor after the token that follows the procedure
+    bool valid;               // the parse didn't go past the next procedure token
+
+    // outcome
+    const Diagnostics* diagnostics;  // diagnostics of the thread that parsed it
+    unsigned long first;             // first diagnostic of the procedure
+    unsigned long count;             // number of diagnostics of the procedure
+    const ProgramTokens* tokens;     // tokens recorded by the thread (NULL if they aren't recorded)
+    unsigned long firstToken;        // first token read after the procedure token
+    unsigned long tokenCount;        // number of tokens, the one that follows the procedure included
+    int errorCount;
+    bool panic;
+    bool returned;  // synchronized on a token of a rule enclosing _dc_p
+
+    // token that follows the procedure
+    unsigned long tokenStart;
+    unsigned int length;
+    int tokenClass;
+    TokenValue value;
+    int fscanfFlag;
+    bool lastWasNumberOrIdent;
+} ProcedureParse;
+
+struct _parallelParser;
+
+// thread of the pool, it parses every threadCount-th procedure
+typedef struct {
+    struct _parallelParser* owner;
+    int index;
+    Diagnostics diagnostics;
+    ProgramTokens tokens;
+} ParallelParserWorker;
+
+typedef struct _parallelParser {
+    const ParallelLexer* lexed;
+    ProcedureParse* parses;  // in source order
+    unsigned long count;
+    unsigned long next;  // first parse the sequential parser hasn't reached
+    ParallelParserWorker* workers;
+    int threadCount;
+    bool record;  // the tokens are recorded for the semantic analysis
+} ParallelParser;
+
+void parallelParserRun(ParallelParser* parsed, const ParallelLexer* lexed, int jobs, bool record);  // parses every procedure of the lexed tokens
+void parallelParserDestroy(ParallelParser* parsed);
+bool parallelParserReplay(ParallelParser* parsed, Parser* parser, SincTokens* sincTokens);  // replays the procedure at the current token
+int parallelParserThreads(int jobs);  // number of threads (jobs 0 uses every CPU)
+
+// auxiliary functions
+void _parallelParserScan(ParallelParser* parsed);
+void* _parallelParserWorker(void* argument);
+void _parallelParserParse(ProcedureParse* parse, Parser* parser, unsigned long tokenLimit);
+void _parallelParserMerge(const ProcedureParse* parse, Parser* parser);
+void _parallelParserRecord(const ProcedureParse* parse, Parser* parser);
+
+#endif  // PARALLELPARSER_H
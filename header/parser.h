@@ -6,63 +6,126 @@
 #define PARSER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
+#include "../header/diagnostics.h"
 #include "../header/lexer.h"
 #include "../header/stack.h"
+#include "../header/parallellexer.h"
+#include "../header/program.h"
+#include "../header/tokenstream.h"
+
+// syntax analysis engines
+enum ENGINE { ENGINE_RECURSIVE,  // recursive-descent functions
+              ENGINE_TABLE };    // table-driven LL(1) driver
+
+// followers of a rule call whose push on the stacks is deferred
+typedef struct {
+    const int* followers;
+    unsigned long size;
+    int depth;  // depth they are pushed at
+} DeferredFollowers;
+
+// synchronization tokens of the recursive engine: for each token class, the stack of the depths of
+// the rules in which it is a synchronization token, plus a bitmask of the classes with non-empty stacks
+typedef struct {
+    Stack stacks[N_TOKEN_CLASS];
+    uint64_t mask;
+    int depth;  // depth of the current rule
+
+    // followers of the expression rules, only pushed on the stacks when an error needs them
+    DeferredFollowers* deferred;
+    unsigned long deferredSize;
+    unsigned long deferredCapacity;
+    unsigned long materialized;  // number of deferred sets already pushed
+} SincTokens;
+
+struct _parallelParser;
+struct _ll1Frame;
 
 // struct returned by the compiler
 typedef struct {
     Lexer lexer;
-    FILE* output;
+    TokenStream* tokens;  // when not NULL, tokens are read from this serialized stream instead of the lexer
+    ParallelLexer* lexed;  // when not NULL, tokens were lexed in parallel and are replayed from it
+    struct _parallelParser* procedures;  // when not NULL, procedures were parsed in parallel and are replayed from it
+    ProgramTokens* recorded;  // when not NULL, every token is recorded for the semantic analysis
+    Diagnostics* diagnostics;
+
+    // the parse state lives here rather than in locals of compile, so that parserDestroy frees it
+    // after an allocation failure (see memoryOnFailure)
+    SincTokens sincTokens;         // of the recursive engine
+    struct _ll1Frame* ll1Frames;  // parse stack of the table engine
 
+    int engine;  // ENGINE used by compile
+    int jobs;    // maximum number of threads of the parallel lexer and parser (0 uses every CPU)
+    unsigned long tokenLimit;  // speculative parses stop after this many replayed tokens (0 means no limit)
+    int nesting;  // open parenthesized factors and compound commands, at most MAX_NESTING
     int errorCount;
+    int errorLimit;  // the compilation stops after this number of errors (0 means no limit)
+    bool stopped;    // errorLimit was reached, the rest of the input is treated as EOF
     bool panic;
 } Parser;
 
-bool parserInit(Parser* parser, const char* sourceCodePath);
+bool parserInit(Parser* parser, const char* sourceCodePath, const char* tokenOutputPath, Diagnostics* diagnostics);
+bool parserInitFromTokens(Parser* parser, const char* tokenStreamPath, Diagnostics* diagnostics);
+bool parserInitBuffer(Parser* parser, const char* source, unsigned long size, Diagnostics* diagnostics);
+bool parserInitParallel(Parser* parser, const char* sourceCodePath, const char* tokenOutputPath, int jobs, Diagnostics* diagnostics);
 void parserDestroy(Parser* parser);
 void compile(Parser* parser);  // the syntax analyser controls the compilation process
 
-void _error(Parser* parser, int expectedTokenClass, Node* sincTokens[]);
+int _nextToken(Parser* parser);  // gets next token from the lexer, the token stream or the parallel lexer
+void _stop(Parser* parser);       // treats the rest of the input as EOF once errorLimit is reached
+void _error(Parser* parser, int expectedTokenClass, SincTokens* sincTokens);
+void _reportError(Parser* parser, int expectedTokenClass);  // records the error without skipping tokens
+void _errorAtEnd(Parser* parser, int expectedTokenClass, SincTokens* sincTokens, const int followers[], unsigned long size);
+bool _deferredReturn(Parser* parser, SincTokens* sincTokens);  // ends a call with deferred followers, true if the caller must return
+void _skipNested(Parser* parser);  // reports a factor or command nested too deep and skips it
 
 // synchronization token vector management routines
-void _sincTokensInit(Node* sincTokens[]);
-void _sincTokensIncr(Node* sincTokens[]);
-void _sincTokensDecr(Node* sincTokens[]);
-void _sincTokensAdd(Node* sincTokens[], const int toAdd[], unsigned long toAddSize);
+void _sincTokensInit(SincTokens* sincTokens);
+void _sincTokensDestroy(SincTokens* sincTokens);
+void _sincTokensIncr(SincTokens* sincTokens);
+void _sincTokensDecr(SincTokens* sincTokens);
+void _sincTokensAdd(SincTokens* sincTokens, const int toAdd[], unsigned long toAddSize);
+void _sincTokensRemove(SincTokens* sincTokens, const int toRemove[], unsigned long toRemoveSize);
+int _sincTokensLevel(const SincTokens* sincTokens, int tokenClass);  // -1 if tokenClass is not a synchronization token
+void _sincTokensDefer(SincTokens* sincTokens, const int followers[], unsigned long size);
+void _sincTokensUndefer(SincTokens* sincTokens);
+void _sincTokensMaterialize(SincTokens* sincTokens);  // pushes the deferred followers
 
 // P-- grammar
-void _programa(Parser* parser, Node* sincTokens[]);
-void _corpo(Parser* parser, Node* sincTokens[]);
-void _dc(Parser* parser, Node* sincTokens[]);
-void _dc_c(Parser* parser, Node* sincTokens[]);
-void _dc_v(Parser* parser, Node* sincTokens[]);
-void _tipo_var(Parser* parser, Node* sincTokens[]);
-void _variaveis(Parser* parser, Node* sincTokens[]);
-void _mais_var(Parser* parser, Node* sincTokens[]);
-void _dc_p(Parser* parser, Node* sincTokens[]);
-void _parametros(Parser* parser, Node* sincTokens[]);
-void _lista_par(Parser* parser, Node* sincTokens[]);
-void _mais_par(Parser* parser, Node* sincTokens[]);
-void _corpo_p(Parser* parser, Node* sincTokens[]);
-void _dc_loc(Parser* parser, Node* sincTokens[]);
-void _lista_arg(Parser* parser, Node* sincTokens[]);
-void _argumentos(Parser* parser, Node* sincTokens[]);
-void _mais_ident(Parser* parser, Node* sincTokens[]);
-void _pfalsa(Parser* parser, Node* sincTokens[]);
-void _comandos(Parser* parser, Node* sincTokens[]);
-void _cmd(Parser* parser, Node* sincTokens[]);
-void _pos_ident(Parser* parser, Node* sincTokens[]);
-void _condicao(Parser* parser, Node* sincTokens[]);
-void _relacao(Parser* parser, Node* sincTokens[]);
-void _expressao(Parser* parser, Node* sincTokens[]);
-void _op_un(Parser* parser, Node* sincTokens[]);
-void _outros_termos(Parser* parser, Node* sincTokens[]);
-void _op_ad(Parser* parser, Node* sincTokens[]);
-void _termo(Parser* parser, Node* sincTokens[]);
-void _mais_fatores(Parser* parser, Node* sincTokens[]);
-void _op_mul(Parser* parser, Node* sincTokens[]);
-void _fator(Parser* parser, Node* sincTokens[]);
-void _numero(Parser* parser, Node* sincTokens[]);
+void _programa(Parser* parser, SincTokens* sincTokens);
+void _corpo(Parser* parser, SincTokens* sincTokens);
+void _dc(Parser* parser, SincTokens* sincTokens);
+void _dc_c(Parser* parser, SincTokens* sincTokens);
+void _dc_c_item(Parser* parser, SincTokens* sincTokens);
+void _dc_v(Parser* parser, SincTokens* sincTokens);
+void _dc_v_item(Parser* parser, SincTokens* sincTokens);
+void _tipo_var(Parser* parser, SincTokens* sincTokens);
+void _variaveis(Parser* parser, SincTokens* sincTokens);
+void _dc_p(Parser* parser, SincTokens* sincTokens);
+void _dc_p_item(Parser* parser, SincTokens* sincTokens);
+void _procedimento(Parser* parser, SincTokens* sincTokens);
+void _parametros(Parser* parser, SincTokens* sincTokens);
+void _lista_par(Parser* parser, SincTokens* sincTokens);
+void _parametro(Parser* parser, SincTokens* sincTokens);
+void _mais_par(Parser* parser, SincTokens* sincTokens);
+void _mais_par_item(Parser* parser, SincTokens* sincTokens);
+void _lista_par_item(Parser* parser, SincTokens* sincTokens);
+void _corpo_p(Parser* parser, SincTokens* sincTokens);
+void _dc_loc(Parser* parser, SincTokens* sincTokens);
+void _lista_arg(Parser* parser, SincTokens* sincTokens);
+void _argumentos(Parser* parser, SincTokens* sincTokens);
+void _pfalsa(Parser* parser, SincTokens* sincTokens);
+void _comandos(Parser* parser, SincTokens* sincTokens);
+void _comandos_item(Parser* parser, SincTokens* sincTokens);
+void _cmd(Parser* parser, SincTokens* sincTokens);
+void _cmd_body(Parser* parser, SincTokens* sincTokens);
+void _pos_ident(Parser* parser, SincTokens* sincTokens);
+void _condicao(Parser* parser, SincTokens* sincTokens);
+void _relacao(Parser* parser, SincTokens* sincTokens);
+void _expressao(Parser* parser, SincTokens* sincTokens);  // rules 23 to 30, by precedence climbing
+void _numero(Parser* parser, SincTokens* sincTokens);
 
 #endif  // PARSER_H
\ No newline at end of file
@@ -0,0 +1,61 @@
+/**
+ * @file pmm.h
+ * @brief Embedding API: compiles P-- source code held in memory, without touching files or
+ * printing. Compiler instances share no state, so many compilations can run concurrently
+ * (one instance per thread at a time). libpmm.so is built with hidden visibility: only the
+ * functions marked PMM_API are exported.
+ */
+#ifndef PMM_H
+#define PMM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../header/diagnostics.h"
+#include "../header/memory.h"
+
+#if defined(__GNUC__)
+#define PMM_API __attribute__((visibility("default")))  // exported by the shared library
+#else
+#define PMM_API
+#endif
+
+// a diagnostic as passed to PmmDiagnosticCallback, the strings are only valid during the call
+typedef struct {
+    int kind;             // DIAGNOSTIC_KIND (DIAGNOSTIC_LEXER or DIAGNOSTIC_PARSER)
+    int line;             // line on P-- source code
+    int col;              // column on P-- source code, in code points
+    unsigned long offset; // byte offset on P-- source code
+    const char* message;  // description, without the position
+    const char* found;    // offending lexeme (NULL at the end of the source code)
+} PmmDiagnostic;
+
+typedef void (*PmmDiagnosticCallback)(const PmmDiagnostic* diagnostic, void* userData);
+
+// compilation options, see pmmDefaultOptions
+typedef struct {
+    int engine;                          // ENGINE used by compile
+    int maxErrors;                       // maximum number of recorded errors (0 means no limit)
+    int errorLimit;                      // the compilation stops after this number of errors (0 means no limit)
+    PmmDiagnosticCallback onDiagnostic;  // called for every recorded diagnostic (NULL for none)
+    void* userData;                      // passed back to onDiagnostic
+    const Allocator* allocator;          // allocator of the instance (NULL for the C library one)
+} PmmOptions;
+
+typedef struct _pmm Pmm;  // compiler instance
+
+PMM_API void pmmDefaultOptions(PmmOptions* options);
+PMM_API Pmm* pmmCreate(const PmmOptions* options);  // NULL options uses the defaults, returns NULL if out of memory
+PMM_API void pmmDestroy(Pmm* pmm);
+PMM_API int pmmCompile(Pmm* pmm, const char* source, size_t size);  // returns the number of errors or -1 if out of memory
+PMM_API bool pmmStopped(const Pmm* pmm);                            // whether the last compilation reached errorLimit
+PMM_API const char* pmmReport(Pmm* pmm, int format);                // diagnostics of the last compilation rendered in a DIAGNOSTIC_FORMAT, NULL if out of memory
+
+// records into diagnostics initialized with diagnosticsInit, which only the static library exports;
+// returns the number of errors or -1 if out of memory
+PMM_API int pmmCompileBuffer(const char* source, size_t size, Diagnostics* diagnostics);
+
+void _pmmCallback(Pmm* pmm);                 // passes the recorded diagnostics to onDiagnostic
+Pmm* _pmmCreate(const PmmOptions* options);  // pmmCreate with the options resolved
+
+#endif  // PMM_H
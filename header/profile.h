@@ -0,0 +1,85 @@
+/**
+ * @file profile.h
+ * @brief Phase timing and counters (--profile). The instrumentation is compiled in only when
+ * PMM_PROFILE is defined (make PROFILE=1), otherwise the macros expand to nothing.
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../header/string.h"
+
+#define PROFILE_MAX_NESTING 16  // maximum number of nested phases
+
+// phases of a compilation, time is accounted to the innermost active phase
+enum PROFILE_PHASE { PHASE_SETUP,     // initialization and everything outside the other phases
+                     PHASE_LEXER,     // nextToken (or token stream decoding)
+                     PHASE_PARSER,    // grammar rules
+                     PHASE_SYNC,      // synchronization token bookkeeping
+                     PHASE_ERROR,     // error recording
+                     PHASE_IO,        // file reads and writes
+                     PHASE_SEMANTIC,  // tree construction and semantic checks
+                     PHASE_DATAFLOW,  // definite assignment analysis (--warn-uninitialized)
+                     PHASE_OPTIMIZE,  // inlining, SSA construction and optimization (--emit-ir)
+                     PHASE_CODEGEN,   // machine code generation (--run)
+                     PHASE_RUN,       // execution of the program (--run)
+                     N_PHASES };
+
+// event counters
+enum PROFILE_COUNTER { COUNTER_TOKENS,
+                       COUNTER_CHARS,
+                       COUNTER_ALLOCATIONS,
+                       COUNTER_SYNC_PUSHES,
+                       COUNTER_SKIPPED_TOKENS,  // tokens skipped in panic mode
+                       COUNTER_ERRORS,
+                       N_COUNTERS };
+
+// profiling data of a compilation
+typedef struct {
+    uint64_t phaseTime[N_PHASES];  // nanoseconds spent in each phase
+    uint64_t counters[N_COUNTERS];
+    long depth;     // current recursion depth of the syntax analysis
+    long maxDepth;  // maximum recursion depth of the syntax analysis
+
+    uint64_t start;  // time when profiling started
+    uint64_t total;  // total profiled time
+    uint64_t last;   // time of the last phase change
+    int phase;       // current phase
+    int nesting;     // number of suspended phases
+    int suspended[PROFILE_MAX_NESTING];
+} Profile;
+
+extern Profile profile;  // profiling data of the running compilation
+
+// output formats
+enum PROFILE_FORMAT { PROFILE_TEXT,
+                      PROFILE_JSON };
+
+bool profileEnabled();  // whether the instrumentation was compiled in
+void profileStart();
+void profileStop();
+void profileEnter(int phase);
+void profileLeave();
+void profileRender(String* report, int format);
+uint64_t _profileNow();
+
+#ifdef PMM_PROFILE
+#define PROFILE_ENTER(phase) profileEnter(phase)
+#define PROFILE_LEAVE() profileLeave()
+#define PROFILE_COUNT(counter, n) (profile.counters[counter] += (n))
+#define PROFILE_DEPTH(n)                              \
+    do {                                              \
+        profile.depth += (n);                         \
+        if (profile.depth > profile.maxDepth)         \
+            profile.maxDepth = profile.depth;         \
+    } while (0)
+#else
+#define PROFILE_ENTER(phase) ((void)0)
+#define PROFILE_LEAVE() ((void)0)
+#define PROFILE_COUNT(counter, n) ((void)0)
+#define PROFILE_DEPTH(n) ((void)0)
+#endif
+
+#endif  // PROFILE_H
@@ -0,0 +1,181 @@
+/**
+ * @file program.h
+ * @brief Semantic analysis: builds the checked tree of a program (symbols, types and implicit
+ * conversions) from the tokens recorded during a syntax analysis without errors. The back ends
+ * work on this tree.
+ */
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <stdbool.h>
+
+#include "../header/diagnostics.h"
+#include "../header/lexer.h"
+#include "../header/string.h"
+
+#define NO_NODE -1        // absent child or end of a list
+#define GLOBAL_SCOPE -1   // scope of the symbols declared by the program
+
+// types of constants, variables and expressions
+enum TYPE { TYPE_INTEGER,
+            TYPE_REAL };
+
+// kinds of symbols
+enum SYMBOL_KIND { SYMBOL_CONSTANT,
+                   SYMBOL_VARIABLE,
+                   SYMBOL_PARAMETER,
+                   SYMBOL_PROCEDURE };
+
+// kinds of tree nodes, the fields they use are listed after them
+enum NODE_KIND { NODE_NUMBER,    // value (constants are replaced by their value)
+                 NODE_VARIABLE,  // symbol (variable or parameter)
+                 NODE_NEGATE,    // a
+                 NODE_TO_REAL,   // a, an integer expression converted to real
+                 NODE_ADD,       // a + b, both operands have the type of the node
+                 NODE_SUBTRACT,  // a - b
+                 NODE_MULTIPLY,  // a * b
+                 NODE_DIVIDE,    // a / b, truncated if both are integers
+                 NODE_COMPARE,   // a op b, op is a RELATION_OP and both operands have the same type
+                 NODE_ASSIGN,    // symbol := a
+                 NODE_CALL,      // symbol (procedure), a first argument (expressions chained by next)
+                 NODE_READ,      // a first variable (NODE_VARIABLE chained by next)
+                 NODE_WRITE,     // a first value (NODE_VARIABLE or NODE_NUMBER chained by next)
+                 NODE_IF,        // a condition, b command, c else command (or NO_NODE)
+                 NODE_WHILE,     // a condition, b command
+                 NODE_FOR,       // symbol (integer variable), a initial value, b final value, c command
+                 NODE_BLOCK };   // a first command (chained by next)
+
+// relations of NODE_COMPARE
+enum RELATION_OP { RELATION_EQUAL,
+                   RELATION_NOT_EQUAL,
+                   RELATION_LESS,
+                   RELATION_LESS_EQUAL,
+                   RELATION_GREATER,
+                   RELATION_GREATER_EQUAL };
+
+// semantic errors, the code of DIAGNOSTIC_SEMANTIC diagnostics
+enum SEMANTIC_ERROR { SEMANTIC_UNDECLARED,
+                      SEMANTIC_REDECLARED,
+                      SEMANTIC_NOT_VARIABLE,
+                      SEMANTIC_NOT_VALUE,
+                      SEMANTIC_NOT_PROCEDURE,
+                      SEMANTIC_ARGUMENT_COUNT,
+                      SEMANTIC_REAL_TO_INTEGER,
+                      SEMANTIC_FOR_INTEGER,
+                      N_SEMANTIC_ERRORS };
+
+// a token recorded by the parser
+typedef struct {
+    int tokenClass;
+    TokenValue value;
+    unsigned long text;  // offset of the lexeme in the lexeme pool
+    SourcePosition position;
+} ProgramToken;
+
+// tokens of a compilation, in source order
+typedef struct {
+    ProgramToken* list;
+    unsigned long size;
+    unsigned long capacity;
+    String lexemes;  // '\0' separated lexemes
+} ProgramTokens;
+
+typedef struct {
+    char kind;         // NODE_KIND
+    char type;         // TYPE of an expression
+    char op;           // RELATION_OP of NODE_COMPARE
+    int symbol;        // symbol of NODE_VARIABLE, NODE_ASSIGN, NODE_CALL and NODE_FOR
+    int a, b, c;       // children (NO_NODE when absent)
+    int next;          // next node of a list (NO_NODE at the end)
+    TokenValue value;  // NODE_NUMBER
+    int line, col;     // position of the token the node comes from
+} Node;
+
+typedef struct {
+    unsigned long name;  // offset of the name in the name pool
+    char kind;           // SYMBOL_KIND
+    char type;           // TYPE of constants, variables and parameters
+    int scope;           // procedure that declares it (GLOBAL_SCOPE for the program)
+    int index;           // global variables are numbered from 0, and so are the parameters and then the locals
+                         // of each procedure; procedures: index in the procedure list
+    TokenValue value;    // constants
+} Symbol;
+
+typedef struct {
+    int symbol;          // its symbol
+    int firstParameter;  // symbol of the first parameter, the local variables follow the parameters
+    int parameterCount;
+    int localCount;      // local variables, the ones added by inlining included
+    int body;            // NODE_BLOCK
+    int* added;          // symbols of the local variables added by inlining, they follow the declared ones
+    int addedCount;
+    int addedCapacity;
+} Procedure;
+
+typedef struct {
+    Node* nodes;
+    unsigned long nodeCount;
+    unsigned long nodeCapacity;
+    Symbol* symbols;
+    unsigned long symbolCount;
+    unsigned long symbolCapacity;
+    Procedure* procedures;
+    unsigned long procedureCount;
+    unsigned long procedureCapacity;
+    String names;  // '\0' separated names of the symbols
+
+    int globalCount;  // global variables
+    int body;         // NODE_BLOCK of the program
+
+    // symbols by name and scope (open addressing, -1 is an empty slot)
+    int* table;
+    unsigned long tableCapacity;
+} Program;
+
+// state of the tree construction
+typedef struct {
+    Program* program;
+    const ProgramTokens* tokens;
+    unsigned long next;  // current token
+    Diagnostics* diagnostics;
+    int errors;
+    int scope;  // procedure being built (GLOBAL_SCOPE in the program)
+} ProgramBuilder;
+
+void programTokensInit(ProgramTokens* tokens);
+void programTokensDestroy(ProgramTokens* tokens);
+void programTokensRecord(ProgramTokens* tokens, const Lexer* lexer, const SourcePosition* position);  // appends the current token
+void programTokensCopy(ProgramTokens* tokens, const ProgramTokens* from, unsigned long index, const SourcePosition* position);
+
+int programBuild(Program* program, const ProgramTokens* tokens, Diagnostics* diagnostics);  // returns the number of semantic errors
+void programDestroy(Program* program);
+int programLookup(const Program* program, const char* name, int scope);  // symbol visible in scope or -1
+const char* programName(const Program* program, int symbol);
+int programVariable(const Program* program, int procedure, int index);  // symbol of a parameter or local by index
+const char* programErrorMessage(int code);  // description of a SEMANTIC_ERROR
+
+// auxiliary functions of the tree construction
+int _programNode(ProgramBuilder* builder, int kind, int type, const ProgramToken* token);
+int _programDeclare(ProgramBuilder* builder, const ProgramToken* token, int kind, int type);  // -1 if already declared
+void _programError(ProgramBuilder* builder, const ProgramToken* token, int code);
+const ProgramToken* _programToken(ProgramBuilder* builder);  // current token, moves to the next one
+const ProgramToken* _programPeek(const ProgramBuilder* builder);
+const char* _programLexeme(const ProgramBuilder* builder, const ProgramToken* token);
+unsigned long _programHash(const char* name, int scope);
+void _programInsert(Program* program, int symbol);
+void _programDeclarations(ProgramBuilder* builder);
+void _programVariables(ProgramBuilder* builder, int kind);
+void _programProcedure(ProgramBuilder* builder);
+int _programBlock(ProgramBuilder* builder);     // begin <comandos> end
+int _programCommand(ProgramBuilder* builder);
+int _programCall(ProgramBuilder* builder, const ProgramToken* name);
+int _programTarget(ProgramBuilder* builder, const ProgramToken* name);  // variable of read, := and for
+int _programValue(ProgramBuilder* builder, const ProgramToken* name);   // variable or constant
+int _programCondition(ProgramBuilder* builder);
+int _programExpression(ProgramBuilder* builder);
+int _programTerm(ProgramBuilder* builder);
+int _programFactor(ProgramBuilder* builder);
+int _programBinary(ProgramBuilder* builder, int kind, int left, int right, const ProgramToken* token);
+int _programToReal(ProgramBuilder* builder, int node);
+
+#endif  // PROGRAM_H
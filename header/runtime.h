@@ -0,0 +1,89 @@
+/**
+ * @file runtime.h
+ * @brief Runtime of the executed programs: read and write, and the runtime errors. The compiled
+ * code calls these functions with the runtime as first argument; a runtime error leaves the
+ * program with a longjmp to the caller that started it. The input and output go through buffers
+ * held by the runtime, so reads and writes neither allocate nor call the C library per number.
+ */
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define RUNTIME_REAL_SIZE 32        // room for a formatted real and its NUL
+#define RUNTIME_WORD_SIZE 512       // longest number accepted by read, with its NUL
+#define RUNTIME_BUFFER_SIZE 65536   // bytes of the input and output buffers
+#define RUNTIME_SLICE 65536         // steps between two calls of runtimeTick
+
+// packs the position of a command in the argument of the runtime functions
+#define RUNTIME_WHERE(line, col) (((long)(line) << 32) | (long)(unsigned int)(col))
+
+// outcome of a run
+enum RUNTIME_STATUS { RUNTIME_OK,
+                      RUNTIME_DIVISION_BY_ZERO,
+                      RUNTIME_INVALID_INPUT,
+                      RUNTIME_END_OF_INPUT,
+                      RUNTIME_BUDGET_EXCEEDED,  // the limits of a sandboxed run
+                      RUNTIME_TIME_LIMIT,
+                      RUNTIME_MEMORY_LIMIT,
+                      N_RUNTIME_STATUS };
+
+typedef struct {
+    FILE* input;
+    FILE* output;
+    jmp_buf exit;    // where runtime errors go
+    int status;      // RUNTIME_STATUS
+    int line, col;   // position of the command that failed
+
+    // limits of a sandboxed run: the code counts steps (loop iterations and procedure calls) in
+    // slices and calls runtimeTick at the end of each slice, procedures compare rsp with stackLimit
+    long ticks;              // steps left in the slice, minus one
+    long slice;              // steps of the slice
+    long consumed;           // steps of the previous slices
+    long budget;             // steps allowed
+    double deadline;         // monotonic time when the run is stopped, 0 without limit
+    const char* stackLimit;  // lowest stack address of the frames (NULL without limit)
+
+    bool terminal;         // the input is a terminal, it is read a line at a time
+    bool lineBuffered;     // the output is a terminal, it is written at the end of each line
+    bool ended;            // the end of the input was reached
+    unsigned long head;    // unread bytes of the input buffer, from head to tail
+    unsigned long tail;
+    unsigned long written; // bytes of the output buffer
+    char inputBuffer[RUNTIME_BUFFER_SIZE + 1];  // room for the NUL after the last word
+    char outputBuffer[RUNTIME_BUFFER_SIZE];
+} Runtime;
+
+void runtimeInit(Runtime* runtime, FILE* input, FILE* output);
+void runtimeFinish(Runtime* runtime);  // writes what is left of the output
+const char* runtimeStatusMessage(int status);
+
+long runtimeReadInteger(Runtime* runtime, long where);
+double runtimeReadReal(Runtime* runtime, long where);
+void runtimeWriteInteger(Runtime* runtime, long value, int separator);  // the value followed by the separator
+void runtimeWriteReal(Runtime* runtime, double value, int separator);
+_Noreturn void runtimeFail(Runtime* runtime, int status, long where);
+void runtimeLimit(Runtime* runtime, long budget, long milliseconds);  // 0 is no limit
+void runtimeTick(Runtime* runtime, long where);                       // end of a slice of steps
+long runtimeSteps(const Runtime* runtime);
+double runtimeClock(void);  // monotonic time in seconds
+
+unsigned long runtimeFormatReal(double value, char* text);  // shortest text that reads back as value, returns its size
+
+// auxiliary functions
+bool _runtimeBlank(char c);  // isspace in the C locale
+char* _runtimeWord(Runtime* runtime, unsigned long* size, long where);  // next blank separated word of the input, NUL terminated in the buffer
+bool _runtimeFill(Runtime* runtime);   // reads more input after the unread bytes, returns false at the end of the input
+void _runtimeFlush(Runtime* runtime);  // writes the output buffer
+void _runtimeSlice(Runtime* runtime);  // starts a slice of steps, at most what is left of the budget plus one
+bool _runtimeParseInteger(const char* text, unsigned long size, long* value);  // returns true if it isn't a valid integer
+bool _runtimeEightDigits(const char* text, unsigned long* value);              // returns true if the 8 chars aren't all digits
+unsigned long _runtimeMultiplyShift(unsigned long m, const uint64_t* factor, int shift);
+bool _runtimeMultipleOfFive(unsigned long value, unsigned int power);
+int _runtimeShortest(double value, unsigned long* digits, int* exponent);     // value = digits * 10^exponent, returns the number of digits (0 if left to _runtimeRoundTrip)
+int _runtimeRoundTrip(double value, char* digits, int* exponent);             // returns the number of digits, exponent is the one of the first digit
+
+#endif  // RUNTIME_H
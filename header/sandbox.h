@@ -0,0 +1,60 @@
+/**
+ * @file sandbox.h
+ * @brief Sandboxed runs of untrusted programs (--sandbox): the program runs on a thread of its own
+ * whose stack is sized by the memory limit, with code that counts its steps (loop iterations and
+ * procedure calls) against a budget and checks a wall-clock limit once per slice of steps. Every
+ * way the program can stop is a verdict; none of them stops the host process.
+ */
+#ifndef SANDBOX_H
+#define SANDBOX_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "../header/jit.h"
+#include "../header/program.h"
+#include "../header/runtime.h"
+
+#define SANDBOX_DEFAULT_MEMORY (64l << 20)  // bytes of stack and global variables by default
+#define SANDBOX_DEFAULT_TIME 10000          // wall-clock milliseconds by default, a run always has a limit
+#define SANDBOX_STACK_RESERVE 65536         // bytes of stack kept below the limit for the runtime calls
+
+// how a sandboxed run ended
+enum SANDBOX_VERDICT { SANDBOX_OK,
+                       SANDBOX_BUDGET_EXCEEDED,
+                       SANDBOX_TIME_LIMIT,
+                       SANDBOX_MEMORY_LIMIT,
+                       SANDBOX_RUNTIME_ERROR,
+                       N_SANDBOX_VERDICTS };
+
+typedef struct {
+    long budget;        // steps, 0 for no limit
+    long timeLimit;     // wall-clock milliseconds, 0 for no limit (not given by the options)
+    long memoryLimit;   // bytes of stack and global variables
+} SandboxLimits;
+
+typedef struct {
+    int verdict;     // SANDBOX_VERDICT
+    int status;      // RUNTIME_STATUS
+    int line, col;   // where the program was stopped (0 if it ended or never started)
+    long steps;
+    double seconds;  // wall-clock time of the run
+} SandboxResult;
+
+// state shared with the thread of the run
+typedef struct {
+    Jit* jit;
+    Runtime* runtime;
+    int status;
+} SandboxRun;
+
+void sandboxLimitsInit(SandboxLimits* limits);
+bool sandboxRun(const Program* program, const SandboxLimits* limits, FILE* input, FILE* output,
+                SandboxResult* result);  // returns true if the run couldn't be started
+void sandboxPrint(const SandboxResult* result, int format, FILE* output);  // DIAGNOSTIC_FORMAT
+const char* sandboxVerdictName(int verdict);
+
+// auxiliary functions
+void* _sandboxThread(void* argument);
+
+#endif  // SANDBOX_H
@@ -7,16 +7,17 @@
 
 #include <stdbool.h>
 
-typedef struct _node {
-    int depth;
-    struct _node* next;
-} Node;
+// stack of the depths of the rules in which a token is a synchronization token
+typedef struct {
+    int* depths;
+    int size;
+    int capacity;
+} Stack;
 
-Node* stackInit();
-void stackDestroy(Node** head);
-void stackPush(Node** head);
-int stackPeak(Node* head);
-void stackPop(Node** head);
-void stackAdd(Node** head, int toAdd);
+void stackInit(Stack* stack);
+void stackDestroy(Stack* stack);
+void stackPush(Stack* stack, int depth);
+int stackPeak(const Stack* stack);
+void stackPop(Stack* stack);
 
-#endif  // STACK_H
\ No newline at end of file
+#endif  // STACK_H
@@ -16,10 +16,14 @@ void stringDestroy(String* s);
 
 void stringAppendChar(String* s, char c);
 void stringAppendCstr(String* s, const char* cstr);
+void stringAppend(String* s, const char* data, unsigned long size);
 void stringAppendInt(String* s, int integer);
+void stringAppendLong(String* s, unsigned long integer);
 
 void stringOverwrite(String* s, const char cstr[], unsigned long size);
 
+unsigned long stringUtf8CharLength(const char* cstr);  // bytes of the valid UTF-8 character at cstr (0 if invalid)
+
 void _stringExpand(String* s, unsigned long newCapacity);
 
 #endif  // STRING_H
\ No newline at end of file
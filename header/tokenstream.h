@@ -0,0 +1,70 @@
+/**
+ * @file tokenstream.h
+ * @brief Compact binary serialization of the lexer output (token streams)
+ *
+ * Format (version 3), all integers are LEB128 varints unless noted:
+ *   header:  "PMMT" | version (1 byte) | 3 reserved bytes | lexeme count | token count
+ *   lexemes: for each interned lexeme: length | bytes | '\0'
+ *   tokens:  for each token: tag (token class | TOKEN_STREAM_EOF_FLAG) | line delta (zigzag) |
+ *            column | byte offset delta | lexeme index [| automaton state or INTEGER_OVERFLOW_ERROR,
+ *            for lexer error records only]
+ * Lines, columns and byte offsets are those of the first char of the token, deltas are taken from
+ * the previous record (offsets never decrease). The offsets of the line starts aren't stored, so
+ * diagnostics of a replayed stream have their byte offsets but no source snippets.
+ * Lexer errors are stored as records tagged TOKEN_STREAM_LEXER_ERROR, so replaying a stream
+ * reproduces its diagnostics. Values of numbers are converted again from their lexemes.
+ */
+#ifndef TOKENSTREAM_H
+#define TOKENSTREAM_H
+
+#include <stdbool.h>
+
+#include "../header/diagnostics.h"
+#include "../header/lexer.h"
+#include "../header/string.h"
+
+#define TOKEN_STREAM_MAGIC "PMMT"
+#define TOKEN_STREAM_VERSION 3
+#define TOKEN_STREAM_HEADER_SIZE 8
+#define TOKEN_STREAM_EOF_FLAG 64      // tag bit set when the token was recognized at the end of file
+#define TOKEN_STREAM_LEXER_ERROR 63   // tag of the records that store lexer errors
+
+// a serialized token stream mapped in memory
+typedef struct {
+    const unsigned char* data;    // mapped file
+    unsigned long size;           // mapped file size
+    const unsigned char* cursor;  // next token record
+    const unsigned char* end;     // end of the mapped file
+
+    const char** lexemes;  // lexeme table (points into the mapped file)
+    unsigned long lexemeCount;
+    unsigned long remaining;  // number of token records not read yet
+    SourcePosition position;  // position of the last token read (without line offsets)
+} TokenStream;
+
+// lexeme interning table used while writing a stream
+typedef struct {
+    String table;              // encoded lexeme table
+    String text;               // '\0' separated interned lexemes
+    unsigned long* offsets;    // offset of each interned lexeme in text
+    unsigned long* slots;      // open addressing hash table (lexeme index + 1, 0 when empty)
+    unsigned long count;
+    unsigned long capacity;    // number of slots
+} LexemeTable;
+
+bool tokenStreamOpen(TokenStream* stream, const char* path);
+void tokenStreamClose(TokenStream* stream);
+int tokenStreamNext(TokenStream* stream, Lexer* lexer, Diagnostics* diagnostics);  // loads next token into the lexer
+bool tokenStreamEmit(const char* sourcePath, const char* streamPath, int jobs, Diagnostics* diagnostics, int* errorCount);
+
+// auxiliary functions used to encode and decode streams
+void _writeVarint(String* s, unsigned long value);
+bool _readVarint(TokenStream* stream, unsigned long* value);
+void _writeToken(String* s, LexemeTable* lexemes, int tokenClass, bool atEOF, const SourcePosition* position, SourcePosition* last, const char* lexeme, int state);
+void _lexemeTableInit(LexemeTable* lexemes);
+void _lexemeTableDestroy(LexemeTable* lexemes);
+unsigned long _lexemeHash(const char* lexeme, unsigned long length);
+unsigned long _lexemeTableIntern(LexemeTable* lexemes, const char* lexeme);
+void _lexemeTableGrow(LexemeTable* lexemes);
+
+#endif  // TOKENSTREAM_H
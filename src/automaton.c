@@ -0,0 +1,224 @@
+/**
+ * @file automaton.c
+ * @brief Description of the lexer automata (transition matrices and final states). It only depends
+ * on the headers, so the generator of the direct-coded lexer (tools/lexgen.c) builds the same automaton
+ */
+#include "../header/lexer.h"
+
+#include <string.h>
+
+/**
+ * @brief The transitionMatrix[][] has NUMBER_OF_STATES lines (number of states) and NUMBER_OF_CHARS rows
+ * (number of ASCII characters). An element 'transionMatrix[i][j]'
+ * represents the new state the automaton must go next when it is in state
+ * 'i' and reads the character of ASCII number 'j'.
+ * If transionMatrix[i][j] == -1, we have an invalid transition.
+ *
+ * @param transitionMatrix the transition matrix
+ */
+void _buildTransitionMatrix(int transitionMatrix[NUMBER_OF_STATES][NUMBER_OF_CHARS]) {
+    // invalid state by default
+    for (int i = 0; i < NUMBER_OF_STATES; i++)
+        for (int j = 0; j < NUMBER_OF_CHARS; j++)
+            transitionMatrix[i][j] = -1;
+
+    // IDENTIFIERS
+    _fillOther(transitionMatrix, 0, 3);  // invalid char
+    _fillOther(transitionMatrix, 1, 2);  // end of identifier
+    transitionMatrix[0]['_'] = 1;
+    transitionMatrix[1]['_'] = 1;
+    for (int i = 'a'; i <= 'z'; i++) {
+        transitionMatrix[0][i] = 1;
+        transitionMatrix[1][i] = 1;
+    }
+    for (int i = 'A'; i <= 'Z'; i++) {
+        transitionMatrix[0][i] = 1;
+        transitionMatrix[1][i] = 1;
+    }
+    for (int i = '0'; i <= '9'; i++)
+        transitionMatrix[1][i] = 1;
+
+    // NUMBERS
+    for (int i = '0'; i <= '9'; i++) {
+        transitionMatrix[0][i] = 4;  // integer part, first number
+        transitionMatrix[4][i] = 4;  // integer part, following numbers
+        transitionMatrix[6][i] = 8;  // first number after decimal place
+        transitionMatrix[8][i] = 8;  // following number after decimal place
+    }
+    transitionMatrix[4]['.'] = 6;
+    _fillOther(transitionMatrix, 4, 5);  // end of an int
+    _fillOther(transitionMatrix, 6, 7);  // error: decimal number without following number
+    _fillOther(transitionMatrix, 8, 9);  // end of a decimal number
+
+    // OPERANDS
+    transitionMatrix[0]['+'] = 10;
+    transitionMatrix[0]['-'] = 10;
+    transitionMatrix[0]['*'] = 11;
+    transitionMatrix[0]['/'] = 11;
+    transitionMatrix[0]['='] = 12;
+    transitionMatrix[0][':'] = 13;
+    transitionMatrix[13]['='] = 14;
+    transitionMatrix[0]['<'] = 16;
+    transitionMatrix[16]['='] = 18;
+    transitionMatrix[16]['>'] = 18;
+    transitionMatrix[0]['>'] = 20;
+    transitionMatrix[20]['='] = 22;
+    _fillOther(transitionMatrix, 13, 15);  // : Declare type
+    _fillOther(transitionMatrix, 16, 19);  // < Relation
+    _fillOther(transitionMatrix, 20, 21);  // > Relation
+
+    // MISCELLANEOUS
+    transitionMatrix[0][' '] = 0;
+    transitionMatrix[0]['\t'] = 0;
+    transitionMatrix[0]['\n'] = 0;
+    transitionMatrix[0][';'] = 24;
+    transitionMatrix[0][','] = 25;
+    transitionMatrix[0]['('] = 26;
+    transitionMatrix[0][')'] = 27;
+    transitionMatrix[0]['.'] = 28;
+    transitionMatrix[0]['{'] = 30;
+    transitionMatrix[30]['}'] = 0;
+    _fillOther(transitionMatrix, COMMENT_STATE, COMMENT_STATE);  // comment, any byte (UTF-8 text) is accepted
+
+    // NON-ASCII CHARACTERS (UTF-8), only valid inside comments: a whole character is a single error
+    for (int i = 0x80; i <= 0xff; i++)
+        transitionMatrix[0][i] = 37;  // continuation byte or byte that never starts a character
+    for (int i = 0xc2; i <= 0xdf; i++)
+        transitionMatrix[0][i] = 32;  // 2 byte character
+    for (int i = 0xe1; i <= 0xef; i++)
+        transitionMatrix[0][i] = 33;  // 3 byte character
+    for (int i = 0xf1; i <= 0xf3; i++)
+        transitionMatrix[0][i] = 34;  // 4 byte character
+    transitionMatrix[0][0xe0] = 38;   // 3 byte character, no overlong encodings
+    transitionMatrix[0][0xed] = 39;   // 3 byte character, no surrogates
+    transitionMatrix[0][0xf0] = 40;   // 4 byte character, no overlong encodings
+    transitionMatrix[0][0xf4] = 41;   // 4 byte character, up to U+10FFFF
+    for (int i = 0x80; i <= 0xbf; i++) {
+        transitionMatrix[32][i] = 35;  // last continuation byte
+        transitionMatrix[33][i] = 32;
+        transitionMatrix[34][i] = 33;
+        transitionMatrix[38][i] = (i >= 0xa0) ? 32 : -1;
+        transitionMatrix[39][i] = (i <= 0x9f) ? 32 : -1;
+        transitionMatrix[40][i] = (i >= 0x90) ? 33 : -1;
+        transitionMatrix[41][i] = (i <= 0x8f) ? 33 : -1;
+    }
+    _fillOther(transitionMatrix, 32, 36);  // truncated character
+    _fillOther(transitionMatrix, 33, 36);
+    _fillOther(transitionMatrix, 34, 36);
+    for (int i = 38; i <= 41; i++)
+        _fillOther(transitionMatrix, i, 36);
+}
+
+/**
+ * @brief Build a vector that identifies final states.
+ *
+ * @param finalState vector that identifies final states
+ * @param finalStateClass vector that identifies to which token class each final state corresponds
+ */
+void _buildFinalStates(bool finalState[NUMBER_OF_STATES], char finalStateClass[NUMBER_OF_STATES]) {
+    // list of states that aren't final
+    static const char notFinals[] = {0, 1, 4, 6, 8, 13, 16, 20, 30, 32, 33, 34, 38, 39, 40, 41};
+    // list of final states
+    static const char finals[] = {2, 3, 5, 7, 9, 10, 11, 12, 14, 15, 17, 18, 19, 21, 22, 23, 24, 25, 26, 27, 28, 29, 31, 35, 36, 37};
+    // list of token classes corresponding to each final state, negative values indicate that
+    // we must retreat on the source code file after such final state is reacheded
+    static const int stateClasses[] = {-ID, ERROR, -N_INTEGER, -ERROR, -N_REAL, OP_ADD, OP_MULT, RELATION, ASSIGN,
+                                       -DECLARE_TYPE, RELATION, RELATION, -RELATION, -RELATION, RELATION, OP_UN,
+                                       SEMICOLON, COLON, OPEN_PAR, CLOSE_PAR, DOT, EOF, ERROR, ERROR, -ERROR, ERROR};
+
+    // Mark not final states as ERROR by default
+    for (unsigned long i = 0; i < sizeof notFinals; i++) {
+        finalState[notFinals[i]] = 0;
+        finalStateClass[notFinals[i]] = ERROR;
+    }
+
+    // mark final states appropriately
+    for (unsigned long i = 0; i < sizeof finals; i++) {
+        finalState[finals[i]] = 1;
+        finalStateClass[finals[i]] = stateClasses[i];
+    }
+}
+
+/**
+ * @brief Builds protected symbol recognizer automaton transition matrix.
+ * The protectedSymbolMatrix[][] has NUMBER_OF_STATES_PROTECTED_SYMBOLS lines (number of states)
+ * and NUMBER_OF_CHARS rows (number of ASCII characters). An element 'protectedSymbolMatrix[i][j]'
+ * represents the new state the automaton must go next when it is in state
+ * 'i' and reads the character of ASCII number 'j'.
+ * If protectedSymbolMatrix[i][j] == -1, we have an invalid transition.
+ *
+ * @param protectedSymbolMatrix
+ */
+void _buildProtectedSymbolMatrix(int protectedSymbolMatrix[NUMBER_OF_STATES_PROTECTED_SYMBOLS][NUMBER_OF_LOWER_CASE_LETTERS]) {
+    // invalid state by default
+    for (int i = 0; i < NUMBER_OF_STATES_PROTECTED_SYMBOLS; i++)
+        for (int j = 0; j < NUMBER_OF_LOWER_CASE_LETTERS; j++)
+            protectedSymbolMatrix[i][j] = -1;
+
+    _fillWord(protectedSymbolMatrix, "begin", 0, 1);
+    _fillWord(protectedSymbolMatrix, "const", 0, 6);
+    _fillWord(protectedSymbolMatrix, "do", 0, 11);
+    _fillWord(protectedSymbolMatrix, "end", 0, 13);
+    _fillWord(protectedSymbolMatrix, "lse", 13, 16);        // else
+    _fillWord(protectedSymbolMatrix, "if", 0, 19);
+    _fillWord(protectedSymbolMatrix, "nteger", 19, 21);     // integer
+    _fillWord(protectedSymbolMatrix, "for", 0, 27);
+    _fillWord(protectedSymbolMatrix, "program", 0, 30);
+    _fillWord(protectedSymbolMatrix, "cedure", 32, 37);     // procedure
+    _fillWord(protectedSymbolMatrix, "real", 0, 43);
+    _fillWord(protectedSymbolMatrix, "d", 45, 47);          // read
+    _fillWord(protectedSymbolMatrix, "then", 0, 48);
+    _fillWord(protectedSymbolMatrix, "o", 48, 52);          // to
+    _fillWord(protectedSymbolMatrix, "var", 0, 53);
+    _fillWord(protectedSymbolMatrix, "write", 0, 56);
+    _fillWord(protectedSymbolMatrix, "hile", 56, 61);       // while
+}
+
+/**
+ * @brief Build a vector that identifies final states regarding protected symbols.
+ *
+ * @param protectedSymbolFinalState vector that identifies final states token classes
+ */
+void _buildProtectedSymbolFinalStates(char protectedSymbolFinalState[NUMBER_OF_STATES_PROTECTED_SYMBOLS]) {
+    // list of final states
+    static const char finals[] = {5, 10, 12, 15, 18, 20, 26, 29, 36, 42, 46, 47, 51, 52, 55, 60, 64};
+    // list of token classes (protected symbols) corresponding to final states
+    static const char classes[] = {BEGIN, CONST, DO, END, ELSE, IF, INTEGER, FOR, PROGRAM, PROCEDURE, REAL, READ, THEN, TO, VAR, WRITE, WHILE};
+
+    // invalid states correspond to IDs
+    for (int i = 0; i < NUMBER_OF_STATES_PROTECTED_SYMBOLS; i++)
+        protectedSymbolFinalState[i] = ID;
+    // mark final states
+    for (unsigned long i = 0; i < sizeof finals; i++)
+        protectedSymbolFinalState[finals[i]] = classes[i];
+}
+
+/**
+ * @brief Auxiliary function used to fill the transition matrix. Fills in "other" transitions.
+ *
+ * @param transitionMatrix the transition matrix
+ * @param startState the state where the 'other' transition starts
+ * @param endState the state where the 'other' transition goes
+ */
+void _fillOther(int transitionMatrix[NUMBER_OF_STATES][NUMBER_OF_CHARS], int startState, int endState) {
+    for (int i = 0; i < NUMBER_OF_CHARS; i++)
+        if (transitionMatrix[startState][i] == -1)
+            transitionMatrix[startState][i] = endState;
+}
+
+/**
+ * @brief Auxiliary function used to fill the protected symbol transition matrix. Given a protected symbol,
+ * fills in the corresponding entries in the matrix.
+ *
+ * @param protectedSymbolMatrix the protected symbol matrix
+ * @param word protected symbol
+ * @param firstState state from where recognizition starts
+ * @param secondState second state on word recognition flow
+ */
+void _fillWord(int protectedSymbolMatrix[NUMBER_OF_STATES_PROTECTED_SYMBOLS][NUMBER_OF_LOWER_CASE_LETTERS], const char word[], int firstState, int secondState) {
+    protectedSymbolMatrix[firstState][word[0] - 'a'] = secondState;
+
+    for (unsigned long i = 1; i < strlen(word); i++, secondState++) {
+        protectedSymbolMatrix[secondState][word[i] - 'a'] = secondState + 1;
+    }
+}
@@ -0,0 +1,593 @@
+/**
+ * @file cgen.c
+ * @brief C code generation implementation. Integers are long long and reals double; variables and
+ * parameters are prefixed with v_ and procedures with p_, so names can't clash with C keywords or
+ * with the runtime. Integer arithmetic goes through unsigned long long so that it wraps around
+ * like the machine code of --run instead of being undefined on overflow, and the division checks
+ * its divisor. The runtime prints reals like src/runtime.c; the file must be compiled without
+ * -ffast-math for the results to match.
+ */
+#include "../header/cgen.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+#include "../header/runtime.h"
+
+// infinite literals are detected with isinf, which -Ofast (-ffast-math) folds to false
+#pragma GCC optimize("no-fast-math")
+
+/**
+ * @brief Writes the C translation of a program
+ *
+ * @param program a program without semantic errors
+ * @param sourcePath path of its source, quoted in the header comment
+ * @param outputPath path of the C file
+ * @return true if the file couldn't be written
+ * @return false otherwise
+ */
+bool cgenEmit(const Program* program, const char* sourcePath, const char* outputPath) {
+    PROFILE_ENTER(PHASE_CODEGEN);
+    FILE* output = fopen(outputPath, "w");
+    if (output == NULL) {
+        printf("Error: couldn't create %s\n", outputPath);
+        PROFILE_LEAVE();
+        return true;
+    }
+
+    // procedures whose calls were all inlined (or never called) are left out
+    CGen cgen = {program, output, 0, 0, (bool*)memoryCalloc(program->procedureCount + 1, sizeof(bool)), NULL, 0, 0};
+    int* pending = (int*)memoryAlloc((program->procedureCount + 1) * sizeof(int));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 2);
+    int count = 0, called = 0;
+    _cgenCalls(&cgen, program->nodes[program->body].a, pending, &count);
+    while (count > 0) {
+        called++;
+        _cgenCalls(&cgen, program->nodes[program->procedures[pending[--count]].body].a, pending, &count);
+    }
+    memoryFree(pending);
+
+    fprintf(output, "/* translated by pmm from %s */\n", sourcePath);
+    _cgenRuntime(&cgen);
+
+    for (unsigned long i = 0; i < program->symbolCount; i++) {
+        const Symbol* symbol = &program->symbols[i];
+        if (symbol->scope == GLOBAL_SCOPE && symbol->kind == SYMBOL_VARIABLE) {
+            fputs("static ", output);
+            _cgenDeclaration(&cgen, (int)i);
+            fputs(";\n", output);
+        }
+    }
+    fputc('\n', output);
+    for (unsigned long i = 0; i < program->procedureCount; i++)
+        if (cgen.called[i])
+            _cgenProcedure(&cgen, (int)i, true);
+    if (called > 0)
+        fputc('\n', output);
+    for (unsigned long i = 0; i < program->procedureCount; i++)
+        if (cgen.called[i])
+            _cgenProcedure(&cgen, (int)i, false);
+
+    fputs("int main(void) {\n", output);
+    cgen.depth = 1;
+    _cgenBody(&cgen, program->body);
+    fputs("    return 0;\n}\n", output);
+
+    memoryFree(cgen.called);
+    memoryFree(cgen.chain);
+    bool error = ferror(output) != 0;
+    if (fclose(output) || error) {
+        printf("Error: couldn't write %s\n", outputPath);
+        error = true;
+    }
+    PROFILE_LEAVE();
+    return error;
+}
+
+/**
+ * @brief Writes the runtime of the translated program: read, write, runtime errors and the
+ * wrapping integer operations. The functions are static inline so that the unused ones compile
+ * without warnings
+ *
+ * @param cgen the translation
+ */
+void _cgenRuntime(CGen* cgen) {
+    static const char* includes =
+        "#include <ctype.h>\n"
+        "#include <errno.h>\n"
+        "#include <math.h>\n"
+        "#include <stdio.h>\n"
+        "#include <stdlib.h>\n"
+        "#include <string.h>\n"
+        "\n"
+        "#define PMM_NEG(a) ((long long)(0ull - (unsigned long long)(a)))\n"
+        "\n";
+    static const char* functions =
+        "static inline void pmm_fail(int status, int line, int col) {\n"
+        "    fflush(stdout);\n"
+        "    fprintf(stderr, \"Runtime error on line %d col %d: %s\\n\", line, col, pmm_messages[status]);\n"
+        "    exit(1);\n"
+        "}\n"
+        "\n"
+        "static inline long long pmm_divide(long long a, long long b, int line, int col) {\n"
+        "    if (b == 0)\n"
+        "        pmm_fail(PMM_DIVISION_BY_ZERO, line, col);\n"
+        "    return (b == -1) ? PMM_NEG(a) : a / b;\n"
+        "}\n"
+        "\n"
+        "static inline void pmm_word(char* word, int line, int col) {\n"
+        "    int c;\n"
+        "    do {\n"
+        "        c = getchar();\n"
+        "    } while (c != EOF && isspace(c));\n"
+        "    if (c == EOF)\n"
+        "        pmm_fail(PMM_END_OF_INPUT, line, col);\n"
+        "    int length = 0;\n"
+        "    while (c != EOF && !isspace(c)) {\n"
+        "        if (length == PMM_WORD_SIZE - 1)\n"
+        "            pmm_fail(PMM_INVALID_INPUT, line, col);\n"
+        "        word[length++] = (char)c;\n"
+        "        c = getchar();\n"
+        "    }\n"
+        "    word[length] = '\\0';\n"
+        "}\n"
+        "\n"
+        "static inline long long pmm_read_integer(int line, int col) {\n"
+        "    char word[PMM_WORD_SIZE];\n"
+        "    char* end;\n"
+        "    pmm_word(word, line, col);\n"
+        "    errno = 0;\n"
+        "    long long value = strtoll(word, &end, 10);\n"
+        "    if (*end != '\\0' || errno == ERANGE)\n"
+        "        pmm_fail(PMM_INVALID_INPUT, line, col);\n"
+        "    return value;\n"
+        "}\n"
+        "\n"
+        "static inline double pmm_read_real(int line, int col) {\n"
+        "    char word[PMM_WORD_SIZE];\n"
+        "    char* end;\n"
+        "    pmm_word(word, line, col);\n"
+        "    double value = strtod(word, &end);\n"
+        "    if (*end != '\\0')\n"
+        "        pmm_fail(PMM_INVALID_INPUT, line, col);\n"
+        "    return value;\n"
+        "}\n"
+        "\n"
+        "static inline void pmm_write_integer(long long value, int separator) {\n"
+        "    printf(\"%lld%c\", value, separator);\n"
+        "}\n"
+        "\n"
+        "/* fewest digits that read back as the same value, positional from 1e-7 to 1e21 */\n"
+        "static inline void pmm_write_real(double value, int separator) {\n"
+        "    char scientific[32], text[40], digits[20] = {0}, *out = text;\n"
+        "    if (isnan(value) || isinf(value)) {\n"
+        "        printf(\"%s%c\", isnan(value) ? \"nan\" : (value < 0) ? \"-inf\" : \"inf\", separator);\n"
+        "        return;\n"
+        "    }\n"
+        "    for (int precision = 1; precision <= 17; precision++) {\n"
+        "        snprintf(scientific, sizeof(scientific), \"%.*e\", precision - 1, value);\n"
+        "        double back = strtod(scientific, NULL);\n"
+        "        if (!memcmp(&back, &value, sizeof(double)))\n"
+        "            break;\n"
+        "    }\n"
+        "    const char* p = scientific;\n"
+        "    if (*p == '-')\n"
+        "        *out++ = *p++;\n"
+        "    int count = 0;\n"
+        "    for (; *p != 'e'; p++)\n"
+        "        if (*p != '.')\n"
+        "            digits[count++] = *p;\n"
+        "    int exponent = atoi(p + 1);\n"
+        "    if (exponent < -7 || exponent >= 21) {\n"
+        "        *out++ = digits[0];\n"
+        "        if (count > 1) {\n"
+        "            *out++ = '.';\n"
+        "            memcpy(out, digits + 1, count - 1);\n"
+        "            out += count - 1;\n"
+        "        }\n"
+        "        out += sprintf(out, \"e%c%d\", (exponent < 0) ? '-' : '+', abs(exponent));\n"
+        "    } else if (exponent < 0) {\n"
+        "        *out++ = '0';\n"
+        "        *out++ = '.';\n"
+        "        for (int i = 1; i < -exponent; i++)\n"
+        "            *out++ = '0';\n"
+        "        memcpy(out, digits, count);\n"
+        "        out += count;\n"
+        "    } else {\n"
+        "        for (int i = 0; i <= exponent; i++)\n"
+        "            *out++ = (i < count) ? digits[i] : '0';\n"
+        "        *out++ = '.';\n"
+        "        if (count > exponent + 1) {\n"
+        "            memcpy(out, digits + exponent + 1, count - exponent - 1);\n"
+        "            out += count - exponent - 1;\n"
+        "        } else {\n"
+        "            *out++ = '0';\n"
+        "        }\n"
+        "    }\n"
+        "    *out = '\\0';\n"
+        "    printf(\"%s%c\", text, separator);\n"
+        "}\n"
+        "\n";
+
+    FILE* output = cgen->output;
+    fputs(includes, output);
+    fprintf(output, "enum { PMM_DIVISION_BY_ZERO = %d, PMM_INVALID_INPUT = %d, PMM_END_OF_INPUT = %d, PMM_WORD_SIZE = 512 };\n",
+            RUNTIME_DIVISION_BY_ZERO, RUNTIME_INVALID_INPUT, RUNTIME_END_OF_INPUT);
+    fputs("static const char* pmm_messages[] = {", output);
+    for (int i = 0; i < N_RUNTIME_STATUS; i++)
+        fprintf(output, "%s\"%s\"", (i > 0) ? ", " : "", runtimeStatusMessage(i));
+    fputs("};\n\n", output);
+    fputs(functions, output);
+}
+
+/**
+ * @brief Marks the procedures called by a list of commands, and by the commands nested in them,
+ * pushing the ones not marked before so that their bodies are scanned too
+ *
+ * @param cgen the translation
+ * @param node the first command
+ * @param pending procedures whose bodies are still to be scanned
+ * @param count procedures in pending, updated
+ */
+void _cgenCalls(CGen* cgen, int node, int* pending, int* count) {
+    const Program* program = cgen->program;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        const Node* command = &program->nodes[node];
+        if (command->kind == NODE_CALL) {
+            int procedure = program->symbols[command->symbol].index;
+            if (!cgen->called[procedure]) {
+                cgen->called[procedure] = true;
+                pending[(*count)++] = procedure;
+            }
+        } else if (command->kind == NODE_IF) {
+            _cgenCalls(cgen, command->b, pending, count);
+            _cgenCalls(cgen, command->c, pending, count);
+        } else if (command->kind == NODE_WHILE) {
+            _cgenCalls(cgen, command->b, pending, count);
+        } else if (command->kind == NODE_FOR) {
+            _cgenCalls(cgen, command->c, pending, count);
+        } else if (command->kind == NODE_BLOCK) {
+            _cgenCalls(cgen, command->a, pending, count);
+        }
+    }
+}
+
+/**
+ * @brief Writes the prototype or the definition of a procedure
+ *
+ * @param cgen the translation
+ * @param procedure the procedure
+ * @param prototype whether only the prototype is written
+ */
+void _cgenProcedure(CGen* cgen, int procedure, bool prototype) {
+    const Procedure* declared = &cgen->program->procedures[procedure];
+    fprintf(cgen->output, "static void p_%s(", programName(cgen->program, declared->symbol));
+    for (int i = 0; i < declared->parameterCount; i++) {
+        if (i > 0)
+            fputs(", ", cgen->output);
+        _cgenDeclaration(cgen, declared->firstParameter + i);
+    }
+    if (declared->parameterCount == 0)
+        fputs("void", cgen->output);
+    if (prototype) {
+        fputs(");\n", cgen->output);
+        return;
+    }
+
+    fputs(") {\n", cgen->output);
+    cgen->depth = 1;
+    for (int i = 0; i < declared->localCount; i++) {
+        _cgenIndent(cgen);
+        _cgenDeclaration(cgen, programVariable(cgen->program, procedure, declared->parameterCount + i));
+        fputs(" = 0;\n", cgen->output);
+    }
+    _cgenBody(cgen, declared->body);
+    fputs("}\n\n", cgen->output);
+}
+
+/**
+ * @brief Writes the indentation of the current line
+ *
+ * @param cgen the translation
+ */
+void _cgenIndent(CGen* cgen) {
+    for (int i = 0; i < cgen->depth; i++)
+        fputs("    ", cgen->output);
+}
+
+/**
+ * @brief Writes the commands of a block, or a single command, inside braces already written
+ *
+ * @param cgen the translation
+ * @param node the command
+ */
+void _cgenBody(CGen* cgen, int node) {
+    if (node != NO_NODE && cgen->program->nodes[node].kind == NODE_BLOCK) {
+        for (int command = cgen->program->nodes[node].a; command != NO_NODE; command = cgen->program->nodes[command].next)
+            _cgenCommand(cgen, command);
+    } else {
+        _cgenCommand(cgen, node);
+    }
+}
+
+/**
+ * @brief Writes a command
+ *
+ * @param cgen the translation
+ * @param node the command (NO_NODE is an empty command)
+ */
+void _cgenCommand(CGen* cgen, int node) {
+    static const char* relations[] = {"==", "!=", "<", "<=", ">", ">="};
+
+    if (node == NO_NODE)
+        return;
+    const Program* program = cgen->program;
+    const Node* n = &program->nodes[node];
+    FILE* output = cgen->output;
+
+    switch (n->kind) {
+        case NODE_BLOCK:
+            _cgenIndent(cgen);
+            fputs("{\n", output);
+            cgen->depth++;
+            _cgenBody(cgen, node);
+            cgen->depth--;
+            _cgenIndent(cgen);
+            fputs("}\n", output);
+            break;
+
+        case NODE_ASSIGN:
+            _cgenIndent(cgen);
+            _cgenVariable(cgen, n->symbol);
+            fputs(" = ", output);
+            _cgenExpression(cgen, n->a);
+            fputs(";\n", output);
+            break;
+
+        case NODE_CALL:
+            _cgenIndent(cgen);
+            fprintf(output, "p_%s(", programName(program, n->symbol));
+            for (int argument = n->a; argument != NO_NODE; argument = program->nodes[argument].next) {
+                _cgenExpression(cgen, argument);
+                if (program->nodes[argument].next != NO_NODE)
+                    fputs(", ", output);
+            }
+            fputs(");\n", output);
+            break;
+
+        case NODE_READ:
+            for (int item = n->a; item != NO_NODE; item = program->nodes[item].next) {
+                _cgenIndent(cgen);
+                _cgenVariable(cgen, program->nodes[item].symbol);
+                fprintf(output, " = pmm_read_%s(%d, %d);\n", (program->nodes[item].type == TYPE_REAL) ? "real" : "integer",
+                        n->line, n->col);
+            }
+            break;
+
+        case NODE_WRITE:
+            for (int item = n->a; item != NO_NODE; item = program->nodes[item].next) {
+                _cgenIndent(cgen);
+                fprintf(output, "pmm_write_%s(", (program->nodes[item].type == TYPE_REAL) ? "real" : "integer");
+                _cgenExpression(cgen, item);
+                fprintf(output, ", '%s');\n", (program->nodes[item].next == NO_NODE) ? "\\n" : " ");
+            }
+            break;
+
+        case NODE_IF:
+        case NODE_WHILE: {
+            const Node* condition = &program->nodes[n->a];
+            _cgenIndent(cgen);
+            fputs((n->kind == NODE_IF) ? "if (" : "while (", output);
+            _cgenExpression(cgen, condition->a);
+            fprintf(output, " %s ", relations[(int)condition->op]);
+            _cgenExpression(cgen, condition->b);
+            fputs(") {\n", output);
+            cgen->depth++;
+            _cgenBody(cgen, n->b);
+            cgen->depth--;
+            _cgenIndent(cgen);
+            if (n->kind == NODE_IF && n->c != NO_NODE) {
+                fputs("} else {\n", output);
+                cgen->depth++;
+                _cgenBody(cgen, n->c);
+                cgen->depth--;
+                _cgenIndent(cgen);
+            }
+            fputs("}\n", output);
+            break;
+        }
+
+        case NODE_FOR:
+            _cgenFor(cgen, node);
+            break;
+    }
+}
+
+/**
+ * @brief Writes a for loop like the one of --run: the final value is computed once, before the
+ * initial one, and the variable isn't incremented past it
+ *
+ * @param cgen the translation
+ * @param node the NODE_FOR
+ */
+void _cgenFor(CGen* cgen, int node) {
+    const Node* n = &cgen->program->nodes[node];
+    FILE* output = cgen->output;
+    int loop = ++cgen->loops;
+
+    _cgenIndent(cgen);
+    fputs("{\n", output);
+    cgen->depth++;
+    _cgenIndent(cgen);
+    fprintf(output, "long long last%d = ", loop);
+    _cgenExpression(cgen, n->b);
+    fputs(";\n", output);
+    _cgenIndent(cgen);
+    _cgenVariable(cgen, n->symbol);
+    fputs(" = ", output);
+    _cgenExpression(cgen, n->a);
+    fputs(";\n", output);
+    _cgenIndent(cgen);
+    fputs("if (", output);
+    _cgenVariable(cgen, n->symbol);
+    fprintf(output, " <= last%d) {\n", loop);
+    cgen->depth++;
+    _cgenIndent(cgen);
+    fputs("for (;;) {\n", output);
+    cgen->depth++;
+    _cgenBody(cgen, n->c);
+    _cgenIndent(cgen);
+    fputs("if (", output);
+    _cgenVariable(cgen, n->symbol);
+    fprintf(output, " >= last%d)\n", loop);
+    _cgenIndent(cgen);
+    fputs("    break;\n", output);
+    _cgenIndent(cgen);
+    _cgenVariable(cgen, n->symbol);
+    fputs("++;\n", output);
+    for (int i = 0; i < 3; i++) {
+        cgen->depth--;
+        _cgenIndent(cgen);
+        fputs("}\n", output);
+    }
+    cgen->loops--;
+}
+
+/**
+ * @brief Writes an expression, parenthesized. Expressions are left-deep, so the chain of first
+ * operands is written by loops, without recursion: the prefixes from the top down to the first
+ * operand, then the second operands back up. Runs of + - * (and / on reals) are written infix, in
+ * unsigned arithmetic for integers (the wrapping of --run), with parentheses only where a lower
+ * precedence is the first operand, so that a long sum is flat for the C compiler too.
+ *
+ * @param cgen the translation
+ * @param node the expression
+ */
+void _cgenExpression(CGen* cgen, int node) {
+    static const char* operators[] = {" + ", " - ", " * ", " / "};
+    const Program* program = cgen->program;
+    FILE* output = cgen->output;
+
+    int base = cgen->chainSize;
+    for (int link = node;; link = program->nodes[link].a) {
+        if (cgen->chainSize == cgen->chainCapacity) {
+            cgen->chainCapacity = (cgen->chainCapacity == 0) ? 64 : 2 * cgen->chainCapacity;
+            cgen->chain = (int*)memoryRealloc(cgen->chain, cgen->chainCapacity * sizeof(int));
+            PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+        }
+        cgen->chain[cgen->chainSize++] = link;
+        if (program->nodes[link].kind == NODE_NUMBER || program->nodes[link].kind == NODE_VARIABLE)
+            break;
+    }
+    int top = cgen->chainSize;
+
+    for (int i = base; i < top; i++) {
+        const Node* n = &program->nodes[cgen->chain[i]];
+        bool real = n->type == TYPE_REAL;
+        int precedence = _cgenPrecedence(n);
+        if (precedence > 0) {
+            int parent = (i > base) ? _cgenPrecedence(&program->nodes[cgen->chain[i - 1]]) : 0;
+            int child = _cgenPrecedence(&program->nodes[n->a]);
+            if (parent == 0)  // start of a run
+                fputs(real ? "(" : "(long long)(", output);
+            if (child > 0 && child < precedence)
+                fputc('(', output);
+            if (child == 0 && !real)
+                fputs("(unsigned long long)", output);
+            continue;
+        }
+
+        switch (n->kind) {
+            case NODE_NUMBER:
+                if (!real) {
+                    fprintf(output, "%ldLL", n->value.integer);
+                } else if (isinf(n->value.real)) {  // a literal too large for a double
+                    fputs("HUGE_VAL", output);
+                } else {
+                    char text[RUNTIME_REAL_SIZE];
+                    runtimeFormatReal(n->value.real, text);  // reads back as the same double
+                    fputs(text, output);
+                }
+                break;
+            case NODE_VARIABLE:
+                _cgenVariable(cgen, n->symbol);
+                break;
+            case NODE_NEGATE:
+                fputs(real ? "(-" : "PMM_NEG(", output);
+                break;
+            case NODE_TO_REAL:
+                fputs("((double)", output);
+                break;
+            default:  // integer division
+                fputs("pmm_divide(", output);
+        }
+    }
+
+    for (int i = top - 1; i >= base; i--) {
+        const Node* n = &program->nodes[cgen->chain[i]];
+        int precedence = _cgenPrecedence(n);
+        if (precedence > 0) {
+            int parent = (i > base) ? _cgenPrecedence(&program->nodes[cgen->chain[i - 1]]) : 0;
+            int child = _cgenPrecedence(&program->nodes[n->a]);
+            if (child > 0 && child < precedence)
+                fputc(')', output);
+            fputs(operators[n->kind - NODE_ADD], output);
+            if (n->type != TYPE_REAL)
+                fputs("(unsigned long long)", output);
+            _cgenExpression(cgen, n->b);
+            if (parent == 0)
+                fputc(')', output);
+        } else if (n->kind == NODE_DIVIDE) {
+            int line = n->line, col = n->col;  // the nodes don't move, but n isn't used after the call
+            fputs(", ", output);
+            _cgenExpression(cgen, n->b);
+            fprintf(output, ", %d, %d)", line, col);
+        } else if (n->kind == NODE_NEGATE || n->kind == NODE_TO_REAL) {
+            fputc(')', output);
+        }
+    }
+    cgen->chainSize = base;
+}
+
+/**
+ * @brief Returns the precedence of an operator written infix by _cgenExpression
+ *
+ * @param node a node
+ * @return int 2 for * and real /, 1 for + and -, 0 for the other nodes (integer / is a call)
+ */
+int _cgenPrecedence(const Node* node) {
+    if (node->kind == NODE_ADD || node->kind == NODE_SUBTRACT)
+        return 1;
+    if (node->kind == NODE_MULTIPLY || (node->kind == NODE_DIVIDE && node->type == TYPE_REAL))
+        return 2;
+    return 0;
+}
+
+/**
+ * @brief Writes the name of a variable or parameter
+ *
+ * @param cgen the translation
+ * @param symbol the variable
+ */
+void _cgenVariable(CGen* cgen, int symbol) {
+    // the variables added by inlining are named name.N, they can't clash with the declared ones
+    const char* name = programName(cgen->program, symbol);
+    const char* dot = strchr(name, '.');
+    if (dot == NULL)
+        fprintf(cgen->output, "v_%s", name);
+    else
+        fprintf(cgen->output, "w_%.*s_%s", (int)(dot - name), name, dot + 1);
+}
+
+/**
+ * @brief Writes the type and the name of a variable or parameter
+ *
+ * @param cgen the translation
+ * @param symbol the variable
+ */
+void _cgenDeclaration(CGen* cgen, int symbol) {
+    fputs((cgen->program->symbols[symbol].type == TYPE_REAL) ? "double " : "long long ", cgen->output);
+    _cgenVariable(cgen, symbol);
+}
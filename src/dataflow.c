@@ -0,0 +1,362 @@
+/**
+ * @file dataflow.c
+ * @brief Definite assignment analysis implementation. Control flow is structured, so the data flow
+ * follows the tree in a single pass: the state is the set of variables assigned on every path,
+ * the branches of an if meet with an intersection and a loop leaves with its entry state (its body
+ * may not run, and a second iteration starts with more variables assigned than the first one, so
+ * no iteration to a fixed point is needed). Each command costs a few word-parallel operations on
+ * bit vectors of the variables of its function.
+ *
+ * Every function tracks the globals besides its own variables, and the parameters are assigned by
+ * the call. Procedures only call themselves and the ones declared before them, so they are
+ * summarized in declaration order: the globals a procedure assigns on every path (a call adds them
+ * to the state of the caller). The program body is then analyzed, and the procedures in reverse
+ * order, each one entered with the globals assigned at all of its calls (all of its callers were
+ * analyzed before it) that are assigned somewhere in the program, so a procedure that is never
+ * called only warns about globals nothing assigns. A recursive call doesn't change the state: it
+ * enters the procedure with at least the globals of its entry. Each variable is reported once per
+ * function, at its first suspicious read.
+ */
+#include "../header/dataflow.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+
+/**
+ * @brief Warns about the variables that may be read before they are assigned
+ *
+ * @param program a program without semantic errors
+ * @param tokens the tokens it was built from, which give the positions of the warnings
+ * @param diagnostics where the warnings are recorded
+ * @return int the number of warnings
+ */
+int dataflowCheck(const Program* program, const ProgramTokens* tokens, Diagnostics* diagnostics) {
+    PROFILE_ENTER(PHASE_DATAFLOW);
+    Dataflow dataflow;
+    memset(&dataflow, 0, sizeof(Dataflow));
+    dataflow.program = program;
+    dataflow.tokens = tokens;
+    dataflow.diagnostics = diagnostics;
+    dataflow.globalWords = program->globalCount / 64 + 1;
+
+    int count = (int)program->procedureCount;
+    unsigned long words = (unsigned long)dataflow.globalWords;
+    dataflow.assigned = (uint64_t*)memoryCalloc((2 * (unsigned long)count + 1) * words, sizeof(uint64_t));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    dataflow.entries = dataflow.assigned + count * words;
+    dataflow.anywhere = dataflow.entries + count * words;
+    memset(dataflow.entries, 0xff, count * words * sizeof(uint64_t));
+
+    // summaries, the callees first
+    for (int i = 0; i < count; i++) {
+        _dataflowFunction(&dataflow, i, program->procedures[i].body, NULL);
+        memcpy(dataflow.assigned + i * words, dataflow.states, words * sizeof(uint64_t));
+    }
+
+    // warnings, the callers first
+    dataflow.warn = true;
+    _dataflowFunction(&dataflow, GLOBAL_SCOPE, program->body, NULL);
+    for (int i = count - 1; i >= 0; i--) {
+        uint64_t* entry = dataflow.entries + i * words;
+        for (unsigned long j = 0; j < words; j++)
+            entry[j] &= dataflow.anywhere[j];
+        _dataflowFunction(&dataflow, i, program->procedures[i].body, entry);
+    }
+    _dataflowReport(&dataflow);
+
+    memoryFree(dataflow.pending);
+    memoryFree(dataflow.assigned);
+    memoryFree(dataflow.states);
+    memoryFree(dataflow.reported);
+    PROFILE_LEAVE();
+    return dataflow.warnings;
+}
+
+/**
+ * @brief Analyzes a procedure or the program body
+ *
+ * @param dataflow a dataflow instance
+ * @param scope the procedure or GLOBAL_SCOPE
+ * @param body its NODE_BLOCK
+ * @param entry globals assigned when it starts (NULL for none)
+ */
+void _dataflowFunction(Dataflow* dataflow, int scope, int body, const uint64_t* entry) {
+    const Program* program = dataflow->program;
+    const Procedure* declared = (scope == GLOBAL_SCOPE) ? NULL : &program->procedures[scope];
+    int variables = (declared == NULL) ? program->globalCount : dataflow->globalWords * 64 + declared->parameterCount + declared->localCount;
+    int words = variables / 64 + 1;
+    if (dataflow->stateCapacity == 0)
+        dataflow->stateCapacity = 16;
+    if (words > dataflow->words) {
+        dataflow->states = (uint64_t*)memoryRealloc(dataflow->states, (unsigned long)dataflow->stateCapacity * words * sizeof(uint64_t));
+        dataflow->reported = (uint64_t*)memoryRealloc(dataflow->reported, words * sizeof(uint64_t));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 2);
+    }
+    dataflow->scope = scope;
+    dataflow->words = words;
+    dataflow->depth = 0;
+
+    // the parameters are assigned by the call
+    memset(dataflow->states, 0, words * sizeof(uint64_t));
+    memset(dataflow->reported, 0, words * sizeof(uint64_t));
+    if (entry != NULL)
+        memcpy(dataflow->states, entry, dataflow->globalWords * sizeof(uint64_t));
+    for (int i = 0; declared != NULL && i < declared->parameterCount; i++) {
+        int bit = dataflow->globalWords * 64 + i;
+        dataflow->states[bit / 64] |= 1ull << (bit % 64);
+    }
+    _dataflowCommands(dataflow, program->nodes[body].a);
+}
+
+/**
+ * @brief Finds the bit of a variable in the bit vectors of the function being analyzed
+ *
+ * @param dataflow a dataflow instance
+ * @param symbol the variable or parameter
+ * @return int its bit
+ */
+int _dataflowVariable(const Dataflow* dataflow, int symbol) {
+    const Symbol* variable = &dataflow->program->symbols[symbol];
+    return (variable->scope == GLOBAL_SCOPE) ? variable->index : dataflow->globalWords * 64 + variable->index;
+}
+
+/**
+ * @brief Pushes a copy of the current state
+ *
+ * @param dataflow a dataflow instance
+ * @return int the level of the copy
+ */
+int _dataflowSave(Dataflow* dataflow) {
+    int level = dataflow->depth + 1;
+    if (level >= dataflow->stateCapacity) {
+        dataflow->stateCapacity = (dataflow->stateCapacity == 0) ? 16 : 2 * dataflow->stateCapacity;
+        dataflow->states = (uint64_t*)memoryRealloc(dataflow->states, (unsigned long)dataflow->stateCapacity * dataflow->words * sizeof(uint64_t));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    memcpy(dataflow->states + (unsigned long)level * dataflow->words, dataflow->states, dataflow->words * sizeof(uint64_t));
+    dataflow->depth = level;
+    return level;
+}
+
+/**
+ * @brief Replaces the current state by a saved one, or by its intersection with it
+ *
+ * @param dataflow a dataflow instance
+ * @param level the saved state
+ * @param intersect whether the variables must be assigned in both
+ */
+void _dataflowMerge(Dataflow* dataflow, int level, bool intersect) {
+    uint64_t* state = dataflow->states;
+    const uint64_t* saved = dataflow->states + (unsigned long)level * dataflow->words;
+    for (int i = 0; i < dataflow->words; i++)
+        state[i] = intersect ? (state[i] & saved[i]) : saved[i];
+}
+
+/**
+ * @brief Analyzes a list of commands
+ *
+ * @param dataflow a dataflow instance
+ * @param node the first command
+ */
+void _dataflowCommands(Dataflow* dataflow, int node) {
+    const Program* program = dataflow->program;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        const Node* command = &program->nodes[node];
+        switch (command->kind) {
+            case NODE_ASSIGN:
+                _dataflowUse(dataflow, command->a);
+                _dataflowAssign(dataflow, command->symbol);
+                break;
+            case NODE_READ:
+                for (int variable = command->a; variable != NO_NODE; variable = program->nodes[variable].next)
+                    _dataflowAssign(dataflow, program->nodes[variable].symbol);
+                break;
+            case NODE_WRITE:
+            case NODE_CALL:
+                for (int value = command->a; value != NO_NODE; value = program->nodes[value].next)
+                    _dataflowUse(dataflow, value);
+                if (command->kind == NODE_CALL)
+                    _dataflowCall(dataflow, program->symbols[command->symbol].index);
+                break;
+            case NODE_IF: {
+                _dataflowUse(dataflow, command->a);
+                int entry = _dataflowSave(dataflow);
+                _dataflowCommands(dataflow, command->b);
+                if (command->c == NO_NODE) {
+                    _dataflowMerge(dataflow, entry, false);
+                } else {
+                    int then = _dataflowSave(dataflow);
+                    _dataflowMerge(dataflow, entry, false);
+                    _dataflowCommands(dataflow, command->c);
+                    _dataflowMerge(dataflow, then, true);
+                }
+                dataflow->depth = entry - 1;
+                break;
+            }
+            case NODE_WHILE: {
+                _dataflowUse(dataflow, command->a);
+                int entry = _dataflowSave(dataflow);
+                _dataflowCommands(dataflow, command->b);
+                _dataflowMerge(dataflow, entry, false);
+                dataflow->depth = entry - 1;
+                break;
+            }
+            case NODE_FOR: {
+                _dataflowUse(dataflow, command->b);  // the final value is evaluated first
+                _dataflowUse(dataflow, command->a);
+                _dataflowAssign(dataflow, command->symbol);
+                int entry = _dataflowSave(dataflow);
+                _dataflowCommands(dataflow, command->c);
+                _dataflowMerge(dataflow, entry, false);
+                dataflow->depth = entry - 1;
+                break;
+            }
+            case NODE_BLOCK:
+                _dataflowCommands(dataflow, command->a);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Records the globals assigned at a call (once the summaries are known) and adds the ones
+ * the procedure assigns to the state. A recursive call changes nothing.
+ *
+ * @param dataflow a dataflow instance
+ * @param callee the procedure
+ */
+void _dataflowCall(Dataflow* dataflow, int callee) {
+    if (callee == dataflow->scope)
+        return;
+    uint64_t* entry = dataflow->entries + (unsigned long)callee * dataflow->globalWords;
+    const uint64_t* assigned = dataflow->assigned + (unsigned long)callee * dataflow->globalWords;
+    for (int i = 0; i < dataflow->globalWords; i++) {
+        if (dataflow->warn)
+            entry[i] &= dataflow->states[i];
+        dataflow->states[i] |= assigned[i];
+    }
+}
+
+/**
+ * @brief Marks a variable as assigned
+ *
+ * @param dataflow a dataflow instance
+ * @param symbol the variable
+ */
+void _dataflowAssign(Dataflow* dataflow, int symbol) {
+    int bit = _dataflowVariable(dataflow, symbol);
+    dataflow->states[bit / 64] |= 1ull << (bit % 64);
+    if (dataflow->program->symbols[symbol].scope == GLOBAL_SCOPE)
+        dataflow->anywhere[bit / 64] |= 1ull << (bit % 64);
+}
+
+/**
+ * @brief Checks the variables read by an expression
+ *
+ * @param dataflow a dataflow instance
+ * @param node the expression
+ */
+void _dataflowUse(Dataflow* dataflow, int node) {
+    const Program* program = dataflow->program;
+    while (node != NO_NODE) {
+        const Node* expression = &program->nodes[node];
+        if (expression->kind == NODE_VARIABLE) {
+            int bit = _dataflowVariable(dataflow, expression->symbol);
+            if (dataflow->warn && !(dataflow->states[bit / 64] >> (bit % 64) & 1))
+                _dataflowWarn(dataflow, node);
+            return;
+        }
+        if (expression->b != NO_NODE)
+            _dataflowUse(dataflow, expression->b);
+        node = expression->a;
+    }
+}
+
+/**
+ * @brief Keeps a warning for a variable read before it is assigned, unless it was reported. The
+ * functions aren't analyzed in source order, so the warnings are recorded at the end.
+ *
+ * @param dataflow a dataflow instance
+ * @param node the NODE_VARIABLE
+ */
+void _dataflowWarn(Dataflow* dataflow, int node) {
+    const Node* read = &dataflow->program->nodes[node];
+    int bit = _dataflowVariable(dataflow, read->symbol);
+    if (dataflow->reported[bit / 64] >> (bit % 64) & 1)
+        return;
+    dataflow->reported[bit / 64] |= 1ull << (bit % 64);
+
+    if (dataflow->warnings == dataflow->pendingCapacity) {
+        dataflow->pendingCapacity = (dataflow->pendingCapacity == 0) ? 16 : 2 * dataflow->pendingCapacity;
+        dataflow->pending = (const Node**)memoryRealloc(dataflow->pending, dataflow->pendingCapacity * sizeof(Node*));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    dataflow->pending[dataflow->warnings++] = read;
+}
+
+/**
+ * @brief Records the warnings in source order
+ *
+ * @param dataflow a dataflow instance
+ */
+void _dataflowReport(Dataflow* dataflow) {
+    if (dataflow->warnings > 0)
+        qsort(dataflow->pending, dataflow->warnings, sizeof(Node*), _dataflowCompare);
+
+    for (int i = 0; i < dataflow->warnings; i++) {
+        const Node* read = dataflow->pending[i];
+        SourcePosition position = {0};
+        const ProgramToken* token = _dataflowToken(dataflow, read->line, read->col);
+        if (token != NULL) {
+            position = token->position;
+        } else {
+            position.line = read->line;
+            position.col = read->col;
+            position.offset = NO_OFFSET;
+            position.lineOffset = NO_OFFSET;
+        }
+        diagnosticsWarning(dataflow->diagnostics, &position, programName(dataflow->program, read->symbol));
+    }
+}
+
+/**
+ * @brief Orders two warnings by position (qsort comparator)
+ *
+ * @param a pointer to the first NODE_VARIABLE
+ * @param b pointer to the second NODE_VARIABLE
+ * @return int negative, zero or positive as a is before, at or after b
+ */
+int _dataflowCompare(const void* a, const void* b) {
+    const Node* first = *(const Node* const*)a;
+    const Node* second = *(const Node* const*)b;
+    if (first->line != second->line)
+        return (first->line < second->line) ? -1 : 1;
+    return (first->col > second->col) - (first->col < second->col);
+}
+
+/**
+ * @brief Finds the token at a position (the tokens are in source order)
+ *
+ * @param dataflow a dataflow instance
+ * @param line its line
+ * @param col its column
+ * @return const ProgramToken* the token or NULL if none starts there
+ */
+const ProgramToken* _dataflowToken(const Dataflow* dataflow, int line, int col) {
+    const ProgramToken* list = dataflow->tokens->list;
+    unsigned long low = 0, high = dataflow->tokens->size;
+    while (low < high) {
+        unsigned long middle = low + (high - low) / 2;
+        const SourcePosition* position = &list[middle].position;
+        if (position->line < line || (position->line == line && position->col < col))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low < dataflow->tokens->size && list[low].position.line == line && list[low].position.col == col)
+        return &list[low];
+    return NULL;
+}
@@ -0,0 +1,580 @@
+/**
+ * @file diagnostics.c
+ * @brief Buffered compiler diagnostics implementation
+ */
+#include "../header/diagnostics.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../header/lexer.h"
+#include "../header/memory.h"
+#include "../header/profile.h"
+#include "../header/program.h"
+
+/**
+ * @brief Initializes an empty diagnostics sink
+ *
+ * @param diagnostics a diagnostics instance
+ * @param format output format (DIAGNOSTIC_FORMAT)
+ * @param maxErrors maximum number of errors to be recorded (0 means no limit)
+ */
+void diagnosticsInit(Diagnostics* diagnostics, int format, int maxErrors) {
+    diagnostics->size = 0;
+    diagnostics->capacity = 16;
+    diagnostics->list = (Diagnostic*)memoryAlloc(diagnostics->capacity * sizeof(Diagnostic));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    stringInit(&diagnostics->textPool);
+    stringInit(&diagnostics->scratch);
+
+    diagnostics->format = format;
+    diagnostics->maxErrors = maxErrors;
+    diagnostics->snippets = false;
+    diagnostics->errors = 0;
+    diagnostics->dropped = 0;
+    diagnostics->warnings = 0;
+}
+
+/**
+ * @brief Deallocates the memory used by the diagnostics
+ *
+ * @param diagnostics a diagnostics instance
+ */
+void diagnosticsDestroy(Diagnostics* diagnostics) {
+    memoryFree(diagnostics->list);
+    stringDestroy(&diagnostics->textPool);
+    stringDestroy(&diagnostics->scratch);
+}
+
+/**
+ * @brief Forgets the recorded diagnostics, keeping the allocated memory
+ *
+ * @param diagnostics a diagnostics instance
+ */
+void diagnosticsClear(Diagnostics* diagnostics) {
+    diagnostics->size = 0;
+    diagnostics->errors = 0;
+    diagnostics->dropped = 0;
+    diagnostics->warnings = 0;
+    stringOverwrite(&diagnostics->textPool, "", 0);
+}
+
+/**
+ * @brief Records a lexer error
+ *
+ * @param diagnostics a diagnostics instance
+ * @param position position of the invalid lexeme
+ * @param lexeme the invalid lexeme
+ * @param state automaton state that identifies the error
+ */
+void diagnosticsLexerError(Diagnostics* diagnostics, const SourcePosition* position, const char* lexeme, int state) {
+    Diagnostic* diagnostic = _diagnosticsNew(diagnostics, DIAGNOSTIC_LEXER);
+    if (diagnostic == NULL)
+        return;
+
+    diagnostic->line = position->line;
+    diagnostic->col = position->col;
+    diagnostic->offset = position->offset;
+    diagnostic->lineOffset = position->lineOffset;
+    diagnostic->code = state;
+    diagnostic->text = diagnostics->textPool.size;
+    stringAppend(&diagnostics->textPool, lexeme, strlen(lexeme) + 1);
+}
+
+/**
+ * @brief Records a parser error
+ *
+ * @param diagnostics a diagnostics instance
+ * @param position position of the unexpected token
+ * @param expectedTokenClass expected token class
+ * @param found lexeme found instead, NULL if the end of file was reached
+ */
+void diagnosticsParserError(Diagnostics* diagnostics, const SourcePosition* position, int expectedTokenClass, const char* found) {
+    Diagnostic* diagnostic = _diagnosticsNew(diagnostics, DIAGNOSTIC_PARSER);
+    if (diagnostic == NULL)
+        return;
+
+    diagnostic->line = position->line;
+    diagnostic->col = position->col;
+    diagnostic->offset = position->offset;
+    diagnostic->lineOffset = position->lineOffset;
+    diagnostic->code = expectedTokenClass;
+    diagnostic->text = NO_TEXT;
+    if (found != NULL) {
+        diagnostic->text = diagnostics->textPool.size;
+        stringAppend(&diagnostics->textPool, found, strlen(found) + 1);
+    }
+}
+
+/**
+ * @brief Records that the lexer reached the end of file
+ *
+ * @param diagnostics a diagnostics instance
+ */
+void diagnosticsEOF(Diagnostics* diagnostics) {
+    Diagnostic* diagnostic = _diagnosticsNew(diagnostics, DIAGNOSTIC_EOF);
+    if (diagnostic == NULL)
+        return;
+
+    diagnostic->line = 0;
+    diagnostic->col = 0;
+    diagnostic->offset = NO_OFFSET;
+    diagnostic->lineOffset = NO_OFFSET;
+    diagnostic->code = LAMBDA;
+    diagnostic->text = NO_TEXT;
+}
+
+/**
+ * @brief Records a semantic error
+ *
+ * @param diagnostics a diagnostics instance
+ * @param position position of the identifier
+ * @param code SEMANTIC_ERROR
+ * @param name the identifier
+ */
+void diagnosticsSemanticError(Diagnostics* diagnostics, const SourcePosition* position, int code, const char* name) {
+    Diagnostic* diagnostic = _diagnosticsNew(diagnostics, DIAGNOSTIC_SEMANTIC);
+    if (diagnostic == NULL)
+        return;
+
+    diagnostic->line = position->line;
+    diagnostic->col = position->col;
+    diagnostic->offset = position->offset;
+    diagnostic->lineOffset = position->lineOffset;
+    diagnostic->code = code;
+    diagnostic->text = diagnostics->textPool.size;
+    stringAppend(&diagnostics->textPool, name, strlen(name) + 1);
+}
+
+/**
+ * @brief Records a warning about a variable that may be read before it is assigned
+ *
+ * @param diagnostics a diagnostics instance
+ * @param position position of the read
+ * @param name the variable
+ */
+void diagnosticsWarning(Diagnostics* diagnostics, const SourcePosition* position, const char* name) {
+    Diagnostic* diagnostic = _diagnosticsNew(diagnostics, DIAGNOSTIC_WARNING);
+    diagnostic->line = position->line;
+    diagnostic->col = position->col;
+    diagnostic->offset = position->offset;
+    diagnostic->lineOffset = position->lineOffset;
+    diagnostic->code = 0;
+    diagnostic->text = diagnostics->textPool.size;
+    stringAppend(&diagnostics->textPool, name, strlen(name) + 1);
+}
+
+/**
+ * @brief Reserves space for a new diagnostic. Errors beyond maxErrors are only counted, warnings
+ * are always recorded.
+ *
+ * @param diagnostics a diagnostics instance
+ * @param kind kind of the diagnostic (DIAGNOSTIC_KIND)
+ * @return Diagnostic* the new diagnostic or NULL if it must not be recorded
+ */
+Diagnostic* _diagnosticsNew(Diagnostics* diagnostics, int kind) {
+    if (kind == DIAGNOSTIC_WARNING) {
+        diagnostics->warnings++;
+    } else {
+        if (kind != DIAGNOSTIC_EOF) {
+            if (diagnostics->maxErrors > 0 && diagnostics->errors >= (unsigned long)diagnostics->maxErrors) {
+                diagnostics->dropped++;
+                return NULL;
+            }
+            diagnostics->errors++;
+        }
+        PROFILE_COUNT(COUNTER_ERRORS, 1);
+    }
+
+    if (diagnostics->size == diagnostics->capacity) {
+        diagnostics->capacity *= 2;
+        diagnostics->list = (Diagnostic*)memoryRealloc(diagnostics->list, diagnostics->capacity * sizeof(Diagnostic));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+
+    Diagnostic* diagnostic = &diagnostics->list[diagnostics->size++];
+    diagnostic->kind = kind;
+    return diagnostic;
+}
+
+/**
+ * @brief Renders all recorded diagnostics in the selected format
+ *
+ * @param diagnostics a diagnostics instance
+ * @param report string where the report is appended
+ * @param sourcePath path of the compiled file (used by SARIF and by the text snippets, may be NULL)
+ */
+void diagnosticsRender(Diagnostics* diagnostics, String* report, const char* sourcePath) {
+    switch (diagnostics->format) {
+        case FORMAT_JSON:
+            _diagnosticsRenderJson(diagnostics, report);
+            break;
+        case FORMAT_SARIF:
+            _diagnosticsRenderSarif(diagnostics, report, sourcePath);
+            break;
+        default:
+            _diagnosticsRenderText(diagnostics, report, sourcePath);
+    }
+}
+
+/**
+ * @brief Renders the diagnostics once and writes the report to the given stream and output file
+ *
+ * @param diagnostics a diagnostics instance
+ * @param sourcePath path of the compiled file
+ * @param stream stream where the report is written (may be NULL)
+ * @param outputFilePath file where the report is written (may be NULL)
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool diagnosticsFlush(Diagnostics* diagnostics, const char* sourcePath, FILE* stream, const char* outputFilePath) {
+    String report;
+    stringInit(&report);
+    diagnosticsRender(diagnostics, &report, sourcePath);
+
+    PROFILE_ENTER(PHASE_IO);
+    if (stream != NULL)
+        fwrite(report.str, sizeof(char), report.size, stream);
+
+    bool error = false;
+    if (outputFilePath != NULL) {
+        FILE* output = fopen(outputFilePath, "w");
+        if (output == NULL) {
+            printf("Error: couldn't create output file\n");
+            error = true;
+        } else {
+            fwrite(report.str, sizeof(char), report.size, output);
+            fclose(output);
+        }
+    }
+    PROFILE_LEAVE();
+
+    stringDestroy(&report);
+    return error;
+}
+
+/**
+ * @brief Returns the format identifier given its name
+ *
+ * @param name format name (text, json or sarif)
+ * @return int DIAGNOSTIC_FORMAT or -1 if the name is unknown
+ */
+int diagnosticsParseFormat(const char* name) {
+    if (!strcmp(name, "text"))
+        return FORMAT_TEXT;
+    if (!strcmp(name, "json"))
+        return FORMAT_JSON;
+    if (!strcmp(name, "sarif"))
+        return FORMAT_SARIF;
+    return -1;
+}
+
+/**
+ * @brief Builds the message of a diagnostic, without its location
+ *
+ * @param diagnostics a diagnostics instance
+ * @param diagnostic the diagnostic
+ * @param message string where the message is appended
+ */
+void _diagnosticsMessage(Diagnostics* diagnostics, const Diagnostic* diagnostic, String* message) {
+    if (diagnostic->kind == DIAGNOSTIC_LEXER) {
+        const char* description = lexerErrorMessage(diagnostic->code);
+        if (!strncmp(description, "Error: ", 7))
+            description += 7;
+        stringAppendCstr(message, description);
+        stringAppendCstr(message, " '");
+        stringAppendCstr(message, diagnostics->textPool.str + diagnostic->text);
+        stringAppendChar(message, '\'');
+    } else if (diagnostic->kind == DIAGNOSTIC_SEMANTIC || diagnostic->kind == DIAGNOSTIC_WARNING) {
+        stringAppendCstr(message, (diagnostic->kind == DIAGNOSTIC_WARNING) ? "possibly uninitialized variable" : programErrorMessage(diagnostic->code));
+        stringAppendCstr(message, " '");
+        stringAppendCstr(message, diagnostics->textPool.str + diagnostic->text);
+        stringAppendChar(message, '\'');
+    } else if (diagnostic->text == NO_TEXT) {
+        stringAppendCstr(message, "unexpected end of file (expected ");
+        stringAppendCstr(message, lexerTokenClassUserFriendlyName(diagnostic->code));
+        stringAppendChar(message, ')');
+    } else {
+        stringAppendCstr(message, "expected ");
+        stringAppendCstr(message, lexerTokenClassUserFriendlyName(diagnostic->code));
+        stringAppendCstr(message, " but found ");
+        stringAppendCstr(message, diagnostics->textPool.str + diagnostic->text);
+    }
+}
+
+/**
+ * @brief Renders the diagnostics as human readable text. When snippets are enabled the source code
+ * is reopened, so the lines are only read for the errors being shown (stdin can't be reopened).
+ *
+ * @param diagnostics a diagnostics instance
+ * @param report string where the report is appended
+ * @param sourcePath path of the compiled file (may be NULL)
+ */
+void _diagnosticsRenderText(Diagnostics* diagnostics, String* report, const char* sourcePath) {
+    FILE* source = NULL;
+    if (diagnostics->snippets && sourcePath != NULL && strcmp(sourcePath, "-"))
+        source = fopen(sourcePath, "rb");
+    String* line = &diagnostics->scratch;
+
+    for (unsigned long i = 0; i < diagnostics->size; i++) {
+        const Diagnostic* diagnostic = &diagnostics->list[i];
+        if (diagnostic->kind == DIAGNOSTIC_EOF) {
+            stringAppendCstr(report, "EOF\n");
+            continue;
+        }
+
+        static const char* kindName[] = {"Lexer error on line ", "Parser error on line ", "", "Semantic error on line ", "Warning on line "};
+        stringAppendCstr(report, kindName[(int)diagnostic->kind]);
+        stringAppendInt(report, diagnostic->line);
+        stringAppendCstr(report, " col ");
+        stringAppendInt(report, diagnostic->col);
+        if (diagnostic->kind == DIAGNOSTIC_LEXER) {  // keeps the lexeme before the description
+            stringAppendCstr(report, " ('");
+            stringAppendCstr(report, diagnostics->textPool.str + diagnostic->text);
+            stringAppendCstr(report, "'): ");
+            stringAppendCstr(report, lexerErrorMessage(diagnostic->code));
+        } else {
+            stringAppendCstr(report, ": ");
+            _diagnosticsMessage(diagnostics, diagnostic, report);
+        }
+        stringAppendChar(report, '\n');
+
+        if (source != NULL && diagnostic->lineOffset != NO_OFFSET)
+            _diagnosticsSnippet(diagnostic, diagnostic->text == NO_TEXT ? "" : diagnostics->textPool.str + diagnostic->text, source, line, report);
+    }
+
+    if (source != NULL)
+        fclose(source);
+
+    if (diagnostics->dropped > 0) {
+        stringAppendCstr(report, "Too many errors, ");
+        stringAppendInt(report, (int)diagnostics->dropped);
+        stringAppendCstr(report, " more not shown\n");
+    }
+}
+
+/**
+ * @brief Renders the source line of a diagnostic with the lexeme underlined, e.g.
+ *     3 | x := y +* 2;
+ *       |         ^
+ * Tabs are expanded to 4 spaces, as columns count them.
+ *
+ * @param diagnostic the diagnostic
+ * @param lexeme the offending lexeme (empty at the end of file)
+ * @param source the source code file
+ * @param line string used to read the line
+ * @param report string where the snippet is appended
+ */
+void _diagnosticsSnippet(const Diagnostic* diagnostic, const char* lexeme, FILE* source, String* line, String* report) {
+    if (fseek(source, (long)diagnostic->lineOffset, SEEK_SET))
+        return;
+
+    stringOverwrite(line, "", 0);
+    int c;
+    while ((c = fgetc(source)) != EOF && c != '\n' && c != '\r') {
+        if (c == '\t')
+            stringAppendCstr(line, "    ");
+        else
+            stringAppendChar(line, (char)c);
+    }
+
+    char number[16];
+    int width = snprintf(number, sizeof(number), "%5d", diagnostic->line);
+    stringAppendCstr(report, number);
+    stringAppendCstr(report, " | ");
+    stringAppend(report, line->str, line->size);
+    stringAppendChar(report, '\n');
+
+    for (int i = 0; i < width; i++)
+        stringAppendChar(report, ' ');
+    stringAppendCstr(report, " | ");
+    for (int i = 1; i < diagnostic->col; i++)
+        stringAppendChar(report, ' ');
+
+    // the underline covers the lexeme (code points) but never goes beyond the line
+    stringAppendChar(report, '^');
+    int lineCols = 0;
+    for (unsigned long i = 0; i < line->size; i++)
+        lineCols += ((line->str[i] & 0xc0) != 0x80);
+    int col = diagnostic->col + 1;
+    for (const char* l = lexeme; *l && *l != '\n'; l++) {
+        if ((*l & 0xc0) == 0x80 || l == lexeme)
+            continue;
+        if (col > lineCols)
+            break;
+        stringAppendChar(report, '~');
+        col++;
+    }
+    stringAppendChar(report, '\n');
+}
+
+/**
+ * @brief Renders the diagnostics as JSON lines, one object per error
+ *
+ * @param diagnostics a diagnostics instance
+ * @param report string where the report is appended
+ */
+void _diagnosticsRenderJson(Diagnostics* diagnostics, String* report) {
+    String* message = &diagnostics->scratch;
+
+    for (unsigned long i = 0; i < diagnostics->size; i++) {
+        const Diagnostic* diagnostic = &diagnostics->list[i];
+        if (diagnostic->kind == DIAGNOSTIC_EOF)
+            continue;
+
+        stringOverwrite(message, "", 0);
+        _diagnosticsMessage(diagnostics, diagnostic, message);
+
+        static const char* kindName[] = {"{\"kind\":\"lexer\"", "{\"kind\":\"parser\"", "", "{\"kind\":\"semantic\"", "{\"kind\":\"warning\""};
+        stringAppendCstr(report, kindName[(int)diagnostic->kind]);
+        stringAppendCstr(report, ",\"line\":");
+        stringAppendInt(report, diagnostic->line);
+        stringAppendCstr(report, ",\"col\":");
+        stringAppendInt(report, diagnostic->col);
+        if (diagnostic->offset != NO_OFFSET) {
+            stringAppendCstr(report, ",\"offset\":");
+            stringAppendLong(report, diagnostic->offset);
+        }
+        stringAppendCstr(report, ",\"message\":");
+        _appendJsonString(report, message->str);
+        if (diagnostic->kind == DIAGNOSTIC_PARSER) {
+            stringAppendCstr(report, ",\"expected\":");
+            _appendJsonString(report, lexerTokenClassUserFriendlyName(diagnostic->code));
+        }
+        if (diagnostic->text != NO_TEXT) {
+            stringAppendCstr(report, ",\"found\":");
+            _appendJsonString(report, diagnostics->textPool.str + diagnostic->text);
+        }
+        stringAppendCstr(report, "}\n");
+    }
+
+    if (diagnostics->dropped > 0) {
+        stringAppendCstr(report, "{\"kind\":\"limit\",\"dropped\":");
+        stringAppendInt(report, (int)diagnostics->dropped);
+        stringAppendCstr(report, "}\n");
+    }
+
+}
+
+/**
+ * @brief Renders the diagnostics as a SARIF 2.1.0 log. Its columns are code points, a tab counting
+ * as one: they are counted again in the source code, which is reopened, and left out when it can't
+ * be (stdin, token streams)
+ *
+ * @param diagnostics a diagnostics instance
+ * @param report string where the report is appended
+ * @param sourcePath path of the compiled file
+ */
+void _diagnosticsRenderSarif(Diagnostics* diagnostics, String* report, const char* sourcePath) {
+    String* message = &diagnostics->scratch;
+    FILE* source = NULL;
+    if (sourcePath != NULL && strcmp(sourcePath, "-"))
+        source = fopen(sourcePath, "rb");
+
+    stringAppendCstr(report,
+                     "{\"version\":\"2.1.0\","
+                     "\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+                     "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"pmm\","
+                     "\"rules\":[{\"id\":\"lexer-error\"},{\"id\":\"parser-error\"},{\"id\":\"semantic-error\"},{\"id\":\"uninitialized-variable\"}]}},"
+                     "\"columnKind\":\"unicodeCodePoints\","
+                     "\"results\":[");
+
+    bool first = true;
+    for (unsigned long i = 0; i < diagnostics->size; i++) {
+        const Diagnostic* diagnostic = &diagnostics->list[i];
+        if (diagnostic->kind == DIAGNOSTIC_EOF)
+            continue;
+
+        stringOverwrite(message, "", 0);
+        _diagnosticsMessage(diagnostics, diagnostic, message);
+
+        if (!first)
+            stringAppendChar(report, ',');
+        first = false;
+
+        static const char* ruleId[] = {"{\"ruleId\":\"lexer-error\"", "{\"ruleId\":\"parser-error\"", "", "{\"ruleId\":\"semantic-error\"",
+                                       "{\"ruleId\":\"uninitialized-variable\""};
+        stringAppendCstr(report, ruleId[(int)diagnostic->kind]);
+        stringAppendCstr(report, (diagnostic->kind == DIAGNOSTIC_WARNING) ? ",\"level\":\"warning\"" : ",\"level\":\"error\"");
+        stringAppendCstr(report, ",\"message\":{\"text\":");
+        _appendJsonString(report, message->str);
+        stringAppendCstr(report, "},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":");
+        _appendJsonString(report, sourcePath != NULL ? sourcePath : "");
+        stringAppendCstr(report, "},\"region\":{\"startLine\":");
+        stringAppendInt(report, diagnostic->line);
+        int col = _diagnosticsCodePoints(diagnostic, source);
+        if (col > 0) {
+            stringAppendCstr(report, ",\"startColumn\":");
+            stringAppendInt(report, col);
+        }
+        if (diagnostic->offset != NO_OFFSET) {
+            stringAppendCstr(report, ",\"byteOffset\":");
+            stringAppendLong(report, diagnostic->offset);
+        }
+        stringAppendCstr(report, "}}}]}");
+    }
+
+    stringAppendCstr(report, "]}]}\n");
+    if (source != NULL)
+        fclose(source);
+}
+
+/**
+ * @brief Counts the code points of the line of a diagnostic before it in the source code
+ *
+ * @param diagnostic the diagnostic
+ * @param source the source code file (may be NULL)
+ * @return int its column in code points, a tab counting as one, or 0 if it isn't known
+ */
+int _diagnosticsCodePoints(const Diagnostic* diagnostic, FILE* source) {
+    if (source == NULL || diagnostic->offset == NO_OFFSET || diagnostic->lineOffset == NO_OFFSET ||
+        fseek(source, (long)diagnostic->lineOffset, SEEK_SET))
+        return 0;
+    int col = 1;
+    for (unsigned long i = diagnostic->lineOffset; i < diagnostic->offset; i++) {
+        int c = fgetc(source);
+        if (c == EOF)
+            return 0;
+        col += ((c & 0xc0) != 0x80);
+    }
+    return col;
+}
+
+/**
+ * @brief Appends a C string as a quoted and escaped JSON string
+ *
+ * @param s the string
+ * @param cstr the C string
+ */
+void _appendJsonString(String* s, const char* cstr) {
+    static const char hex[] = "0123456789abcdef";
+
+    stringAppendChar(s, '"');
+    for (; *cstr; cstr++) {
+        unsigned char c = (unsigned char)*cstr;
+        if (c == '"' || c == '\\') {
+            stringAppendChar(s, '\\');
+            stringAppendChar(s, (char)c);
+        } else if (c == '\n') {
+            stringAppendCstr(s, "\\n");
+        } else if (c == '\t') {
+            stringAppendCstr(s, "\\t");
+        } else if (c < 0x20) {
+            stringAppendCstr(s, "\\u00");
+            stringAppendChar(s, hex[c >> 4]);
+            stringAppendChar(s, hex[c & 0xf]);
+        } else if (c >= 0x80) {
+            // valid UTF-8 characters are copied, invalid bytes become U+FFFD
+            unsigned long length = stringUtf8CharLength(cstr);
+            if (length == 0) {
+                stringAppendCstr(s, "\\ufffd");
+            } else {
+                stringAppend(s, cstr, length);
+                cstr += length - 1;
+            }
+        } else {
+            stringAppendChar(s, (char)c);
+        }
+    }
+    stringAppendChar(s, '"');
+}
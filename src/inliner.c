@@ -0,0 +1,492 @@
+/**
+ * @file inliner.c
+ * @brief Procedure inlining implementation. The call graph of the procedures is built from their
+ * call sites and its cycles (Tarjan's strongly connected components) mark the recursive ones. The
+ * procedures are processed with their callees first, so an inlined body has its own calls already
+ * inlined, and the program body last. A call is inlined if the callee isn't recursive, its body
+ * is small and the caller stays within its growth budget: the call node becomes a block that
+ * assigns each argument to a fresh copy of its parameter, resets fresh copies of the locals (only
+ * inside loops, the caller starts with them at 0) and runs a copy of the body that uses them.
+ * Arguments are values, so the evaluation order and the runtime errors don't change.
+ */
+#include "../header/inliner.h"
+
+#include <string.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+
+/**
+ * @brief Inlines the small non-recursive procedures at their call sites
+ *
+ * @param program a program without semantic errors
+ * @param report where the decisions are printed, NULL if they aren't
+ */
+void inlinerRun(Program* program, FILE* report) {
+    PROFILE_ENTER(PHASE_OPTIMIZE);
+    Inliner inliner;
+    memset(&inliner, 0, sizeof(Inliner));
+    inliner.program = program;
+    inliner.report = report;
+    int count = (int)program->procedureCount;
+    inliner.calleeStart = (int*)memoryAlloc((count + 1) * sizeof(int));
+    inliner.recursive = (bool*)memoryCalloc(count + 1, sizeof(bool));
+    inliner.order = (int*)memoryAlloc((count + 1) * sizeof(int));
+    inliner.sizes = (int*)memoryAlloc((count + 1) * sizeof(int));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 4);
+
+    for (int i = 0; i < count; i++) {
+        inliner.calleeStart[i] = inliner.calleeCount;
+        _inlinerCalls(&inliner, program->nodes[program->procedures[i].body].a);
+    }
+    inliner.calleeStart[count] = inliner.calleeCount;
+    _inlinerCycles(&inliner);
+
+    for (int i = 0; i < count; i++) {
+        int procedure = inliner.order[i];
+        _inlinerFunction(&inliner, procedure, program->procedures[procedure].body);
+        inliner.sizes[procedure] = _inlinerSize(program, program->procedures[procedure].body);
+    }
+    _inlinerFunction(&inliner, GLOBAL_SCOPE, program->body);
+    if (report != NULL)
+        fprintf(report, "%d calls inlined, %d kept\n", inliner.inlined, inliner.kept);
+
+    memoryFree(inliner.callees);
+    memoryFree(inliner.calleeStart);
+    memoryFree(inliner.recursive);
+    memoryFree(inliner.order);
+    memoryFree(inliner.sizes);
+    memoryFree(inliner.map);
+    PROFILE_LEAVE();
+}
+
+/**
+ * @brief Adds the procedures called by a list of commands, and by the commands nested in them,
+ * to the call graph
+ *
+ * @param inliner an inliner
+ * @param node the first command
+ */
+void _inlinerCalls(Inliner* inliner, int node) {
+    const Program* program = inliner->program;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        const Node* command = &program->nodes[node];
+        switch (command->kind) {
+            case NODE_CALL:
+                if (inliner->calleeCount == inliner->calleeCapacity) {
+                    inliner->calleeCapacity = (inliner->calleeCapacity == 0) ? 64 : 2 * inliner->calleeCapacity;
+                    inliner->callees = (int*)memoryRealloc(inliner->callees, inliner->calleeCapacity * sizeof(int));
+                    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+                }
+                inliner->callees[inliner->calleeCount++] = program->symbols[command->symbol].index;
+                break;
+            case NODE_IF:
+                _inlinerCalls(inliner, command->b);
+                _inlinerCalls(inliner, command->c);
+                break;
+            case NODE_WHILE:
+                _inlinerCalls(inliner, command->b);
+                break;
+            case NODE_FOR:
+                _inlinerCalls(inliner, command->c);
+                break;
+            case NODE_BLOCK:
+                _inlinerCalls(inliner, command->a);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Finds the strongly connected components of the call graph (Tarjan's algorithm, with an
+ * explicit stack since call chains can be long): the procedures of a component with several of
+ * them, or that call themselves, are recursive. The components are completed with their callees
+ * first, which gives the processing order.
+ *
+ * @param inliner an inliner with its call graph
+ */
+void _inlinerCycles(Inliner* inliner) {
+    int count = (int)inliner->program->procedureCount;
+    int* number = (int*)memoryAlloc((count + 1) * sizeof(int));  // discovery order, -1 if not visited
+    int* low = (int*)memoryAlloc((count + 1) * sizeof(int));
+    int* edge = (int*)memoryAlloc((count + 1) * sizeof(int));    // next callee to visit
+    int* visiting = (int*)memoryAlloc((count + 1) * sizeof(int));
+    int* component = (int*)memoryAlloc((count + 1) * sizeof(int));
+    bool* open = (bool*)memoryCalloc(count + 1, sizeof(bool));   // in the component stack
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 6);
+    memset(number, -1, (count + 1) * sizeof(int));
+
+    int discovered = 0, ordered = 0;
+    for (int root = 0; root < count; root++) {
+        if (number[root] != -1)
+            continue;
+        int depth = 0, size = 0;
+        visiting[depth++] = root;
+        number[root] = low[root] = discovered++;
+        edge[root] = inliner->calleeStart[root];
+        component[size++] = root;
+        open[root] = true;
+
+        while (depth > 0) {
+            int procedure = visiting[depth - 1];
+            if (edge[procedure] < inliner->calleeStart[procedure + 1]) {
+                int callee = inliner->callees[edge[procedure]++];
+                if (callee == procedure) {
+                    inliner->recursive[procedure] = true;
+                } else if (number[callee] == -1) {
+                    visiting[depth++] = callee;
+                    number[callee] = low[callee] = discovered++;
+                    edge[callee] = inliner->calleeStart[callee];
+                    component[size++] = callee;
+                    open[callee] = true;
+                } else if (open[callee] && number[callee] < low[procedure]) {
+                    low[procedure] = number[callee];
+                }
+                continue;
+            }
+
+            depth--;
+            if (depth > 0 && low[procedure] < low[visiting[depth - 1]])
+                low[visiting[depth - 1]] = low[procedure];
+            if (low[procedure] == number[procedure]) {
+                bool cycle = component[size - 1] != procedure;
+                int member;
+                do {
+                    member = component[--size];
+                    open[member] = false;
+                    inliner->recursive[member] |= cycle;
+                    inliner->order[ordered++] = member;
+                } while (member != procedure);
+            }
+        }
+    }
+
+    memoryFree(number);
+    memoryFree(low);
+    memoryFree(edge);
+    memoryFree(visiting);
+    memoryFree(component);
+    memoryFree(open);
+}
+
+/**
+ * @brief Inlines the calls of a procedure or of the program body, within its growth budget
+ *
+ * @param inliner an inliner
+ * @param scope the procedure or GLOBAL_SCOPE
+ * @param body its NODE_BLOCK
+ */
+void _inlinerFunction(Inliner* inliner, int scope, int body) {
+    int size = _inlinerSize(inliner->program, body);
+    inliner->budget = (size > INLINER_MIN_BUDGET) ? size : INLINER_MIN_BUDGET;
+    _inlinerSites(inliner, scope, inliner->program->nodes[body].a, 0);
+}
+
+/**
+ * @brief Decides on the call sites of a list of commands, and of the commands nested in them, in
+ * source order. The blocks that replace the calls aren't visited again.
+ *
+ * @param inliner an inliner
+ * @param scope the procedure or GLOBAL_SCOPE
+ * @param node the first command
+ * @param loops while and for loops around the commands
+ */
+void _inlinerSites(Inliner* inliner, int scope, int node, int loops) {
+    Program* program = inliner->program;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        Node command = program->nodes[node];  // the nodes can move while the list is visited
+        switch (command.kind) {
+            case NODE_CALL: {
+                int callee = program->symbols[command.symbol].index;
+                const Procedure* declared = &program->procedures[callee];
+                int locals = (loops > 0) ? declared->localCount : 0;
+                int cost = inliner->sizes[callee] + declared->parameterCount + 2 * locals;
+                int decision = _inlinerDecide(inliner, callee, cost);
+                _inlinerReport(inliner, scope, node, decision, inliner->sizes[callee]);
+                if (decision == INLINER_INLINED) {
+                    inliner->budget -= cost;
+                    _inlinerInline(inliner, scope, node, callee, loops > 0);
+                }
+                break;
+            }
+            case NODE_IF:
+                _inlinerSites(inliner, scope, command.b, loops);
+                _inlinerSites(inliner, scope, command.c, loops);
+                break;
+            case NODE_WHILE:
+                _inlinerSites(inliner, scope, command.b, loops + 1);
+                break;
+            case NODE_FOR:
+                _inlinerSites(inliner, scope, command.c, loops + 1);
+                break;
+            case NODE_BLOCK:
+                _inlinerSites(inliner, scope, command.a, loops);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Decides whether a call is inlined
+ *
+ * @param inliner an inliner
+ * @param callee the procedure called
+ * @param cost nodes the caller grows by
+ * @return int INLINER_DECISION
+ */
+int _inlinerDecide(Inliner* inliner, int callee, int cost) {
+    if (inliner->recursive[callee])
+        return INLINER_RECURSIVE;
+    if (inliner->sizes[callee] > INLINER_MAX_SIZE)
+        return INLINER_TOO_LARGE;
+    if (cost > inliner->budget)
+        return INLINER_BUDGET;
+    return INLINER_INLINED;
+}
+
+/**
+ * @brief Counts a decision and prints it if the decisions are reported
+ *
+ * @param inliner an inliner
+ * @param scope the caller or GLOBAL_SCOPE
+ * @param node the NODE_CALL
+ * @param decision INLINER_DECISION
+ * @param size nodes of the callee body
+ */
+void _inlinerReport(Inliner* inliner, int scope, int node, int decision, int size) {
+    if (decision == INLINER_INLINED)
+        inliner->inlined++;
+    else
+        inliner->kept++;
+    if (inliner->report == NULL)
+        return;
+
+    const Program* program = inliner->program;
+    const Node* call = &program->nodes[node];
+    const char* callee = programName(program, call->symbol);
+    const char* caller = (scope == GLOBAL_SCOPE) ? "the program" : programName(program, program->procedures[scope].symbol);
+    if (decision == INLINER_INLINED)
+        fprintf(inliner->report, "line %d col %d: inlined %s into %s (%d nodes)\n", call->line, call->col, callee, caller, size);
+    else
+        fprintf(inliner->report, "line %d col %d: kept the call of %s in %s: ", call->line, call->col, callee, caller);
+    if (decision == INLINER_RECURSIVE)
+        fputs("recursive\n", inliner->report);
+    else if (decision == INLINER_TOO_LARGE)
+        fprintf(inliner->report, "%d nodes, more than %d\n", size, INLINER_MAX_SIZE);
+    else if (decision == INLINER_BUDGET)
+        fprintf(inliner->report, "the growth budget of %s is spent\n", caller);
+}
+
+/**
+ * @brief Replaces a call by a block: the arguments are assigned to fresh copies of the parameters,
+ * the fresh copies of the locals are reset and a copy of the body follows
+ *
+ * @param inliner an inliner
+ * @param scope the caller or GLOBAL_SCOPE
+ * @param node the NODE_CALL, it keeps its place in its list
+ * @param callee the procedure called
+ * @param reset whether the locals are reset (the call is in a loop)
+ */
+void _inlinerInline(Inliner* inliner, int scope, int node, int callee, bool reset) {
+    Program* program = inliner->program;
+    int parameters = program->procedures[callee].parameterCount;
+    int count = parameters + program->procedures[callee].localCount;
+    if (count > inliner->mapCapacity) {
+        inliner->mapCapacity = 2 * count;
+        inliner->map = (int*)memoryRealloc(inliner->map, inliner->mapCapacity * sizeof(int));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    for (int i = 0; i < count; i++)
+        inliner->map[i] = _inlinerVariable(inliner, scope, programVariable(program, callee, i));
+
+    int first = NO_NODE, last = NO_NODE;
+    int argument = program->nodes[node].a;
+    for (int i = 0; i < count; i++) {
+        if (i >= parameters && !reset)
+            break;
+        int assign = _inlinerNode(inliner, node);
+        Node* command = &program->nodes[assign];
+        command->kind = NODE_ASSIGN;
+        command->symbol = inliner->map[i];
+        if (i < parameters) {
+            command->a = argument;
+            argument = program->nodes[argument].next;
+            program->nodes[command->a].next = NO_NODE;
+        } else {
+            int zero = _inlinerNode(inliner, node);
+            program->nodes[zero].kind = NODE_NUMBER;
+            program->nodes[zero].type = program->symbols[inliner->map[i]].type;
+            program->nodes[zero].symbol = -1;
+            if (program->nodes[zero].type == TYPE_REAL)
+                program->nodes[zero].value.real = 0.0;
+            else
+                program->nodes[zero].value.integer = 0;
+            program->nodes[assign].a = zero;
+        }
+        if (first == NO_NODE)
+            first = assign;
+        else
+            program->nodes[last].next = assign;
+        last = assign;
+    }
+
+    int body = _inlinerCopy(inliner, program->nodes[program->procedures[callee].body].a, callee);
+    if (first == NO_NODE)
+        first = body;
+    else
+        program->nodes[last].next = body;
+    Node* block = &program->nodes[node];
+    block->kind = NODE_BLOCK;
+    block->symbol = -1;
+    block->a = first;
+}
+
+/**
+ * @brief Declares a fresh variable in the caller for a parameter or local of the callee, named
+ * name.N (no identifier has a dot): a global one in the program body, a local one (listed in the
+ * variables added to the procedure) otherwise
+ *
+ * @param inliner an inliner
+ * @param scope the caller or GLOBAL_SCOPE
+ * @param original the parameter or local
+ * @return int the symbol
+ */
+int _inlinerVariable(Inliner* inliner, int scope, int original) {
+    Program* program = inliner->program;
+    if (program->symbolCount == program->symbolCapacity) {
+        program->symbolCapacity = (program->symbolCapacity == 0) ? 64 : 2 * program->symbolCapacity;
+        program->symbols = (Symbol*)memoryRealloc(program->symbols, program->symbolCapacity * sizeof(Symbol));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+
+    // the name of a variable added by an earlier inlining loses its number
+    unsigned long name = program->symbols[original].name;
+    unsigned long length = strcspn(program->names.str + name, ".");
+    if (program->names.size + length + 16 > program->names.capacity)
+        _stringExpand(&program->names, 2 * (program->names.size + length + 16));
+    Symbol* symbol = &program->symbols[program->symbolCount];
+    symbol->name = program->names.size;
+    symbol->kind = SYMBOL_VARIABLE;
+    symbol->type = program->symbols[original].type;
+    symbol->scope = scope;
+    symbol->value.integer = 0;
+    stringAppend(&program->names, program->names.str + name, length);
+    stringAppendChar(&program->names, '.');
+    stringAppendInt(&program->names, ++inliner->variables);
+    stringAppend(&program->names, "", 1);
+
+    if (scope == GLOBAL_SCOPE) {
+        symbol->index = program->globalCount++;
+    } else {
+        Procedure* procedure = &program->procedures[scope];
+        if (procedure->addedCount == procedure->addedCapacity) {
+            procedure->addedCapacity = (procedure->addedCapacity == 0) ? 16 : 2 * procedure->addedCapacity;
+            procedure->added = (int*)memoryRealloc(procedure->added, procedure->addedCapacity * sizeof(int));
+            PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+        }
+        procedure->added[procedure->addedCount++] = (int)program->symbolCount;
+        symbol->index = procedure->parameterCount + procedure->localCount++;
+    }
+    return (int)program->symbolCount++;
+}
+
+/**
+ * @brief Appends a copy of a node to the tree, without its children and next node
+ *
+ * @param inliner an inliner
+ * @param from the node copied
+ * @return int the copy
+ */
+int _inlinerNode(Inliner* inliner, int from) {
+    Program* program = inliner->program;
+    if (program->nodeCount == program->nodeCapacity) {
+        program->nodeCapacity = (program->nodeCapacity == 0) ? 256 : 2 * program->nodeCapacity;
+        program->nodes = (Node*)memoryRealloc(program->nodes, program->nodeCapacity * sizeof(Node));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+
+    Node* node = &program->nodes[program->nodeCount];
+    *node = program->nodes[from];
+    node->a = node->b = node->c = NO_NODE;
+    node->next = NO_NODE;
+    return (int)program->nodeCount++;
+}
+
+/**
+ * @brief Copies a list of nodes and their children, the parameters and locals of the callee
+ * replaced by their fresh variables
+ *
+ * @param inliner an inliner with the fresh variables of the callee
+ * @param node the first node
+ * @param callee the procedure the nodes come from
+ * @return int the first copy (NO_NODE for an empty list)
+ */
+int _inlinerCopy(Inliner* inliner, int node, int callee) {
+    Program* program = inliner->program;
+    int first = NO_NODE, last = NO_NODE;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        int copy = _inlinerCopyChain(inliner, node, callee);
+        if (first == NO_NODE)
+            first = copy;
+        else
+            program->nodes[last].next = copy;
+        last = copy;
+    }
+    return first;
+}
+
+/**
+ * @brief Copies a node and its children, without its next node. Expressions are left-deep (a
+ * chain of operators through their a child), so the a children are followed by a loop and only
+ * the other children recurse: the depth doesn't grow with the length of a sum.
+ *
+ * @param inliner an inliner with the fresh variables of the callee
+ * @param node the node
+ * @param callee the procedure the node comes from
+ * @return int the copy
+ */
+int _inlinerCopyChain(Inliner* inliner, int node, int callee) {
+    Program* program = inliner->program;
+    int top = NO_NODE, parent = NO_NODE;
+    for (; node != NO_NODE; node = program->nodes[node].a) {
+        int copy = _inlinerNode(inliner, node);
+        int symbol = program->nodes[copy].symbol;
+        if (symbol != -1 && program->symbols[symbol].scope == callee)
+            program->nodes[copy].symbol = inliner->map[program->symbols[symbol].index];
+
+        int b = _inlinerCopy(inliner, program->nodes[node].b, callee);
+        int c = _inlinerCopy(inliner, program->nodes[node].c, callee);
+        program->nodes[copy].b = b;
+        program->nodes[copy].c = c;
+        if (parent == NO_NODE) {
+            top = copy;
+        } else {
+            int next = _inlinerCopy(inliner, program->nodes[node].next, callee);  // rest of the a list
+            program->nodes[copy].next = next;
+            program->nodes[parent].a = copy;
+        }
+        parent = copy;
+    }
+    return top;
+}
+
+/**
+ * @brief Counts the nodes of a list and of their children, following the a children by a loop as
+ * _inlinerCopyChain does
+ *
+ * @param program a program
+ * @param node the first node
+ * @return int the nodes
+ */
+int _inlinerSize(const Program* program, int node) {
+    int size = 0;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        for (int chain = node; chain != NO_NODE; chain = program->nodes[chain].a) {
+            const Node* counted = &program->nodes[chain];
+            size += 1 + _inlinerSize(program, counted->b) + _inlinerSize(program, counted->c);
+            if (chain != node)
+                size += _inlinerSize(program, counted->next);  // rest of the a list
+        }
+    }
+    return size;
+}
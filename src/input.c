@@ -0,0 +1,181 @@
+/**
+ * @file input.c
+ * @brief Streaming source code input implementation
+ */
+#include "../header/input.h"
+
+#include <string.h>
+
+#include "../header/profile.h"
+
+/**
+ * @brief Opens the source code. Files don't need to be seekable, so pipes and stdin work.
+ *
+ * @param input an input instance
+ * @param path source code path, "-" reads from stdin
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool inputOpen(Input* input, const char* path) {
+    _inputReset(input);
+
+    if (!strcmp(path, "-")) {
+        input->file = stdin;
+        input->ownsFile = false;
+    } else {
+        input->file = fopen(path, "rb");
+        input->ownsFile = true;
+    }
+    return input->file == NULL;
+}
+
+/**
+ * @brief Uses a buffer as source code, no file is touched. The buffer isn't copied, it must
+ * outlive the input.
+ *
+ * @param input an input instance
+ * @param source source code
+ * @param size size of the source code in bytes
+ */
+void inputOpenBuffer(Input* input, const char* source, unsigned long size) {
+    _inputReset(input);
+    input->eof = (source == NULL);
+    input->file = NULL;
+    input->ownsFile = false;
+    input->memory = (const unsigned char*)source;
+    input->memorySize = size;
+}
+
+/**
+ * @brief Closes the source code
+ *
+ * @param input an input instance
+ */
+void inputClose(Input* input) {
+    if (input->file != NULL && input->ownsFile)
+        fclose(input->file);
+    input->file = NULL;
+}
+
+/**
+ * @brief Reads the next block of the file (or of the in-memory source code) into the free part of the ring buffer.
+ * Blocks are at most half of the ring, so the last INPUT_BUFFER_SIZE / 2 bytes read are kept: one char can
+ * always be retreated and the position of the current token can still be computed.
+ *
+ * @param input an input instance
+ * @return true if the end of the input was reached
+ * @return false if some bytes were read
+ */
+bool _inputRefill(Input* input) {
+    if (input->eof)
+        return true;
+
+    unsigned long start = input->tail & INPUT_MASK;
+    unsigned long count = INPUT_BUFFER_SIZE - start;  // contiguous free space
+    if (count > INPUT_BUFFER_SIZE / 2)
+        count = INPUT_BUFFER_SIZE / 2;
+
+    // the block overwrites the oldest bytes of the ring, their lines must be indexed before
+    if (input->memory == NULL && input->tail + count > INPUT_BUFFER_SIZE) {
+        unsigned long overwritten = input->tail + count - INPUT_BUFFER_SIZE;
+        if (input->mark >= input->cursor.offset && input->mark < overwritten) {
+            _inputAdvance(input, input->mark);
+            input->marked = input->cursor;
+        }
+        _inputAdvance(input, overwritten);
+    }
+
+    unsigned long read;
+    if (input->memory != NULL) {
+        read = (input->memorySize - input->tail < count) ? input->memorySize - input->tail : count;
+        memcpy(input->ring + start, input->memory + input->tail, read);
+    } else {
+        PROFILE_ENTER(PHASE_IO);
+        read = fread(input->ring + start, sizeof(char), count, input->file);
+        PROFILE_LEAVE();
+    }
+    PROFILE_COUNT(COUNTER_CHARS, read);
+    if (read == 0) {
+        input->eof = true;
+        return true;
+    }
+    input->tail += read;
+    return false;
+}
+
+/**
+ * @brief Computes the line and column of a byte offset. Offsets are expected in increasing order
+ * (as tokens are read), so each byte is scanned once. An offset before the cursor is only possible
+ * for a token longer than half of the ring buffer, whose start was saved by the refill that
+ * overwrote it (see inputMark).
+ *
+ * @param input an input instance
+ * @param offset byte offset, at most the number of bytes read and not before the last marked token
+ * @param position the computed position
+ */
+void inputPosition(Input* input, unsigned long offset, SourcePosition* position) {
+    if (offset < input->cursor.offset && offset == input->marked.offset) {
+        *position = input->marked;
+        return;
+    }
+    if (offset > input->cursor.offset)
+        _inputAdvance(input, offset);
+    *position = input->cursor;
+}
+
+/**
+ * @brief Resets the input state: nothing read and the cursor at the beginning of the first line
+ *
+ * @param input an input instance
+ */
+void _inputReset(Input* input) {
+    input->eof = false;
+    input->head = 0;
+    input->tail = 0;
+    input->memory = NULL;
+    input->memorySize = 0;
+    input->cursor.offset = 0;
+    input->cursor.lineOffset = 0;
+    input->cursor.line = 1;
+    input->cursor.col = 1;
+    input->mark = 0;
+    input->marked = input->cursor;
+}
+
+/**
+ * @brief Moves the cursor forward to an offset. Newlines are found with memchr, so only the bytes
+ * after the last newline are looked at one by one (to count code points and tabs).
+ *
+ * @param input an input instance
+ * @param offset new cursor offset, the bytes up to it must still be in the ring buffer (or in memory)
+ */
+void _inputAdvance(Input* input, unsigned long offset) {
+    SourcePosition* cursor = &input->cursor;
+    while (cursor->offset < offset) {
+        // contiguous segment of bytes
+        const unsigned char* begin;
+        unsigned long size = offset - cursor->offset;
+        if (input->memory != NULL) {
+            begin = input->memory + cursor->offset;
+        } else {
+            begin = input->ring + (cursor->offset & INPUT_MASK);
+            if (size > INPUT_BUFFER_SIZE - (cursor->offset & INPUT_MASK))
+                size = INPUT_BUFFER_SIZE - (cursor->offset & INPUT_MASK);
+        }
+        const unsigned char* end = begin + size;
+
+        const unsigned char* lineBegin = begin;
+        const unsigned char* newline;
+        while ((newline = memchr(lineBegin, '\n', end - lineBegin)) != NULL) {
+            lineBegin = newline + 1;
+            cursor->line++;
+            cursor->col = 1;
+            cursor->lineOffset = cursor->offset + (lineBegin - begin);
+        }
+
+        // columns count code points: UTF-8 continuation bytes don't advance them
+        for (const unsigned char* c = lineBegin; c < end; c++)
+            cursor->col += ((*c & 0xc0) != 0x80) + (*c == '\t') * 3;
+        cursor->offset += size;
+    }
+}
@@ -0,0 +1,1464 @@
+/**
+ * @file ir.c
+ * @brief SSA intermediate representation implementation. The construction follows the structure
+ * of the tree: the current value of every variable is kept in an array, branches undo their
+ * assignments through a log and their joins get a phi for each variable assigned differently, and
+ * loops get a phi at their header for each variable assigned in their body (the ones that turn out
+ * to be trivial are removed). Parameters and local variables are SSA values; global variables are
+ * too, loaded at the entry and after each call and stored before calls and at the return, since
+ * the called procedures work on their memory.
+ */
+#include "../header/ir.h"
+
+#include <string.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+#include "../header/runtime.h"
+
+// constants are folded like the generated code computes them, which -Ofast (-ffast-math) doesn't keep
+#pragma GCC optimize("no-fast-math")
+
+/**
+ * @brief Builds the SSA form of every procedure and of the program body
+ *
+ * @param ir an ir instance
+ * @param program a program without semantic errors
+ */
+void irBuild(Ir* ir, const Program* program) {
+    PROFILE_ENTER(PHASE_OPTIMIZE);
+    memset(ir, 0, sizeof(Ir));
+    ir->program = program;
+    ir->functionCount = (int)program->procedureCount + 1;
+    ir->functions = (IrFunction*)memoryCalloc(ir->functionCount, sizeof(IrFunction));
+    ir->globals = (char*)memoryAlloc(program->globalCount + 1);
+    ir->referenced = (int*)memoryAlloc((program->globalCount + 1) * sizeof(int));
+    ir->written = (int*)memoryAlloc((program->globalCount + 1) * sizeof(int));
+    ir->setStart = (int*)memoryAlloc((program->nodeCount + 1) * sizeof(int));
+    ir->setLength = (int*)memoryAlloc((program->nodeCount + 1) * sizeof(int));
+
+    for (int i = 0; i < ir->functionCount; i++)
+        _irFunction(ir, (i < (int)program->procedureCount) ? i : -1);
+
+    memoryFree(ir->globals);
+    memoryFree(ir->referenced);
+    memoryFree(ir->written);
+    memoryFree(ir->setStart);
+    memoryFree(ir->setLength);
+    memoryFree(ir->sets);
+    memoryFree(ir->log);
+    memoryFree(ir->changes);
+    memoryFree(ir->loops);
+    memoryFree(ir->chain);
+    PROFILE_LEAVE();
+}
+
+/**
+ * @brief Optimizes every function: dead stores, global value numbering with constant folding,
+ * phis left with a single value and dead code
+ *
+ * @param ir an ir instance
+ */
+void irOptimize(Ir* ir) {
+    PROFILE_ENTER(PHASE_OPTIMIZE);
+    for (int i = 0; i < ir->functionCount; i++) {
+        IrFunction* function = &ir->functions[i];
+        _irDeadStores(function);
+        _irNumber(function);
+        int removed;
+        while ((removed = _irSimplifyPhis(function)) > 0)
+            function->numbered += removed;
+        _irDeadCode(function);
+    }
+    PROFILE_LEAVE();
+}
+
+/**
+ * @brief Prints the functions, with their blocks in reverse postorder, and the instruction counts
+ * before and after the optimization
+ *
+ * @param ir an ir instance
+ * @param output where it is printed
+ */
+void irPrint(Ir* ir, FILE* output) {
+    static const char* typeName[] = {"integer", "real"};
+
+    const Program* program = ir->program;
+    int before = 0, after = 0, numbered = 0, deadStores = 0, dead = 0;
+    for (int i = 0; i < ir->functionCount; i++) {
+        IrFunction* function = &ir->functions[i];
+        if (function->procedure == -1) {
+            fputs("program", output);
+        } else {
+            const Procedure* declared = &program->procedures[function->procedure];
+            fprintf(output, "procedure %s(", programName(program, declared->symbol));
+            for (int j = 0; j < declared->parameterCount; j++)
+                fprintf(output, "%s%s: %s", (j > 0) ? "; " : "", programName(program, declared->firstParameter + j),
+                        typeName[(int)program->symbols[declared->firstParameter + j].type]);
+            fputc(')', output);
+        }
+        int count = _irCount(function);
+        fprintf(output, "  ; %d instructions, %d after optimization\n", function->before, count);
+
+        int* order = (int*)memoryAlloc(function->blockCount * sizeof(int));
+        int* position = (int*)memoryAlloc(function->blockCount * sizeof(int));
+        int blocks = _irOrder(function, order, position);
+        for (int j = 0; j < blocks; j++) {
+            const IrBlock* block = &function->blocks[order[j]];
+            fprintf(output, "b%d:", order[j]);
+            for (int k = 0; k < block->predecessorCount; k++)
+                fprintf(output, "%sb%d", (k > 0) ? ", " : "  ; from ", block->predecessors[k]);
+            fputc('\n', output);
+            for (int k = 0; k < block->count; k++)
+                if (!function->instructions[block->instructions[k]].removed)
+                    _irPrintInstruction(ir, function, block->instructions[k], output);
+        }
+        fputc('\n', output);
+        memoryFree(order);
+        memoryFree(position);
+
+        before += function->before;
+        after += count;
+        numbered += function->numbered;
+        deadStores += function->deadStores;
+        dead += function->dead;
+    }
+    fprintf(output, "; %d instructions before optimization, %d after: %d redundant, %d dead stores, %d dead\n", before,
+            after, numbered, deadStores, dead);
+}
+
+/**
+ * @brief Frees the functions
+ *
+ * @param ir an ir instance
+ */
+void irDestroy(Ir* ir) {
+    for (int i = 0; i < ir->functionCount; i++) {
+        IrFunction* function = &ir->functions[i];
+        for (int j = 0; j < function->blockCount; j++)
+            memoryFree(function->blocks[j].instructions);
+        memoryFree(function->blocks);
+        memoryFree(function->instructions);
+        memoryFree(function->arguments);
+    }
+    memoryFree(ir->functions);
+    ir->functions = NULL;
+    ir->functionCount = 0;
+}
+
+/**
+ * @brief Makes room for one more element in an array, doubling its capacity when it is full
+ *
+ * @param array the array
+ * @param capacity its capacity, updated
+ * @param count elements in use
+ * @param size size of an element
+ * @return void* the array, maybe moved
+ */
+void* _irGrow(void* array, int* capacity, int count, unsigned long size) {
+    if (count < *capacity)
+        return array;
+    *capacity = (*capacity == 0) ? 16 : 2 * *capacity;
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    return memoryRealloc(array, *capacity * size);
+}
+
+/**
+ * @brief Builds the SSA form of a procedure or of the program body
+ *
+ * @param ir an ir instance
+ * @param procedure index of the procedure, -1 for the program body
+ */
+void _irFunction(Ir* ir, int procedure) {
+    const Program* program = ir->program;
+    IrFunction* function = &ir->functions[(procedure == -1) ? ir->functionCount - 1 : procedure];
+    const Procedure* declared = (procedure == -1) ? NULL : &program->procedures[procedure];
+    function->procedure = procedure;
+    ir->function = function;
+    ir->localCount = (declared == NULL) ? 0 : declared->parameterCount + declared->localCount;
+    ir->variableCount = ir->localCount + program->globalCount;
+    ir->current = (int*)memoryAlloc((ir->variableCount + 1) * sizeof(int));
+    ir->stamps = (int*)memoryCalloc(ir->variableCount + 1, sizeof(int));
+    ir->joined = (int*)memoryAlloc((ir->variableCount + 1) * sizeof(int));
+    ir->stamp = 0;
+    ir->logSize = 0;
+    memset(ir->globals, 0, program->globalCount + 1);
+    ir->referencedCount = 0;
+    ir->writtenCount = 0;
+    ir->setCount = 0;
+    int body = (declared == NULL) ? program->body : declared->body;
+    _irScan(ir, body);
+    _irLoopSets(ir, body);
+
+    // parameters, locals (starting at 0) and globals
+    ir->block = _irBlock(ir);
+    for (int i = 0; i < ir->localCount; i++) {
+        int symbol = programVariable(program, procedure, i);
+        int type = program->symbols[symbol].type;
+        int value;
+        if (i < declared->parameterCount) {
+            value = _irEmit(ir, ir->block, IR_PARAM, type, -1, -1);
+            function->instructions[value].symbol = symbol;
+        } else {
+            value = _irEmit(ir, ir->block, IR_CONST, type, -1, -1);
+            if (type == TYPE_REAL)
+                function->instructions[value].value.real = 0.0;
+        }
+        ir->current[i] = value;
+    }
+    _irMemory(ir, true);
+
+    _irCommand(ir, body);
+    _irMemory(ir, false);
+    _irEmit(ir, ir->block, IR_RETURN, TYPE_INTEGER, -1, -1);
+    while (_irSimplifyPhis(function) > 0)
+        continue;
+    function->before = _irCount(function);
+
+    memoryFree(ir->current);
+    memoryFree(ir->stamps);
+    memoryFree(ir->joined);
+}
+
+/**
+ * @brief Finds the globals referenced and written by the commands of a list, in preorder. The
+ * chain of first operands is visited by a loop and pushed on a stack, their other children are
+ * visited back up from its end, so that long expressions don't nest calls
+ *
+ * @param ir an ir instance
+ * @param node first node of the list
+ */
+void _irScan(Ir* ir, int node) {
+    const Program* program = ir->program;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        int base = ir->chainSize;
+        for (int chain = node; chain != NO_NODE; chain = program->nodes[chain].a) {
+            const Node* n = &program->nodes[chain];
+            ir->chain = (int*)_irGrow(ir->chain, &ir->chainCapacity, ir->chainSize, sizeof(int));
+            ir->chain[ir->chainSize++] = chain;
+            if (n->kind == NODE_READ) {
+                for (int item = n->a; item != NO_NODE; item = program->nodes[item].next)
+                    _irGlobal(ir, program->nodes[item].symbol, true);
+                break;
+            }
+            if (n->kind == NODE_VARIABLE || n->kind == NODE_ASSIGN || n->kind == NODE_FOR)
+                _irGlobal(ir, n->symbol, n->kind != NODE_VARIABLE);
+        }
+        while (ir->chainSize > base) {
+            const Node* n = &program->nodes[ir->chain[--ir->chainSize]];
+            _irScan(ir, n->b);
+            _irScan(ir, n->c);
+            if (ir->chainSize > base)  // the rest of the list under the node above
+                _irScan(ir, n->next);
+        }
+    }
+}
+
+/**
+ * @brief Records a reference to a variable if it is global
+ *
+ * @param ir an ir instance
+ * @param symbol the variable
+ * @param write whether it is assigned
+ */
+void _irGlobal(Ir* ir, int symbol, bool write) {
+    const Symbol* variable = &ir->program->symbols[symbol];
+    if (variable->scope != GLOBAL_SCOPE)
+        return;
+    char* flags = &ir->globals[variable->index];
+    if (!(*flags & IR_REFERENCED))
+        ir->referenced[ir->referencedCount++] = symbol;
+    if (write && !(*flags & IR_WRITTEN))
+        ir->written[ir->writtenCount++] = symbol;
+    *flags |= IR_REFERENCED | (write ? IR_WRITTEN : 0);
+}
+
+/**
+ * @brief Returns the variable of a symbol in the function being built
+ *
+ * @param ir an ir instance
+ * @param symbol a variable or parameter
+ * @return int the variable
+ */
+int _irVariable(const Ir* ir, int symbol) {
+    const Symbol* variable = &ir->program->symbols[symbol];
+    return (variable->scope == GLOBAL_SCOPE) ? ir->localCount + variable->index : variable->index;
+}
+
+/**
+ * @brief Adds an empty block to the function being built
+ *
+ * @param ir an ir instance
+ * @return int the block
+ */
+int _irBlock(Ir* ir) {
+    IrFunction* function = ir->function;
+    function->blocks = (IrBlock*)_irGrow(function->blocks, &function->blockCapacity, function->blockCount, sizeof(IrBlock));
+    memset(&function->blocks[function->blockCount], 0, sizeof(IrBlock));
+    return function->blockCount++;
+}
+
+/**
+ * @brief Adds an edge from the current block, in the order of the successors of its terminator
+ *
+ * @param ir an ir instance
+ * @param to the successor
+ */
+void _irEdge(Ir* ir, int to) {
+    IrBlock* from = &ir->function->blocks[ir->block];
+    IrBlock* successor = &ir->function->blocks[to];
+    from->successors[from->successorCount++] = to;
+    successor->predecessors[successor->predecessorCount++] = ir->block;
+}
+
+/**
+ * @brief Appends an instruction to a block
+ *
+ * @param ir an ir instance
+ * @param block the block
+ * @param op IR_OP
+ * @param type TYPE
+ * @param a first operand (or -1)
+ * @param b second operand (or -1)
+ * @return int the instruction
+ */
+int _irEmit(Ir* ir, int block, int op, int type, int a, int b) {
+    IrFunction* function = ir->function;
+    function->instructions = (IrInstruction*)_irGrow(function->instructions, &function->instructionCapacity,
+                                                     function->instructionCount, sizeof(IrInstruction));
+    int value = function->instructionCount++;
+    IrInstruction* instruction = &function->instructions[value];
+    memset(instruction, 0, sizeof(IrInstruction));
+    instruction->op = (char)op;
+    instruction->type = (char)type;
+    instruction->replacement = value;
+    instruction->block = block;
+    instruction->a = a;
+    instruction->b = b;
+    instruction->symbol = -1;
+    instruction->arguments = -1;
+
+    IrBlock* target = &function->blocks[block];
+    target->instructions = (int*)_irGrow(target->instructions, &target->capacity, target->count, sizeof(int));
+    target->instructions[target->count++] = value;
+    return value;
+}
+
+/**
+ * @brief Reserves arguments of a call or a phi in the argument pool
+ *
+ * @param ir an ir instance
+ * @param count number of arguments
+ * @return int the first one
+ */
+int _irArguments(Ir* ir, int count) {
+    IrFunction* function = ir->function;
+    int first = function->argumentCount;
+    for (int i = 0; i < count; i++) {
+        function->arguments = (int*)_irGrow(function->arguments, &function->argumentCapacity, function->argumentCount, sizeof(int));
+        function->arguments[function->argumentCount++] = -1;
+    }
+    return first;
+}
+
+/**
+ * @brief Adds a phi, with its operands still unknown, to a block with two predecessors
+ *
+ * @param ir an ir instance
+ * @param block the block, with no other instruction than phis
+ * @param type TYPE of the variable
+ * @return int the phi
+ */
+int _irPhi(Ir* ir, int block, int type) {
+    int phi = _irEmit(ir, block, IR_PHI, type, -1, -1);
+    int arguments = _irArguments(ir, 2);
+    ir->function->instructions[phi].arguments = arguments;
+    ir->function->instructions[phi].argumentCount = 2;
+    return phi;
+}
+
+/**
+ * @brief Sets the operand of a phi that comes from a predecessor of its block
+ *
+ * @param ir an ir instance
+ * @param phi the phi
+ * @param predecessor the predecessor
+ * @param value the operand
+ */
+void _irPhiOperand(Ir* ir, int phi, int predecessor, int value) {
+    const IrInstruction* instruction = &ir->function->instructions[phi];
+    const IrBlock* block = &ir->function->blocks[instruction->block];
+    for (int i = 0; i < block->predecessorCount; i++)
+        if (block->predecessors[i] == predecessor)
+            ir->function->arguments[instruction->arguments + i] = value;
+}
+
+/**
+ * @brief Returns the value of a variable at the start of the current block, where two values meet
+ *
+ * @param ir an ir instance
+ * @param first value that comes from a predecessor
+ * @param firstBlock the predecessor
+ * @param second value that comes from the other predecessor
+ * @param secondBlock the other predecessor
+ * @return int the value, a new phi if they are different
+ */
+int _irMerge(Ir* ir, int first, int firstBlock, int second, int secondBlock) {
+    if (first == second)
+        return first;
+    int phi = _irPhi(ir, ir->block, ir->function->instructions[first].type);
+    _irPhiOperand(ir, phi, firstBlock, first);
+    _irPhiOperand(ir, phi, secondBlock, second);
+    return phi;
+}
+
+/**
+ * @brief Assigns a value to a variable, logging the previous one
+ *
+ * @param ir an ir instance
+ * @param variable the variable
+ * @param value its new value
+ */
+void _irSet(Ir* ir, int variable, int value) {
+    ir->log = (IrChange*)_irGrow(ir->log, &ir->logCapacity, ir->logSize, sizeof(IrChange));
+    ir->log[ir->logSize].variable = variable;
+    ir->log[ir->logSize].value = ir->current[variable];
+    ir->logSize++;
+    ir->current[variable] = value;
+}
+
+/**
+ * @brief Undoes the assignments logged after a mark
+ *
+ * @param ir an ir instance
+ * @param mark size of the log to go back to
+ */
+void _irRestore(Ir* ir, int mark) {
+    while (ir->logSize > mark) {
+        ir->logSize--;
+        ir->current[ir->log[ir->logSize].variable] = ir->log[ir->logSize].value;
+    }
+}
+
+/**
+ * @brief Pushes each variable assigned after a mark of the log, once, with its current value
+ *
+ * @param ir an ir instance
+ * @param mark size of the log at the mark
+ */
+void _irCollect(Ir* ir, int mark) {
+    int stamp = ++ir->stamp;
+    for (int i = ir->logSize - 1; i >= mark; i--) {
+        int variable = ir->log[i].variable;
+        if (ir->stamps[variable] == stamp)
+            continue;
+        ir->stamps[variable] = stamp;
+        ir->changes = (IrChange*)_irGrow(ir->changes, &ir->changeCapacity, ir->changeCount, sizeof(IrChange));
+        ir->changes[ir->changeCount].variable = variable;
+        ir->changes[ir->changeCount].value = ir->current[variable];
+        ir->changeCount++;
+    }
+}
+
+/**
+ * @brief Computes the set of variables assigned by each loop of a list of commands, inner loops
+ * first so that each command is gathered only by its innermost loop
+ *
+ * @param ir an ir instance
+ * @param node first command of the list
+ */
+void _irLoopSets(Ir* ir, int node) {
+    const Program* program = ir->program;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        const Node* n = &program->nodes[node];
+        switch (n->kind) {
+            case NODE_IF:
+                _irLoopSets(ir, n->b);
+                _irLoopSets(ir, n->c);
+                break;
+            case NODE_BLOCK:
+                _irLoopSets(ir, n->a);
+                break;
+            case NODE_WHILE:
+            case NODE_FOR: {
+                int body = (n->kind == NODE_WHILE) ? n->b : n->c;
+                _irLoopSets(ir, body);
+                ir->stamp++;
+                ir->setStart[node] = ir->setCount;
+                _irAssigned(ir, body);
+                ir->setLength[node] = ir->setCount - ir->setStart[node];
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Adds the variables assigned by a list of commands to the set being gathered (a call
+ * assigns every global the function references, which it reloads); the sets of the inner loops
+ * are already known
+ *
+ * @param ir an ir instance
+ * @param node first command of the list
+ */
+void _irAssigned(Ir* ir, int node) {
+    const Program* program = ir->program;
+    for (; node != NO_NODE; node = program->nodes[node].next) {
+        const Node* n = &program->nodes[node];
+        switch (n->kind) {
+            case NODE_ASSIGN:
+                _irAssignedVariable(ir, _irVariable(ir, n->symbol));
+                break;
+            case NODE_READ:
+                for (int item = n->a; item != NO_NODE; item = program->nodes[item].next)
+                    _irAssignedVariable(ir, _irVariable(ir, program->nodes[item].symbol));
+                break;
+            case NODE_CALL:
+                for (int i = 0; i < ir->referencedCount; i++)
+                    _irAssignedVariable(ir, _irVariable(ir, ir->referenced[i]));
+                break;
+            case NODE_FOR:
+                _irAssignedVariable(ir, _irVariable(ir, n->symbol));
+                // fallthrough
+            case NODE_WHILE:
+                for (int i = 0; i < ir->setLength[node]; i++)
+                    _irAssignedVariable(ir, ir->sets[ir->setStart[node] + i]);
+                break;
+            case NODE_IF:
+                _irAssigned(ir, n->b);
+                _irAssigned(ir, n->c);
+                break;
+            case NODE_BLOCK:
+                _irAssigned(ir, n->a);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Adds a variable to the set being gathered, unless it is marked with the current stamp
+ *
+ * @param ir an ir instance
+ * @param variable the variable
+ */
+void _irAssignedVariable(Ir* ir, int variable) {
+    if (ir->stamps[variable] == ir->stamp)
+        return;
+    ir->stamps[variable] = ir->stamp;
+    ir->sets = (int*)_irGrow(ir->sets, &ir->setCapacity, ir->setCount, sizeof(int));
+    ir->sets[ir->setCount++] = variable;
+}
+
+/**
+ * @brief Pushes a variable of the loop being built, unless it is marked with the current stamp
+ *
+ * @param ir an ir instance
+ * @param variable the variable
+ */
+void _irLoopVariable(Ir* ir, int variable) {
+    if (ir->stamps[variable] == ir->stamp)
+        return;
+    ir->stamps[variable] = ir->stamp;
+    ir->loops = (IrLoopVariable*)_irGrow(ir->loops, &ir->loopCapacity, ir->loopCount, sizeof(IrLoopVariable));
+    IrLoopVariable* loop = &ir->loops[ir->loopCount++];
+    loop->variable = variable;
+    loop->entry = loop->phi = loop->exit = -1;
+}
+
+/**
+ * @brief Loads the globals referenced by the function (at the entry and after calls) or stores
+ * the ones it writes (before calls and at the return)
+ *
+ * @param ir an ir instance
+ * @param load whether they are loaded
+ */
+void _irMemory(Ir* ir, bool load) {
+    const Program* program = ir->program;
+    int count = load ? ir->referencedCount : ir->writtenCount;
+    const int* symbols = load ? ir->referenced : ir->written;
+    for (int i = 0; i < count; i++) {
+        int variable = _irVariable(ir, symbols[i]);
+        int type = program->symbols[symbols[i]].type;
+        int value;
+        if (load) {
+            value = _irEmit(ir, ir->block, IR_LOAD, type, -1, -1);
+            _irSet(ir, variable, value);
+        } else {
+            value = _irEmit(ir, ir->block, IR_STORE, type, ir->current[variable], -1);
+        }
+        ir->function->instructions[value].symbol = symbols[i];
+    }
+}
+
+/**
+ * @brief Builds a command
+ *
+ * @param ir an ir instance
+ * @param node the command (NO_NODE is an empty command)
+ */
+void _irCommand(Ir* ir, int node) {
+    if (node == NO_NODE)
+        return;
+    const Program* program = ir->program;
+    const Node* n = &program->nodes[node];
+
+    switch (n->kind) {
+        case NODE_BLOCK:
+            for (int command = n->a; command != NO_NODE; command = program->nodes[command].next)
+                _irCommand(ir, command);
+            break;
+
+        case NODE_ASSIGN: {
+            int value = _irExpression(ir, n->a);
+            _irSet(ir, _irVariable(ir, n->symbol), value);
+            break;
+        }
+
+        case NODE_CALL:
+            _irCall(ir, node);
+            break;
+
+        case NODE_READ:
+            for (int item = n->a; item != NO_NODE; item = program->nodes[item].next) {
+                const Node* variable = &program->nodes[item];
+                int value = _irEmit(ir, ir->block, IR_READ, variable->type, -1, -1);
+                IrInstruction* instruction = &ir->function->instructions[value];
+                instruction->symbol = variable->symbol;
+                instruction->line = n->line;
+                instruction->col = n->col;
+                _irSet(ir, _irVariable(ir, variable->symbol), value);
+            }
+            break;
+
+        case NODE_WRITE:
+            for (int item = n->a; item != NO_NODE; item = program->nodes[item].next) {
+                int value = _irExpression(ir, item);
+                int write = _irEmit(ir, ir->block, IR_WRITE, program->nodes[item].type, value, -1);
+                ir->function->instructions[write].last = program->nodes[item].next == NO_NODE;
+            }
+            break;
+
+        case NODE_IF:
+            _irIf(ir, node);
+            break;
+
+        case NODE_WHILE:
+            _irWhile(ir, node);
+            break;
+
+        case NODE_FOR:
+            _irFor(ir, node);
+            break;
+    }
+}
+
+/**
+ * @brief Builds a procedure call: the written globals are stored before it and the referenced
+ * ones loaded after it
+ *
+ * @param ir an ir instance
+ * @param node the NODE_CALL
+ */
+void _irCall(Ir* ir, int node) {
+    const Program* program = ir->program;
+    const Node* n = &program->nodes[node];
+    int count = 0;
+    for (int argument = n->a; argument != NO_NODE; argument = program->nodes[argument].next)
+        count++;
+    int arguments = _irArguments(ir, count);
+    int i = 0;
+    for (int argument = n->a; argument != NO_NODE; argument = program->nodes[argument].next) {
+        int value = _irExpression(ir, argument);
+        ir->function->arguments[arguments + i++] = value;
+    }
+
+    _irMemory(ir, false);
+    int call = _irEmit(ir, ir->block, IR_CALL, TYPE_INTEGER, -1, -1);
+    IrInstruction* instruction = &ir->function->instructions[call];
+    instruction->symbol = n->symbol;
+    instruction->arguments = arguments;
+    instruction->argumentCount = count;
+    _irMemory(ir, true);
+}
+
+/**
+ * @brief Builds an if: each variable assigned by a branch gets a phi at the join if its values at
+ * the end of both branches differ
+ *
+ * @param ir an ir instance
+ * @param node the NODE_IF
+ */
+void _irIf(Ir* ir, int node) {
+    const Node* n = &ir->program->nodes[node];
+    int condition = _irExpression(ir, n->a);
+    int from = ir->block;
+    int thenBlock = _irBlock(ir);
+    int elseBlock = (n->c != NO_NODE) ? _irBlock(ir) : -1;
+    int join = _irBlock(ir);
+    _irEmit(ir, from, IR_BRANCH, TYPE_INTEGER, condition, -1);
+    _irEdge(ir, thenBlock);
+    _irEdge(ir, (elseBlock != -1) ? elseBlock : join);
+
+    int mark = ir->logSize;
+    int changes = ir->changeCount;
+    ir->block = thenBlock;
+    _irCommand(ir, n->b);
+    int thenEnd = ir->block;
+    _irEmit(ir, thenEnd, IR_JUMP, TYPE_INTEGER, -1, -1);
+    _irEdge(ir, join);
+    _irCollect(ir, mark);
+    _irRestore(ir, mark);
+
+    int thenChanges = ir->changeCount;
+    int elseEnd = from;
+    if (elseBlock != -1) {
+        ir->block = elseBlock;
+        _irCommand(ir, n->c);
+        elseEnd = ir->block;
+        _irEmit(ir, elseEnd, IR_JUMP, TYPE_INTEGER, -1, -1);
+        _irEdge(ir, join);
+        _irCollect(ir, mark);
+        _irRestore(ir, mark);
+    }
+
+    // variables assigned by the else branch, then the ones assigned only by the then branch
+    ir->block = join;
+    int thenStamp = ++ir->stamp;
+    for (int i = changes; i < thenChanges; i++) {
+        ir->stamps[ir->changes[i].variable] = thenStamp;
+        ir->joined[ir->changes[i].variable] = ir->changes[i].value;
+    }
+    int mergedStamp = ++ir->stamp;
+    for (int i = thenChanges; i < ir->changeCount; i++) {
+        int variable = ir->changes[i].variable;
+        int thenValue = (ir->stamps[variable] == thenStamp) ? ir->joined[variable] : ir->current[variable];
+        ir->stamps[variable] = mergedStamp;
+        _irSet(ir, variable, _irMerge(ir, thenValue, thenEnd, ir->changes[i].value, elseEnd));
+    }
+    for (int i = changes; i < thenChanges; i++) {
+        int variable = ir->changes[i].variable;
+        if (ir->stamps[variable] == thenStamp)
+            _irSet(ir, variable, _irMerge(ir, ir->changes[i].value, thenEnd, ir->current[variable], elseEnd));
+    }
+    ir->changeCount = changes;
+}
+
+/**
+ * @brief Builds a while loop: each variable assigned by the body gets a phi at the header
+ *
+ * @param ir an ir instance
+ * @param node the NODE_WHILE
+ */
+void _irWhile(Ir* ir, int node) {
+    const Node* n = &ir->program->nodes[node];
+    int entry = ir->block;
+    int header = _irBlock(ir);
+    _irEmit(ir, entry, IR_JUMP, TYPE_INTEGER, -1, -1);
+    _irEdge(ir, header);
+
+    int loops = ir->loopCount;
+    ir->stamp++;
+    for (int i = 0; i < ir->setLength[node]; i++)
+        _irLoopVariable(ir, ir->sets[ir->setStart[node] + i]);
+    for (int i = loops; i < ir->loopCount; i++) {
+        IrLoopVariable* loop = &ir->loops[i];
+        loop->entry = ir->current[loop->variable];
+        loop->phi = _irPhi(ir, header, ir->function->instructions[loop->entry].type);
+        _irPhiOperand(ir, loop->phi, entry, loop->entry);
+        _irSet(ir, loop->variable, loop->phi);
+    }
+    int phis = ir->logSize;
+
+    ir->block = header;
+    int condition = _irExpression(ir, n->a);
+    int body = _irBlock(ir);
+    int exit = _irBlock(ir);
+    _irEmit(ir, header, IR_BRANCH, TYPE_INTEGER, condition, -1);
+    _irEdge(ir, body);
+    _irEdge(ir, exit);
+
+    ir->block = body;
+    _irCommand(ir, n->b);
+    int end = ir->block;
+    _irEmit(ir, end, IR_JUMP, TYPE_INTEGER, -1, -1);
+    _irEdge(ir, header);
+    for (int i = loops; i < ir->loopCount; i++)
+        _irPhiOperand(ir, ir->loops[i].phi, end, ir->current[ir->loops[i].variable]);
+
+    // the loop is left from the header
+    _irRestore(ir, phis);
+    ir->block = exit;
+    ir->loopCount = loops;
+}
+
+/**
+ * @brief Builds a for loop like the back ends run it: the final value is computed once, before
+ * the initial one, the body is skipped if the initial value is greater and the loop is left after
+ * the iteration that reaches the final value, so the variable never goes past it. The variable
+ * and each variable assigned by the body get a phi at the start of the body, and another one after
+ * the loop (which is left from the test before the body or from the test after it).
+ *
+ * @param ir an ir instance
+ * @param node the NODE_FOR
+ */
+void _irFor(Ir* ir, int node) {
+    const Node* n = &ir->program->nodes[node];
+    int variable = _irVariable(ir, n->symbol);
+    int last = _irExpression(ir, n->b);
+    int first = _irExpression(ir, n->a);
+    _irSet(ir, variable, first);
+
+    int guard = ir->block;
+    int condition = _irCompare(ir, RELATION_LESS_EQUAL, first, last);
+    int body = _irBlock(ir);
+    int exit = _irBlock(ir);
+    _irEmit(ir, guard, IR_BRANCH, TYPE_INTEGER, condition, -1);
+    _irEdge(ir, body);
+    _irEdge(ir, exit);
+
+    int loops = ir->loopCount;
+    int mark = ir->logSize;
+    ir->stamp++;
+    _irLoopVariable(ir, variable);
+    for (int i = 0; i < ir->setLength[node]; i++)
+        _irLoopVariable(ir, ir->sets[ir->setStart[node] + i]);
+    for (int i = loops; i < ir->loopCount; i++) {
+        IrLoopVariable* loop = &ir->loops[i];
+        loop->entry = ir->current[loop->variable];
+        loop->phi = _irPhi(ir, body, ir->function->instructions[loop->entry].type);
+        _irPhiOperand(ir, loop->phi, guard, loop->entry);
+        _irSet(ir, loop->variable, loop->phi);
+    }
+
+    ir->block = body;
+    _irCommand(ir, n->c);
+    int latch = ir->block;
+    condition = _irCompare(ir, RELATION_GREATER_EQUAL, ir->current[variable], last);
+    int increment = _irBlock(ir);
+    _irEmit(ir, latch, IR_BRANCH, TYPE_INTEGER, condition, -1);
+    _irEdge(ir, exit);
+    _irEdge(ir, increment);
+    for (int i = loops; i < ir->loopCount; i++)
+        ir->loops[i].exit = ir->current[ir->loops[i].variable];
+
+    ir->block = increment;
+    int one = _irEmit(ir, increment, IR_CONST, TYPE_INTEGER, -1, -1);
+    ir->function->instructions[one].value.integer = 1;
+    _irSet(ir, variable, _irEmit(ir, increment, IR_ADD, TYPE_INTEGER, ir->current[variable], one));
+    _irEmit(ir, increment, IR_JUMP, TYPE_INTEGER, -1, -1);
+    _irEdge(ir, body);
+    for (int i = loops; i < ir->loopCount; i++)
+        _irPhiOperand(ir, ir->loops[i].phi, increment, ir->current[ir->loops[i].variable]);
+
+    _irRestore(ir, mark);
+    ir->block = exit;
+    for (int i = loops; i < ir->loopCount; i++) {
+        const IrLoopVariable* loop = &ir->loops[i];
+        _irSet(ir, loop->variable, _irMerge(ir, loop->entry, guard, loop->exit, latch));
+    }
+    ir->loopCount = loops;
+}
+
+/**
+ * @brief Builds an expression in the current block. The chain of first operands is pushed on a
+ * stack and built back up from its first operand, so only second operands nest calls
+ *
+ * @param ir an ir instance
+ * @param node the expression (or NODE_COMPARE)
+ * @return int its value
+ */
+int _irExpression(Ir* ir, int node) {
+    const Program* program = ir->program;
+    int base = ir->chainSize;
+    for (; program->nodes[node].kind != NODE_NUMBER && program->nodes[node].kind != NODE_VARIABLE;
+         node = program->nodes[node].a) {
+        ir->chain = (int*)_irGrow(ir->chain, &ir->chainCapacity, ir->chainSize, sizeof(int));
+        ir->chain[ir->chainSize++] = node;
+    }
+
+    const Node* n = &program->nodes[node];
+    int value;
+    if (n->kind == NODE_NUMBER) {
+        value = _irEmit(ir, ir->block, IR_CONST, n->type, -1, -1);
+        ir->function->instructions[value].value = n->value;
+    } else {
+        value = ir->current[_irVariable(ir, n->symbol)];
+    }
+
+    while (ir->chainSize > base) {
+        n = &program->nodes[ir->chain[--ir->chainSize]];
+        if (n->kind == NODE_NEGATE || n->kind == NODE_TO_REAL) {
+            value = _irEmit(ir, ir->block, (n->kind == NODE_NEGATE) ? IR_NEGATE : IR_TO_REAL, n->type, value, -1);
+            continue;
+        }
+        int right = _irExpression(ir, n->b);
+        if (n->kind == NODE_COMPARE) {
+            value = _irCompare(ir, n->op, value, right);
+        } else {  // binary operations
+            value = _irEmit(ir, ir->block, IR_ADD + n->kind - NODE_ADD, n->type, value, right);
+            ir->function->instructions[value].line = n->line;
+            ir->function->instructions[value].col = n->col;
+        }
+    }
+    return value;
+}
+
+/**
+ * @brief Adds a comparison to the current block
+ *
+ * @param ir an ir instance
+ * @param relation RELATION_OP
+ * @param a left operand
+ * @param b right operand
+ * @return int the comparison
+ */
+int _irCompare(Ir* ir, int relation, int a, int b) {
+    int value = _irEmit(ir, ir->block, IR_COMPARE, ir->function->instructions[a].type, a, b);
+    ir->function->instructions[value].relation = (char)relation;
+    return value;
+}
+
+/**
+ * @brief Returns the value an instruction was replaced by, following (and shortening) the chain
+ * of replacements
+ *
+ * @param function a function
+ * @param value the instruction
+ * @return int the value that replaces it
+ */
+int _irResolve(IrFunction* function, int value) {
+    int root = value;
+    while (function->instructions[root].replacement != root)
+        root = function->instructions[root].replacement;
+    while (value != root) {
+        int next = function->instructions[value].replacement;
+        function->instructions[value].replacement = root;
+        value = next;
+    }
+    return root;
+}
+
+/**
+ * @brief Orders the blocks reachable from the entry in reverse postorder (each block comes after
+ * its dominators)
+ *
+ * @param function a function
+ * @param order where the blocks are written
+ * @param position where the position of each block in the order is written (-1 if unreachable)
+ * @return int number of reachable blocks
+ */
+int _irOrder(const IrFunction* function, int* order, int* position) {
+    int* stack = (int*)memoryAlloc((function->blockCount + 1) * sizeof(int));
+    int* next = (int*)memoryCalloc(function->blockCount + 1, sizeof(int));  // next successor to visit
+    for (int i = 0; i < function->blockCount; i++)
+        position[i] = -1;
+
+    // postorder into the end of order, position marks the visited blocks meanwhile
+    int count = 0, top = 0;
+    stack[top++] = 0;
+    position[0] = 0;
+    while (top > 0) {
+        int block = stack[top - 1];
+        const IrBlock* visited = &function->blocks[block];
+        if (next[block] < visited->successorCount) {
+            int successor = visited->successors[visited->successorCount - 1 - next[block]++];  // the first one comes first
+            if (position[successor] == -1) {
+                position[successor] = 0;
+                stack[top++] = successor;
+            }
+        } else {
+            order[function->blockCount - 1 - count++] = block;
+            top--;
+        }
+    }
+    memmove(order, order + function->blockCount - count, count * sizeof(int));
+    for (int i = 0; i < count; i++)
+        position[order[i]] = i;
+
+    memoryFree(stack);
+    memoryFree(next);
+    return count;
+}
+
+/**
+ * @brief Computes the dominator tree (Cooper, Harvey and Kennedy's iteration) and numbers it so
+ * that x dominates y if enter[x] <= enter[y] and leave[y] <= leave[x]
+ *
+ * @param function a function
+ * @param order reachable blocks in reverse postorder
+ * @param position position of each block in the order
+ * @param count number of reachable blocks
+ * @param enter where the preorder number of each block is written
+ * @param leave where the postorder number of each block is written
+ */
+void _irDominators(const IrFunction* function, const int* order, const int* position, int count, int* enter, int* leave) {
+    int blocks = function->blockCount;
+    int* dominator = (int*)memoryAlloc(blocks * sizeof(int));
+    for (int i = 0; i < blocks; i++)
+        dominator[i] = -1;
+    dominator[order[0]] = order[0];
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 1; i < count; i++) {
+            const IrBlock* block = &function->blocks[order[i]];
+            int idom = -1;
+            for (int j = 0; j < block->predecessorCount; j++) {
+                int predecessor = block->predecessors[j];
+                if (position[predecessor] == -1 || dominator[predecessor] == -1)
+                    continue;
+                if (idom == -1) {
+                    idom = predecessor;
+                    continue;
+                }
+                int x = predecessor, y = idom;
+                while (x != y) {
+                    while (position[x] > position[y])
+                        x = dominator[x];
+                    while (position[y] > position[x])
+                        y = dominator[y];
+                }
+                idom = x;
+            }
+            if (dominator[order[i]] != idom) {
+                dominator[order[i]] = idom;
+                changed = true;
+            }
+        }
+    }
+
+    // children lists, then a depth-first walk of the tree
+    int* child = (int*)memoryAlloc(blocks * sizeof(int));
+    int* sibling = (int*)memoryAlloc(blocks * sizeof(int));
+    int* stack = (int*)memoryAlloc(blocks * sizeof(int));
+    for (int i = 0; i < blocks; i++)
+        child[i] = -1;
+    for (int i = count - 1; i >= 1; i--) {
+        int parent = dominator[order[i]];
+        sibling[order[i]] = child[parent];
+        child[parent] = order[i];
+    }
+    int number = 0, top = 0;
+    stack[top++] = order[0];
+    enter[order[0]] = number++;
+    while (top > 0) {
+        int block = stack[top - 1];
+        int next = child[block];
+        if (next != -1) {
+            child[block] = sibling[next];
+            enter[next] = number++;
+            stack[top++] = next;
+        } else {
+            leave[block] = number++;
+            top--;
+        }
+    }
+
+    memoryFree(dominator);
+    memoryFree(child);
+    memoryFree(sibling);
+    memoryFree(stack);
+}
+
+/**
+ * @brief Removes the stores of a global that still holds the value (loaded at the entry or after
+ * the last call, which is the only memory write), and the stores at the end of the program body,
+ * which nothing reads
+ *
+ * @param function a function
+ */
+void _irDeadStores(IrFunction* function) {
+    for (int i = 0; i < function->instructionCount; i++) {
+        IrInstruction* store = &function->instructions[i];
+        if (store->op != IR_STORE || store->removed)
+            continue;
+        const IrInstruction* value = &function->instructions[_irResolve(function, store->a)];
+        if (value->op == IR_LOAD && value->symbol == store->symbol) {
+            store->removed = true;
+            function->deadStores++;
+        }
+    }
+    if (function->procedure != -1)
+        return;
+
+    for (int i = 0; i < function->blockCount; i++) {
+        const IrBlock* block = &function->blocks[i];
+        if (block->count == 0 || function->instructions[block->instructions[block->count - 1]].op != IR_RETURN)
+            continue;
+        for (int j = block->count - 2; j >= 0 && function->instructions[block->instructions[j]].op == IR_STORE; j--) {
+            IrInstruction* store = &function->instructions[block->instructions[j]];
+            if (!store->removed) {
+                store->removed = true;
+                function->deadStores++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Global value numbering: in reverse postorder, after folding its constant operands, each
+ * operation equal to one of a dominating block (or earlier in the same block) is replaced by it
+ *
+ * @param function a function
+ */
+void _irNumber(IrFunction* function) {
+    int blocks = function->blockCount;
+    int* order = (int*)memoryAlloc(blocks * sizeof(int));
+    int* position = (int*)memoryAlloc(blocks * sizeof(int));
+    int* enter = (int*)memoryAlloc(blocks * sizeof(int));
+    int* leave = (int*)memoryAlloc(blocks * sizeof(int));
+    int count = _irOrder(function, order, position);
+    _irDominators(function, order, position, count, enter, leave);
+
+    unsigned long capacity = 16;
+    while (capacity < 2 * (unsigned long)function->instructionCount)
+        capacity *= 2;
+    int* table = (int*)memoryAlloc(capacity * sizeof(int));
+    memset(table, -1, capacity * sizeof(int));
+
+    for (int i = 0; i < count; i++) {
+        const IrBlock* block = &function->blocks[order[i]];
+        for (int j = 0; j < block->count; j++) {
+            int value = block->instructions[j];
+            IrInstruction* instruction = &function->instructions[value];
+            if (instruction->removed)
+                continue;
+            if (instruction->a != -1)
+                instruction->a = _irResolve(function, instruction->a);
+            if (instruction->b != -1)
+                instruction->b = _irResolve(function, instruction->b);
+            for (int k = 0; k < instruction->argumentCount; k++) {
+                int* argument = &function->arguments[instruction->arguments + k];
+                if (*argument != -1)
+                    *argument = _irResolve(function, *argument);
+            }
+            if (instruction->op != IR_CONST && (instruction->op < IR_NEGATE || instruction->op > IR_COMPARE))
+                continue;
+
+            _irFold(function, value);
+            bool commutative = instruction->op == IR_ADD || instruction->op == IR_MULTIPLY ||
+                               (instruction->op == IR_COMPARE && instruction->relation <= RELATION_NOT_EQUAL);
+            if (commutative && instruction->a > instruction->b) {
+                int swap = instruction->a;
+                instruction->a = instruction->b;
+                instruction->b = swap;
+            }
+
+            unsigned long slot = _irHash(instruction) & (capacity - 1);
+            for (; table[slot] != -1; slot = (slot + 1) & (capacity - 1))
+                if (_irSameValue(instruction, &function->instructions[table[slot]]))
+                    break;
+            int other = table[slot];
+            int from = function->instructions[(other == -1) ? value : other].block;
+            if (other != -1 && enter[from] <= enter[order[i]] && leave[order[i]] <= leave[from]) {
+                instruction->replacement = other;
+                instruction->removed = true;
+                function->numbered++;
+            } else {
+                table[slot] = value;  // the closest one is the most likely to dominate the next ones
+            }
+        }
+    }
+
+    memoryFree(order);
+    memoryFree(position);
+    memoryFree(enter);
+    memoryFree(leave);
+    memoryFree(table);
+}
+
+/**
+ * @brief Replaces an operation on constants by its result, computed like the generated code
+ * (integers wrap around, a division by zero is left to fail at run time)
+ *
+ * @param function a function
+ * @param value the operation
+ * @return true if it was folded
+ * @return false otherwise
+ */
+bool _irFold(IrFunction* function, int value) {
+    IrInstruction* instruction = &function->instructions[value];
+    if (instruction->op == IR_CONST || instruction->op == IR_COMPARE)
+        return false;
+    const IrInstruction* a = &function->instructions[instruction->a];
+    const IrInstruction* b = (instruction->b == -1) ? NULL : &function->instructions[instruction->b];
+    if (a->op != IR_CONST || (b != NULL && b->op != IR_CONST))
+        return false;
+
+    TokenValue result = {0};
+    if (instruction->op == IR_TO_REAL) {
+        result.real = (double)a->value.integer;
+    } else if (instruction->type == TYPE_REAL) {
+        double x = a->value.real, y = (b == NULL) ? 0.0 : b->value.real;
+        switch (instruction->op) {
+            case IR_NEGATE:
+                result.real = -x;
+                break;
+            case IR_ADD:
+                result.real = x + y;
+                break;
+            case IR_SUBTRACT:
+                result.real = x - y;
+                break;
+            case IR_MULTIPLY:
+                result.real = x * y;
+                break;
+            default:
+                result.real = x / y;
+                break;
+        }
+    } else {
+        unsigned long x = (unsigned long)a->value.integer, y = (b == NULL) ? 0 : (unsigned long)b->value.integer;
+        switch (instruction->op) {
+            case IR_NEGATE:
+                result.integer = (long)(0 - x);
+                break;
+            case IR_ADD:
+                result.integer = (long)(x + y);
+                break;
+            case IR_SUBTRACT:
+                result.integer = (long)(x - y);
+                break;
+            case IR_MULTIPLY:
+                result.integer = (long)(x * y);
+                break;
+            default:
+                if (y == 0)
+                    return false;
+                result.integer = ((long)y == -1) ? (long)(0 - x) : (long)x / (long)y;
+                break;
+        }
+    }
+    instruction->op = IR_CONST;
+    instruction->a = instruction->b = -1;
+    instruction->value = result;
+    return true;
+}
+
+/**
+ * @brief Hashes the operation of an instruction and its operands
+ *
+ * @param instruction the instruction
+ * @return unsigned long the hash
+ */
+unsigned long _irHash(const IrInstruction* instruction) {
+    unsigned long hash = (unsigned long)instruction->op * 31 + (unsigned long)instruction->type;
+    if (instruction->op == IR_CONST) {
+        unsigned long bits;
+        memcpy(&bits, &instruction->value, sizeof(bits));
+        hash = hash * 0x9e3779b97f4a7c15UL + bits;
+    } else {
+        hash = hash * 0x9e3779b97f4a7c15UL + (unsigned long)instruction->relation;
+        hash = hash * 0x9e3779b97f4a7c15UL + (unsigned long)(unsigned int)instruction->a;
+        hash = hash * 0x9e3779b97f4a7c15UL + (unsigned long)(unsigned int)instruction->b;
+    }
+    return hash ^ (hash >> 29);
+}
+
+/**
+ * @brief Returns whether two instructions compute the same value (same operation on the same
+ * operands, or constants with the same bits)
+ *
+ * @param x an instruction
+ * @param y another instruction
+ * @return true if they are equal
+ * @return false otherwise
+ */
+bool _irSameValue(const IrInstruction* x, const IrInstruction* y) {
+    if (x->op != y->op || x->type != y->type)
+        return false;
+    if (x->op == IR_CONST)
+        return !memcmp(&x->value, &y->value, sizeof(TokenValue));
+    return x->a == y->a && x->b == y->b && x->relation == y->relation;
+}
+
+/**
+ * @brief Replaces the phis whose operands are all the same value (or the phi itself) by that value
+ *
+ * @param function a function
+ * @return int number of phis removed
+ */
+int _irSimplifyPhis(IrFunction* function) {
+    int removed = 0;
+    for (int i = 0; i < function->instructionCount; i++) {
+        IrInstruction* phi = &function->instructions[i];
+        if (phi->op != IR_PHI || phi->removed)
+            continue;
+        int same = -1;
+        bool trivial = true;
+        for (int j = 0; j < phi->argumentCount && trivial; j++) {
+            int operand = _irResolve(function, function->arguments[phi->arguments + j]);
+            if (operand == i || operand == same)
+                continue;
+            trivial = same == -1;
+            same = operand;
+        }
+        if (trivial && same != -1) {
+            function->instructions[i].replacement = same;
+            function->instructions[i].removed = true;
+            removed++;
+        }
+    }
+    return removed;
+}
+
+/**
+ * @brief Removes the instructions whose value isn't used by an instruction that must be kept
+ *
+ * @param function a function
+ */
+void _irDeadCode(IrFunction* function) {
+    int count = function->instructionCount;
+    bool* live = (bool*)memoryCalloc(count + 1, sizeof(bool));
+    int* stack = (int*)memoryAlloc((count + 1) * sizeof(int));
+    int top = 0;
+    for (int i = 0; i < count; i++) {
+        if (!function->instructions[i].removed && _irEffect(function, i)) {
+            live[i] = true;
+            stack[top++] = i;
+        }
+    }
+
+    while (top > 0) {
+        const IrInstruction* instruction = &function->instructions[stack[--top]];
+        int operands[2] = {instruction->a, instruction->b};
+        for (int i = 0; i < 2 + instruction->argumentCount; i++) {
+            int operand = (i < 2) ? operands[i] : function->arguments[instruction->arguments + i - 2];
+            if (operand == -1)
+                continue;
+            operand = _irResolve(function, operand);
+            if (!live[operand]) {
+                live[operand] = true;
+                stack[top++] = operand;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!function->instructions[i].removed && !live[i]) {
+            function->instructions[i].removed = true;
+            function->dead++;
+        }
+    }
+    memoryFree(live);
+    memoryFree(stack);
+}
+
+/**
+ * @brief Returns whether an instruction must be kept even if its value isn't used: memory and
+ * input/output, calls, control flow and integer divisions that may fail
+ *
+ * @param function a function
+ * @param value the instruction
+ * @return true if it has an effect
+ * @return false otherwise
+ */
+bool _irEffect(const IrFunction* function, int value) {
+    const IrInstruction* instruction = &function->instructions[value];
+    switch (instruction->op) {
+        case IR_STORE:
+        case IR_READ:
+        case IR_WRITE:
+        case IR_CALL:
+        case IR_JUMP:
+        case IR_BRANCH:
+        case IR_RETURN:
+            return true;
+        case IR_DIVIDE: {
+            if (instruction->type == TYPE_REAL)
+                return false;
+            int divisor = instruction->b;
+            while (function->instructions[divisor].replacement != divisor)
+                divisor = function->instructions[divisor].replacement;
+            return function->instructions[divisor].op != IR_CONST || function->instructions[divisor].value.integer == 0;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Counts the instructions of a function that weren't removed
+ *
+ * @param function a function
+ * @return int the count
+ */
+int _irCount(const IrFunction* function) {
+    int count = 0;
+    for (int i = 0; i < function->instructionCount; i++)
+        count += !function->instructions[i].removed;
+    return count;
+}
+
+/**
+ * @brief Prints an instruction on a line, e.g. "v7 = add.i v5, v6" or "branch v9, b2, b3"
+ *
+ * @param ir an ir instance
+ * @param function its function
+ * @param value the instruction
+ * @param output where it is printed
+ */
+void _irPrintInstruction(Ir* ir, IrFunction* function, int value, FILE* output) {
+    static const char* opName[] = {"const", "param", "load", "store", "neg", "toreal", "add", "sub", "mul",
+                                   "div", "", "read", "write", "call", "phi", "jump", "branch", "return"};
+    static const char* relationName[] = {"eq", "ne", "lt", "le", "gt", "ge"};
+
+    const IrInstruction* instruction = &function->instructions[value];
+    const IrBlock* block = &function->blocks[instruction->block];
+    const char* name = (instruction->op == IR_COMPARE) ? relationName[(int)instruction->relation] : opName[(int)instruction->op];
+    char type = (instruction->type == TYPE_REAL) ? 'r' : 'i';
+    int a = (instruction->a == -1) ? -1 : _irResolve(function, instruction->a);
+    int b = (instruction->b == -1) ? -1 : _irResolve(function, instruction->b);
+
+    fputs("    ", output);
+    switch (instruction->op) {
+        case IR_STORE:
+            fprintf(output, "store %s, v%d\n", programName(ir->program, instruction->symbol), a);
+            return;
+        case IR_WRITE:
+            fprintf(output, "write.%c v%d%s\n", type, a, instruction->last ? ", eol" : "");
+            return;
+        case IR_CALL:
+            fprintf(output, "call %s(", programName(ir->program, instruction->symbol));
+            for (int i = 0; i < instruction->argumentCount; i++)
+                fprintf(output, "%sv%d", (i > 0) ? ", " : "", _irResolve(function, function->arguments[instruction->arguments + i]));
+            fputs(")\n", output);
+            return;
+        case IR_JUMP:
+            fprintf(output, "jump b%d\n", block->successors[0]);
+            return;
+        case IR_BRANCH:
+            fprintf(output, "branch v%d, b%d, b%d\n", a, block->successors[0], block->successors[1]);
+            return;
+        case IR_RETURN:
+            fputs("return\n", output);
+            return;
+    }
+
+    fprintf(output, "v%d = %s.%c", value, name, type);
+    switch (instruction->op) {
+        case IR_CONST:
+            if (instruction->type == TYPE_REAL) {
+                char text[RUNTIME_REAL_SIZE];
+                runtimeFormatReal(instruction->value.real, text);
+                fprintf(output, " %s\n", text);
+            } else {
+                fprintf(output, " %ld\n", instruction->value.integer);
+            }
+            break;
+        case IR_PARAM:
+        case IR_LOAD:
+        case IR_READ:
+            fprintf(output, " %s\n", programName(ir->program, instruction->symbol));
+            break;
+        case IR_PHI:
+            for (int i = 0; i < instruction->argumentCount; i++)
+                fprintf(output, "%s[b%d: v%d]", (i > 0) ? ", " : " ", block->predecessors[i],
+                        _irResolve(function, function->arguments[instruction->arguments + i]));
+            fputc('\n', output);
+            break;
+        default:
+            fprintf(output, (b == -1) ? " v%d\n" : " v%d, v%d\n", a, b);
+    }
+}
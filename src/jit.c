@@ -0,0 +1,1463 @@
+/**
+ * @file jit.c
+ * @brief x86-64 code generation implementation. Each procedure and the program become a function
+ * with a frame pointer; arguments are passed on the stack and the global variables live in a
+ * block addressed by rbx. The most used integer variables of each function are kept in r12 to
+ * r15 and the most used real ones in xmm8 to xmm15, stored back around calls when a callee could
+ * see them or clobber their register. Expressions are evaluated in rax or xmm0, with simple
+ * operands (variables and constants) used in place. Integer division by zero jumps to an out of
+ * line call of runtimeFail; real operations follow IEEE 754.
+ *
+ * Sandboxed code (--sandbox) counts a step at each loop back-edge and procedure entry: a
+ * decrement of r15, which holds Runtime.ticks and isn't used for variables, and a branch not
+ * taken, with a call of runtimeTick once per slice of steps. r15 is stored in Runtime.ticks before
+ * every call of the runtime, so that a run stopped there knows its steps. Procedure entries also
+ * compare the stack pointer with Runtime.stackLimit.
+ */
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS
+
+#include "../header/jit.h"
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define JIT_SIGN_MASK LONG_MIN  // sign bit of a double
+
+/**
+ * @brief Translates a program to machine code in executable memory
+ *
+ * @param jit a Jit instance, it must be destroyed even if there are errors
+ * @param program a program without semantic errors
+ * @param sandbox whether the code checks the limits of the runtime
+ * @return true if executable memory couldn't be obtained
+ * @return false otherwise
+ */
+bool jitCompile(Jit* jit, const Program* program, bool sandbox) {
+    PROFILE_ENTER(PHASE_CODEGEN);
+    memset(jit, 0, sizeof(Jit));
+    jit->program = program;
+    jit->sandbox = sandbox;
+    jit->registers = (int*)memoryAlloc((program->symbolCount + 1) * sizeof(int));
+    jit->weights = (long*)memoryCalloc(program->symbolCount + 1, sizeof(long));
+    jit->touched = (int*)memoryAlloc((program->symbolCount + 1) * sizeof(int));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 3);
+    memset(jit->registers, -1, (program->symbolCount + 1) * sizeof(int));
+
+    for (unsigned long i = 0; i < program->procedureCount; i++)
+        _jitLabel(jit);
+    int entry = _jitLabel(jit);
+    for (unsigned long i = 0; i < program->procedureCount; i++)
+        _jitUnit(jit, (int)i, program->procedures[i].body, (int)i);
+    _jitUnit(jit, GLOBAL_SCOPE, program->body, entry);
+
+    for (int i = 0; i < jit->stubCount; i++) {
+        const JitStub* stub = &jit->stubs[i];
+        _jitBind(jit, stub->label);
+        if (stub->status == RUNTIME_MEMORY_LIMIT)
+            _jitRegister(jit, 0, true, 0x89, REG_RBP, REG_RSP);  // mov rsp, rbp (the frame is below the limit)
+        _jitRegister(jit, 0, true, 0x83, 4, REG_RSP);         // and rsp, -16
+        _jitByte(jit, 0xf0);
+        _jitMemory(jit, 0, true, 0x8b, REG_RDI, REG_RBX, 0);
+        _jitImmediate(jit, REG_RSI, stub->status);
+        _jitImmediate(jit, REG_RDX, stub->where);
+        _jitCallRuntime(jit, (const void*)runtimeFail);
+    }
+
+    for (unsigned long i = 0; i < jit->fixupCount; i++) {
+        const JitFixup* fixup = &jit->fixups[i];
+        long rel = jit->labels[fixup->label] - (long)(fixup->at + 4);
+        for (int byte = 0; byte < 4; byte++)
+            jit->code[fixup->at + byte] = (unsigned char)(rel >> (8 * byte));
+    }
+
+    // the code is copied to its own pages, which are never writable and executable at once
+    unsigned long page = (unsigned long)sysconf(_SC_PAGESIZE);
+    jit->mapped = (jit->size + page - 1) / page * page;
+    void* memory = mmap(NULL, jit->mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        printf("Error: couldn't allocate memory for the generated code\n");
+        jit->mapped = 0;
+        PROFILE_LEAVE();
+        return true;
+    }
+    jit->memory = (unsigned char*)memory;
+    memcpy(jit->memory, jit->code, jit->size);
+    if (mprotect(jit->memory, jit->mapped, PROT_READ | PROT_EXEC)) {
+        printf("Error: couldn't make the generated code executable\n");
+        PROFILE_LEAVE();
+        return true;
+    }
+    jit->entry = (unsigned long)jit->labels[entry];
+    jit->data = (long*)memoryCalloc(program->globalCount + 1, sizeof(long));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+
+    PROFILE_LEAVE();
+    return false;
+}
+
+/**
+ * @brief Runs a compiled program until it ends or fails
+ *
+ * @param jit a compiled program
+ * @param runtime the runtime it uses, its status tells how the program ended
+ * @return int RUNTIME_STATUS
+ */
+int jitRun(Jit* jit, Runtime* runtime) {
+    PROFILE_ENTER(PHASE_RUN);
+    jit->data[0] = (long)runtime;
+    void (*entry)(long*) = (void (*)(long*))(void*)(jit->memory + jit->entry);
+    if (!setjmp(runtime->exit))
+        entry(jit->data);
+    PROFILE_LEAVE();
+    return runtime->status;
+}
+
+/**
+ * @brief Deallocates a Jit instance and its code
+ *
+ * @param jit a Jit instance
+ */
+void jitDestroy(Jit* jit) {
+    if (jit->mapped)
+        munmap(jit->memory, jit->mapped);
+    memoryFree(jit->code);
+    memoryFree(jit->labels);
+    memoryFree(jit->fixups);
+    memoryFree(jit->stubs);
+    memoryFree(jit->registers);
+    memoryFree(jit->weights);
+    memoryFree(jit->touched);
+    memoryFree(jit->chain);
+    memoryFree(jit->data);
+    memset(jit, 0, sizeof(Jit));
+}
+
+/**
+ * @brief Appends a byte to the code
+ *
+ * @param jit a Jit instance
+ * @param byte the byte
+ */
+void _jitByte(Jit* jit, int byte) {
+    if (jit->size == jit->capacity) {
+        jit->capacity = (jit->capacity == 0) ? 4096 : 2 * jit->capacity;
+        jit->code = (unsigned char*)memoryRealloc(jit->code, jit->capacity);
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    jit->code[jit->size++] = (unsigned char)byte;
+}
+
+/**
+ * @brief Appends a 32 bits little-endian value to the code
+ *
+ * @param jit a Jit instance
+ * @param value the value (its low 32 bits)
+ */
+void _jitInt32(Jit* jit, long value) {
+    for (int i = 0; i < 4; i++)
+        _jitByte(jit, (int)((value >> (8 * i)) & 0xff));
+}
+
+/**
+ * @brief Appends a 64 bits little-endian value to the code
+ *
+ * @param jit a Jit instance
+ * @param value the value
+ */
+void _jitInt64(Jit* jit, long value) {
+    for (int i = 0; i < 8; i++)
+        _jitByte(jit, (int)((value >> (8 * i)) & 0xff));
+}
+
+/**
+ * @brief Appends the mandatory prefix and the REX prefix of an instruction
+ *
+ * @param jit a Jit instance
+ * @param prefix 0x66, 0xf2, 0xf3 or 0 for none
+ * @param wide whether the operation is 64 bits (REX.W)
+ * @param reg register of the reg field (or opcode extension)
+ * @param rm register of the rm field (or base register)
+ */
+void _jitRex(Jit* jit, int prefix, bool wide, int reg, int rm) {
+    if (prefix)
+        _jitByte(jit, prefix);
+    int rex = 0x40 | (wide << 3) | (((reg >> 3) & 1) << 2) | ((rm >> 3) & 1);
+    if (rex != 0x40)
+        _jitByte(jit, rex);
+}
+
+/**
+ * @brief Appends an opcode
+ *
+ * @param jit a Jit instance
+ * @param opcode 1 to 3 bytes, the first one in the most significant position (0x0f58)
+ */
+void _jitOpcode(Jit* jit, int opcode) {
+    if (opcode > 0xffff)
+        _jitByte(jit, opcode >> 16);
+    if (opcode > 0xff)
+        _jitByte(jit, (opcode >> 8) & 0xff);
+    _jitByte(jit, opcode & 0xff);
+}
+
+/**
+ * @brief Appends an instruction with two register operands
+ *
+ * @param jit a Jit instance
+ * @param prefix mandatory prefix or 0
+ * @param wide whether the operation is 64 bits
+ * @param opcode the opcode
+ * @param reg register of the reg field (or opcode extension)
+ * @param rm register of the rm field
+ */
+void _jitRegister(Jit* jit, int prefix, bool wide, int opcode, int reg, int rm) {
+    _jitRex(jit, prefix, wide, reg, rm);
+    _jitOpcode(jit, opcode);
+    _jitByte(jit, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/**
+ * @brief Appends an instruction with a register and a [base + disp] memory operand
+ *
+ * @param jit a Jit instance
+ * @param prefix mandatory prefix or 0
+ * @param wide whether the operation is 64 bits
+ * @param opcode the opcode
+ * @param reg register of the reg field (or opcode extension)
+ * @param base base register
+ * @param disp displacement
+ */
+void _jitMemory(Jit* jit, int prefix, bool wide, int opcode, int reg, int base, long disp) {
+    _jitRex(jit, prefix, wide, reg, base);
+    _jitOpcode(jit, opcode);
+    int mod = (disp == 0 && (base & 7) != REG_RBP) ? 0 : (disp >= -128 && disp < 128) ? 1 : 2;
+    _jitByte(jit, (mod << 6) | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == REG_RSP)  // SIB byte without index
+        _jitByte(jit, 0x24);
+    if (mod == 1)
+        _jitByte(jit, (int)(disp & 0xff));
+    else if (mod == 2)
+        _jitInt32(jit, disp);
+}
+
+/**
+ * @brief Loads a constant in a general purpose register, with the shortest encoding
+ *
+ * @param jit a Jit instance
+ * @param reg the register
+ * @param value the constant
+ */
+void _jitImmediate(Jit* jit, int reg, long value) {
+    if (value == 0) {
+        _jitRegister(jit, 0, false, 0x31, reg, reg);  // xor r32, r32
+    } else if (value > 0 && value <= 0xffffffffl) {
+        _jitRex(jit, 0, false, 0, reg);  // mov r32, imm32 (zero extended)
+        _jitByte(jit, 0xb8 + (reg & 7));
+        _jitInt32(jit, value);
+    } else if (value >= -0x80000000l && value < 0) {
+        _jitRegister(jit, 0, true, 0xc7, 0, reg);  // mov r64, imm32 (sign extended)
+        _jitInt32(jit, value);
+    } else {
+        _jitRex(jit, 0, true, 0, reg);  // mov r64, imm64
+        _jitByte(jit, 0xb8 + (reg & 7));
+        _jitInt64(jit, value);
+    }
+}
+
+/**
+ * @brief Loads a real constant in an xmm register (through rax)
+ *
+ * @param jit a Jit instance
+ * @param reg the xmm register
+ * @param value the constant
+ */
+void _jitRealImmediate(Jit* jit, int reg, double value) {
+    long bits;
+    memcpy(&bits, &value, sizeof(long));
+    if (bits == 0) {
+        _jitRegister(jit, 0x66, false, 0x0fef, reg, reg);  // pxor
+        return;
+    }
+    _jitImmediate(jit, REG_RAX, bits);
+    _jitRegister(jit, 0x66, true, 0x0f6e, reg, REG_RAX);  // movq xmm, rax
+}
+
+/**
+ * @brief Calls a function of the runtime, whose address doesn't fit a rel32
+ *
+ * @param jit a Jit instance
+ * @param function the function
+ */
+void _jitCallRuntime(Jit* jit, const void* function) {
+    if (jit->sandbox) {
+        _jitMemory(jit, 0, true, 0x8b, REG_RAX, REG_RBX, 0);                                  // mov rax, [rbx] (the runtime)
+        _jitMemory(jit, 0, true, 0x89, REG_R15, REG_RAX, (long)offsetof(Runtime, ticks));  // mov [rax + ticks], r15
+    }
+    _jitImmediate(jit, REG_RAX, (long)function);
+    _jitRegister(jit, 0, false, 0xff, 2, REG_RAX);  // call rax
+}
+
+/**
+ * @brief Creates an unbound label
+ *
+ * @param jit a Jit instance
+ * @return int the label
+ */
+int _jitLabel(Jit* jit) {
+    if (jit->labelCount == jit->labelCapacity) {
+        jit->labelCapacity = (jit->labelCapacity == 0) ? 256 : 2 * jit->labelCapacity;
+        jit->labels = (long*)memoryRealloc(jit->labels, jit->labelCapacity * sizeof(long));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    jit->labels[jit->labelCount] = -1;
+    return jit->labelCount++;
+}
+
+/**
+ * @brief Binds a label to the current position of the code
+ *
+ * @param jit a Jit instance
+ * @param label the label
+ */
+void _jitBind(Jit* jit, int label) {
+    jit->labels[label] = (long)jit->size;
+}
+
+/**
+ * @brief Appends a jump to a label, short if the label is bound and near
+ *
+ * @param jit a Jit instance
+ * @param condition condition code of a jcc or -1 for jmp
+ * @param label the target
+ */
+void _jitJump(Jit* jit, int condition, int label) {
+    if (jit->labels[label] != -1) {
+        long rel = jit->labels[label] - (long)(jit->size + 2);
+        if (rel >= -128) {
+            _jitByte(jit, (condition == -1) ? 0xeb : 0x70 + condition);
+            _jitByte(jit, (int)(rel & 0xff));
+            return;
+        }
+    }
+
+    if (condition == -1) {
+        _jitByte(jit, 0xe9);
+    } else {
+        _jitByte(jit, 0x0f);
+        _jitByte(jit, 0x80 + condition);
+    }
+    _jitFixup(jit, label);
+}
+
+/**
+ * @brief Appends a call of a procedure
+ *
+ * @param jit a Jit instance
+ * @param label entry of the procedure
+ */
+void _jitCall(Jit* jit, int label) {
+    _jitByte(jit, 0xe8);
+    _jitFixup(jit, label);
+}
+
+/**
+ * @brief Appends the rel32 of a jump or call, filled in when the code is complete
+ *
+ * @param jit a Jit instance
+ * @param label the target
+ */
+void _jitFixup(Jit* jit, int label) {
+    if (jit->fixupCount == jit->fixupCapacity) {
+        jit->fixupCapacity = (jit->fixupCapacity == 0) ? 256 : 2 * jit->fixupCapacity;
+        jit->fixups = (JitFixup*)memoryRealloc(jit->fixups, jit->fixupCapacity * sizeof(JitFixup));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    jit->fixups[jit->fixupCount].at = jit->size;
+    jit->fixups[jit->fixupCount++].label = label;
+    _jitInt32(jit, 0);
+}
+
+/**
+ * @brief Creates an out of line call of runtimeFail, appended after every function
+ *
+ * @param jit a Jit instance
+ * @param status RUNTIME_STATUS
+ * @param where RUNTIME_WHERE of the failing command
+ * @return int the label of the call
+ */
+int _jitStub(Jit* jit, int status, long where) {
+    if (jit->stubCount == jit->stubCapacity) {
+        jit->stubCapacity = (jit->stubCapacity == 0) ? 16 : 2 * jit->stubCapacity;
+        jit->stubs = (JitStub*)memoryRealloc(jit->stubs, jit->stubCapacity * sizeof(JitStub));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    JitStub* stub = &jit->stubs[jit->stubCount++];
+    stub->label = _jitLabel(jit);
+    stub->status = status;
+    stub->where = where;
+    return stub->label;
+}
+
+/**
+ * @brief Generates a step of the sandbox: r15 is decremented and runtimeTick called when it goes
+ * negative, with the cached reals in memory. At a procedure entry, nothing is cached yet and
+ * the stack pointer, below the frame, is compared with the limit first.
+ *
+ * @param jit a Jit instance
+ * @param where RUNTIME_WHERE of the loop or of the procedure
+ * @param entry whether it is the entry of a procedure
+ */
+void _jitTick(Jit* jit, long where, bool entry) {
+    if (entry) {
+        _jitMemory(jit, 0, true, 0x8b, REG_RAX, REG_RBX, 0);                                     // mov rax, [rbx] (the runtime)
+        _jitMemory(jit, 0, true, 0x3b, REG_RSP, REG_RAX, (long)offsetof(Runtime, stackLimit));  // cmp rsp, [rax + limit]
+        _jitJump(jit, 0x2, _jitStub(jit, RUNTIME_MEMORY_LIMIT, where));                        // jb
+    }
+    _jitRegister(jit, 0, true, 0x83, 5, REG_R15);  // sub r15, 1
+    _jitByte(jit, 1);
+    int done = _jitLabel(jit);
+    _jitJump(jit, 0x9, done);  // jns
+
+    if (!entry)
+        _jitSpill(jit, SPILL_REAL_GLOBALS | SPILL_REAL_LOCALS);
+    _jitMemory(jit, 0, true, 0x8b, REG_RDI, REG_RBX, 0);
+    _jitImmediate(jit, REG_RSI, where);
+    _jitCallRuntime(jit, (const void*)runtimeTick);
+    _jitMemory(jit, 0, true, 0x8b, REG_RAX, REG_RBX, 0);
+    _jitMemory(jit, 0, true, 0x8b, REG_R15, REG_RAX, (long)offsetof(Runtime, ticks));  // mov r15, [rax + ticks]
+    if (!entry)
+        _jitReload(jit, SPILL_REAL_GLOBALS | SPILL_REAL_LOCALS);
+    _jitBind(jit, done);
+}
+
+/**
+ * @brief Generates the function of a procedure or of the program. The frame holds the saved
+ * registers, then the local variables, then the temporary slots.
+ *
+ * @param jit a Jit instance
+ * @param scope the procedure or GLOBAL_SCOPE
+ * @param body its NODE_BLOCK
+ * @param label label of its entry
+ */
+void _jitUnit(Jit* jit, int scope, int body, int label) {
+    const Program* program = jit->program;
+    jit->scope = scope;
+    _jitAllocate(jit, body);
+    int locals = (scope == GLOBAL_SCOPE) ? 0 : program->procedures[scope].localCount;
+    jit->slots = jit->maxSlots = jit->savedCount + locals;
+    jit->realsSpilled = false;
+
+    _jitBind(jit, label);
+    _jitByte(jit, 0x55);                                  // push rbp
+    _jitRegister(jit, 0, true, 0x89, REG_RSP, REG_RBP);  // mov rbp, rsp
+    _jitRegister(jit, 0, true, 0x81, 5, REG_RSP);        // sub rsp, frame size
+    unsigned long frame = jit->size;
+    _jitInt32(jit, 0);
+
+    // rbx (which the program sets), r15 in sandboxed code and the used registers of r12 to r15
+    // belong to the caller
+    int slot = 0;
+    if (scope == GLOBAL_SCOPE)
+        _jitMemory(jit, 0, true, 0x89, REG_RBX, REG_RBP, -8 * ++slot);
+    if (scope == GLOBAL_SCOPE && jit->sandbox)
+        _jitMemory(jit, 0, true, 0x89, REG_R15, REG_RBP, -8 * ++slot);
+    for (int i = 0; i < jit->cachedCount; i++)
+        if (program->symbols[jit->cached[i].symbol].type == TYPE_INTEGER)
+            _jitMemory(jit, 0, true, 0x89, jit->cached[i].reg, REG_RBP, -8 * ++slot);
+    if (scope == GLOBAL_SCOPE)
+        _jitRegister(jit, 0, true, 0x8b, REG_RBX, REG_RDI);  // mov rbx, rdi (the data block)
+    if (scope == GLOBAL_SCOPE && jit->sandbox) {
+        _jitMemory(jit, 0, true, 0x8b, REG_RAX, REG_RBX, 0);
+        _jitMemory(jit, 0, true, 0x8b, REG_R15, REG_RAX, (long)offsetof(Runtime, ticks));  // mov r15, [rax + ticks]
+    } else if (jit->sandbox)
+        _jitTick(jit, RUNTIME_WHERE(program->nodes[body].line, program->nodes[body].col), true);
+
+    // every variable starts at 0
+    if (locals > 0)
+        _jitImmediate(jit, REG_RAX, 0);
+    for (int i = 0; i < locals; i++)
+        _jitMemory(jit, 0, true, 0x89, REG_RAX, REG_RBP, -8 * (jit->savedCount + i + 1));
+    for (int i = 0; i < jit->cachedCount; i++) {
+        const Symbol* symbol = &program->symbols[jit->cached[i].symbol];
+        int reg = jit->cached[i].reg;
+        if (symbol->scope == GLOBAL_SCOPE || symbol->kind == SYMBOL_PARAMETER) {
+            int base;
+            long disp;
+            _jitHome(jit, jit->cached[i].symbol, &base, &disp);
+            if (symbol->type == TYPE_INTEGER)
+                _jitMemory(jit, 0, true, 0x8b, reg, base, disp);
+            else
+                _jitMemory(jit, 0xf2, false, 0x0f10, reg, base, disp);  // movsd
+        } else if (symbol->type == TYPE_INTEGER)
+            _jitRegister(jit, 0, false, 0x31, reg, reg);  // xor
+        else
+            _jitRegister(jit, 0x66, false, 0x0fef, reg, reg);  // pxor
+    }
+
+    _jitCommand(jit, body);
+
+    _jitSpill(jit, SPILL_INTEGER_GLOBALS | SPILL_REAL_GLOBALS);
+    if (scope == GLOBAL_SCOPE && jit->sandbox) {
+        _jitMemory(jit, 0, true, 0x8b, REG_RAX, REG_RBX, 0);
+        _jitMemory(jit, 0, true, 0x89, REG_R15, REG_RAX, (long)offsetof(Runtime, ticks));  // mov [rax + ticks], r15
+    }
+    slot = 0;
+    if (scope == GLOBAL_SCOPE)
+        _jitMemory(jit, 0, true, 0x8b, REG_RBX, REG_RBP, -8 * ++slot);
+    if (scope == GLOBAL_SCOPE && jit->sandbox)
+        _jitMemory(jit, 0, true, 0x8b, REG_R15, REG_RBP, -8 * ++slot);
+    for (int i = 0; i < jit->cachedCount; i++)
+        if (program->symbols[jit->cached[i].symbol].type == TYPE_INTEGER)
+            _jitMemory(jit, 0, true, 0x8b, jit->cached[i].reg, REG_RBP, -8 * ++slot);
+    _jitByte(jit, 0xc9);  // leave
+    _jitByte(jit, 0xc3);  // ret
+
+    long size = (8l * jit->maxSlots + 15) & ~15l;  // keeps rsp 16-byte aligned at calls
+    for (int byte = 0; byte < 4; byte++)
+        jit->code[frame + byte] = (unsigned char)(size >> (8 * byte));
+
+    for (int i = 0; i < jit->cachedCount; i++)
+        jit->registers[jit->cached[i].symbol] = -1;
+    jit->cachedCount = 0;
+}
+
+/**
+ * @brief Chooses the variables kept in registers by a function: the integer and real ones with
+ * the highest weight, counting the uses inside loops 8 times for each loop level
+ *
+ * @param jit a Jit instance, on the function
+ * @param body its NODE_BLOCK
+ */
+void _jitAllocate(Jit* jit, int body) {
+    int integers[JIT_INTEGER_REGISTERS];
+    int reals[JIT_REAL_REGISTERS];
+    long integerWeights[JIT_INTEGER_REGISTERS];
+    long realWeights[JIT_REAL_REGISTERS];
+    int integerCount = 0;
+    int realCount = 0;
+
+    jit->touchedCount = 0;
+    _jitCount(jit, body, 1);
+    for (int i = 0; i < jit->touchedCount; i++) {
+        int symbol = jit->touched[i];
+        long weight = jit->weights[symbol];
+        jit->weights[symbol] = 0;
+        if (weight < 2)
+            continue;
+
+        // insertion in the candidates of its type, sorted by decreasing weight
+        bool real = jit->program->symbols[symbol].type == TYPE_REAL;
+        int* list = real ? reals : integers;
+        long* weights = real ? realWeights : integerWeights;
+        int* count = real ? &realCount : &integerCount;
+        int size = real ? JIT_REAL_REGISTERS : JIT_INTEGER_REGISTERS - jit->sandbox;  // r15 counts the steps
+        int position = *count;
+        while (position > 0 && weights[position - 1] < weight)
+            position--;
+        if (position == size)
+            continue;
+        if (*count < size)
+            (*count)++;
+        for (int j = *count - 1; j > position; j--) {
+            list[j] = list[j - 1];
+            weights[j] = weights[j - 1];
+        }
+        list[position] = symbol;
+        weights[position] = weight;
+    }
+
+    jit->cachedCount = 0;
+    for (int i = 0; i < integerCount; i++) {
+        jit->cached[jit->cachedCount].symbol = integers[i];
+        jit->cached[jit->cachedCount++].reg = REG_R12 + i;
+    }
+    for (int i = 0; i < realCount; i++) {
+        jit->cached[jit->cachedCount].symbol = reals[i];
+        jit->cached[jit->cachedCount++].reg = 8 + i;  // xmm8
+    }
+    for (int i = 0; i < jit->cachedCount; i++)
+        jit->registers[jit->cached[i].symbol] = jit->cached[i].reg;
+    jit->savedCount = integerCount + (jit->scope == GLOBAL_SCOPE) * (1 + jit->sandbox);
+}
+
+/**
+ * @brief Adds the uses of the variables of a subtree to their weights, in preorder. The chain of
+ * first operands is followed by a loop and pushed on a stack, their other children are counted
+ * back up from its end, so that long expressions don't nest calls
+ *
+ * @param jit a Jit instance
+ * @param node root of the subtree (NO_NODE is ignored)
+ * @param weight weight of a use at this loop level
+ */
+void _jitCount(Jit* jit, int node, long weight) {
+    const Program* program = jit->program;
+    long inner = (weight < (1l << 40)) ? 8 * weight : weight;
+    int base = jit->chainSize;
+    for (; node != NO_NODE; node = program->nodes[node].a) {
+        const Node* n = &program->nodes[node];
+        if (n->kind == NODE_VARIABLE || n->kind == NODE_ASSIGN || n->kind == NODE_FOR) {
+            if (jit->weights[n->symbol] == 0)
+                jit->touched[jit->touchedCount++] = n->symbol;
+            jit->weights[n->symbol] += (n->kind == NODE_FOR) ? 2 * inner : weight;  // tested and incremented
+        }
+        _jitPush(jit, node);
+        if (n->kind == NODE_WHILE || n->kind == NODE_FOR || n->kind == NODE_BLOCK || n->kind == NODE_READ ||
+            n->kind == NODE_WRITE || n->kind == NODE_CALL)
+            break;
+    }
+
+    while (jit->chainSize > base) {
+        const Node* n = &program->nodes[jit->chain[--jit->chainSize]];
+        switch (n->kind) {
+            case NODE_WHILE:
+                _jitCount(jit, n->a, inner);
+                _jitCount(jit, n->b, inner);
+                break;
+            case NODE_FOR:
+                _jitCount(jit, n->a, weight);
+                _jitCount(jit, n->b, weight);
+                _jitCount(jit, n->c, inner);
+                break;
+            case NODE_BLOCK:
+            case NODE_READ:
+            case NODE_WRITE:
+            case NODE_CALL:
+                for (int item = n->a; item != NO_NODE; item = program->nodes[item].next)
+                    _jitCount(jit, item, weight);
+                break;
+            default:
+                _jitCount(jit, n->b, weight);
+                _jitCount(jit, n->c, weight);
+        }
+    }
+}
+
+/**
+ * @brief Pushes a node on the stack of the chains being walked
+ *
+ * @param jit a Jit instance
+ * @param node the node
+ */
+void _jitPush(Jit* jit, int node) {
+    if (jit->chainSize == jit->chainCapacity) {
+        jit->chainCapacity = (jit->chainCapacity == 0) ? 256 : 2 * jit->chainCapacity;
+        jit->chain = (int*)memoryRealloc(jit->chain, jit->chainCapacity * sizeof(int));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    jit->chain[jit->chainSize++] = node;
+}
+
+/**
+ * @brief Returns the memory location of a variable: global variables are in the data block after
+ * the runtime, parameters above the return address and local variables below the saved registers
+ *
+ * @param jit a Jit instance, on the function of the variable
+ * @param symbol the variable or parameter
+ * @param base where the base register is written
+ * @param disp where the displacement is written
+ */
+void _jitHome(const Jit* jit, int symbol, int* base, long* disp) {
+    const Symbol* declared = &jit->program->symbols[symbol];
+    if (declared->scope == GLOBAL_SCOPE) {
+        *base = REG_RBX;
+        *disp = 8l * (declared->index + 1);
+        return;
+    }
+
+    int parameters = jit->program->procedures[declared->scope].parameterCount;
+    *base = REG_RBP;
+    if (declared->index < parameters)
+        *disp = 16 + 8l * declared->index;
+    else
+        *disp = -8l * (jit->savedCount + declared->index - parameters + 1);
+}
+
+/**
+ * @brief Stores cached variables in their memory location
+ *
+ * @param jit a Jit instance
+ * @param set JIT_SPILL flags
+ */
+void _jitSpill(Jit* jit, int set) {
+    for (int i = 0; i < jit->cachedCount; i++) {
+        const Symbol* symbol = &jit->program->symbols[jit->cached[i].symbol];
+        bool global = symbol->scope == GLOBAL_SCOPE;
+        int flag = (symbol->type == TYPE_INTEGER) ? (global ? SPILL_INTEGER_GLOBALS : 0)
+                                                 : (global ? SPILL_REAL_GLOBALS : SPILL_REAL_LOCALS);
+        if (!(set & flag))
+            continue;
+
+        int base;
+        long disp;
+        _jitHome(jit, jit->cached[i].symbol, &base, &disp);
+        if (symbol->type == TYPE_INTEGER)
+            _jitMemory(jit, 0, true, 0x89, jit->cached[i].reg, base, disp);
+        else
+            _jitMemory(jit, 0xf2, false, 0x0f11, jit->cached[i].reg, base, disp);  // movsd
+    }
+    if (set & SPILL_REAL_LOCALS)
+        jit->realsSpilled = true;
+}
+
+/**
+ * @brief Loads cached variables from their memory location
+ *
+ * @param jit a Jit instance
+ * @param set JIT_SPILL flags
+ */
+void _jitReload(Jit* jit, int set) {
+    for (int i = 0; i < jit->cachedCount; i++) {
+        const Symbol* symbol = &jit->program->symbols[jit->cached[i].symbol];
+        bool global = symbol->scope == GLOBAL_SCOPE;
+        int flag = (symbol->type == TYPE_INTEGER) ? (global ? SPILL_INTEGER_GLOBALS : 0)
+                                                 : (global ? SPILL_REAL_GLOBALS : SPILL_REAL_LOCALS);
+        if (!(set & flag))
+            continue;
+
+        int base;
+        long disp;
+        _jitHome(jit, jit->cached[i].symbol, &base, &disp);
+        if (symbol->type == TYPE_INTEGER)
+            _jitMemory(jit, 0, true, 0x8b, jit->cached[i].reg, base, disp);
+        else
+            _jitMemory(jit, 0xf2, false, 0x0f10, jit->cached[i].reg, base, disp);  // movsd
+    }
+    if (set & SPILL_REAL_LOCALS)
+        jit->realsSpilled = false;
+}
+
+/**
+ * @brief Loads a variable in a register
+ *
+ * @param jit a Jit instance
+ * @param reg a general purpose register for integers, an xmm register for reals
+ * @param symbol the variable
+ */
+void _jitLoad(Jit* jit, int reg, int symbol) {
+    bool real = jit->program->symbols[symbol].type == TYPE_REAL;
+    int cached = jit->registers[symbol];
+    if (cached != -1 && !(real && jit->realsSpilled)) {
+        if (cached != reg)
+            _jitRegister(jit, real ? 0x66 : 0, !real, real ? 0x0f28 : 0x8b, reg, cached);  // movapd, mov
+        return;
+    }
+
+    int base;
+    long disp;
+    _jitHome(jit, symbol, &base, &disp);
+    _jitMemory(jit, real ? 0xf2 : 0, !real, real ? 0x0f10 : 0x8b, reg, base, disp);  // movsd, mov
+}
+
+/**
+ * @brief Stores a register in a variable
+ *
+ * @param jit a Jit instance
+ * @param reg a general purpose register for integers, an xmm register for reals
+ * @param symbol the variable
+ */
+void _jitStore(Jit* jit, int reg, int symbol) {
+    bool real = jit->program->symbols[symbol].type == TYPE_REAL;
+    int cached = jit->registers[symbol];
+    if (cached != -1 && !(real && jit->realsSpilled)) {
+        if (cached != reg)
+            _jitRegister(jit, real ? 0x66 : 0, !real, real ? 0x0f28 : 0x8b, cached, reg);  // movapd, mov
+        return;
+    }
+
+    int base;
+    long disp;
+    _jitHome(jit, symbol, &base, &disp);
+    _jitMemory(jit, real ? 0xf2 : 0, !real, real ? 0x0f11 : 0x89, reg, base, disp);  // movsd, mov
+}
+
+/**
+ * @brief Reserves a temporary slot of the frame, released by decrementing jit->slots
+ *
+ * @param jit a Jit instance
+ * @return int the slot, at rbp - 8 * (slot + 1)
+ */
+int _jitSlot(Jit* jit) {
+    if (++jit->slots > jit->maxSlots)
+        jit->maxSlots = jit->slots;
+    return jit->slots - 1;
+}
+
+/**
+ * @brief Generates a command
+ *
+ * @param jit a Jit instance
+ * @param node the command (NO_NODE is an empty command)
+ */
+void _jitCommand(Jit* jit, int node) {
+    if (node == NO_NODE)
+        return;
+    const Node* n = &jit->program->nodes[node];
+
+    switch (n->kind) {
+        case NODE_BLOCK:
+            for (int command = n->a; command != NO_NODE; command = jit->program->nodes[command].next)
+                _jitCommand(jit, command);
+            break;
+
+        case NODE_ASSIGN:
+            _jitAssign(jit, node);
+            break;
+
+        case NODE_CALL:
+            _jitProcedureCall(jit, node);
+            break;
+
+        case NODE_READ:
+        case NODE_WRITE:
+            _jitReadWrite(jit, node);
+            break;
+
+        case NODE_IF: {
+            int otherwise = _jitLabel(jit);
+            int end = (n->c == NO_NODE) ? otherwise : _jitLabel(jit);
+            _jitCondition(jit, n->a, otherwise, false);
+            _jitCommand(jit, n->b);
+            if (n->c != NO_NODE) {
+                _jitJump(jit, -1, end);
+                _jitBind(jit, otherwise);
+                _jitCommand(jit, n->c);
+            }
+            _jitBind(jit, end);
+            break;
+        }
+
+        case NODE_WHILE: {  // the test is at the bottom
+            int test = _jitLabel(jit);
+            int top = _jitLabel(jit);
+            _jitJump(jit, -1, test);
+            _jitBind(jit, top);
+            if (jit->sandbox)
+                _jitTick(jit, RUNTIME_WHERE(n->line, n->col), false);
+            _jitCommand(jit, n->b);
+            _jitBind(jit, test);
+            _jitCondition(jit, n->a, top, true);
+            break;
+        }
+
+        case NODE_FOR:
+            _jitFor(jit, node);
+            break;
+    }
+}
+
+/**
+ * @brief Generates an assignment. x := x + y and x := x - y are done in the register of x.
+ *
+ * @param jit a Jit instance
+ * @param node the NODE_ASSIGN
+ */
+void _jitAssign(Jit* jit, int node) {
+    const Node* n = &jit->program->nodes[node];
+    const Node* value = &jit->program->nodes[n->a];
+    int reg = jit->registers[n->symbol];
+    if (n->type == TYPE_INTEGER && reg != -1 && (value->kind == NODE_ADD || value->kind == NODE_SUBTRACT) &&
+        jit->program->nodes[value->a].kind == NODE_VARIABLE && jit->program->nodes[value->a].symbol == n->symbol &&
+        _jitIntegerOperand(jit, (value->kind == NODE_ADD) ? ALU_ADD : ALU_SUBTRACT, reg, value->b))
+        return;
+
+    _jitExpression(jit, n->a);
+    _jitStore(jit, REG_RAX, n->symbol);  // rax or xmm0
+}
+
+/**
+ * @brief Generates a for loop. The final value is computed once, the variable goes up to it.
+ *
+ * @param jit a Jit instance
+ * @param node the NODE_FOR
+ */
+void _jitFor(Jit* jit, int node) {
+    const Node* n = &jit->program->nodes[node];
+    int slot = -1;  // the final value is a constant
+    if (!_jitSimple(jit, n->b) || jit->program->nodes[n->b].kind != NODE_NUMBER) {
+        _jitExpression(jit, n->b);
+        slot = _jitSlot(jit);
+        _jitMemory(jit, 0, true, 0x89, REG_RAX, REG_RBP, -8l * (slot + 1));
+    }
+    _jitExpression(jit, n->a);
+    _jitStore(jit, REG_RAX, n->symbol);
+
+    int next = _jitLabel(jit);
+    int body = _jitLabel(jit);
+    int end = _jitLabel(jit);
+    _jitForTest(jit, node, slot);
+    _jitJump(jit, 0xf, end);  // jg
+    _jitJump(jit, -1, body);
+    _jitBind(jit, next);
+    if (jit->sandbox)
+        _jitTick(jit, RUNTIME_WHERE(n->line, n->col), false);
+    int reg = jit->registers[n->symbol];
+    if (reg != -1) {
+        _jitRegister(jit, 0, true, 0x83, 0, reg);  // add reg, 1
+    } else {
+        int base;
+        long disp;
+        _jitHome(jit, n->symbol, &base, &disp);
+        _jitMemory(jit, 0, true, 0x83, 0, base, disp);  // add qword [home], 1
+    }
+    _jitByte(jit, 1);
+    _jitBind(jit, body);
+    _jitCommand(jit, n->c);
+    _jitForTest(jit, node, slot);
+    _jitJump(jit, 0xc, next);  // jl
+    _jitBind(jit, end);
+
+    if (slot != -1)
+        jit->slots--;
+}
+
+/**
+ * @brief Compares the variable of a for loop with its final value
+ *
+ * @param jit a Jit instance
+ * @param node the NODE_FOR
+ * @param slot slot of the final value, -1 if it is a constant
+ */
+void _jitForTest(Jit* jit, int node, int slot) {
+    const Node* n = &jit->program->nodes[node];
+    int reg = jit->registers[n->symbol];
+    if (reg == -1) {
+        _jitLoad(jit, REG_RAX, n->symbol);
+        reg = REG_RAX;
+    }
+    if (slot == -1)
+        _jitIntegerOperand(jit, ALU_COMPARE, reg, n->b);
+    else
+        _jitMemory(jit, 0, true, 0x3b, reg, REG_RBP, -8l * (slot + 1));  // cmp reg, [slot]
+}
+
+/**
+ * @brief Generates a procedure call: the arguments are stored in a 16-byte aligned area below
+ * the frame, the cached variables the callee could see or clobber are stored around the call
+ *
+ * @param jit a Jit instance
+ * @param node the NODE_CALL
+ */
+void _jitProcedureCall(Jit* jit, int node) {
+    const Program* program = jit->program;
+    const Node* n = &program->nodes[node];
+    int procedure = program->symbols[n->symbol].index;
+    long size = (8l * program->procedures[procedure].parameterCount + 15) & ~15l;
+
+    if (size > 0) {
+        _jitRegister(jit, 0, true, 0x81, 5, REG_RSP);  // sub rsp, size
+        _jitInt32(jit, size);
+    }
+    long disp = 0;
+    for (int argument = n->a; argument != NO_NODE; argument = program->nodes[argument].next, disp += 8) {
+        _jitExpression(jit, argument);
+        if (program->nodes[argument].type == TYPE_INTEGER)
+            _jitMemory(jit, 0, true, 0x89, REG_RAX, REG_RSP, disp);
+        else
+            _jitMemory(jit, 0xf2, false, 0x0f11, 0, REG_RSP, disp);  // movsd [rsp + disp], xmm0
+    }
+
+    int all = SPILL_INTEGER_GLOBALS | SPILL_REAL_GLOBALS | SPILL_REAL_LOCALS;
+    _jitSpill(jit, all);
+    _jitCall(jit, procedure);
+    if (size > 0) {
+        _jitRegister(jit, 0, true, 0x81, 0, REG_RSP);  // add rsp, size
+        _jitInt32(jit, size);
+    }
+    _jitReload(jit, all);
+}
+
+/**
+ * @brief Generates read or write, a call of the runtime for each item. The cached reals are in
+ * memory during the command since the runtime clobbers the xmm registers.
+ *
+ * @param jit a Jit instance
+ * @param node the NODE_READ or NODE_WRITE
+ */
+void _jitReadWrite(Jit* jit, int node) {
+    const Program* program = jit->program;
+    const Node* n = &program->nodes[node];
+    long where = RUNTIME_WHERE(n->line, n->col);
+
+    _jitSpill(jit, SPILL_REAL_GLOBALS | SPILL_REAL_LOCALS);
+    for (int item = n->a; item != NO_NODE; item = program->nodes[item].next) {
+        const Node* value = &program->nodes[item];
+        bool real = value->type == TYPE_REAL;
+        if (n->kind == NODE_READ) {
+            _jitMemory(jit, 0, true, 0x8b, REG_RDI, REG_RBX, 0);  // the runtime
+            _jitImmediate(jit, REG_RSI, where);
+            _jitCallRuntime(jit, real ? (const void*)runtimeReadReal : (const void*)runtimeReadInteger);
+            _jitStore(jit, REG_RAX, value->symbol);  // rax or xmm0
+            continue;
+        }
+
+        int separator = (value->next == NO_NODE) ? '\n' : ' ';
+        if (real) {
+            _jitExpression(jit, item);  // xmm0
+            _jitImmediate(jit, REG_RSI, separator);
+        } else {
+            if (value->kind == NODE_NUMBER)
+                _jitImmediate(jit, REG_RSI, value->value.integer);
+            else
+                _jitLoad(jit, REG_RSI, value->symbol);
+            _jitImmediate(jit, REG_RDX, separator);
+        }
+        _jitMemory(jit, 0, true, 0x8b, REG_RDI, REG_RBX, 0);
+        _jitCallRuntime(jit, real ? (const void*)runtimeWriteReal : (const void*)runtimeWriteInteger);
+    }
+    _jitReload(jit, SPILL_REAL_GLOBALS | SPILL_REAL_LOCALS);
+}
+
+/**
+ * @brief Generates a jump taken when a condition has a given value
+ *
+ * @param jit a Jit instance
+ * @param node the NODE_COMPARE
+ * @param label the target
+ * @param when whether the jump is taken when the condition is true or false
+ */
+void _jitCondition(Jit* jit, int node, int label, bool when) {
+    // jcc condition codes of each RELATION_OP, the opposite condition is code ^ 1
+    static const int integerConditions[] = {0x4, 0x5, 0xc, 0xe, 0xf, 0xd};  // e, ne, l, le, g, ge
+
+    const Node* n = &jit->program->nodes[node];
+    if (jit->program->nodes[n->a].type == TYPE_INTEGER) {
+        _jitIntegerBinary(jit, ALU_COMPARE, n->a, n->b, false);
+        _jitJump(jit, integerConditions[(int)n->op] ^ !when, label);
+        return;
+    }
+
+    // ucomisd: unordered (NaN) operands set ZF, PF and CF, so only <> is true for them
+    int right = _jitRealBinary(jit, n->a, n->b, false, false);
+    switch (n->op) {
+        case RELATION_LESS:
+        case RELATION_LESS_EQUAL:  // right > left, right >= left
+            _jitRegister(jit, 0x66, false, 0x0f2e, right, 0);
+            _jitJump(jit, ((n->op == RELATION_LESS) ? 0x7 : 0x3) ^ !when, label);  // ja, jae
+            break;
+        case RELATION_GREATER:
+        case RELATION_GREATER_EQUAL:
+            _jitRegister(jit, 0x66, false, 0x0f2e, 0, right);
+            _jitJump(jit, ((n->op == RELATION_GREATER) ? 0x7 : 0x3) ^ !when, label);
+            break;
+        default:
+            _jitRegister(jit, 0x66, false, 0x0f2e, 0, right);
+            if ((n->op == RELATION_EQUAL) == when) {  // jump if equal and ordered
+                int skip = _jitLabel(jit);
+                _jitJump(jit, 0xa, skip);  // jp
+                _jitJump(jit, 0x4, label);  // je
+                _jitBind(jit, skip);
+            } else {
+                _jitJump(jit, 0xa, label);
+                _jitJump(jit, 0x5, label);  // jne
+            }
+    }
+}
+
+/**
+ * @brief Generates an expression, leaving its value in rax (integers) or xmm0 (reals). The
+ * operations whose code starts with their first operand are pushed on a stack down to the first
+ * one that doesn't, and generated back up, so that long expressions don't nest calls
+ *
+ * @param jit a Jit instance
+ * @param node the expression
+ */
+void _jitExpression(Jit* jit, int node) {
+    const Program* program = jit->program;
+    int base = jit->chainSize;
+    for (; _jitChained(jit, node); node = program->nodes[node].a)
+        _jitPush(jit, node);
+    _jitOperation(jit, node, false);
+    while (jit->chainSize > base)
+        _jitOperation(jit, jit->chain[--jit->chainSize], true);
+}
+
+/**
+ * @brief Tells whether the code of an operation starts with the code of its first operand, when
+ * that operand isn't simple
+ *
+ * @param jit a Jit instance
+ * @param node the expression
+ * @return true if the first operand is generated first and nests
+ * @return false otherwise
+ */
+bool _jitChained(const Jit* jit, int node) {
+    const Node* n = &jit->program->nodes[node];
+    switch (n->kind) {
+        case NODE_NUMBER:
+        case NODE_VARIABLE:
+            return false;
+        case NODE_NEGATE:
+            return true;
+        case NODE_TO_REAL:
+            return jit->program->nodes[n->a].kind != NODE_VARIABLE;
+        default:  // binary operations generate a simple first operand last or in place
+            return !_jitSimple(jit, n->a);
+    }
+}
+
+/**
+ * @brief Generates an operation of an expression, leaving its value in rax (integers) or xmm0
+ * (reals)
+ *
+ * @param jit a Jit instance
+ * @param node the expression
+ * @param evaluated whether its first operand is already in rax or xmm0 (see _jitChained)
+ */
+void _jitOperation(Jit* jit, int node, bool evaluated) {
+    // opcodes of addsd, subsd, mulsd and divsd, by NODE_KIND from NODE_ADD
+    static const int realOpcodes[] = {0x0f58, 0x0f5c, 0x0f59, 0x0f5e};
+
+    const Node* n = &jit->program->nodes[node];
+    bool real = n->type == TYPE_REAL;
+    switch (n->kind) {
+        case NODE_NUMBER:
+            if (real)
+                _jitRealImmediate(jit, 0, n->value.real);
+            else
+                _jitImmediate(jit, REG_RAX, n->value.integer);
+            break;
+
+        case NODE_VARIABLE:
+            _jitLoad(jit, REG_RAX, n->symbol);  // rax or xmm0
+            break;
+
+        case NODE_NEGATE:
+            if (!evaluated)
+                _jitExpression(jit, n->a);
+            if (real) {
+                _jitImmediate(jit, REG_RAX, JIT_SIGN_MASK);
+                _jitRegister(jit, 0x66, true, 0x0f6e, 1, REG_RAX);  // movq xmm1, rax
+                _jitRegister(jit, 0x66, false, 0x0f57, 0, 1);       // xorpd xmm0, xmm1
+            } else {
+                _jitRegister(jit, 0, true, 0xf7, 3, REG_RAX);  // neg rax
+            }
+            break;
+
+        case NODE_TO_REAL: {
+            const Node* value = &jit->program->nodes[n->a];
+            if (value->kind == NODE_VARIABLE && jit->registers[value->symbol] == -1) {
+                int base;
+                long disp;
+                _jitHome(jit, value->symbol, &base, &disp);
+                _jitRegister(jit, 0x66, false, 0x0fef, 0, 0);  // pxor breaks the dependency on xmm0
+                _jitMemory(jit, 0xf2, true, 0x0f2a, 0, base, disp);  // cvtsi2sd xmm0, [home]
+                break;
+            }
+            int reg = REG_RAX;
+            if (value->kind == NODE_VARIABLE)
+                reg = jit->registers[value->symbol];
+            else if (!evaluated)
+                _jitExpression(jit, n->a);
+            _jitRegister(jit, 0x66, false, 0x0fef, 0, 0);
+            _jitRegister(jit, 0xf2, true, 0x0f2a, 0, reg);  // cvtsi2sd xmm0, reg
+            break;
+        }
+
+        case NODE_ADD:
+        case NODE_SUBTRACT:
+        case NODE_MULTIPLY:
+            if (real) {
+                int right = _jitRealBinary(jit, n->a, n->b, n->kind != NODE_SUBTRACT, evaluated);
+                _jitRegister(jit, 0xf2, false, realOpcodes[n->kind - NODE_ADD], 0, right);
+            } else {
+                _jitIntegerBinary(jit, (n->kind == NODE_ADD) ? ALU_ADD : (n->kind == NODE_SUBTRACT) ? ALU_SUBTRACT : ALU_MULTIPLY,
+                                  n->a, n->b, evaluated);
+            }
+            break;
+
+        case NODE_DIVIDE:
+            if (real) {
+                int right = _jitRealBinary(jit, n->a, n->b, false, evaluated);
+                _jitRegister(jit, 0xf2, false, realOpcodes[NODE_DIVIDE - NODE_ADD], 0, right);
+            } else {
+                _jitDivide(jit, node, evaluated);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Tells whether an expression can be used in place as the second operand of an
+ * instruction: a variable or a constant (integers that fit 32 bits)
+ *
+ * @param jit a Jit instance
+ * @param node the expression
+ * @return true if it is simple
+ * @return false otherwise
+ */
+bool _jitSimple(const Jit* jit, int node) {
+    const Node* n = &jit->program->nodes[node];
+    if (n->kind == NODE_VARIABLE)
+        return true;
+    if (n->kind != NODE_NUMBER)
+        return false;
+    return n->type == TYPE_REAL || (n->value.integer >= -0x80000000l && n->value.integer <= 0x7fffffffl);
+}
+
+/**
+ * @brief Generates reg = reg op node for a simple integer node
+ *
+ * @param jit a Jit instance
+ * @param alu JIT_ALU
+ * @param reg the first operand and destination
+ * @param node the second operand
+ * @return true if the instruction was generated
+ * @return false if node isn't simple
+ */
+bool _jitIntegerOperand(Jit* jit, int alu, int reg, int node) {
+    // opcodes with a register or memory operand, and extensions of 0x81 (imm32) and 0x83 (imm8)
+    static const int opcodes[] = {0x03, 0x2b, 0x0faf, 0x3b, 0x8b};
+    static const int extensions[] = {0, 5, 0, 7, 0};
+
+    if (!_jitSimple(jit, node))
+        return false;
+    const Node* n = &jit->program->nodes[node];
+    if (n->kind == NODE_VARIABLE) {
+        int cached = jit->registers[n->symbol];
+        if (cached != -1) {
+            _jitRegister(jit, 0, true, opcodes[alu], reg, cached);
+        } else {
+            int base;
+            long disp;
+            _jitHome(jit, n->symbol, &base, &disp);
+            _jitMemory(jit, 0, true, opcodes[alu], reg, base, disp);
+        }
+        return true;
+    }
+
+    long value = n->value.integer;
+    bool small = value >= -128 && value < 128;
+    if (alu == ALU_MOVE) {
+        _jitImmediate(jit, reg, value);
+    } else if (alu == ALU_COMPARE && value == 0) {
+        _jitRegister(jit, 0, true, 0x85, reg, reg);  // test reg, reg
+    } else if (alu == ALU_MULTIPLY) {
+        _jitRegister(jit, 0, true, small ? 0x6b : 0x69, reg, reg);  // imul reg, reg, imm
+        if (small)
+            _jitByte(jit, (int)(value & 0xff));
+        else
+            _jitInt32(jit, value);
+    } else {
+        _jitRegister(jit, 0, true, small ? 0x83 : 0x81, extensions[alu], reg);
+        if (small)
+            _jitByte(jit, (int)(value & 0xff));
+        else
+            _jitInt32(jit, value);
+    }
+    return true;
+}
+
+/**
+ * @brief Generates rax = left op right (or only the flags of the comparison)
+ *
+ * @param jit a Jit instance
+ * @param alu ALU_ADD, ALU_SUBTRACT, ALU_MULTIPLY or ALU_COMPARE
+ * @param left left operand
+ * @param right right operand
+ * @param evaluated whether the left operand, not simple, is already in rax
+ */
+void _jitIntegerBinary(Jit* jit, int alu, int left, int right, bool evaluated) {
+    static const int opcodes[] = {0x03, 0x2b, 0x0faf, 0x3b};
+
+    if (_jitSimple(jit, right)) {
+        if (!evaluated)
+            _jitExpression(jit, left);
+        _jitIntegerOperand(jit, alu, REG_RAX, right);
+        return;
+    }
+    if (_jitSimple(jit, left) && (alu == ALU_ADD || alu == ALU_MULTIPLY)) {
+        _jitExpression(jit, right);
+        _jitIntegerOperand(jit, alu, REG_RAX, left);
+        return;
+    }
+
+    if (_jitSimple(jit, left)) {
+        _jitExpression(jit, right);
+        _jitRegister(jit, 0, true, 0x8b, REG_RCX, REG_RAX);
+        _jitExpression(jit, left);
+    } else {
+        if (!evaluated)
+            _jitExpression(jit, left);
+        _jitByte(jit, 0x50);  // push rax
+        _jitExpression(jit, right);
+        _jitRegister(jit, 0, true, 0x8b, REG_RCX, REG_RAX);
+        _jitByte(jit, 0x58);  // pop rax
+    }
+    _jitRegister(jit, 0, true, opcodes[alu], REG_RAX, REG_RCX);
+}
+
+/**
+ * @brief Generates the truncated division of two integers. A zero divisor is a runtime error, -1
+ * is a negation (idiv would trap on the smallest integer), positive powers of 2 are shifts.
+ *
+ * @param jit a Jit instance
+ * @param node the NODE_DIVIDE
+ * @param evaluated whether its left operand, not simple, is already in rax
+ */
+void _jitDivide(Jit* jit, int node, bool evaluated) {
+    const Node* n = &jit->program->nodes[node];
+    const Node* right = &jit->program->nodes[n->b];
+
+    if (right->kind == NODE_NUMBER) {
+        long divisor = right->value.integer;
+        if (!evaluated)
+            _jitExpression(jit, n->a);
+        if (divisor == 0) {
+            _jitJump(jit, -1, _jitStub(jit, RUNTIME_DIVISION_BY_ZERO, RUNTIME_WHERE(n->line, n->col)));
+        } else if (divisor == -1) {
+            _jitRegister(jit, 0, true, 0xf7, 3, REG_RAX);  // neg rax
+        } else if (divisor > 1 && !(divisor & (divisor - 1))) {
+            int shift = __builtin_ctzl((unsigned long)divisor);
+            // negative dividends are biased by divisor - 1 so that the shift truncates toward 0
+            _jitRegister(jit, 0, true, 0x8b, REG_RDX, REG_RAX);  // mov rdx, rax
+            _jitRegister(jit, 0, true, 0xc1, 7, REG_RDX);        // sar rdx, 63
+            _jitByte(jit, 63);
+            _jitRegister(jit, 0, true, 0xc1, 5, REG_RDX);  // shr rdx, 64 - shift
+            _jitByte(jit, 64 - shift);
+            _jitRegister(jit, 0, true, 0x03, REG_RAX, REG_RDX);  // add rax, rdx
+            _jitRegister(jit, 0, true, 0xc1, 7, REG_RAX);        // sar rax, shift
+            _jitByte(jit, shift);
+        } else if (divisor != 1) {
+            _jitImmediate(jit, REG_RCX, divisor);
+            _jitByte(jit, 0x48);  // cqo
+            _jitByte(jit, 0x99);
+            _jitRegister(jit, 0, true, 0xf7, 7, REG_RCX);  // idiv rcx
+        }
+        return;
+    }
+
+    if (_jitSimple(jit, n->b)) {
+        if (!evaluated)
+            _jitExpression(jit, n->a);
+        _jitIntegerOperand(jit, ALU_MOVE, REG_RCX, n->b);
+    } else if (_jitSimple(jit, n->a)) {
+        _jitExpression(jit, n->b);
+        _jitRegister(jit, 0, true, 0x8b, REG_RCX, REG_RAX);
+        _jitExpression(jit, n->a);
+    } else {
+        if (!evaluated)
+            _jitExpression(jit, n->a);
+        _jitByte(jit, 0x50);
+        _jitExpression(jit, n->b);
+        _jitRegister(jit, 0, true, 0x8b, REG_RCX, REG_RAX);
+        _jitByte(jit, 0x58);
+    }
+
+    int stub = _jitStub(jit, RUNTIME_DIVISION_BY_ZERO, RUNTIME_WHERE(n->line, n->col));
+    int negate = _jitLabel(jit);
+    int end = _jitLabel(jit);
+    _jitRegister(jit, 0, true, 0x85, REG_RCX, REG_RCX);  // test rcx, rcx
+    _jitJump(jit, 0x4, stub);                             // je
+    _jitRegister(jit, 0, true, 0x83, 7, REG_RCX);         // cmp rcx, -1
+    _jitByte(jit, 0xff);
+    _jitJump(jit, 0x4, negate);
+    _jitByte(jit, 0x48);  // cqo
+    _jitByte(jit, 0x99);
+    _jitRegister(jit, 0, true, 0xf7, 7, REG_RCX);  // idiv rcx
+    _jitJump(jit, -1, end);
+    _jitBind(jit, negate);
+    _jitRegister(jit, 0, true, 0xf7, 3, REG_RAX);
+    _jitBind(jit, end);
+}
+
+/**
+ * @brief Evaluates the operands of a real operation: the left one in xmm0, the right one in a
+ * register returned (xmm1 or the register of a cached variable). Commutative operations with a
+ * simple left operand may get the operands swapped.
+ *
+ * @param jit a Jit instance
+ * @param left left operand
+ * @param right right operand
+ * @param commutative whether the operands can be swapped
+ * @param evaluated whether the left operand, not simple, is already in xmm0
+ * @return int the xmm register of the right operand
+ */
+int _jitRealBinary(Jit* jit, int left, int right, bool commutative, bool evaluated) {
+    if (!_jitSimple(jit, right) && _jitSimple(jit, left) && commutative) {
+        int swap = left;
+        left = right;
+        right = swap;
+    }
+
+    if (_jitSimple(jit, right)) {
+        if (!evaluated)
+            _jitExpression(jit, left);
+        const Node* n = &jit->program->nodes[right];
+        if (n->kind == NODE_VARIABLE && jit->registers[n->symbol] != -1 && !jit->realsSpilled)
+            return jit->registers[n->symbol];
+        if (n->kind == NODE_VARIABLE)
+            _jitLoad(jit, 1, n->symbol);
+        else
+            _jitRealImmediate(jit, 1, n->value.real);
+        return 1;
+    }
+
+    if (_jitSimple(jit, left)) {
+        _jitExpression(jit, right);
+        _jitRegister(jit, 0x66, false, 0x0f28, 1, 0);  // movapd xmm1, xmm0
+        _jitExpression(jit, left);
+    } else {
+        if (!evaluated)
+            _jitExpression(jit, left);
+        _jitRegister(jit, 0, true, 0x83, 5, REG_RSP);  // sub rsp, 8
+        _jitByte(jit, 8);
+        _jitMemory(jit, 0xf2, false, 0x0f11, 0, REG_RSP, 0);  // movsd [rsp], xmm0
+        _jitExpression(jit, right);
+        _jitRegister(jit, 0x66, false, 0x0f28, 1, 0);
+        _jitMemory(jit, 0xf2, false, 0x0f10, 0, REG_RSP, 0);  // movsd xmm0, [rsp]
+        _jitRegister(jit, 0, true, 0x83, 0, REG_RSP);         // add rsp, 8
+        _jitByte(jit, 8);
+    }
+    return 1;
+}
+
+#else
+
+/**
+ * @brief Code generation isn't available on this host
+ *
+ * @param jit a Jit instance
+ * @param program a program
+ * @param sandbox whether the code checks the limits of the runtime
+ * @return true always
+ */
+bool jitCompile(Jit* jit, const Program* program, bool sandbox) {
+    (void)sandbox;
+    memset(jit, 0, sizeof(Jit));
+    jit->program = program;
+    printf("Error: --run needs an x86-64 host\n");
+    return true;
+}
+
+/**
+ * @brief Code generation isn't available on this host
+ *
+ * @param jit a Jit instance
+ * @param runtime a runtime
+ * @return int RUNTIME_OK
+ */
+int jitRun(Jit* jit, Runtime* runtime) {
+    (void)jit;
+    return runtime->status;
+}
+
+/**
+ * @brief Deallocates a Jit instance
+ *
+ * @param jit a Jit instance
+ */
+void jitDestroy(Jit* jit) {
+    memset(jit, 0, sizeof(Jit));
+}
+
+#endif
@@ -6,34 +6,45 @@
 
 #include <ctype.h>
 #include <stdbool.h>
-#include <string.h>
+
+#include "../header/number.h"
+#include "../header/profile.h"
 
 /**
  * @brief Builds structures needed for lexer operation.
  *
  * @param lexer a lexer instance
+ * @param sourceFilePath P-- source code file path, "-" for stdin (NULL if tokens are loaded by a token stream)
+ * @param tokenOutputPath file where the recognized tokens are dumped (NULL disables the dump)
  * @return true if there was some error
  * @return false if there was no error
  */
-bool lexerInit(Lexer* lexer, const char* sourceFilePath) {
+bool lexerInit(Lexer* lexer, const char* sourceFilePath, const char* tokenOutputPath) {
     lexer->currState = 0;
-    lexer->currLine = 1;
-    lexer->currCol = 1;
+    lexer->tokenStart = 0;
     lexer->tokenClass = 0;
+    lexer->automaton = AUTOMATON_DIRECT;
     lexer->lastWasNumberOrIdent = false;
+    lexer->tokenOutput = NULL;
     stringInit(&lexer->buffer);
-
-    // open P-- source code file
-    lexer->sourceCode = fopen(sourceFilePath, "r");
-    if (lexer->sourceCode == NULL) {
-        printf("Error: no such file\n");
-        return true;
+    stringInit(&lexer->tokenDump);
+
+    // open P-- source code file (there is none when tokens are read from a serialized stream)
+    inputOpenBuffer(&lexer->sourceCode, NULL, 0);
+    if (sourceFilePath != NULL) {
+        if (inputOpen(&lexer->sourceCode, sourceFilePath)) {
+            printf("Error: no such file\n");
+            return true;
+        }
     }
 
-    lexer->tokenOutput = fopen("tokenOutput.txt", "w");
-    if (lexer->sourceCode == NULL) {
-        printf("Error: couldn't create tokenOutput file\n");
-        return true;
+    if (tokenOutputPath != NULL) {
+        lexer->tokenOutput = fopen(tokenOutputPath, "w");
+        if (lexer->tokenOutput == NULL) {
+            printf("Error: couldn't create tokenOutput file\n");
+            return true;
+        }
+        _stringExpand(&lexer->tokenDump, TOKEN_DUMP_BUFFER_SIZE + 1);
     }
 
     _buildTransitionMatrix(lexer->transitionMatrix);
@@ -44,249 +55,110 @@ bool lexerInit(Lexer* lexer, const char* sourceFilePath) {
     return false;
 }
 
+/**
+ * @brief Builds structures needed for lexer operation on an in-memory source code. No file is
+ * read or written.
+ *
+ * @param lexer a lexer instance
+ * @param source P-- source code, it must outlive the lexer
+ * @param size size of the source code in bytes
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool lexerInitBuffer(Lexer* lexer, const char* source, unsigned long size) {
+    if (lexerInit(lexer, NULL, NULL))
+        return true;
+
+    inputOpenBuffer(&lexer->sourceCode, source, size);
+    return false;
+}
+
 /**
  * @brief Destroy file handles and the buffer
  *
  * @param lexer A lexer instance
  */
 void lexerDestroy(Lexer* lexer) {
-    fclose(lexer->sourceCode);
-    fclose(lexer->tokenOutput);
+    inputClose(&lexer->sourceCode);
+    if (lexer->tokenOutput != NULL) {
+        _flushTokenDump(lexer);
+        fclose(lexer->tokenOutput);
+    }
     stringDestroy(&lexer->buffer);
+    stringDestroy(&lexer->tokenDump);
 }
 
 /**
- * @brief Gets next token from P-- source code file
+ * @brief Gets next token from P-- source code file. Invalid tokens are recorded and skipped in
+ * a loop, so a long run of lexer errors doesn't grow the call stack.
  *
  * @param lexer lexer instance
- * @param output file to output errors
+ * @param diagnostics diagnostics where errors are recorded
+ * @return int number of lexer errors found before the token
  */
-int nextToken(Lexer* lexer, FILE* output) {
-    // initial state
-    lexer->currState = 0;
+int nextToken(Lexer* lexer, Diagnostics* diagnostics) {
+    int errors = 0;
 
-    // Cleaning the buffer
-    stringOverwrite(&lexer->buffer, "", 0);
+    while (true) {
+        // initial state
+        lexer->currState = 0;
 
-    while (!lexer->finalState[lexer->currState]) {  // while the automaton hasn't reached a final state
+        // Cleaning the buffer
+        stringOverwrite(&lexer->buffer, "", 0);
 
-        _nextChar(lexer);  // read char from file
-        if (lexer->fscanfFlag == EOF) {
+        bool eof = (lexer->automaton == AUTOMATON_DIRECT) ? _scanDirectCoded(lexer) : _scanWithTable(lexer);
+        if (eof) {
             _dealWithEOF(lexer);
-            return 0;
+            return errors + _numberError(lexer, diagnostics);
         }
-        _nextState(lexer);
+        _identifyTokenClass(lexer);
 
-        // Only append to the buffer if:
-        // - Is an error (to show to the user)
-        // - We're a not at the initial state or at a comment (state 31) (to avoid '\n' '\t' and such)
-        // and we won't retreat (to avoid showing twice)
-        if (lexer->finalStateClass[lexer->currState] == -ERROR ||
-            (lexer->currState != 0 && lexer->currState != COMMENT_STATE && lexer->finalStateClass[lexer->currState] >= 0)) {
-            stringAppendChar(&lexer->buffer, lexer->currChar);
-        }
-    }
-    _identifyTokenClass(lexer);
-
-    if (lexer->tokenClass == ERROR) {
-        printf("Lexer error on line %d col %d ('%s'): %s\n", lexer->currLine, lexerCurrColWithoutRetreat(lexer), lexer->buffer.str, lexerErrorMessage(lexer->currState));
-        fprintf(output, "Lexer error on line %d col %d ('%s'): %s\n", lexer->currLine, lexerCurrColWithoutRetreat(lexer), lexer->buffer.str, lexerErrorMessage(lexer->currState));
-        return nextToken(lexer, output) + 1;
-    } else if (lexer->tokenClass == LAMBDA) {
-        printf("EOF\n");
-        fprintf(output, "EOF\n");
-    } else {
-        fprintf(lexer->tokenOutput, "%s, %s\n", lexer->buffer.str, lexerTokenClassName(lexer->tokenClass));
-    }
-    return 0;
-}
+        if (lexer->tokenClass != ERROR)
+            break;
 
-/**
- * @brief The transitionMatrix[][] has NUMBER_OF_STATES lines (number of states) and NUMBER_OF_CHARS rows
- * (number of ASCII characters). An element 'transionMatrix[i][j]'
- * represents the new state the automaton must go next when it is in state
- * 'i' and reads the character of ASCII number 'j'.
- * If transionMatrix[i][j] == -1, we have an invalid transition.
- *
- * @param transitionMatrix the transition matrix
- */
-void _buildTransitionMatrix(int transitionMatrix[NUMBER_OF_STATES][NUMBER_OF_CHARS]) {
-    // invalid state by default
-    for (int i = 0; i < NUMBER_OF_STATES; i++)
-        for (int j = 0; j < NUMBER_OF_CHARS; j++)
-            transitionMatrix[i][j] = -1;
-
-    // IDENTIFIERS
-    _fillOther(transitionMatrix, 0, 3);  // invalid char
-    _fillOther(transitionMatrix, 1, 2);  // end of identifier
-    transitionMatrix[0]['_'] = 1;
-    transitionMatrix[1]['_'] = 1;
-    for (int i = 'a'; i <= 'z'; i++) {
-        transitionMatrix[0][i] = 1;
-        transitionMatrix[1][i] = 1;
-    }
-    for (int i = 'A'; i <= 'Z'; i++) {
-        transitionMatrix[0][i] = 1;
-        transitionMatrix[1][i] = 1;
-    }
-    for (int i = '0'; i <= '9'; i++)
-        transitionMatrix[1][i] = 1;
-
-    // NUMBERS
-    for (int i = '0'; i <= '9'; i++) {
-        transitionMatrix[0][i] = 4;  // integer part, first number
-        transitionMatrix[4][i] = 4;  // integer part, following numbers
-        transitionMatrix[6][i] = 8;  // first number after decimal place
-        transitionMatrix[8][i] = 8;  // following number after decimal place
-    }
-    transitionMatrix[4]['.'] = 6;
-    _fillOther(transitionMatrix, 4, 5);  // end of an int
-    _fillOther(transitionMatrix, 6, 7);  // error: decimal number without following number
-    _fillOther(transitionMatrix, 8, 9);  // end of a decimal number
-
-    // OPERANDS
-    transitionMatrix[0]['+'] = 10;
-    transitionMatrix[0]['-'] = 10;
-    transitionMatrix[0]['*'] = 11;
-    transitionMatrix[0]['/'] = 11;
-    transitionMatrix[0]['='] = 12;
-    transitionMatrix[0][':'] = 13;
-    transitionMatrix[13]['='] = 14;
-    transitionMatrix[0]['<'] = 16;
-    transitionMatrix[16]['='] = 18;
-    transitionMatrix[16]['>'] = 18;
-    transitionMatrix[0]['>'] = 20;
-    transitionMatrix[20]['='] = 22;
-    _fillOther(transitionMatrix, 13, 15);  // : Declare type
-    _fillOther(transitionMatrix, 16, 19);  // < Relation
-    _fillOther(transitionMatrix, 20, 21);  // > Relation
-
-    // MISCELLANEOUS
-    transitionMatrix[0][' '] = 0;
-    transitionMatrix[0]['\t'] = 0;
-    transitionMatrix[0]['\n'] = 0;
-    transitionMatrix[0][';'] = 24;
-    transitionMatrix[0][','] = 25;
-    transitionMatrix[0]['('] = 26;
-    transitionMatrix[0][')'] = 27;
-    transitionMatrix[0]['.'] = 28;
-    transitionMatrix[0]['{'] = 30;
-    transitionMatrix[30]['}'] = 0;
-    _fillOther(transitionMatrix, COMMENT_STATE, COMMENT_STATE);  // comment
-}
-
-/**
- * @brief Build a vector that identifies final states.
- *
- * @param finalState vector that identifies final states
- * @param finalStateClass vector that identifies to which token class each final state corresponds
- */
-void _buildFinalStates(bool finalState[NUMBER_OF_STATES], char finalStateClass[NUMBER_OF_STATES]) {
-    // list of states that aren't final
-    static const char notFinals[] = {0, 1, 4, 6, 8, 13, 16, 20, 30};
-    // list of final states
-    static const char finals[] = {2, 3, 5, 7, 9, 10, 11, 12, 14, 15, 17, 18, 19, 21, 22, 23, 24, 25, 26, 27, 28, 29, 31};
-    // list of token classes corresponding to each final state, negative values indicate that
-    // we must retreat on the source code file after such final state is reacheded
-    static const int stateClasses[] = {-ID, ERROR, -N_INTEGER, -ERROR, -N_REAL, OP_ADD, OP_MULT, RELATION, ASSIGN,
-                                       -DECLARE_TYPE, RELATION, RELATION, -RELATION, -RELATION, RELATION, OP_UN,
-                                       SEMICOLON, COLON, OPEN_PAR, CLOSE_PAR, DOT, EOF, ERROR};
-
-    // Mark not final states as ERROR by default
-    for (unsigned long i = 0; i < sizeof notFinals; i++) {
-        finalState[notFinals[i]] = 0;
-        finalStateClass[notFinals[i]] = ERROR;
+        SourcePosition position;
+        lexerTokenPosition(lexer, &position);
+        diagnosticsLexerError(diagnostics, &position, lexer->buffer.str, lexer->currState);
+        errors++;
     }
 
-    // mark final states appropriately
-    for (unsigned long i = 0; i < sizeof finals; i++) {
-        finalState[finals[i]] = 1;
-        finalStateClass[finals[i]] = stateClasses[i];
+    errors += _numberError(lexer, diagnostics);
+    if (lexer->tokenClass == LAMBDA) {
+        diagnosticsEOF(diagnostics);
+    } else if (lexer->tokenOutput != NULL) {
+        _dumpToken(lexer);
     }
+    return errors;
 }
 
 /**
- * @brief Builds protected symbol recognizer automaton transition matrix.
- * The protectedSymbolMatrix[][] has NUMBER_OF_STATES_PROTECTED_SYMBOLS lines (number of states)
- * and NUMBER_OF_CHARS rows (number of ASCII characters). An element 'protectedSymbolMatrix[i][j]'
- * represents the new state the automaton must go next when it is in state
- * 'i' and reads the character of ASCII number 'j'.
- * If protectedSymbolMatrix[i][j] == -1, we have an invalid transition.
+ * @brief Runs the automaton by interpreting the transition matrix, from the initial state until a
+ * final state or the end of the source code
  *
- * @param protectedSymbolMatrix
+ * @param lexer lexer instance, the buffer holds the token
+ * @return true if the end of the source code was reached before a final state
+ * @return false if a final state was reached
  */
-void _buildProtectedSymbolMatrix(int protectedSymbolMatrix[NUMBER_OF_STATES_PROTECTED_SYMBOLS][NUMBER_OF_LOWER_CASE_LETTERS]) {
-    // invalid state by default
-    for (int i = 0; i < NUMBER_OF_STATES_PROTECTED_SYMBOLS; i++)
-        for (int j = 0; j < NUMBER_OF_LOWER_CASE_LETTERS; j++)
-            protectedSymbolMatrix[i][j] = -1;
-
-    _fillWord(protectedSymbolMatrix, "begin", 0, 1);
-    _fillWord(protectedSymbolMatrix, "const", 0, 6);
-    _fillWord(protectedSymbolMatrix, "do", 0, 11);
-    _fillWord(protectedSymbolMatrix, "end", 0, 13);
-    _fillWord(protectedSymbolMatrix, "lse", 13, 16);        // else
-    _fillWord(protectedSymbolMatrix, "if", 0, 19);
-    _fillWord(protectedSymbolMatrix, "nteger", 19, 21);     // integer
-    _fillWord(protectedSymbolMatrix, "for", 0, 27);
-    _fillWord(protectedSymbolMatrix, "program", 0, 30);
-    _fillWord(protectedSymbolMatrix, "cedure", 32, 37);     // procedure
-    _fillWord(protectedSymbolMatrix, "real", 0, 43);
-    _fillWord(protectedSymbolMatrix, "d", 45, 47);          // read
-    _fillWord(protectedSymbolMatrix, "then", 0, 48);
-    _fillWord(protectedSymbolMatrix, "o", 48, 52);          // to
-    _fillWord(protectedSymbolMatrix, "var", 0, 53);
-    _fillWord(protectedSymbolMatrix, "write", 0, 56);
-    _fillWord(protectedSymbolMatrix, "hile", 56, 61);       // while
-}
-
-/**
- * @brief Build a vector that identifies final states regarding protected symbols.
- *
- * @param protectedSymbolFinalState vector that identifies final states token classes
- */
-void _buildProtectedSymbolFinalStates(char protectedSymbolFinalState[NUMBER_OF_STATES_PROTECTED_SYMBOLS]) {
-    // list of final states
-    static const char finals[] = {5, 10, 12, 15, 18, 20, 26, 29, 36, 42, 46, 47, 51, 52, 55, 60, 64};
-    // list of token classes (protected symbols) corresponding to final states
-    static const char classes[] = {BEGIN, CONST, DO, END, ELSE, IF, INTEGER, FOR, PROGRAM, PROCEDURE, REAL, READ, THEN, TO, VAR, WRITE, WHILE};
-
-    // invalid states correspond to IDs
-    for (int i = 0; i < NUMBER_OF_STATES_PROTECTED_SYMBOLS; i++)
-        protectedSymbolFinalState[i] = ID;
-    // mark final states
-    for (unsigned long i = 0; i < sizeof finals; i++)
-        protectedSymbolFinalState[finals[i]] = classes[i];
-}
-
-/**
- * @brief Auxiliary function used to fill the transition matrix. Fills in "other" transitions.
- *
- * @param transitionMatrix the transition matrix
- * @param startState the state where the 'other' transition starts
- * @param endState the state where the 'other' transition goes
- */
-void _fillOther(int transitionMatrix[NUMBER_OF_STATES][NUMBER_OF_CHARS], int startState, int endState) {
-    for (int i = 0; i < NUMBER_OF_CHARS; i++)
-        if (transitionMatrix[startState][i] == -1)
-            transitionMatrix[startState][i] = endState;
-}
+bool _scanWithTable(Lexer* lexer) {
+    while (!lexer->finalState[lexer->currState]) {  // while the automaton hasn't reached a final state
 
-/**
- * @brief Auxiliary function used to fill the protected symbol transition matrix. Given a protected symbol,
- * fills in the corresponding entries in the matrix.
- *
- * @param protectedSymbolMatrix the protected symbol matrix
- * @param word protected symbol
- * @param firstState state from where recognizition starts
- * @param secondState second state on word recognition flow
- */
-void _fillWord(int protectedSymbolMatrix[NUMBER_OF_STATES_PROTECTED_SYMBOLS][NUMBER_OF_LOWER_CASE_LETTERS], const char word[], int firstState, int secondState) {
-    protectedSymbolMatrix[firstState][word[0] - 'a'] = secondState;
+        if (lexer->sourceCode.head == lexer->sourceCode.tail)  // the ring buffer is about to be refilled
+            inputMark(&lexer->sourceCode, lexer->sourceCode.head - lexer->buffer.size);
+        _nextChar(lexer);  // read char from file
+        if (lexer->fscanfFlag == EOF)
+            return true;
+        _nextState(lexer);
 
-    for (unsigned long i = 1; i < strlen(word); i++, secondState++) {
-        protectedSymbolMatrix[secondState][word[i] - 'a'] = secondState + 1;
+        // Only append to the buffer if:
+        // - Is an error (to show to the user)
+        // - We're a not at the initial state or at a comment (state 31) (to avoid '\n' '\t' and such)
+        // and we won't retreat (to avoid showing twice)
+        if (lexer->finalStateClass[lexer->currState] == -ERROR ||
+            (lexer->currState != 0 && lexer->currState != COMMENT_STATE && lexer->finalStateClass[lexer->currState] >= 0)) {
+            stringAppendChar(&lexer->buffer, lexer->currChar);
+        }
     }
+    return false;
 }
 
 /**
@@ -296,10 +168,10 @@ void _fillWord(int protectedSymbolMatrix[NUMBER_OF_STATES_PROTECTED_SYMBOLS][NUM
  * @param lexer a lexer instance
  */
 void _nextChar(Lexer* lexer) {
-    lexer->fscanfFlag = fscanf(lexer->sourceCode, "%c", &lexer->currChar);
-    if (lexer->fscanfFlag != EOF) {
-        lexer->currLine += (lexer->currChar == '\n');
-        lexer->currCol = (lexer->currChar == '\n') ? 1 : lexer->currCol + 1 + (lexer->currChar == '\t') * 3;
+    int c = inputGetc(&lexer->sourceCode);
+    lexer->fscanfFlag = (c == EOF) ? EOF : 1;
+    if (c != EOF) {
+        lexer->currChar = (unsigned char)c;
     }
 }
 
@@ -312,6 +184,7 @@ void _nextChar(Lexer* lexer) {
  * @param lexer a lexer instance
  */
 void _dealWithEOF(Lexer* lexer) {
+    lexer->tokenStart = lexer->sourceCode.head - lexer->buffer.size;
     if (lexer->currState == 0) {  // EOF is recognized only from a0
         lexer->tokenClass = LAMBDA;
     } else if (lexer->currState == COMMENT_STATE) {  // EOF inside a comment, error
@@ -322,7 +195,7 @@ void _dealWithEOF(Lexer* lexer) {
         lexer->currState = lexer->transitionMatrix[lexer->currState]['@'];
 
         lexer->tokenClass = lexer->finalStateClass[lexer->currState];
-        fseek(lexer->sourceCode, 0, SEEK_END);  // retreat
+        // no retreat needed, the input keeps returning EOF
 
         lexer->tokenClass = abs(lexer->tokenClass);
         if (lexer->tokenClass == ID)
@@ -353,11 +226,12 @@ void _nextState(Lexer* lexer) {
 void _identifyTokenClass(Lexer* lexer) {
     lexer->tokenClass = lexer->finalStateClass[lexer->currState];
 
+    // the buffer holds the token (and the char to be retreated, for errors only)
+    lexer->tokenStart = lexer->sourceCode.head - lexer->buffer.size - (lexer->tokenClass < 0 && lexer->tokenClass != -ERROR);
+
     if (lexer->tokenClass < 0) {
-        // retreat the file and the count
-        fseek(lexer->sourceCode, -sizeof(char), SEEK_CUR);
-        lexer->currLine -= (lexer->currChar == '\n');
-        lexer->currCol -= (lexer->currChar != '\n') + (lexer->currChar == '\t') * 3;
+        // retreat the file
+        inputUngetc(&lexer->sourceCode);
         lexer->tokenClass = -1 * (lexer->tokenClass);
     }
     if (lexer->tokenClass == ID)
@@ -389,20 +263,88 @@ int _checkIfProtectedSymbol(Lexer* lexer) {
     return lexer->protectedSymbolFinalStates[state];
 }
 
+/**
+ * @brief Converts the current token to its value if it is a number (the value is left unchanged
+ * otherwise)
+ *
+ * @param lexer a lexer instance
+ * @return true if the token is an integer number too large for a long (its value is LONG_MAX)
+ * @return false otherwise
+ */
+bool _convertNumber(Lexer* lexer) {
+    if (lexer->tokenClass == N_INTEGER)
+        return numberParseInteger(lexer->buffer.str, lexer->buffer.size, &lexer->value.integer);
+    if (lexer->tokenClass == N_REAL)
+        lexer->value.real = numberParseReal(lexer->buffer.str, lexer->buffer.size);
+    return false;
+}
+
+/**
+ * @brief Converts the current token to its value if it is a number and records an error if it is
+ * an integer number too large for a long. The token is still returned as a number.
+ *
+ * @param lexer a lexer instance
+ * @param diagnostics diagnostics where the error is recorded
+ * @return int number of lexer errors (0 or 1)
+ */
+int _numberError(Lexer* lexer, Diagnostics* diagnostics) {
+    if (!_convertNumber(lexer))
+        return 0;
+
+    SourcePosition position;
+    lexerTokenPosition(lexer, &position);
+    diagnosticsLexerError(diagnostics, &position, lexer->buffer.str, INTEGER_OVERFLOW_ERROR);
+    return 1;
+}
+
+/**
+ * @brief Appends the last token to the token dump, writing the dump to the
+ * token output file whenever it grows past TOKEN_DUMP_BUFFER_SIZE.
+ *
+ * @param lexer a lexer instance
+ */
+void _dumpToken(Lexer* lexer) {
+    const char* className = lexerTokenClassName(lexer->tokenClass);
+
+    stringAppend(&lexer->tokenDump, lexer->buffer.str, lexer->buffer.size);
+    stringAppend(&lexer->tokenDump, ", ", 2);
+    stringAppendCstr(&lexer->tokenDump, className);
+    stringAppendChar(&lexer->tokenDump, '\n');
+
+    if (lexer->tokenDump.size >= TOKEN_DUMP_BUFFER_SIZE)
+        _flushTokenDump(lexer);
+}
+
+/**
+ * @brief Writes the pending token dump to the token output file
+ *
+ * @param lexer a lexer instance
+ */
+void _flushTokenDump(Lexer* lexer) {
+    PROFILE_ENTER(PHASE_IO);
+    fwrite(lexer->tokenDump.str, sizeof(char), lexer->tokenDump.size, lexer->tokenOutput);
+    PROFILE_LEAVE();
+    stringOverwrite(&lexer->tokenDump, "", 0);
+}
+
 /**
  * @brief Returns error description given current automaton state.
  *
- * @param currState current automaton state
+ * @param currState current automaton state (or INTEGER_OVERFLOW_ERROR)
  * @return char* error description
  */
 const char* lexerErrorMessage(int currState) {
-    static const char* lexerErrorMessages[NUMBER_OF_STATES] = {"", "", "",
+    static const char* lexerErrorMessages[NUMBER_OF_LEXER_ERROR_CODES] = {"", "", "",
                                                                "Error: Invalid character", "", "", "",
                                                                "Error: did you mean to type a real number?", "", "", "", "", "",
                                                                ""
                                                                "",
                                                                "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "",
-                                                               "Error: Unexpected end of file"};
+                                                               "Error: Unexpected end of file",
+                                                               "", "", "",
+                                                               "Error: Invalid character", "Error: Invalid UTF-8 sequence", "Error: Invalid UTF-8 sequence",
+                                                               "", "", "", "",
+                                                               "Error: Integer number too large"};
     return lexerErrorMessages[currState];
 }
 
@@ -445,20 +387,21 @@ const char* lexerTokenClassUserFriendlyName(int tokenClass) {
             return "command";
         case EQUALS:
             return "=";
+        case NESTING:
+            return "at most 10000 nested parentheses or commands";  // MAX_NESTING
         default:
             return tokenClassName[tokenClass];
     }
 }
 
 /**
- * @brief Col count is incremented, just for showing purposes, in case there was a retreat
+ * @brief Computes the position of the first char of the current token
  *
- * @param lexer a lexer instance
- * @return int current col without considering a possible retreat
+ * @param lexer lexer instance
+ * @param position the position
  */
-int lexerCurrColWithoutRetreat(Lexer* lexer) {
-    // Col count is incremented, just for showing purposes, in case there was a retreat
-    return lexer->currCol + (lexer->finalStateClass[lexer->currState] < 0);
+void lexerTokenPosition(Lexer* lexer, SourcePosition* position) {
+    inputPosition(&lexer->sourceCode, lexer->tokenStart, position);
 }
 
 /**
@@ -0,0 +1,47 @@
+/**
+ * @file lexerdirect.c
+ * @brief Direct-coded lexer automaton. _scanDirectCoded is generated at build time by tools/lexgen.c
+ * from the transition matrix and the final states of automaton.c: each state is a label whose
+ * transitions are a switch on the char, so the next state is known by the code instead of being
+ * loaded from the matrix. States that loop on themselves (identifiers, numbers, blanks and comments)
+ * first skip their run of chars in a tight loop. The chars are read straight from the ring buffer of
+ * the input and the token is appended to the buffer in blocks, not char by char.
+ */
+#include "../header/lexer.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// appends the chars of the token read up to to (excluded) to the buffer
+#define FLUSH(to)                                                                  \
+    if (token != NULL) {                                                           \
+        stringAppend(&lexer->buffer, (const char*)token, (unsigned long)((to) - token)); \
+        token = (to);                                                              \
+    }
+
+// reads the next char into c, refilling the ring buffer if needed. At the end of the source code
+// the automaton stops in state
+#define READ(state)                                                    \
+    if (p == end) {                                                    \
+        FLUSH(p);                                                      \
+        inputSkip(input, (unsigned long)(p - base));                   \
+        inputMark(input, input->head - lexer->buffer.size);            \
+        if (input->head == input->tail && _inputRefill(input)) {       \
+            lexer->currState = (state);                                \
+            lexer->fscanfFlag = EOF;                                   \
+            return true;                                               \
+        }                                                              \
+        base = p = inputSpan(input, &end);                             \
+        if (token != NULL)                                             \
+            token = p;                                                 \
+    }                                                                  \
+    c = *p++;
+
+// the automaton reached a final state, the buffer holds the token
+#define ACCEPT()                                   \
+    inputSkip(input, (unsigned long)(p - base));   \
+    lexer->currChar = c;                           \
+    lexer->fscanfFlag = 1;                         \
+    return false;
+
+#include "../build/lexerdirect.inc"
@@ -0,0 +1,405 @@
+/**
+ * @file ll1.c
+ * @brief Table-driven LL(1) syntax analyser implementation
+ *
+ * The grammar below mirrors the recursive-descent functions of parser.c item by item: each
+ * nonterminal item carries the followers its NEXTRULE call adds and each terminal item carries
+ * the followers its PANICMODE adds. Instead of pushing them on the synchronization stacks as the
+ * rules are entered, the frames of the explicit parse stack are inspected only when an error
+ * happens, which gives the same synchronization levels as the recursive engine.
+ */
+#include "../header/ll1.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+
+#define FOLLOWERS(...) (const int[]){__VA_ARGS__}, sizeof((const int[]){__VA_ARGS__}) / sizeof(int)
+#define TERM(symbol, ...) {symbol, FOLLOWERS(__VA_ARGS__)}  // terminal that may be missing
+#define MATCH(symbol) {symbol, NULL, 0}                    // terminal already checked by the lookahead
+#define RULE(symbol, ...) {symbol, FOLLOWERS(__VA_ARGS__)}  // nonterminal
+#define PRODUCTION(head, isDefault, ...) \
+    {head, isDefault, (const LL1Item[]){__VA_ARGS__}, sizeof((const LL1Item[]){__VA_ARGS__}) / sizeof(LL1Item)}
+#define LAMBDA_PRODUCTION(head) {head, true, NULL, 0}
+
+#define CMD_FIRST READ, WRITE, WHILE, IF, FOR, ID, BEGIN
+#define EXPRESSION_FIRST OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL
+#define EXPRESSION_FOLLOWERS SEMICOLON, RELATION, CLOSE_PAR, THEN, TO, DO
+
+#define BIT(tokenClass) ((uint64_t)1 << (tokenClass))
+
+// P-- grammar, the comments show the rule numbers used in parser.c
+static const LL1Production grammar[] = {
+    // 1. <programa> ::= program ident ; <corpo> .
+    PRODUCTION(NT_PROGRAMA, true, TERM(PROGRAM, ID), TERM(ID, SEMICOLON), TERM(SEMICOLON, CONST, VAR, PROCEDURE, BEGIN),
+               RULE(NT_CORPO, DOT), TERM(DOT, LAMBDA)),
+    // 2. <corpo> ::= <dc> begin <comandos> end
+    PRODUCTION(NT_CORPO, true, RULE(NT_DC, BEGIN), TERM(BEGIN, CMD_FIRST, END), RULE(NT_COMANDOS, END), TERM(END, DOT)),
+    // 3. <dc> ::= <dc_c> <dc_v> <dc_p>
+    PRODUCTION(NT_DC, true, RULE(NT_DC_C, BEGIN, VAR, PROCEDURE), RULE(NT_DC_V, BEGIN, PROCEDURE), RULE(NT_DC_P, BEGIN)),
+    // 4. <dc_c> ::= const ident = <numero> ; <dc_c> | lambda
+    PRODUCTION(NT_DC_C, false, MATCH(CONST), TERM(ID, ASSIGN), TERM(EQUALS, N_INTEGER, N_REAL), RULE(NT_NUMERO, SEMICOLON),
+               TERM(SEMICOLON, CONST, BEGIN, VAR, PROCEDURE), RULE(NT_DC_C, BEGIN, VAR, PROCEDURE)),
+    LAMBDA_PRODUCTION(NT_DC_C),
+    // 5. <dc_v> ::= var <variaveis> : <tipo_var> ; <dc_v> | lambda
+    PRODUCTION(NT_DC_V, false, MATCH(VAR), RULE(NT_VARIAVEIS, DECLARE_TYPE), TERM(DECLARE_TYPE, REAL, INTEGER),
+               RULE(NT_TIPO_VAR, SEMICOLON), TERM(SEMICOLON, VAR, BEGIN, PROCEDURE), RULE(NT_DC_V, BEGIN, PROCEDURE)),
+    LAMBDA_PRODUCTION(NT_DC_V),
+    // 6. <tipo_var> ::= real | integer
+    PRODUCTION(NT_TIPO_VAR, true, TERM(TYPES, SEMICOLON, CLOSE_PAR)),
+    // 7. <variaveis> ::= ident <mais_var>
+    PRODUCTION(NT_VARIAVEIS, true, TERM(ID, COLON, DECLARE_TYPE, CLOSE_PAR), RULE(NT_MAIS_VAR, DECLARE_TYPE, CLOSE_PAR)),
+    // 8. <mais_var> ::= , <variaveis> | lambda
+    PRODUCTION(NT_MAIS_VAR, false, MATCH(COLON), RULE(NT_VARIAVEIS, DECLARE_TYPE, CLOSE_PAR)),
+    LAMBDA_PRODUCTION(NT_MAIS_VAR),
+    // 9. <dc_p> ::= procedure ident <parametros> ; <corpo_p> <dc_p> | lambda
+    PRODUCTION(NT_DC_P, false, MATCH(PROCEDURE), TERM(ID, OPEN_PAR, SEMICOLON), RULE(NT_PARAMETROS, SEMICOLON),
+               TERM(SEMICOLON, VAR, BEGIN), RULE(NT_CORPO_P, BEGIN, PROCEDURE), RULE(NT_DC_P, BEGIN)),
+    LAMBDA_PRODUCTION(NT_DC_P),
+    // 10. <parametros> ::= ( <lista_par> ) | lambda
+    PRODUCTION(NT_PARAMETROS, false, MATCH(OPEN_PAR), RULE(NT_LISTA_PAR, CLOSE_PAR), TERM(CLOSE_PAR, SEMICOLON)),
+    LAMBDA_PRODUCTION(NT_PARAMETROS),
+    // 11. <lista_par> ::= <variaveis> : <tipo_var> <mais_par>
+    PRODUCTION(NT_LISTA_PAR, true, RULE(NT_VARIAVEIS, DECLARE_TYPE), TERM(DECLARE_TYPE, REAL, INTEGER),
+               RULE(NT_TIPO_VAR, COLON, DECLARE_TYPE, CLOSE_PAR), RULE(NT_MAIS_PAR, CLOSE_PAR)),
+    // 12. <mais_par> ::= ; <lista_par> | lambda
+    PRODUCTION(NT_MAIS_PAR, false, MATCH(SEMICOLON), RULE(NT_LISTA_PAR, CLOSE_PAR)),
+    LAMBDA_PRODUCTION(NT_MAIS_PAR),
+    // 13. <corpo_p> ::= <dc_loc> begin <comandos> end ;
+    PRODUCTION(NT_CORPO_P, true, RULE(NT_DC_LOC, BEGIN), TERM(BEGIN, CMD_FIRST, END), RULE(NT_COMANDOS, END), TERM(END, SEMICOLON),
+               TERM(SEMICOLON, BEGIN, PROCEDURE)),
+    // 14. <dc_loc> ::= <dc_v>
+    PRODUCTION(NT_DC_LOC, true, RULE(NT_DC_V, BEGIN)),
+    // 15. <lista_arg> ::= ( <argumentos> ) | lambda
+    PRODUCTION(NT_LISTA_ARG, false, MATCH(OPEN_PAR), RULE(NT_ARGUMENTOS, CLOSE_PAR), TERM(CLOSE_PAR, SEMICOLON)),
+    LAMBDA_PRODUCTION(NT_LISTA_ARG),
+    // 16. <argumentos> ::= ident <mais_ident>
+    PRODUCTION(NT_ARGUMENTOS, true, TERM(ID, SEMICOLON, CLOSE_PAR), RULE(NT_MAIS_IDENT, CLOSE_PAR)),
+    // 17. <mais_ident> ::= ; <argumentos> | lambda
+    PRODUCTION(NT_MAIS_IDENT, false, MATCH(SEMICOLON), RULE(NT_ARGUMENTOS, CLOSE_PAR)),
+    LAMBDA_PRODUCTION(NT_MAIS_IDENT),
+    // 18. <pfalsa> ::= else <cmd> | lambda
+    PRODUCTION(NT_PFALSA, false, MATCH(ELSE), RULE(NT_CMD, SEMICOLON)),
+    LAMBDA_PRODUCTION(NT_PFALSA),
+    // 19. <comandos> ::= <cmd> ; <comandos> | lambda
+    PRODUCTION(NT_COMANDOS, false, RULE(NT_CMD, SEMICOLON), TERM(SEMICOLON, CMD_FIRST, END), RULE(NT_COMANDOS, END)),
+    LAMBDA_PRODUCTION(NT_COMANDOS),
+    // 20. <cmd> ::= read ( <variaveis> ) | write ( <variaveis> ) | while ( <condicao> ) do <cmd> |
+    //               if <condicao> then <cmd> <pfalsa> | for ident := <expressao> to <expressao> do <cmd> |
+    //               ident <pos_ident> | begin <comandos> end
+    PRODUCTION(NT_CMD, false, MATCH(READ), TERM(OPEN_PAR, ID), RULE(NT_VARIAVEIS, CLOSE_PAR), TERM(CLOSE_PAR, SEMICOLON)),
+    PRODUCTION(NT_CMD, false, MATCH(WRITE), TERM(OPEN_PAR, ID), RULE(NT_VARIAVEIS, CLOSE_PAR), TERM(CLOSE_PAR, SEMICOLON)),
+    PRODUCTION(NT_CMD, false, MATCH(WHILE), TERM(OPEN_PAR, EXPRESSION_FIRST), RULE(NT_CONDICAO, CLOSE_PAR), TERM(CLOSE_PAR, DO),
+               TERM(DO, CMD_FIRST), RULE(NT_CMD, SEMICOLON)),
+    PRODUCTION(NT_CMD, false, MATCH(IF), RULE(NT_CONDICAO, THEN), TERM(THEN, CMD_FIRST), RULE(NT_CMD, ELSE, SEMICOLON),
+               RULE(NT_PFALSA, SEMICOLON)),
+    PRODUCTION(NT_CMD, false, MATCH(FOR), TERM(ID, ASSIGN), TERM(ASSIGN, EXPRESSION_FIRST), RULE(NT_EXPRESSAO, TO),
+               TERM(TO, EXPRESSION_FIRST), RULE(NT_EXPRESSAO, DO), TERM(DO, CMD_FIRST), RULE(NT_CMD, SEMICOLON)),
+    PRODUCTION(NT_CMD, false, MATCH(ID), RULE(NT_POS_IDENT, SEMICOLON)),
+    PRODUCTION(NT_CMD, false, MATCH(BEGIN), RULE(NT_COMANDOS, END), TERM(END, SEMICOLON)),
+    PRODUCTION(NT_CMD, true, TERM(COMMAND, SEMICOLON)),
+    // 20.1 <pos_ident> ::= := <expressao> | <lista_arg>
+    PRODUCTION(NT_POS_IDENT, false, RULE(NT_LISTA_ARG, SEMICOLON)),
+    PRODUCTION(NT_POS_IDENT, true, TERM(ASSIGN, EXPRESSION_FIRST), RULE(NT_EXPRESSAO, EXPRESSION_FOLLOWERS)),
+    // 21. <condicao> ::= <expressao> <relacao> <expressao>
+    PRODUCTION(NT_CONDICAO, true, RULE(NT_EXPRESSAO, RELATION), RULE(NT_RELACAO, EXPRESSION_FIRST),
+               RULE(NT_EXPRESSAO, EXPRESSION_FOLLOWERS)),
+    // 22. <relacao> ::= = | <> | >= | <= | > | <
+    PRODUCTION(NT_RELACAO, true, TERM(RELATION, EXPRESSION_FIRST)),
+    // 23. <expressao> ::= <termo> <outros_termos>
+    PRODUCTION(NT_EXPRESSAO, true, RULE(NT_TERMO, OP_UN), RULE(NT_OUTROS_TERMOS, EXPRESSION_FOLLOWERS)),
+    // 24. <op_un> ::= + | - | lambda
+    PRODUCTION(NT_OP_UN, false, MATCH(OP_UN)),
+    LAMBDA_PRODUCTION(NT_OP_UN),
+    // 25. <outros_termos> ::= <op_ad> <termo> <outros_termos> | lambda
+    PRODUCTION(NT_OUTROS_TERMOS, false, RULE(NT_OP_AD, EXPRESSION_FIRST), RULE(NT_TERMO, OP_UN),
+               RULE(NT_OUTROS_TERMOS, EXPRESSION_FOLLOWERS)),
+    LAMBDA_PRODUCTION(NT_OUTROS_TERMOS),
+    // 26. <op_ad> ::= + | -
+    PRODUCTION(NT_OP_AD, true, TERM(OP_ADD, EXPRESSION_FIRST)),
+    // 27. <termo> ::= <op_un> <fator> <mais_fatores>
+    PRODUCTION(NT_TERMO, true, RULE(NT_OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL), RULE(NT_FATOR, OP_MULT), RULE(NT_MAIS_FATORES, OP_UN)),
+    // 28. <mais_fatores> ::= <op_mul> <fator> <mais_fatores> | lambda
+    PRODUCTION(NT_MAIS_FATORES, false, RULE(NT_OP_MUL, ID, OPEN_PAR, N_INTEGER, N_REAL), RULE(NT_FATOR, OP_MULT),
+               RULE(NT_MAIS_FATORES, OP_UN)),
+    LAMBDA_PRODUCTION(NT_MAIS_FATORES),
+    // 29. <op_mul> ::= * | /
+    PRODUCTION(NT_OP_MUL, true, TERM(OP_MULT, ID, OPEN_PAR, N_INTEGER, N_REAL)),
+    // 30. <fator> ::= ident | <numero> | ( <expressao> )
+    PRODUCTION(NT_FATOR, false, MATCH(ID)),
+    PRODUCTION(NT_FATOR, false, MATCH(OPEN_PAR), RULE(NT_EXPRESSAO, CLOSE_PAR), TERM(CLOSE_PAR, OP_MULT)),
+    PRODUCTION(NT_FATOR, true, RULE(NT_NUMERO, SEMICOLON, OP_MULT)),
+    // 31. <numero> ::= numero_int | numero_real
+    PRODUCTION(NT_NUMERO, true, TERM(NUMBER, SEMICOLON, OP_MULT)),
+};
+
+#define N_PRODUCTIONS (sizeof(grammar) / sizeof(LL1Production))
+
+// parse table, built from the grammar once, by the first compilation that uses it
+static LL1Table ll1Table;
+static pthread_once_t ll1TableOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Controls the compilation process using an explicit parse stack instead of recursion.
+ * Produces exactly the same diagnostics as the recursive-descent engine.
+ *
+ * @param parser initialized parser instance
+ */
+void ll1Compile(Parser* parser) {
+    pthread_once(&ll1TableOnce, _ll1InitTable);
+    const LL1Table* table = &ll1Table;
+
+    LL1Stack stack;
+    stack.size = 0;
+    stack.capacity = 64;
+    stack.frames = parser->ll1Frames = (LL1Frame*)memoryAlloc(stack.capacity * sizeof(LL1Frame));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+
+    // get first token
+    parser->errorCount += _nextToken(parser);
+    _ll1Push(&stack, table->defaults[NT_PROGRAMA - NT_PROGRAMA]);
+
+    while (stack.size > 0) {
+        LL1Frame* frame = &stack.frames[stack.size - 1];
+
+        // production recognized, its parent goes to the next item
+        if (frame->item == frame->production->size) {
+            parser->nesting -= _ll1Nests(frame->production);
+            PROFILE_DEPTH(-1);
+            if (--stack.size > 0)
+                stack.frames[stack.size - 1].item++;
+            continue;
+        }
+
+        const LL1Item* item = &frame->production->items[frame->item];
+        if (item->symbol >= NT_PROGRAMA) {  // expand nonterminal
+            const LL1Production* production = table->table[item->symbol - NT_PROGRAMA][parser->lexer.tokenClass];
+            if (production == NULL) {
+                production = table->defaults[item->symbol - NT_PROGRAMA];
+            } else if (_ll1Nests(production)) {
+                if (parser->nesting == MAX_NESTING) {  // skipped as the recursive engine skips it
+                    _skipNested(parser);
+                    frame->item++;
+                    continue;
+                }
+                parser->nesting++;
+            }
+            _ll1Push(&stack, production);
+            parser->ll1Frames = stack.frames;  // moved when the stack grows
+            continue;
+        }
+
+        if (_ll1Matches(parser, item->symbol)) {
+            parser->errorCount += _nextToken(parser);
+            frame->item++;
+            continue;
+        }
+
+        // panic mode: skip tokens until one of the active synchronization tokens is found
+        _reportError(parser, item->symbol);
+        uint64_t syncMask = _ll1SyncMask(&stack);
+        while (!(syncMask & BIT(parser->lexer.tokenClass))) {
+            parser->errorCount += _nextToken(parser);
+            PROFILE_COUNT(COUNTER_SKIPPED_TOKENS, 1);
+        }
+
+        // the frames that don't synchronize on the token return, the one that does continues after its item
+        unsigned long level = _ll1SyncLevel(&stack, parser->lexer.tokenClass);
+        PROFILE_DEPTH(-(long)level);
+        for (unsigned long i = 0; i < level; i++)
+            parser->nesting -= _ll1Nests(stack.frames[--stack.size].production);
+        parser->panic = false;
+        if (stack.size > 0)
+            stack.frames[stack.size - 1].item++;
+    }
+
+    // check if source code ended
+    if (parser->lexer.fscanfFlag != EOF) {
+        _reportError(parser, LAMBDA);
+        while (parser->lexer.tokenClass != LAMBDA)
+            parser->errorCount += _nextToken(parser);
+    }
+
+    memoryFree(stack.frames);
+    parser->ll1Frames = NULL;
+}
+
+/**
+ * @brief Generates the LL(1) parse table from the grammar. For each nonterminal, every
+ * production that isn't the default one is indexed by the token classes of its FIRST set.
+ *
+ * @param table the parse table
+ * @return true if the grammar isn't LL(1) (two productions share a lookahead)
+ * @return false if the table was built
+ */
+bool ll1BuildTable(LL1Table* table) {
+    memset(table, 0, sizeof(LL1Table));
+
+    for (unsigned long i = 0; i < N_PRODUCTIONS; i++)
+        if (grammar[i].isDefault)
+            table->defaults[grammar[i].head - NT_PROGRAMA] = &grammar[i];
+
+    // FIRST sets, iterated until a fixed point is reached (no production starts with a nullable nonterminal)
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (unsigned long i = 0; i < N_PRODUCTIONS; i++) {
+            if (grammar[i].size == 0)
+                continue;
+            uint64_t first = table->first[grammar[i].head - NT_PROGRAMA] | _ll1SymbolFirst(table, grammar[i].items[0].symbol);
+            if (first != table->first[grammar[i].head - NT_PROGRAMA]) {
+                table->first[grammar[i].head - NT_PROGRAMA] = first;
+                changed = true;
+            }
+        }
+    }
+
+    bool conflict = false;
+    for (unsigned long i = 0; i < N_PRODUCTIONS; i++) {
+        if (grammar[i].isDefault)
+            continue;
+
+        uint64_t first = _ll1SymbolFirst(table, grammar[i].items[0].symbol);
+        for (int tokenClass = 0; tokenClass < N_TOKEN_CLASS; tokenClass++) {
+            if (!(first & BIT(tokenClass)))
+                continue;
+            if (table->table[grammar[i].head - NT_PROGRAMA][tokenClass] != NULL)
+                conflict = true;
+            table->table[grammar[i].head - NT_PROGRAMA][tokenClass] = &grammar[i];
+        }
+    }
+
+    return conflict;
+}
+
+/**
+ * @brief Builds the shared parse table. A conflict is a bug in the grammar above, so it ends the
+ * process instead of parsing with an ambiguous table.
+ */
+void _ll1InitTable(void) {
+    if (ll1BuildTable(&ll1Table)) {
+        fprintf(stderr, "Error: the grammar of the table-driven engine isn't LL(1)\n");
+        abort();
+    }
+}
+
+/**
+ * @brief Returns the FIRST set of a grammar symbol
+ *
+ * @param table the parse table (with the FIRST sets of the nonterminals)
+ * @param symbol token class, MULTIPLE_EXPECTED or NONTERMINAL
+ * @return uint64_t bitmask of token classes
+ */
+uint64_t _ll1SymbolFirst(const LL1Table* table, int symbol) {
+    switch (symbol) {
+        case NUMBER:
+            return BIT(N_INTEGER) | BIT(N_REAL);
+        case TYPES:
+            return BIT(REAL) | BIT(INTEGER);
+        case EQUALS:
+            return BIT(RELATION);
+        case COMMAND:
+            return 0;
+        default:
+            return (symbol >= NT_PROGRAMA) ? table->first[symbol - NT_PROGRAMA] : BIT(symbol);
+    }
+}
+
+/**
+ * @brief Checks whether the current token is the expected terminal
+ *
+ * @param parser initialized parser instance
+ * @param symbol token class or MULTIPLE_EXPECTED
+ * @return true if the token matches
+ * @return false otherwise
+ */
+bool _ll1Matches(Parser* parser, int symbol) {
+    switch (symbol) {
+        case NUMBER:
+            return parser->lexer.tokenClass == N_INTEGER || parser->lexer.tokenClass == N_REAL;
+        case TYPES:
+            return parser->lexer.tokenClass == REAL || parser->lexer.tokenClass == INTEGER;
+        case EQUALS:
+            return !strcmp(parser->lexer.buffer.str, "=");
+        case COMMAND:
+            return false;
+        default:
+            return parser->lexer.tokenClass == symbol;
+    }
+}
+
+/**
+ * @brief Checks whether a production nests: a parenthesized factor or a compound command (while,
+ * if, for and begin), which the recursive engine counts against MAX_NESTING
+ *
+ * @param production a production of the grammar
+ * @return true if the production nests
+ * @return false otherwise
+ */
+bool _ll1Nests(const LL1Production* production) {
+    if (production->size == 0)
+        return false;
+    int symbol = production->items[0].symbol;
+    if (production->head == NT_FATOR)
+        return symbol == OPEN_PAR;
+    return production->head == NT_CMD && (symbol == WHILE || symbol == IF || symbol == FOR || symbol == BEGIN);
+}
+
+/**
+ * @brief Pushes a production on the parse stack
+ *
+ * @param stack the parse stack
+ * @param production production to be recognized
+ */
+void _ll1Push(LL1Stack* stack, const LL1Production* production) {
+    if (stack->size == stack->capacity) {
+        stack->capacity *= 2;
+        stack->frames = (LL1Frame*)memoryRealloc(stack->frames, stack->capacity * sizeof(LL1Frame));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    stack->frames[stack->size].production = production;
+    stack->frames[stack->size].item = 0;
+    stack->size++;
+    PROFILE_DEPTH(1);
+}
+
+/**
+ * @brief Returns the active synchronization tokens: the followers of the item each frame is
+ * recognizing, plus the end of file.
+ *
+ * @param stack the parse stack
+ * @return uint64_t bitmask of token classes
+ */
+uint64_t _ll1SyncMask(const LL1Stack* stack) {
+    uint64_t mask = BIT(LAMBDA);
+    for (unsigned long i = 0; i < stack->size; i++) {
+        const LL1Item* item = &stack->frames[i].production->items[stack->frames[i].item];
+        for (int j = 0; j < item->followerCount; j++)
+            mask |= BIT(item->followers[j]);
+    }
+    return mask;
+}
+
+/**
+ * @brief Returns the synchronization level of a token: how many frames must return until
+ * one of them has the token among the followers of its current item (same as the depth
+ * _sincTokensLevel would return on the recursive engine).
+ *
+ * @param stack the parse stack
+ * @param tokenClass synchronization token
+ * @return unsigned long number of frames that must return (stack size if none synchronizes)
+ */
+unsigned long _ll1SyncLevel(const LL1Stack* stack, int tokenClass) {
+    for (unsigned long level = 0; level < stack->size; level++) {
+        const LL1Frame* frame = &stack->frames[stack->size - 1 - level];
+        const LL1Item* item = &frame->production->items[frame->item];
+        for (int j = 0; j < item->followerCount; j++)
+            if (item->followers[j] == tokenClass)
+                return level;
+    }
+    return stack->size;
+}
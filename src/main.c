@@ -1,34 +1,335 @@
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "../header/cgen.h"
+#include "../header/dataflow.h"
+#include "../header/diagnostics.h"
+#include "../header/inliner.h"
+#include "../header/ir.h"
+#include "../header/jit.h"
 #include "../header/parser.h"
+#include "../header/profile.h"
+#include "../header/sandbox.h"
+
+void _printProfile(int profileFormat);
+bool _parseNumber(const char* option, const char* text, long min, long max, long* value);
+bool _runProgram(const Program* program, const SandboxLimits* limits, int format);
 
 /**
  * @brief P-- compiler
  *
- * @param argc number of command line arguments (expects 2 arguments)
- * @param argv commmand line arguments ( expects {executable name, source code file name} )
- * @return int
+ * @param argc number of command line arguments
+ * @param argv commmand line arguments ( expects {executable name, [options], source code file name} )
+ * options: --format=text|json|sarif  diagnostics output format
+ *          --max-errors=N            show the first N errors only, the others are counted
+ *          --error-limit=N           stop the compilation at the Nth error (independent of --max-errors)
+ *          --no-snippets             don't show the source line of text errors
+ *          --tokens[=FILE]           dump the recognized tokens (to tokenOutput.txt by default)
+ *          --emit-tokens=FILE        only lex the source code, writing its binary token stream to FILE
+ *          --from-tokens             the input file is a binary token stream, compile it without lexing
+ *          --engine=recursive|table  syntax analysis engine (recursive-descent functions by default)
+ *          --lexer=direct|table      lexer automaton (direct-coded by default)
+ *          --jobs=N                  lex the whole file and parse its procedures with N threads (0 uses every CPU)
+ *          --profile[=text|json]     print phase timings and counters to stderr (needs make PROFILE=1)
+ *          --run                     check the program and run it (x86-64 only): read takes numbers from
+ *                                    stdin, write prints to stdout
+ *          --emit-c=FILE             check the program and translate it to a C file to build with a C compiler
+ *          --emit-ir                 check the program and print its optimized SSA form with instruction counts
+ *          --report-inlining         check the program and print the inlining decisions to stderr
+ *          --no-inline               don't inline the small procedures before --run, --emit-c and --emit-ir
+ *          --warn-uninitialized      check the program and warn about the variables that may be read before
+ *                                    they are assigned
+ *          --sandbox                 run the program in a sandbox and print its verdict to stderr
+ *          --budget=N                stop the sandboxed program after N loop iterations and procedure calls
+ *                                    (0, the default, for no limit)
+ *          --time-limit=MS           stop the sandboxed program after MS milliseconds (10000 by default)
+ *          --memory-limit=KB         stack and global variables of the sandboxed program (65536 by default)
+ * @return int 1 if --run, --emit-c or --emit-ir found errors, the program failed (or its verdict isn't ok) or
+ * the C file couldn't be written
  */
 int main(int argc, char** argv) {
+    const char* sourcePath = NULL;
+    int format = FORMAT_TEXT;
+    int maxErrors = 0;
+    int errorLimit = 0;
+    bool snippets = true;
+    const char* tokenOutputPath = NULL;
+    const char* tokenStreamPath = NULL;
+    bool fromTokens = false;
+    int engine = ENGINE_RECURSIVE;
+    int automaton = AUTOMATON_DIRECT;
+    int jobs = 1;  // lexes the file as a stream
+    int profileFormat = -1;  // no profiling
+    bool run = false;
+    const char* cPath = NULL;
+    bool emitIr = false;
+    bool inlining = true;
+    bool reportInlining = false;
+    bool warnUninitialized = false;
+    bool sandbox = false;
+    SandboxLimits limits;
+    sandboxLimitsInit(&limits);
+
+    for (int i = 1; i < argc; i++) {
+        if (!strncmp(argv[i], "--format=", 9)) {
+            format = diagnosticsParseFormat(argv[i] + 9);
+            if (format == -1) {
+                printf("Error: unknown format '%s'\n", argv[i] + 9);
+                return -1;
+            }
+        } else if (!strncmp(argv[i], "--max-errors=", 13)) {
+            maxErrors = atoi(argv[i] + 13);
+        } else if (!strncmp(argv[i], "--error-limit=", 14)) {
+            errorLimit = atoi(argv[i] + 14);
+        } else if (!strcmp(argv[i], "--no-snippets")) {
+            snippets = false;
+        } else if (!strcmp(argv[i], "--tokens")) {
+            tokenOutputPath = "tokenOutput.txt";
+        } else if (!strncmp(argv[i], "--tokens=", 9)) {
+            tokenOutputPath = argv[i] + 9;
+        } else if (!strncmp(argv[i], "--emit-tokens=", 14)) {
+            tokenStreamPath = argv[i] + 14;
+        } else if (!strcmp(argv[i], "--from-tokens")) {
+            fromTokens = true;
+        } else if (!strcmp(argv[i], "--engine=recursive")) {
+            engine = ENGINE_RECURSIVE;
+        } else if (!strcmp(argv[i], "--engine=table")) {
+            engine = ENGINE_TABLE;
+        } else if (!strncmp(argv[i], "--engine=", 9)) {
+            printf("Error: unknown engine '%s'\n", argv[i] + 9);
+            return -1;
+        } else if (!strcmp(argv[i], "--lexer=direct")) {
+            automaton = AUTOMATON_DIRECT;
+        } else if (!strcmp(argv[i], "--lexer=table")) {
+            automaton = AUTOMATON_TABLE;
+        } else if (!strncmp(argv[i], "--lexer=", 8)) {
+            printf("Error: unknown lexer '%s'\n", argv[i] + 8);
+            return -1;
+        } else if (!strncmp(argv[i], "--jobs=", 7)) {
+            jobs = atoi(argv[i] + 7);
+        } else if (!strcmp(argv[i], "--profile") || !strcmp(argv[i], "--profile=text")) {
+            profileFormat = PROFILE_TEXT;
+        } else if (!strcmp(argv[i], "--profile=json")) {
+            profileFormat = PROFILE_JSON;
+        } else if (!strncmp(argv[i], "--profile=", 10)) {
+            printf("Error: unknown profile format '%s'\n", argv[i] + 10);
+            return -1;
+        } else if (!strcmp(argv[i], "--run")) {
+            run = true;
+        } else if (!strncmp(argv[i], "--emit-c=", 9)) {
+            cPath = argv[i] + 9;
+        } else if (!strcmp(argv[i], "--emit-ir")) {
+            emitIr = true;
+        } else if (!strcmp(argv[i], "--report-inlining")) {
+            reportInlining = true;
+        } else if (!strcmp(argv[i], "--no-inline")) {
+            inlining = false;
+        } else if (!strcmp(argv[i], "--warn-uninitialized")) {
+            warnUninitialized = true;
+        } else if (!strcmp(argv[i], "--sandbox")) {
+            sandbox = run = true;
+        } else if (!strncmp(argv[i], "--budget=", 9)) {
+            if (_parseNumber("--budget", argv[i] + 9, 0, LONG_MAX, &limits.budget))
+                return -1;
+            sandbox = run = true;
+        } else if (!strncmp(argv[i], "--time-limit=", 13)) {
+            if (_parseNumber("--time-limit", argv[i] + 13, 1, LONG_MAX, &limits.timeLimit))
+                return -1;
+            sandbox = run = true;
+        } else if (!strncmp(argv[i], "--memory-limit=", 15)) {
+            if (_parseNumber("--memory-limit", argv[i] + 15, 1, LONG_MAX / 1024, &limits.memoryLimit))
+                return -1;
+            limits.memoryLimit *= 1024;
+            sandbox = run = true;
+        } else if (sourcePath == NULL) {
+            sourcePath = argv[i];
+        } else {
+            printf("Error: unexpected argument '%s'\n", argv[i]);
+            return -1;
+        }
+    }
+
     // wrong number of command line arguments error
-    if (argc != 2) {
+    if (sourcePath == NULL) {
         printf("Error: no input files\n");
         return -1;
     }
 
+    if (profileFormat != -1 && !profileEnabled()) {
+        printf("Error: profiling support wasn't compiled in, rebuild with make PROFILE=1\n");
+        return -1;
+    }
+    profileStart();
+
+    Diagnostics diagnostics;
+    diagnosticsInit(&diagnostics, format, maxErrors);
+    diagnostics.snippets = snippets;
+
+    // serialize the lexer output only
+    if (tokenStreamPath != NULL) {
+        int errorCount = 0;
+        bool error = tokenStreamEmit(sourcePath, tokenStreamPath, jobs, &diagnostics, &errorCount);
+        if (!error) {
+            diagnosticsFlush(&diagnostics, sourcePath, stdout, "output.txt");
+            if (format == FORMAT_TEXT)
+                printf("Token stream written to %s with %d lexer errors\n", tokenStreamPath, errorCount);
+        }
+        _printProfile(profileFormat);
+        diagnosticsDestroy(&diagnostics);
+        return error ? -1 : 0;
+    }
+
     Parser parser;
-    if (parserInit(&parser, argv[1])) {
+    bool error;
+    if (fromTokens)
+        error = parserInitFromTokens(&parser, sourcePath, &diagnostics);
+    else if (jobs != 1 && strcmp(sourcePath, "-"))  // stdin can't be mapped, it is lexed as a stream
+        error = parserInitParallel(&parser, sourcePath, tokenOutputPath, jobs, &diagnostics);
+    else
+        error = parserInit(&parser, sourcePath, tokenOutputPath, &diagnostics);
+    if (error) {
+        diagnosticsDestroy(&diagnostics);
         return -1;
     }
+    parser.engine = engine;
+    parser.lexer.automaton = automaton;
+    parser.errorLimit = errorLimit;
+
+    // the semantic analysis works on the tokens the parser records
+    bool check = run || cPath != NULL || emitIr || reportInlining || warnUninitialized;
+    ProgramTokens tokens;
+    programTokensInit(&tokens);
+    if (check)
+        parser.recorded = &tokens;
     compile(&parser);
 
-    // print compiler status
-    if (parser.errorCount > 0)
-        printf("Program compiled with %d errors\n", parser.errorCount);
-    else if (parser.errorCount == 0)
-        printf("Program compiled successfully\n");
+    Program program;
+    bool built = check && parser.errorCount == 0 && !parser.stopped;
+    if (built)
+        parser.errorCount += programBuild(&program, &tokens, &diagnostics);
+    if (built && warnUninitialized && parser.errorCount == 0)
+        dataflowCheck(&program, &tokens, &diagnostics);
+    programTokensDestroy(&tokens);
+
+    // render every diagnostic at once
+    diagnosticsFlush(&diagnostics, sourcePath, stdout, "output.txt");
+
+    // print compiler status (the output of a run is the one of the program, and --emit-ir prints the IR)
+    bool valid = parser.errorCount == 0 && !parser.stopped;
+    if (format == FORMAT_TEXT && !((run || emitIr) && valid)) {
+        if (parser.stopped)
+            printf("Compilation stopped after %d errors\n", parser.errorCount);
+        else if (parser.errorCount > 0)
+            printf("Program compiled with %d errors\n", parser.errorCount);
+        else if (diagnostics.warnings > 0)
+            printf("Program compiled successfully with %lu warnings\n", diagnostics.warnings);
+        else if (parser.errorCount == 0)
+            printf("Program compiled successfully\n");
+    }
+
+    int status = (check && !valid) ? 1 : 0;
+    if (inlining && built && valid && (run || cPath != NULL || emitIr || reportInlining))  // --warn-uninitialized only checks
+        inlinerRun(&program, reportInlining ? stderr : NULL);
+    if (cPath != NULL && valid) {
+        if (cgenEmit(&program, sourcePath, cPath))
+            status = 1;
+        else if (format == FORMAT_TEXT && !run && !emitIr)
+            printf("C code written to %s\n", cPath);
+    }
+    if (emitIr && valid) {
+        Ir ir;
+        irBuild(&ir, &program);
+        irOptimize(&ir);
+        irPrint(&ir, stdout);
+        irDestroy(&ir);
+    }
+    if (run && valid && _runProgram(&program, sandbox ? &limits : NULL, format))
+        status = 1;
+    if (built)
+        programDestroy(&program);
 
     parserDestroy(&parser);
-    return 0;
-}
\ No newline at end of file
+    diagnosticsDestroy(&diagnostics);
+    _printProfile(profileFormat);
+    return status;
+}
+
+/**
+ * @brief Generates the machine code of a program and runs it, reporting runtime errors to stderr,
+ * or runs it in the sandbox and prints its verdict to stderr
+ *
+ * @param program a program without errors
+ * @param limits limits of the sandbox, NULL to run the program without it
+ * @param format DIAGNOSTIC_FORMAT of the verdict
+ * @return true if the code couldn't be generated or the program failed
+ * @return false otherwise
+ */
+bool _runProgram(const Program* program, const SandboxLimits* limits, int format) {
+    if (limits != NULL) {
+        SandboxResult result;
+        if (sandboxRun(program, limits, stdin, stdout, &result))
+            return true;
+        fflush(stdout);
+        sandboxPrint(&result, format, stderr);
+        return result.verdict != SANDBOX_OK;
+    }
+
+    Jit jit;
+    bool error = jitCompile(&jit, program, false);
+    if (!error) {
+        Runtime runtime;
+        runtimeInit(&runtime, stdin, stdout);
+        int status = jitRun(&jit, &runtime);
+        runtimeFinish(&runtime);
+        if (status != RUNTIME_OK) {
+            fprintf(stderr, "Runtime error on line %d col %d: %s\n", runtime.line, runtime.col, runtimeStatusMessage(status));
+            error = true;
+        }
+    }
+    jitDestroy(&jit);
+    return error;
+}
+
+/**
+ * @brief Reads the value of a numeric option: decimal digits only, between two bounds
+ *
+ * @param option name of the option, for the error message
+ * @param text its value
+ * @param min smallest value accepted
+ * @param max largest value accepted
+ * @param value where it is written
+ * @return true if the value is invalid (the error is printed)
+ * @return false otherwise
+ */
+bool _parseNumber(const char* option, const char* text, long min, long max, long* value) {
+    char* end;
+    errno = 0;
+    long number = strtol(text, &end, 10);
+    if (*text < '0' || *text > '9' || *end != '\0' || errno == ERANGE || number < min || number > max) {
+        printf("Error: invalid value '%s' of %s, expected a number from %ld to %ld\n", text, option, min, max);
+        return true;
+    }
+    *value = number;
+    return false;
+}
+
+/**
+ * @brief Stops profiling and prints the report to stderr
+ *
+ * @param profileFormat PROFILE_FORMAT or -1 if profiling wasn't requested
+ */
+void _printProfile(int profileFormat) {
+    if (profileFormat == -1)
+        return;
+
+    profileStop();
+    String report;
+    stringInit(&report);
+    profileRender(&report, profileFormat);
+    fputs(report.str, stderr);
+    stringDestroy(&report);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file memory.c
+ * @brief Memory allocation through a replaceable allocator implementation
+ */
+#include "../header/memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static _Thread_local const Allocator* currentAllocator = NULL;  // NULL uses the C library
+static _Thread_local jmp_buf* failureTarget = NULL;             // NULL ends the process
+
+/**
+ * @brief Selects the allocator used by the current thread. Compilations running on other threads
+ * aren't affected.
+ *
+ * @param allocator the allocator or NULL for the C library one
+ * @return const Allocator* the previously selected allocator (to be restored)
+ */
+const Allocator* memoryUse(const Allocator* allocator) {
+    const Allocator* previous = currentAllocator;
+    currentAllocator = allocator;
+    return previous;
+}
+
+/**
+ * @brief Returns the allocator selected on the current thread, so that threads started by a
+ * compilation can select it too
+ *
+ * @return const Allocator* the allocator or NULL for the C library one
+ */
+const Allocator* memoryCurrent() {
+    return currentAllocator;
+}
+
+/**
+ * @brief Selects where a failed allocation of the current thread jumps to (with longjmp, setjmp
+ * returning 1). The memory the interrupted code held only in local variables isn't freed, so the
+ * structures it was building must be reachable from the caller of setjmp.
+ *
+ * @param target the target or NULL to end the process with an error
+ * @return jmp_buf* the previously selected target (to be restored)
+ */
+jmp_buf* memoryOnFailure(jmp_buf* target) {
+    jmp_buf* previous = failureTarget;
+    failureTarget = target;
+    return previous;
+}
+
+/**
+ * @brief Allocates memory
+ *
+ * @param size number of bytes
+ * @return void* the memory
+ */
+void* memoryAlloc(size_t size) {
+    if (currentAllocator == NULL)
+        return _memoryChecked(malloc(size), size);
+    return _memoryChecked(currentAllocator->malloc(size, currentAllocator->userData), size);
+}
+
+/**
+ * @brief Allocates zeroed memory
+ *
+ * @param count number of elements
+ * @param size size of each element
+ * @return void* the memory
+ */
+void* memoryCalloc(size_t count, size_t size) {
+    if (currentAllocator == NULL)
+        return _memoryChecked(calloc(count, size), count * size);
+
+    void* pointer = _memoryChecked(currentAllocator->malloc(count * size, currentAllocator->userData), count * size);
+    memset(pointer, 0, count * size);
+    return pointer;
+}
+
+/**
+ * @brief Resizes memory
+ *
+ * @param pointer memory previously allocated (or NULL)
+ * @param size new number of bytes
+ * @return void* the resized memory
+ */
+void* memoryRealloc(void* pointer, size_t size) {
+    if (currentAllocator == NULL)
+        return _memoryChecked(realloc(pointer, size), size);
+    return _memoryChecked(currentAllocator->realloc(pointer, size, currentAllocator->userData), size);
+}
+
+/**
+ * @brief Frees memory
+ *
+ * @param pointer memory previously allocated (or NULL)
+ */
+void memoryFree(void* pointer) {
+    if (currentAllocator == NULL)
+        free(pointer);
+    else
+        currentAllocator->free(pointer, currentAllocator->userData);
+}
+
+/**
+ * @brief Checks the result of an allocation. On failure, the previous memory of a reallocation is
+ * still valid and still held by its owner, since the result is never assigned.
+ *
+ * @param pointer the allocated memory
+ * @param size number of bytes requested (NULL is a valid result for 0)
+ * @return void* pointer
+ */
+void* _memoryChecked(void* pointer, size_t size) {
+    if (pointer != NULL || size == 0)
+        return pointer;
+    if (failureTarget != NULL)
+        longjmp(*failureTarget, 1);
+
+    printf("Error: out of memory\n");
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file number.c
+ * @brief Conversion of the numbers of P-- source code implementation
+ */
+#include "../header/number.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+// the conversions rely on IEEE rounding of each operation, which -Ofast (-ffast-math) doesn't keep
+#pragma GCC optimize("no-fast-math")
+
+/**
+ * @brief Converts the digits of an integer number. Numbers of up to 18 digits can't overflow and
+ * are accumulated without checks.
+ *
+ * @param text the digits
+ * @param size number of digits
+ * @param value set to the value, or to LONG_MAX if it doesn't fit in a long
+ * @return true if the number doesn't fit in a long
+ * @return false if it fits
+ */
+bool numberParseInteger(const char* text, unsigned long size, long* value) {
+    long result = 0;
+    if (size < NUMBER_MAX_DIGITS) {
+        for (unsigned long i = 0; i < size; i++)
+            result = result * 10 + (text[i] - '0');
+        *value = result;
+        return false;
+    }
+
+    for (unsigned long i = 0; i < size; i++) {
+        int digit = text[i] - '0';
+        if (result > (LONG_MAX - digit) / 10) {
+            *value = LONG_MAX;
+            return true;
+        }
+        result = result * 10 + digit;
+    }
+    *value = result;
+    return false;
+}
+
+/**
+ * @brief Converts a real number to the nearest double (ties to even). The digits are accumulated
+ * in a mantissa, so the number is mantissa / 10^decimals:
+ * - if both are exact doubles, a single division rounds correctly (Clinger's fast path)
+ * - else, with up to NUMBER_MAX_QUOTIENT_POWER decimals, the quotient is computed exactly in
+ * 128 bits (_numberQuotient)
+ * - else (more than NUMBER_MAX_DIGITS significant digits or too many decimals) strtod is used
+ *
+ * @param text the number, NUL terminated after size chars
+ * @param size number of chars
+ * @return double the value
+ */
+double numberParseReal(const char* text, unsigned long size) {
+    static const double powersOfTen[NUMBER_MAX_EXACT_POWER + 1] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    unsigned long mantissa = 0;
+    int digits = 0;    // significant digits of the mantissa
+    int decimals = 0;  // digits after the point
+    bool point = false;
+    for (unsigned long i = 0; i < size; i++) {
+        if (text[i] == '.') {
+            point = true;
+            continue;
+        }
+        decimals += point;
+        if (digits == 0 && text[i] == '0')  // leading zeros
+            continue;
+        if (++digits > NUMBER_MAX_DIGITS)
+            return strtod(text, NULL);
+        mantissa = mantissa * 10 + (unsigned long)(text[i] - '0');
+    }
+
+    if (mantissa == 0)
+        return 0.0;
+    if (decimals <= NUMBER_MAX_EXACT_POWER && mantissa <= (1ul << 53))
+        return (double)mantissa / powersOfTen[decimals];
+    if (decimals <= NUMBER_MAX_QUOTIENT_POWER)
+        return _numberQuotient(mantissa, decimals);
+    return strtod(text, NULL);
+}
+
+/**
+ * @brief Computes mantissa / 10^decimals = mantissa / 5^decimals * 2^-decimals rounded to the nearest
+ * double. The mantissa is shifted to the top of a 128-bit numerator, so the quotient by 5^decimals
+ * has more than 64 significant bits: its 53 leading bits are the double mantissa, the bits after
+ * them and the remainder of the division decide the rounding exactly.
+ *
+ * @param mantissa the digits, not zero
+ * @param decimals digits after the point, at most NUMBER_MAX_QUOTIENT_POWER
+ * @return double the value
+ */
+double _numberQuotient(unsigned long mantissa, int decimals) {
+    unsigned long power = 1;
+    for (int i = 0; i < decimals; i++)
+        power *= 5;
+
+    int shift = __builtin_clzl(mantissa);
+    unsigned __int128 numerator = (unsigned __int128)(mantissa << shift) << 64;  // at least 2^127
+    unsigned __int128 quotient = numerator / power;                             // at least 2^64
+    bool inexact = (numerator % power) != 0;
+
+    int bits = 128 - __builtin_clzl((unsigned long)(quotient >> 64));
+    int dropped = bits - 53;
+    unsigned __int128 rest = quotient & (((unsigned __int128)1 << dropped) - 1);
+    unsigned __int128 half = (unsigned __int128)1 << (dropped - 1);
+    unsigned long kept = (unsigned long)(quotient >> dropped);
+    if (rest > half || (rest == half && (inexact || (kept & 1))))
+        kept++;  // may become 2^53, still exact
+
+    // the value is quotient * 2^-(64 + shift + decimals)
+    return ldexp((double)kept, dropped - 64 - shift - decimals);
+}
@@ -0,0 +1,423 @@
+/**
+ * @file parallellexer.c
+ * @brief Multi-threaded lexing of an in-memory source code implementation
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "../header/parallellexer.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../header/profile.h"
+
+/**
+ * @brief Maps a P-- source code file in memory and lexes it with up to jobs threads
+ *
+ * @param lexed a parallel lexer instance
+ * @param path P-- source code file path (it must be seekable, stdin can't be mapped)
+ * @param jobs maximum number of threads (0 uses every CPU)
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool parallelLexerOpen(ParallelLexer* lexed, const char* path, int jobs) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        printf("Error: no such file\n");
+        return true;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        printf("Error: no such file\n");
+        close(fd);
+        return true;
+    }
+
+    const char* source = "";
+    if (info.st_size > 0) {
+        PROFILE_ENTER(PHASE_IO);
+        void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        PROFILE_LEAVE();
+        if (data == MAP_FAILED) {
+            printf("Error: couldn't map source code file\n");
+            close(fd);
+            return true;
+        }
+        source = (const char*)data;
+    }
+    close(fd);
+
+    parallelLexerRun(lexed, source, info.st_size, parallelLexerChunks(info.st_size, jobs));
+    lexed->mapped = info.st_size > 0;
+    return false;
+}
+
+/**
+ * @brief Lexes an in-memory source code: every chunk is lexed on its own thread, then the chunks
+ * are stitched. The source code isn't copied, it must outlive the parallel lexer.
+ *
+ * @param lexed a parallel lexer instance
+ * @param source P-- source code
+ * @param size size of the source code in bytes
+ * @param chunkCount number of chunks (and threads)
+ */
+void parallelLexerRun(ParallelLexer* lexed, const char* source, unsigned long size, int chunkCount) {
+    lexed->source = source;
+    lexed->size = size;
+    lexed->mapped = false;
+    lexed->allocator = memoryCurrent();
+    lexed->chunk = 0;
+    lexed->inRelexed = true;
+    lexed->next = 0;
+    lexed->position = 0;
+    _parallelLexerSplit(lexed, chunkCount < 1 ? 1 : chunkCount);
+
+#ifdef PMM_PROFILE
+    // the profiling counters are global, so the chunks are lexed one after another
+    for (int i = 0; i < lexed->chunkCount; i++)
+        _parallelLexerWorker(&lexed->chunks[i]);
+#else
+    pthread_t* threads = (pthread_t*)memoryAlloc(lexed->chunkCount * sizeof(pthread_t));
+    bool* started = (bool*)memoryCalloc(lexed->chunkCount, sizeof(bool));
+    for (int i = 1; i < lexed->chunkCount; i++)
+        started[i] = !pthread_create(&threads[i], NULL, _parallelLexerWorker, &lexed->chunks[i]);
+    _parallelLexerWorker(&lexed->chunks[0]);
+    for (int i = 1; i < lexed->chunkCount; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else  // no thread could be created, the chunk is lexed here
+            _parallelLexerWorker(&lexed->chunks[i]);
+    }
+    memoryFree(threads);
+    memoryFree(started);
+#endif
+
+    _parallelLexerStitch(lexed);
+}
+
+/**
+ * @brief Deallocates the lexed tokens and unmaps the source code file
+ *
+ * @param lexed a parallel lexer instance
+ */
+void parallelLexerDestroy(ParallelLexer* lexed) {
+    for (int i = 0; i < lexed->chunkCount; i++) {
+        memoryFree(lexed->chunks[i].speculative.list);
+        memoryFree(lexed->chunks[i].relexed.list);
+    }
+    memoryFree(lexed->chunks);
+    if (lexed->mapped)
+        munmap((void*)lexed->source, lexed->size);
+    lexed->chunks = NULL;
+    lexed->chunkCount = 0;
+}
+
+/**
+ * @brief Loads the next token into the lexer, as if nextToken had recognized it: lexer errors
+ * found before the token are recorded in the diagnostics and the token is dumped if requested.
+ * The lexer must use the lexed source code as input, so positions can be computed.
+ *
+ * @param lexed a parallel lexer instance
+ * @param lexer a lexer initialized on the lexed source code
+ * @param diagnostics diagnostics where lexer errors are recorded
+ * @return int number of lexer errors found before the token
+ */
+int parallelLexerNext(ParallelLexer* lexed, Lexer* lexer, Diagnostics* diagnostics) {
+    int errors = 0;
+    const LexedToken* token;
+    while ((token = _parallelLexerAdvance(lexed)) != NULL && (token->flags & LEXED_ERROR)) {
+        lexer->tokenStart = token->offset;
+        stringOverwrite(&lexer->buffer, lexed->source + token->offset, token->length);
+        SourcePosition position;
+        lexerTokenPosition(lexer, &position);
+        diagnosticsLexerError(diagnostics, &position, lexer->buffer.str, token->state);
+        errors++;
+    }
+
+    if (token == NULL) {  // the lexer keeps returning EOF
+        lexer->tokenStart = lexed->size;
+        lexer->tokenClass = LAMBDA;
+        lexer->fscanfFlag = EOF;
+        stringOverwrite(&lexer->buffer, "", 0);
+        return errors;
+    }
+
+    lexer->tokenStart = token->offset;
+    lexer->tokenClass = token->tokenClass;
+    lexer->fscanfFlag = (token->flags & LEXED_EOF) ? EOF : 1;
+    stringOverwrite(&lexer->buffer, lexed->source + token->offset, token->length);
+    _convertNumber(lexer);  // an overflow was replayed as an error record
+    if (!(token->flags & LEXED_EOF)) {
+        lexer->lastWasNumberOrIdent = (lexer->tokenClass == ID || lexer->tokenClass == N_INTEGER || lexer->tokenClass == N_REAL);
+        if (lexer->tokenClass == LAMBDA)
+            diagnosticsEOF(diagnostics);
+        else if (lexer->tokenOutput != NULL)
+            _dumpToken(lexer);
+    }
+    return errors;
+}
+
+/**
+ * @brief Returns the number of chunks worth lexing in parallel: one per thread, as long as each
+ * one has at least PARALLEL_LEXER_MIN_CHUNK bytes
+ *
+ * @param size size of the source code in bytes
+ * @param jobs maximum number of threads (0 uses every CPU)
+ * @return int number of chunks
+ */
+int parallelLexerChunks(unsigned long size, int jobs) {
+    if (jobs <= 0)
+        jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    unsigned long chunks = size / PARALLEL_LEXER_MIN_CHUNK;
+    if (chunks > (unsigned long)jobs)
+        chunks = jobs;
+    return chunks < 1 ? 1 : (int)chunks;
+}
+
+/**
+ * @brief Splits the source code in chunks of about the same size. Chunks start at the beginning
+ * of a line, where no token but a comment can be open, so speculation is usually right.
+ *
+ * @param lexed a parallel lexer instance
+ * @param chunkCount number of chunks
+ */
+void _parallelLexerSplit(ParallelLexer* lexed, int chunkCount) {
+    lexed->chunkCount = chunkCount;
+    lexed->chunks = (LexedChunk*)memoryCalloc(chunkCount, sizeof(LexedChunk));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+
+    unsigned long begin = 0;
+    for (int i = 0; i < chunkCount; i++) {
+        LexedChunk* chunk = &lexed->chunks[i];
+        chunk->owner = lexed;
+        chunk->begin = begin;
+
+        if (i == chunkCount - 1) {
+            chunk->end = lexed->size + 1;  // the call that returns EOF starts at the end of the source code
+        } else {
+            unsigned long end = (lexed->size / chunkCount) * (i + 1);
+            end = (end < begin) ? begin : end;
+            const char* newline = memchr(lexed->source + end, '\n', lexed->size - end);
+            chunk->end = (newline == NULL) ? lexed->size : (unsigned long)(newline - lexed->source) + 1;
+        }
+        begin = chunk->end;
+    }
+}
+
+/**
+ * @brief Lexes a chunk as if a token started at its beginning, until a nextToken call starts at
+ * its end or the end of file is returned. Runs on its own thread, with the allocator of the thread
+ * that started the lexing.
+ *
+ * @param argument the chunk (LexedChunk*)
+ * @return void* always NULL
+ */
+void* _parallelLexerWorker(void* argument) {
+    LexedChunk* chunk = (LexedChunk*)argument;
+    const ParallelLexer* lexed = chunk->owner;
+    const Allocator* previous = memoryUse(lexed->allocator);
+
+    chunk->head = chunk->begin;
+    chunk->context = false;
+    if (chunk->begin < chunk->end) {
+        Diagnostics diagnostics;
+        diagnosticsInit(&diagnostics, FORMAT_TEXT, 0);
+        Lexer lexer;
+        lexerInitBuffer(&lexer, lexed->source + chunk->begin, lexed->size - chunk->begin);
+
+        bool more = true;
+        while (more && chunk->head < chunk->end) {
+            more = _parallelLexerCall(&lexer, &diagnostics, chunk->begin, &chunk->speculative);
+            chunk->head = chunk->begin + lexer.sourceCode.head;
+        }
+        chunk->context = lexer.lastWasNumberOrIdent;
+
+        lexerDestroy(&lexer);
+        diagnosticsDestroy(&diagnostics);
+    }
+
+    memoryUse(previous);
+    return NULL;
+}
+
+/**
+ * @brief Calls nextToken once and appends its lexer errors and token to the records
+ *
+ * @param lexer a lexer on the source code from base on
+ * @param diagnostics diagnostics used to collect the lexer errors (cleared after the call)
+ * @param base byte offset of the beginning of the lexer input in the source code
+ * @param tokens records where the call is appended
+ * @return true if the call didn't return the end of file
+ * @return false if the call returned the end of file
+ */
+bool _parallelLexerCall(Lexer* lexer, Diagnostics* diagnostics, unsigned long base, LexedTokens* tokens) {
+    LexedToken token;
+    token.flags = lexer->lastWasNumberOrIdent ? LEXED_CONTEXT : 0;
+    nextToken(lexer, diagnostics);
+
+    for (unsigned long i = 0; i < diagnostics->size; i++) {
+        const Diagnostic* error = &diagnostics->list[i];
+        if (error->kind != DIAGNOSTIC_LEXER)
+            continue;
+        token.offset = base + error->offset;
+        token.length = strlen(diagnostics->textPool.str + error->text);
+        token.tokenClass = ERROR;
+        token.state = error->code;
+        token.flags |= LEXED_ERROR;
+        _lexedTokensPush(tokens, &token);
+        token.flags = 0;
+    }
+    if (diagnostics->size > 0)
+        diagnosticsClear(diagnostics);
+
+    token.offset = base + lexer->tokenStart;
+    token.length = lexer->buffer.size;
+    token.tokenClass = lexer->tokenClass;
+    token.state = 0;
+    token.flags |= (lexer->fscanfFlag == EOF) ? LEXED_EOF : 0;
+    _lexedTokensPush(tokens, &token);
+    return lexer->tokenClass != LAMBDA;
+}
+
+/**
+ * @brief Stitches the chunks in order. The first chunk was lexed from the beginning of the source
+ * code, so its calls are the sequential ones. Every following chunk is entered with the state of
+ * the sequential lexer (offset of the next call and lastWasNumberOrIdent): if one of its
+ * speculative calls was made in that state, it and the following ones are the sequential calls,
+ * since the lexer is deterministic. Otherwise the lexer runs from that state until it reaches the
+ * state of a speculative call or the end of the chunk.
+ *
+ * @param lexed a parallel lexer instance
+ */
+void _parallelLexerStitch(ParallelLexer* lexed) {
+    LexedChunk* chunk = &lexed->chunks[0];
+    chunk->first = 0;
+    unsigned long head = chunk->head;
+    bool context = chunk->context;
+    bool done = _lexedTokensDone(&chunk->speculative);
+
+    for (int i = 1; i < lexed->chunkCount; i++) {
+        chunk = &lexed->chunks[i];
+        chunk->first = chunk->speculative.size;
+        if (done || head >= chunk->end)  // the chunk is covered by the previous ones
+            continue;
+
+        unsigned long index = 0;
+        bool synced = _parallelLexerSync(chunk, &index, head, context);
+        if (!synced) {
+            Diagnostics diagnostics;
+            diagnosticsInit(&diagnostics, FORMAT_TEXT, 0);
+            Lexer lexer;
+            lexerInitBuffer(&lexer, lexed->source + head, lexed->size - head);
+            lexer.lastWasNumberOrIdent = context;
+
+            unsigned long base = head;
+            while (!done && !synced && head < chunk->end) {
+                done = !_parallelLexerCall(&lexer, &diagnostics, base, &chunk->relexed);
+                head = base + lexer.sourceCode.head;
+                context = lexer.lastWasNumberOrIdent;
+                synced = !done && _parallelLexerSync(chunk, &index, head, context);
+            }
+
+            lexerDestroy(&lexer);
+            diagnosticsDestroy(&diagnostics);
+        }
+
+        if (synced) {
+            chunk->first = index;
+            head = chunk->head;
+            context = chunk->context;
+            done = _lexedTokensDone(&chunk->speculative);
+        }
+    }
+}
+
+/**
+ * @brief Looks for the speculative call of a chunk made in a given lexer state. Calls are
+ * visited in order from index, which is left at the first call not before head.
+ *
+ * @param chunk a lexed chunk
+ * @param index first record of a call, updated
+ * @param head offset where the call starts
+ * @param context lastWasNumberOrIdent when the call starts
+ * @return true if the call at index was made in that state
+ * @return false if there is no such call
+ */
+bool _parallelLexerSync(const LexedChunk* chunk, unsigned long* index, unsigned long head, bool context) {
+    const LexedTokens* tokens = &chunk->speculative;
+    while (*index < tokens->size) {
+        // a call starts where the token of the previous one ends
+        unsigned long start = chunk->begin;
+        if (*index > 0)
+            start = tokens->list[*index - 1].offset + tokens->list[*index - 1].length;
+        if (start >= head)
+            return start == head && (bool)(tokens->list[*index].flags & LEXED_CONTEXT) == context;
+
+        while (tokens->list[*index].flags & LEXED_ERROR)
+            (*index)++;
+        (*index)++;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the next record of the stitched chunks
+ *
+ * @param lexed a parallel lexer instance
+ * @return const LexedToken* the record or NULL once they are over
+ */
+const LexedToken* _parallelLexerAdvance(ParallelLexer* lexed) {
+    while (lexed->chunk < lexed->chunkCount) {
+        const LexedChunk* chunk = &lexed->chunks[lexed->chunk];
+        if (lexed->inRelexed) {
+            if (lexed->next < chunk->relexed.size) {
+                lexed->position++;
+                return &chunk->relexed.list[lexed->next++];
+            }
+            lexed->inRelexed = false;
+            lexed->next = chunk->first;
+        }
+        if (lexed->next < chunk->speculative.size) {
+            lexed->position++;
+            return &chunk->speculative.list[lexed->next++];
+        }
+
+        lexed->chunk++;
+        lexed->inRelexed = true;
+        lexed->next = 0;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Appends a record
+ *
+ * @param tokens the records
+ * @param token the record to append
+ */
+void _lexedTokensPush(LexedTokens* tokens, const LexedToken* token) {
+    if (tokens->size == tokens->capacity) {
+        tokens->capacity = (tokens->capacity == 0) ? 1024 : tokens->capacity * 2;
+        tokens->list = (LexedToken*)memoryRealloc(tokens->list, tokens->capacity * sizeof(LexedToken));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    tokens->list[tokens->size++] = *token;
+}
+
+/**
+ * @brief Checks whether the records end with the end of file
+ *
+ * @param tokens the records
+ * @return true if the last call returned the end of file
+ * @return false otherwise
+ */
+bool _lexedTokensDone(const LexedTokens* tokens) {
+    return tokens->size > 0 && tokens->list[tokens->size - 1].tokenClass == LAMBDA;
+}
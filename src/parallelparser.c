@@ -0,0 +1,298 @@
+/**
+ * @file parallelparser.c
+ * @brief Multi-threaded parsing of the procedure declarations implementation
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "../header/parallelparser.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+
+/**
+ * @brief Parses every procedure token of the lexed tokens as the beginning of a procedure, with up
+ * to jobs threads. It must be called before the first token is replayed.
+ *
+ * @param parsed a parallel parser instance
+ * @param lexed the lexed source code
+ * @param jobs maximum number of threads (0 uses every CPU)
+ * @param record whether the tokens of the procedures are recorded for the semantic analysis
+ */
+void parallelParserRun(ParallelParser* parsed, const ParallelLexer* lexed, int jobs, bool record) {
+    parsed->lexed = lexed;
+    parsed->next = 0;
+    parsed->record = record;
+    _parallelParserScan(parsed);
+
+    parsed->threadCount = parallelParserThreads(jobs);
+    if ((unsigned long)parsed->threadCount > parsed->count)
+        parsed->threadCount = parsed->count > 0 ? (int)parsed->count : 1;
+    parsed->workers = (ParallelParserWorker*)memoryAlloc(parsed->threadCount * sizeof(ParallelParserWorker));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    for (int i = 0; i < parsed->threadCount; i++) {
+        parsed->workers[i].owner = parsed;
+        parsed->workers[i].index = i;
+        diagnosticsInit(&parsed->workers[i].diagnostics, FORMAT_TEXT, 0);
+        programTokensInit(&parsed->workers[i].tokens);
+    }
+
+#ifdef PMM_PROFILE
+    // the profiler isn't thread-safe, the procedures are parsed one thread after the other
+    for (int i = 0; i < parsed->threadCount; i++)
+        _parallelParserWorker(&parsed->workers[i]);
+#else
+    pthread_t* threads = (pthread_t*)memoryAlloc(parsed->threadCount * sizeof(pthread_t));
+    bool* started = (bool*)memoryCalloc(parsed->threadCount, sizeof(bool));
+    for (int i = 1; i < parsed->threadCount; i++)
+        started[i] = !pthread_create(&threads[i], NULL, _parallelParserWorker, &parsed->workers[i]);
+    _parallelParserWorker(&parsed->workers[0]);
+    for (int i = 1; i < parsed->threadCount; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else  // no thread could be created, the procedures are parsed here
+            _parallelParserWorker(&parsed->workers[i]);
+    }
+    memoryFree(threads);
+    memoryFree(started);
+#endif
+}
+
+/**
+ * @brief Deallocates the parses and the diagnostics and tokens of the threads
+ *
+ * @param parsed a parallel parser instance
+ */
+void parallelParserDestroy(ParallelParser* parsed) {
+    for (int i = 0; i < parsed->threadCount; i++) {
+        diagnosticsDestroy(&parsed->workers[i].diagnostics);
+        programTokensDestroy(&parsed->workers[i].tokens);
+    }
+    memoryFree(parsed->workers);
+    memoryFree(parsed->parses);
+    parsed->workers = NULL;
+    parsed->threadCount = 0;
+    parsed->parses = NULL;
+    parsed->count = 0;
+}
+
+/**
+ * @brief Replays the parse of the procedure at the current token, as _procedimento would have
+ * parsed it: its diagnostics (or its tokens) are recorded, the parser moves to the token that
+ * follows it and, if it synchronized on a token of an enclosing rule, the frame of _dc_p_item is left.
+ *
+ * @param parsed a parallel parser instance
+ * @param parser the sequential parser, in _dc_p_item on a procedure token
+ * @param sincTokens synchronization tokens of the sequential parser
+ * @return true if the procedure was replayed
+ * @return false if it must be parsed (the current token wasn't parsed as a procedure or the
+ * parse went past the next procedure token)
+ */
+bool parallelParserReplay(ParallelParser* parsed, Parser* parser, SincTokens* sincTokens) {
+    // the parses are in source order and the sequential parser only moves forward
+    unsigned long position = parser->lexed->position;
+    while (parsed->next < parsed->count && parsed->parses[parsed->next].start.position < position)
+        parsed->next++;
+    if (parsed->next == parsed->count || parsed->parses[parsed->next].start.position != position)
+        return false;
+
+    const ProcedureParse* parse = &parsed->parses[parsed->next++];
+    if (!parse->valid || parser->panic || parser->stopped)
+        return false;
+
+    _parallelParserMerge(parse, parser);
+    _parallelParserRecord(parse, parser);
+    parser->errorCount += parse->errorCount;
+    parser->panic = parse->panic;
+    *parser->lexed = parse->end;
+    parser->lexer.tokenStart = parse->tokenStart;
+    parser->lexer.tokenClass = parse->tokenClass;
+    parser->lexer.value = parse->value;
+    parser->lexer.fscanfFlag = parse->fscanfFlag;
+    parser->lexer.lastWasNumberOrIdent = parse->lastWasNumberOrIdent;
+    stringOverwrite(&parser->lexer.buffer, parsed->lexed->source + parse->tokenStart, parse->length);
+    if (parse->returned)
+        _sincTokensDecr(sincTokens);
+    return true;
+}
+
+/**
+ * @brief Returns the number of threads of the parallel parser
+ *
+ * @param jobs maximum number of threads (0 uses every CPU)
+ * @return int number of threads
+ */
+int parallelParserThreads(int jobs) {
+    if (jobs <= 0)
+        jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return jobs < 1 ? 1 : jobs;
+}
+
+/**
+ * @brief Collects the procedure tokens of the lexed tokens, with the replay cursor after each one
+ *
+ * @param parsed a parallel parser instance
+ */
+void _parallelParserScan(ParallelParser* parsed) {
+    unsigned long capacity = 0;
+    parsed->parses = NULL;
+    parsed->count = 0;
+
+    ParallelLexer cursor = *parsed->lexed;
+    const LexedToken* token;
+    while ((token = _parallelLexerAdvance(&cursor)) != NULL) {
+        if (token->tokenClass != PROCEDURE || (token->flags & LEXED_ERROR))
+            continue;
+
+        if (parsed->count == capacity) {
+            capacity = (capacity == 0) ? 64 : capacity * 2;
+            parsed->parses = (ProcedureParse*)memoryRealloc(parsed->parses, capacity * sizeof(ProcedureParse));
+            PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+        }
+        parsed->parses[parsed->count].token = token;
+        parsed->parses[parsed->count].start = cursor;
+        parsed->count++;
+    }
+}
+
+/**
+ * @brief Thread of the pool: parses every threadCount-th procedure with its own parser
+ *
+ * @param argument the ParallelParserWorker
+ * @return void* NULL
+ */
+void* _parallelParserWorker(void* argument) {
+    ParallelParserWorker* worker = (ParallelParserWorker*)argument;
+    const ParallelParser* parsed = worker->owner;
+    const Allocator* previous = memoryUse(parsed->lexed->allocator);
+
+    Parser parser;
+    if (!parserInit(&parser, NULL, NULL, &worker->diagnostics)) {
+        inputOpenBuffer(&parser.lexer.sourceCode, parsed->lexed->source, parsed->lexed->size);
+        ParallelLexer cursor;
+        parser.lexed = &cursor;
+        if (parsed->record)
+            parser.recorded = &worker->tokens;
+        for (unsigned long i = worker->index; i < parsed->count; i += parsed->threadCount) {
+            // a procedure ends at the next procedure token, unless that token is skipped in panic mode
+            unsigned long tokenLimit = (i + 1 < parsed->count) ? parsed->parses[i + 1].start.position : 0;
+            _parallelParserParse(&parsed->parses[i], &parser, tokenLimit);
+        }
+        parser.lexed = NULL;  // the cursor isn't owned by the parser
+        parserDestroy(&parser);
+    } else {  // the procedures are parsed by the sequential parser
+        for (unsigned long i = worker->index; i < parsed->count; i += parsed->threadCount)
+            parsed->parses[i].valid = false;
+    }
+
+    memoryUse(previous);
+    return NULL;
+}
+
+/**
+ * @brief Parses a procedure with _procedimento, in the synchronization state of _dc_p_item: the
+ * followers of the enclosing rules are added as compile, _programa, _corpo and _dc add them, so
+ * every token has the same synchronization level it has in the sequential parse, whatever the
+ * number of procedures before it.
+ *
+ * @param parse the procedure, its outcome is recorded here
+ * @param parser parser of the thread, replaying from its own cursor
+ * @param tokenLimit the parse is abandoned after this many replayed tokens (0 means no limit)
+ */
+void _parallelParserParse(ProcedureParse* parse, Parser* parser, unsigned long tokenLimit) {
+    *parser->lexed = parse->start;
+    parser->tokenLimit = tokenLimit;
+    parser->nesting = 0;
+    parser->errorCount = 0;
+    parser->stopped = false;
+    parser->panic = false;
+
+    // the procedure token is the current token
+    const LexedToken* token = parse->token;
+    parser->lexer.tokenStart = token->offset;
+    parser->lexer.tokenClass = PROCEDURE;
+    parser->lexer.fscanfFlag = (token->flags & LEXED_EOF) ? EOF : 1;
+    parser->lexer.lastWasNumberOrIdent = false;
+    stringOverwrite(&parser->lexer.buffer, parse->start.source + token->offset, token->length);
+
+    // the diagnostics only keep the offsets, lines and columns are computed when they are merged,
+    // so the cursor of the positions starts at the procedure instead of the beginning of the file
+    parser->lexer.sourceCode.cursor.offset = token->offset;
+    parser->lexer.sourceCode.cursor.lineOffset = token->offset;
+    parse->diagnostics = parser->diagnostics;
+    parse->first = parser->diagnostics->size;
+    parse->tokens = parser->recorded;
+    parse->firstToken = (parser->recorded != NULL) ? parser->recorded->size : 0;
+
+    SincTokens sincTokens;
+    _sincTokensInit(&sincTokens);
+    static const int followers[] = {LAMBDA, DOT, BEGIN, BEGIN};  // compile, _programa, _corpo and _dc
+    for (int i = 0; i < 4; i++) {
+        _sincTokensAdd(&sincTokens, &followers[i], 1);
+        _sincTokensIncr(&sincTokens);
+    }
+
+    int depth = sincTokens.depth;
+    _procedimento(parser, &sincTokens);
+    parse->returned = (sincTokens.depth != depth);
+    _sincTokensDestroy(&sincTokens);
+
+    parse->valid = !parser->stopped;
+    parse->end = *parser->lexed;
+    parse->count = parser->diagnostics->size - parse->first;
+    parse->tokenCount = (parser->recorded != NULL) ? parser->recorded->size - parse->firstToken : 0;
+    parse->errorCount = parser->errorCount;
+    parse->panic = parser->panic;
+    parse->tokenStart = parser->lexer.tokenStart;
+    parse->length = parser->lexer.buffer.size;
+    parse->tokenClass = parser->lexer.tokenClass;
+    parse->value = parser->lexer.value;
+    parse->fscanfFlag = parser->lexer.fscanfFlag;
+    parse->lastWasNumberOrIdent = parser->lexer.lastWasNumberOrIdent;
+}
+
+/**
+ * @brief Records the diagnostics of a procedure in the diagnostics of the sequential parser, with
+ * their lines and columns
+ *
+ * @param parse the replayed procedure
+ * @param parser the sequential parser
+ */
+void _parallelParserMerge(const ProcedureParse* parse, Parser* parser) {
+    const Diagnostics* diagnostics = parse->diagnostics;
+    for (unsigned long i = parse->first; i < parse->first + parse->count; i++) {
+        const Diagnostic* diagnostic = &diagnostics->list[i];
+        if (diagnostic->kind == DIAGNOSTIC_EOF) {
+            diagnosticsEOF(parser->diagnostics);
+            continue;
+        }
+
+        SourcePosition position;
+        inputPosition(&parser->lexer.sourceCode, diagnostic->offset, &position);
+        const char* text = (diagnostic->text == NO_TEXT) ? NULL : diagnostics->textPool.str + diagnostic->text;
+        if (diagnostic->kind == DIAGNOSTIC_LEXER)
+            diagnosticsLexerError(parser->diagnostics, &position, text, diagnostic->code);
+        else
+            diagnosticsParserError(parser->diagnostics, &position, diagnostic->code, text);
+    }
+}
+
+/**
+ * @brief Records the tokens of a procedure in the tokens of the sequential parser, with their
+ * lines and columns. They are only needed by a program without errors, so they are left out when
+ * the procedure has diagnostics (their positions would go backwards after them).
+ *
+ * @param parse the replayed procedure
+ * @param parser the sequential parser
+ */
+void _parallelParserRecord(const ProcedureParse* parse, Parser* parser) {
+    if (parser->recorded == NULL || parse->tokens == NULL || parse->count > 0)
+        return;
+    for (unsigned long i = parse->firstToken; i < parse->firstToken + parse->tokenCount; i++) {
+        SourcePosition position;
+        inputPosition(&parser->lexer.sourceCode, parse->tokens->list[i].position.offset, &position);
+        programTokensCopy(parser->recorded, parse->tokens, i, &position);
+    }
+}
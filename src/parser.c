@@ -9,7 +9,10 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "../header/string.h"
+#include "../header/ll1.h"
+#include "../header/memory.h"
+#include "../header/parallelparser.h"
+#include "../header/profile.h"
 
 /**
  * @brief Panic mode. When the expected token isn't found, his followers are added to the
@@ -27,7 +30,7 @@
         static const int followers[] = {__VA_ARGS__};                              \
         _sincTokensAdd(sincTokens, followers, sizeof(followers) / sizeof(int));    \
         _error(parser, expectedTokenClass, sincTokens);                            \
-        int level = stackPeak(sincTokens[parser->lexer.tokenClass]);               \
+        int level = _sincTokensLevel(sincTokens, parser->lexer.tokenClass);        \
         _sincTokensRemove(sincTokens, followers, sizeof(followers) / sizeof(int)); \
         if (level != 0) {                                                          \
             _sincTokensDecr(sincTokens);                                           \
@@ -51,7 +54,7 @@
         _sincTokensAdd(sincTokens, followers, sizeof(followers) / sizeof(int));            \
         rule(parser, sincTokens);                                                          \
         int return_flag = 0; /*check if panic mode is active and level is greater than 0*/ \
-        if (parser->panic && stackPeak(sincTokens[parser->lexer.tokenClass]) > 0) {        \
+        if (parser->panic && _sincTokensLevel(sincTokens, parser->lexer.tokenClass) > 0) { \
             return_flag = 1;                                                               \
         }                                                                                  \
         _sincTokensRemove(sincTokens, followers, sizeof(followers) / sizeof(int));         \
@@ -62,26 +65,120 @@
         parser->panic = false;                                                             \
     }
 
+/**
+ * @brief Iterative treatment of right-recursive list rules (<list> ::= <element> <list> | lambda). Instead of
+ * one recursive call per element, the elements are recognized in a loop, so the stack depth doesn't depend on
+ * the length of the list. The recursive calls would add the same followers on every element, so, from the
+ * second element on, a single frame with those followers stands for the frames of the previous elements:
+ * synchronizing on it ends the list, as returning through the recursive calls would. The list rule itself
+ * has no frame, the first element is nested directly in the caller, as it was.
+ *
+ * @param element function that recognizes one element of the list
+ * @param lookahead condition to recognize one more element
+ * @param ... followers of the recursive call
+ */
+#define LISTRULE(element, lookahead, ...)                                                     \
+    {                                                                                         \
+        static const int followers[] = {__VA_ARGS__};                                         \
+        bool nested = false;                                                                  \
+        while (lookahead) {                                                                   \
+            element(parser, sincTokens);                                                      \
+            if (parser->panic) /*level > 0 for the element*/                                  \
+                break;                                                                        \
+            if (!nested) { /*frame of the previous elements*/                                 \
+                _sincTokensIncr(sincTokens);                                                  \
+                _sincTokensAdd(sincTokens, followers, sizeof(followers) / sizeof(int));       \
+                nested = true;                                                                \
+            }                                                                                 \
+        }                                                                                     \
+        if (nested) {                                                                         \
+            if (parser->panic && _sincTokensLevel(sincTokens, parser->lexer.tokenClass) == 0) \
+                parser->panic = false;                                                        \
+            _sincTokensRemove(sincTokens, followers, sizeof(followers) / sizeof(int));        \
+            _sincTokensDecr(sincTokens);                                                      \
+        }                                                                                     \
+    }
+
+/**
+ * @brief NEXTRULE for the calls of the expression rules: the followers are deferred instead of pushed, as they
+ * are only looked at after an error. _sincTokensAdd pushes the deferred sets before its own tokens, so the
+ * stacks are the same as with NEXTRULE whenever the panic mode uses them.
+ *
+ * @param rule next rule function name
+ * @param ... followers of the corresponding variable
+ */
+#define LAZYRULE(rule, ...)                                                       \
+    {                                                                             \
+        static const int followers[] = {__VA_ARGS__};                             \
+        _sincTokensDefer(sincTokens, followers, sizeof(followers) / sizeof(int)); \
+        rule(parser, sincTokens);                                                 \
+        if (_deferredReturn(parser, sincTokens)) {                                \
+            _sincTokensDecr(sincTokens);                                          \
+            return;                                                               \
+        }                                                                         \
+    }
+
+/**
+ * @brief Defers a follower set given as an array
+ *
+ * @param followers array of token classes
+ */
+#define DEFER(followers) _sincTokensDefer(sincTokens, followers, sizeof(followers) / sizeof(int))
+
 /**
  * @brief Initializes parser variables
  *
  * @param parser a parser instance
  * @param sourceCodePath a source code path to be compiled
+ * @param tokenOutputPath file where the tokens are dumped (NULL disables the dump)
+ * @param diagnostics diagnostics where errors are recorded
  * @return true if there was some error
  * @return false if there was no error
  */
-bool parserInit(Parser* parser, const char* sourceCodePath) {
+bool parserInit(Parser* parser, const char* sourceCodePath, const char* tokenOutputPath, Diagnostics* diagnostics) {
+    parser->nesting = 0;
     parser->errorCount = 0;
+    parser->errorLimit = 0;
+    parser->stopped = false;
     parser->panic = false;
+    parser->engine = ENGINE_RECURSIVE;
+    parser->jobs = 1;
+    parser->tokenLimit = 0;
+    parser->tokens = NULL;
+    parser->lexed = NULL;
+    parser->procedures = NULL;
+    parser->recorded = NULL;
+    parser->diagnostics = diagnostics;
+    _sincTokensInit(&parser->sincTokens);
+    parser->ll1Frames = NULL;
+
+    if (lexerInit(&parser->lexer, sourceCodePath, tokenOutputPath)) {
+        return true;
+    }
+
+    return false;
+}
 
-    if (lexerInit(&parser->lexer, sourceCodePath)) {
+/**
+ * @brief Initializes parser variables to compile a serialized token stream, without lexing
+ *
+ * @param parser a parser instance
+ * @param tokenStreamPath path of a token stream written by tokenStreamEmit
+ * @param diagnostics diagnostics where errors are recorded
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool parserInitFromTokens(Parser* parser, const char* tokenStreamPath, Diagnostics* diagnostics) {
+    if (parserInit(parser, NULL, NULL, diagnostics)) {
         return true;
     }
 
-    // open output file
-    parser->output = fopen("output.txt", "w");
-    if (parser->output == NULL) {
-        printf("Error: couldn't create output file\n");
+    parser->tokens = (TokenStream*)memoryAlloc(sizeof(TokenStream));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    if (tokenStreamOpen(parser->tokens, tokenStreamPath)) {
+        memoryFree(parser->tokens);
+        parser->tokens = NULL;
+        lexerDestroy(&parser->lexer);
         return true;
     }
 
@@ -89,79 +186,235 @@ bool parserInit(Parser* parser, const char* sourceCodePath) {
 }
 
 /**
- * @brief Destroy file handles and the lexer
+ * @brief Initializes parser variables to compile an in-memory source code, without touching any file
+ *
+ * @param parser a parser instance
+ * @param source P-- source code, it must outlive the parser
+ * @param size size of the source code in bytes
+ * @param diagnostics diagnostics where errors are recorded
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool parserInitBuffer(Parser* parser, const char* source, unsigned long size, Diagnostics* diagnostics) {
+    if (parserInit(parser, NULL, NULL, diagnostics)) {
+        return true;
+    }
+
+    inputOpenBuffer(&parser->lexer.sourceCode, source, size);
+    return false;
+}
+
+/**
+ * @brief Initializes parser variables to compile a source code file lexed in parallel before the
+ * syntax analysis. The file is mapped in memory, so it can't be stdin.
+ *
+ * @param parser a parser instance
+ * @param sourceCodePath a source code path to be compiled
+ * @param tokenOutputPath file where the tokens are dumped (NULL disables the dump)
+ * @param jobs maximum number of lexer threads (0 uses every CPU)
+ * @param diagnostics diagnostics where errors are recorded
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool parserInitParallel(Parser* parser, const char* sourceCodePath, const char* tokenOutputPath, int jobs, Diagnostics* diagnostics) {
+    if (parserInit(parser, NULL, tokenOutputPath, diagnostics)) {
+        return true;
+    }
+
+    PROFILE_ENTER(PHASE_LEXER);
+    parser->lexed = (ParallelLexer*)memoryAlloc(sizeof(ParallelLexer));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    bool error = parallelLexerOpen(parser->lexed, sourceCodePath, jobs);
+    PROFILE_LEAVE();
+    if (error) {
+        memoryFree(parser->lexed);
+        parser->lexed = NULL;
+        lexerDestroy(&parser->lexer);
+        return true;
+    }
+    parser->jobs = jobs;
+
+    // positions of the replayed tokens are computed on the mapped source code
+    inputOpenBuffer(&parser->lexer.sourceCode, parser->lexed->source, parser->lexed->size);
+    return false;
+}
+
+/**
+ * @brief Destroy the lexer, the token stream, the parallel lexer, the parallel parser and the parse state
  *
  * @param parser initialized parser instance
  */
 void parserDestroy(Parser* parser) {
-    fclose(parser->output);
+    if (parser->tokens != NULL) {
+        tokenStreamClose(parser->tokens);
+        memoryFree(parser->tokens);
+    }
+    if (parser->procedures != NULL) {
+        parallelParserDestroy(parser->procedures);
+        memoryFree(parser->procedures);
+    }
+    if (parser->lexed != NULL) {
+        parallelLexerDestroy(parser->lexed);
+        memoryFree(parser->lexed);
+    }
+    _sincTokensDestroy(&parser->sincTokens);
+    memoryFree(parser->ll1Frames);
     lexerDestroy(&parser->lexer);
 }
 
 /**
- * @brief Initialize vector of synchronization tokens. Each element is a stack
- * that records all the levels at which the corresponding token is a synchronization
- * symbol. Initially, there are no synchronization symbols, to all elements of the vector
- * are null.
- * On the elements of the stack, values greater then or equal to 0 indicate the depth
- * of the synchronization, while NULL stacks indicates that that token is not a synchronization
- * token at the moment
+ * @brief Initialize synchronization tokens. Each token class has a stack that records
+ * the depths of the rules in which the token is a synchronization symbol, and a bit
+ * of the mask that is set while that stack isn't empty. Initially, there are no
+ * synchronization symbols.
  *
- * @param sincTokens synchronization token vector
+ * @param sincTokens synchronization tokens
  */
-void _sincTokensInit(Node* sincTokens[]) {
+void _sincTokensInit(SincTokens* sincTokens) {
     for (int i = 0; i < N_TOKEN_CLASS; i++)
-        sincTokens[i] = NULL;
+        stackInit(&sincTokens->stacks[i]);
+    sincTokens->mask = 0;
+    sincTokens->depth = 0;
+    sincTokens->deferred = NULL;
+    sincTokens->deferredSize = 0;
+    sincTokens->deferredCapacity = 0;
+    sincTokens->materialized = 0;
 }
 
 /**
- * @brief Destroy stack of synchronization tokens.
+ * @brief Destroy stacks of synchronization tokens, leaving them empty (they can be destroyed again).
  *
- * @param sincTokens synchronization token vector
+ * @param sincTokens synchronization tokens
  */
-void _sincTokensDestroy(Node* sincTokens[]) {
+void _sincTokensDestroy(SincTokens* sincTokens) {
     for (int i = 0; i < N_TOKEN_CLASS; i++)
-        stackDestroy(&sincTokens[i]);
+        stackDestroy(&sincTokens->stacks[i]);
+    memoryFree(sincTokens->deferred);
+    _sincTokensInit(sincTokens);
 }
 
 /**
- * @brief Add synchronization tokens.
+ * @brief Add synchronization tokens at the current depth. The deferred followers are pushed
+ * first, they belong to enclosing rules.
  *
- * @param sincTokens synchronization token vector
+ * @param sincTokens synchronization tokens
  */
-void _sincTokensAdd(Node* sincTokens[], const int toAdd[], unsigned long toAddSize) {
-    for (unsigned long i = 0; i < toAddSize; i++)
-        stackPush(&sincTokens[toAdd[i]]);
+void _sincTokensAdd(SincTokens* sincTokens, const int toAdd[], unsigned long toAddSize) {
+    if (sincTokens->materialized < sincTokens->deferredSize)
+        _sincTokensMaterialize(sincTokens);
+
+    PROFILE_ENTER(PHASE_SYNC);
+    for (unsigned long i = 0; i < toAddSize; i++) {
+        stackPush(&sincTokens->stacks[toAdd[i]], sincTokens->depth);
+        sincTokens->mask |= (uint64_t)1 << toAdd[i];
+    }
+    PROFILE_COUNT(COUNTER_SYNC_PUSHES, toAddSize);
+    PROFILE_LEAVE();
 }
 
 /**
- * @brief Increment depth of synchronization tokens.
+ * @brief Increment depth of synchronization tokens. The depths are stored as absolute
+ * values, so entering a rule is O(1) regardless of how many tokens are on the stacks.
  *
- * @param sincTokens synchronization token vector
+ * @param sincTokens synchronization tokens
  */
-void _sincTokensIncr(Node* sincTokens[]) {
-    for (int i = 0; i < N_TOKEN_CLASS; i++)
-        stackAdd(&sincTokens[i], 1);
+void _sincTokensIncr(SincTokens* sincTokens) {
+    sincTokens->depth++;
+    PROFILE_DEPTH(1);
 }
 
 /**
  * @brief Decrement depth of synchronization tokens.
  *
- * @param sincTokens sybchronization token vector
+ * @param sincTokens synchronization tokens
  */
-void _sincTokensDecr(Node* sincTokens[]) {
-    for (int i = 0; i < N_TOKEN_CLASS; i++)
-        stackAdd(&sincTokens[i], -1);
+void _sincTokensDecr(SincTokens* sincTokens) {
+    sincTokens->depth--;
+    PROFILE_DEPTH(-1);
 }
 
 /**
  * @brief Remove synchronization tokens.
  *
- * @param sincTokens synchronization token vector
+ * @param sincTokens synchronization tokens
  */
-void _sincTokensRemove(Node* sincTokens[], const int toRemove[], unsigned long toRemoveSize) {
-    for (unsigned long i = 0; i < toRemoveSize; i++)
-        stackPop(&sincTokens[toRemove[i]]);
+void _sincTokensRemove(SincTokens* sincTokens, const int toRemove[], unsigned long toRemoveSize) {
+    PROFILE_ENTER(PHASE_SYNC);
+    for (unsigned long i = 0; i < toRemoveSize; i++) {
+        Stack* stack = &sincTokens->stacks[toRemove[i]];
+        stackPop(stack);
+        if (stack->size == 0)
+            sincTokens->mask &= ~((uint64_t)1 << toRemove[i]);
+    }
+    PROFILE_LEAVE();
+}
+
+/**
+ * @brief Gets the synchronization level of a token: 0 if the innermost rule in which it is a
+ * synchronization token is the current one, n if it is n rules below the current one.
+ *
+ * @param sincTokens synchronization tokens
+ * @param tokenClass TOKEN_CLASS of the token
+ * @return int the level or -1 if the token is not a synchronization token
+ */
+int _sincTokensLevel(const SincTokens* sincTokens, int tokenClass) {
+    if (!(sincTokens->mask & ((uint64_t)1 << tokenClass)))
+        return -1;
+
+    return sincTokens->depth - stackPeak(&sincTokens->stacks[tokenClass]);
+}
+
+/**
+ * @brief Defers the push of followers at the current depth: they are pushed by
+ * _sincTokensMaterialize, when they are needed, unless they are undeferred before.
+ *
+ * @param sincTokens synchronization tokens
+ * @param followers token classes, the array must outlive the call (it is static)
+ * @param size number of token classes
+ */
+void _sincTokensDefer(SincTokens* sincTokens, const int followers[], unsigned long size) {
+    if (sincTokens->deferredSize == sincTokens->deferredCapacity) {
+        sincTokens->deferredCapacity = (sincTokens->deferredCapacity == 0) ? 16 : 2 * sincTokens->deferredCapacity;
+        sincTokens->deferred = (DeferredFollowers*)memoryRealloc(sincTokens->deferred,
+                                                                 sincTokens->deferredCapacity * sizeof(DeferredFollowers));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    DeferredFollowers* deferred = &sincTokens->deferred[sincTokens->deferredSize++];
+    deferred->followers = followers;
+    deferred->size = size;
+    deferred->depth = sincTokens->depth;
+}
+
+/**
+ * @brief Removes the last deferred followers, from the stacks if they were pushed.
+ *
+ * @param sincTokens synchronization tokens
+ */
+void _sincTokensUndefer(SincTokens* sincTokens) {
+    const DeferredFollowers* deferred = &sincTokens->deferred[--sincTokens->deferredSize];
+    if (sincTokens->materialized > sincTokens->deferredSize) {
+        sincTokens->materialized--;
+        _sincTokensRemove(sincTokens, deferred->followers, deferred->size);
+    }
+}
+
+/**
+ * @brief Pushes the deferred followers that weren't pushed yet, in order, at the depths they
+ * were deferred at. The stacks are then the same as if they had been pushed by NEXTRULE.
+ *
+ * @param sincTokens synchronization tokens
+ */
+void _sincTokensMaterialize(SincTokens* sincTokens) {
+    PROFILE_ENTER(PHASE_SYNC);
+    for (; sincTokens->materialized < sincTokens->deferredSize; sincTokens->materialized++) {
+        const DeferredFollowers* deferred = &sincTokens->deferred[sincTokens->materialized];
+        for (unsigned long i = 0; i < deferred->size; i++) {
+            stackPush(&sincTokens->stacks[deferred->followers[i]], deferred->depth);
+            sincTokens->mask |= (uint64_t)1 << deferred->followers[i];
+        }
+        PROFILE_COUNT(COUNTER_SYNC_PUSHES, deferred->size);
+    }
+    PROFILE_LEAVE();
 }
 
 /**
@@ -170,12 +423,28 @@ void _sincTokensRemove(Node* sincTokens[], const int toRemove[], unsigned long t
  * @param parser initialized parser instance
  */
 void compile(Parser* parser) {
+    PROFILE_ENTER(PHASE_PARSER);
+    if (parser->engine == ENGINE_TABLE) {
+        ll1Compile(parser);
+        PROFILE_LEAVE();
+        return;
+    }
+
+    // procedures are parsed in parallel when the tokens were lexed in parallel, unless the errors
+    // are limited (the limit depends on the errors before each procedure) or the tokens are dumped
+    // (replayed procedures skip their tokens); recorded tokens are recorded by the threads too
+    if (parser->lexed != NULL && parallelParserThreads(parser->jobs) > 1 && parser->errorLimit == 0 &&
+        parser->lexer.tokenOutput == NULL) {
+        parser->procedures = (ParallelParser*)memoryAlloc(sizeof(ParallelParser));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+        parallelParserRun(parser->procedures, parser->lexed, parser->jobs, parser->recorded != NULL);
+    }
+
     // get first token
-    parser->errorCount += nextToken(&parser->lexer, parser->output);
+    parser->errorCount += _nextToken(parser);
 
-    // initialize synchronization tokens vector
-    Node* sincTokens[N_TOKEN_CLASS];
-    _sincTokensInit(sincTokens);
+    // synchronization tokens vector, initially empty
+    SincTokens* sincTokens = &parser->sincTokens;
 
     // starts building the implicit parse tree
     const int followers[] = {LAMBDA};
@@ -188,6 +457,7 @@ void compile(Parser* parser) {
     }
 
     _sincTokensDestroy(sincTokens);
+    PROFILE_LEAVE();
 }
 
 /**
@@ -195,21 +465,21 @@ void compile(Parser* parser) {
  * <programa> ::= program ident ; <corpo> .
  * @param parser initialized parser instance
  */
-void _programa(Parser* parser, Node* sincTokens[]) {
+void _programa(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == PROGRAM) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(PROGRAM, ID)
     }
     if (parser->lexer.tokenClass == ID) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(ID, SEMICOLON)
     }
     if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(SEMICOLON, CONST, VAR, PROCEDURE, BEGIN)
     }
@@ -217,7 +487,7 @@ void _programa(Parser* parser, Node* sincTokens[]) {
     NEXTRULE(_corpo, DOT)
 
     if (parser->lexer.tokenClass == DOT) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(DOT, LAMBDA)
     }
@@ -230,19 +500,19 @@ void _programa(Parser* parser, Node* sincTokens[]) {
  * <corpo> ::= <dc> begin <comandos> end
  * @param parser initialized parser instance
  */
-void _corpo(Parser* parser, Node* sincTokens[]) {
+void _corpo(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     NEXTRULE(_dc, BEGIN)
     if (parser->lexer.tokenClass == BEGIN) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(BEGIN, READ, WRITE, WHILE, IF, FOR, ID, BEGIN, END)
     }
 
     NEXTRULE(_comandos, END)
     if (parser->lexer.tokenClass == END) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(END, DOT)
     }
@@ -255,7 +525,7 @@ void _corpo(Parser* parser, Node* sincTokens[]) {
  * <dc> ::= <dc_c> <dc_v> <dc_p>
  * @param parser initialized parser instance
  */
-void _dc(Parser* parser, Node* sincTokens[]) {
+void _dc(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     NEXTRULE(_dc_c, BEGIN, VAR, PROCEDURE)
@@ -270,33 +540,36 @@ void _dc(Parser* parser, Node* sincTokens[]) {
  * <dc_c> ::= const ident = <numero>  ; <dc_c> | lambda
  * @param parser initialized parser instance
  */
-void _dc_c(Parser* parser, Node* sincTokens[]) {
+void _dc_c(Parser* parser, SincTokens* sincTokens) {
+    LISTRULE(_dc_c_item, parser->lexer.tokenClass == CONST, BEGIN, VAR, PROCEDURE)
+}
+
+/**
+ * @brief Recognizes one constant declaration of rule 4:
+ * const ident = <numero> ;
+ * @param parser initialized parser instance
+ */
+void _dc_c_item(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
-    if (parser->lexer.tokenClass == CONST) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {  // lambda
-        _sincTokensDecr(sincTokens);
-        return;
-    }
+    parser->errorCount += _nextToken(parser);  // const
     if (parser->lexer.tokenClass == ID) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(ID, ASSIGN)
     }
     if (!strcmp(parser->lexer.buffer.str, "=")) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(EQUALS, N_INTEGER, N_REAL)
     }
 
     NEXTRULE(_numero, SEMICOLON)
     if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(SEMICOLON, CONST, BEGIN, VAR, PROCEDURE);
     }
-    NEXTRULE(_dc_c, BEGIN, VAR, PROCEDURE)
 
     _sincTokensDecr(sincTokens);
 }
@@ -306,30 +579,32 @@ void _dc_c(Parser* parser, Node* sincTokens[]) {
  * <dc_v> ::= var <variaveis> : <tipo_var> ; <dc_v> | lambda
  * @param parser initialized parser instance
  */
-void _dc_v(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
+void _dc_v(Parser* parser, SincTokens* sincTokens) {
+    LISTRULE(_dc_v_item, parser->lexer.tokenClass == VAR, BEGIN, PROCEDURE)
+}
 
-    if (parser->lexer.tokenClass == VAR) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {  // lambda
-        _sincTokensDecr(sincTokens);
-        return;
-    }
+/**
+ * @brief Recognizes one variable declaration of rule 5:
+ * var <variaveis> : <tipo_var> ;
+ * @param parser initialized parser instance
+ */
+void _dc_v_item(Parser* parser, SincTokens* sincTokens) {
+    _sincTokensIncr(sincTokens);
 
+    parser->errorCount += _nextToken(parser);  // var
     NEXTRULE(_variaveis, DECLARE_TYPE)
     if (parser->lexer.tokenClass == DECLARE_TYPE) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(DECLARE_TYPE, REAL, INTEGER)
     }
 
     NEXTRULE(_tipo_var, SEMICOLON)
     if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(SEMICOLON, VAR, BEGIN, PROCEDURE)
     }
-    NEXTRULE(_dc_v, BEGIN, PROCEDURE)
 
     _sincTokensDecr(sincTokens);
 }
@@ -339,11 +614,11 @@ void _dc_v(Parser* parser, Node* sincTokens[]) {
  * <tipo_var> ::= real | integer
  * @param parser initialized parser instance
  */
-void _tipo_var(Parser* parser, Node* sincTokens[]) {
+void _tipo_var(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == REAL || parser->lexer.tokenClass == INTEGER) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {  // multiple type
         PANICMODE(TYPES, SEMICOLON, CLOSE_PAR)
     }
@@ -352,73 +627,81 @@ void _tipo_var(Parser* parser, Node* sincTokens[]) {
 }
 
 /**
- * @brief Implements rule 7 of the grammar:
+ * @brief Implements rules 7 and 8 of the grammar:
  * <variaveis> ::= ident <mais_var>
+ * <mais_var> ::= , <variaveis> | lambda
+ * The list is recognized iteratively. The followers of the recursive calls (: and ')') are
+ * synchronization tokens of the ident itself, so no error can synchronize on them.
  * @param parser initialized parser instance
  */
-void _variaveis(Parser* parser, Node* sincTokens[]) {
+void _variaveis(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
-    if (parser->lexer.tokenClass == ID) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {
-        PANICMODE(ID, COLON, DECLARE_TYPE, CLOSE_PAR)
+    while (true) {
+        if (parser->lexer.tokenClass == ID) {
+            parser->errorCount += _nextToken(parser);
+        } else {
+            PANICMODE(ID, COLON, DECLARE_TYPE, CLOSE_PAR)
+        }
+
+        if (parser->lexer.tokenClass != COLON)  // lambda
+            break;
+        parser->errorCount += _nextToken(parser);
     }
-    NEXTRULE(_mais_var, DECLARE_TYPE, CLOSE_PAR)
 
     _sincTokensDecr(sincTokens);
 }
 
 /**
- * @brief Implements rule 8 of the grammar:
- * <mais_var> ::= , <variaveis> | lambda
+ * @brief Implements rule 9 of the grammar:
+ * <dc_p> ::= procedure ident <parametros> ; <corpo_p> <dc_p> | lambda
+ * @param parser initialized parser instance
+ */
+void _dc_p(Parser* parser, SincTokens* sincTokens) {
+    LISTRULE(_dc_p_item, parser->lexer.tokenClass == PROCEDURE, BEGIN)
+}
+
+/**
+ * @brief Recognizes one procedure declaration of rule 9, replayed from the parallel parser when
+ * it parsed it:
+ * procedure ident <parametros> ; <corpo_p>
  * @param parser initialized parser instance
  */
-void _mais_var(Parser* parser, Node* sincTokens[]) {
+void _dc_p_item(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
-    if (parser->lexer.tokenClass == COLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {  // lambda
-        _sincTokensDecr(sincTokens);
+    int depth = sincTokens->depth;
+    if (parser->procedures == NULL || !parallelParserReplay(parser->procedures, parser, sincTokens))
+        _procedimento(parser, sincTokens);
+    if (sincTokens->depth != depth)  // synchronized on a token of an enclosing rule
         return;
-    }
-    NEXTRULE(_variaveis, DECLARE_TYPE, CLOSE_PAR)
 
     _sincTokensDecr(sincTokens);
 }
 
 /**
- * @brief Implements rule 9 of the grammar:
- * <dc_p> ::= procedure ident <parametros> ; <corpo_p> <dc_p> | lambda
+ * @brief Implements the first part of rule 9 of the grammar, in the frame of _dc_p_item (its panic
+ * modes leave that frame, which _dc_p_item detects by the depth):
+ * procedure ident <parametros> ; <corpo_p>
+ * It only depends on its tokens, so it is also what the parallel parser runs for every procedure.
  * @param parser initialized parser instance
  */
-void _dc_p(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
-
-    if (parser->lexer.tokenClass == PROCEDURE) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {  // lambda
-        _sincTokensDecr(sincTokens);
-        return;
-    }
+void _procedimento(Parser* parser, SincTokens* sincTokens) {
+    parser->errorCount += _nextToken(parser);
 
     if (parser->lexer.tokenClass == ID) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(ID, OPEN_PAR, SEMICOLON)
     }
 
     NEXTRULE(_parametros, SEMICOLON)
     if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(SEMICOLON, VAR, BEGIN)
     }
     NEXTRULE(_corpo_p, BEGIN, PROCEDURE)
-    NEXTRULE(_dc_p, BEGIN)
-
-    _sincTokensDecr(sincTokens);
 }
 
 /**
@@ -426,11 +709,11 @@ void _dc_p(Parser* parser, Node* sincTokens[]) {
  * <parametros> ::= ( <lista_par> ) | lambda
  * @param parser initialized parser instance
  */
-void _parametros(Parser* parser, Node* sincTokens[]) {
+void _parametros(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == OPEN_PAR) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {  // lambda
         _sincTokensDecr(sincTokens);
         return;
@@ -438,7 +721,7 @@ void _parametros(Parser* parser, Node* sincTokens[]) {
 
     NEXTRULE(_lista_par, CLOSE_PAR)
     if (parser->lexer.tokenClass == CLOSE_PAR) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(CLOSE_PAR, SEMICOLON)
     }
@@ -451,36 +734,70 @@ void _parametros(Parser* parser, Node* sincTokens[]) {
  * <lista_par> ::= <variaveis> : <tipo_var> <mais_par>
  * @param parser initialized parser instance
  */
-void _lista_par(Parser* parser, Node* sincTokens[]) {
+void _lista_par(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
+    int depth = sincTokens->depth;
+    _parametro(parser, sincTokens);
+    if (sincTokens->depth != depth)  // synchronized on a token of an enclosing rule
+        return;
+    NEXTRULE(_mais_par, CLOSE_PAR)
+
+    _sincTokensDecr(sincTokens);
+}
+
+/**
+ * @brief Implements the first part of rule 11 of the grammar, in the frame of _lista_par or
+ * _lista_par_item (its panic modes leave that frame, which they detect by the depth):
+ * <variaveis> : <tipo_var>
+ * @param parser initialized parser instance
+ */
+void _parametro(Parser* parser, SincTokens* sincTokens) {
     NEXTRULE(_variaveis, DECLARE_TYPE)
     if (parser->lexer.tokenClass == DECLARE_TYPE) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(DECLARE_TYPE, REAL, INTEGER)
     }
     NEXTRULE(_tipo_var, COLON, DECLARE_TYPE, CLOSE_PAR)
-    NEXTRULE(_mais_par, CLOSE_PAR)
-
-    _sincTokensDecr(sincTokens);
 }
 
 /**
  * @brief Implements rule 12 of the grammar:
  * <mais_par> ::= ; <lista_par> | lambda
+ * The <mais_par> of each <lista_par> is the next element of the list.
+ * @param parser initialized parser instance
+ */
+void _mais_par(Parser* parser, SincTokens* sincTokens) {
+    LISTRULE(_mais_par_item, parser->lexer.tokenClass == SEMICOLON, CLOSE_PAR)
+}
+
+/**
+ * @brief Recognizes one element of rule 12, without the <mais_par> of its <lista_par>:
+ * ; <variaveis> : <tipo_var>
  * @param parser initialized parser instance
  */
-void _mais_par(Parser* parser, Node* sincTokens[]) {
+void _mais_par_item(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
-    if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {  // lambda
-        _sincTokensDecr(sincTokens);
+    parser->errorCount += _nextToken(parser);  // ;
+    NEXTRULE(_lista_par_item, CLOSE_PAR)
+
+    _sincTokensDecr(sincTokens);
+}
+
+/**
+ * @brief Recognizes the <lista_par> of an element of rule 12, without its <mais_par>:
+ * <variaveis> : <tipo_var>
+ * @param parser initialized parser instance
+ */
+void _lista_par_item(Parser* parser, SincTokens* sincTokens) {
+    _sincTokensIncr(sincTokens);
+
+    int depth = sincTokens->depth;
+    _parametro(parser, sincTokens);
+    if (sincTokens->depth != depth)  // synchronized on a token of an enclosing rule
         return;
-    }
-    NEXTRULE(_lista_par, CLOSE_PAR)
 
     _sincTokensDecr(sincTokens);
 }
@@ -490,25 +807,25 @@ void _mais_par(Parser* parser, Node* sincTokens[]) {
  * <corpo_p> ::= <dc_loc> begin <comandos> end ;
  * @param parser initialized parser instance
  */
-void _corpo_p(Parser* parser, Node* sincTokens[]) {
+void _corpo_p(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     NEXTRULE(_dc_loc, BEGIN)
     if (parser->lexer.tokenClass == BEGIN) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(BEGIN, READ, WRITE, WHILE, IF, FOR, ID, BEGIN, END)
     }
 
     NEXTRULE(_comandos, END)
     if (parser->lexer.tokenClass == END) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(END, SEMICOLON)
     }
 
     if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(SEMICOLON, BEGIN, PROCEDURE)
     }
@@ -521,7 +838,7 @@ void _corpo_p(Parser* parser, Node* sincTokens[]) {
  * <dc_loc> ::= <dc_v>
  * @param parser initialized parser instance
  */
-void _dc_loc(Parser* parser, Node* sincTokens[]) {
+void _dc_loc(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     NEXTRULE(_dc_v, BEGIN)
@@ -534,11 +851,11 @@ void _dc_loc(Parser* parser, Node* sincTokens[]) {
  * <lista_arg> ::= ( <argumentos> ) | lambda
  * @param parser initialized parser instance
  */
-void _lista_arg(Parser* parser, Node* sincTokens[]) {
+void _lista_arg(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == OPEN_PAR) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {  // lambda
         _sincTokensDecr(sincTokens);
         return;
@@ -546,7 +863,7 @@ void _lista_arg(Parser* parser, Node* sincTokens[]) {
 
     NEXTRULE(_argumentos, CLOSE_PAR)
     if (parser->lexer.tokenClass == CLOSE_PAR) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(CLOSE_PAR, SEMICOLON)
     }
@@ -555,38 +872,26 @@ void _lista_arg(Parser* parser, Node* sincTokens[]) {
 }
 
 /**
- * @brief Implements rule 16 of the grammar:
+ * @brief Implements rules 16 and 17 of the grammar:
  * <argumentos> ::= ident <mais_ident>
- * @param parser initialized parser instance
- */
-void _argumentos(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
-
-    if (parser->lexer.tokenClass == ID) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {
-        PANICMODE(ID, SEMICOLON, CLOSE_PAR)
-    }
-    NEXTRULE(_mais_ident, CLOSE_PAR)
-
-    _sincTokensDecr(sincTokens);
-}
-
-/**
- * @brief Implements rule 17 of the grammar:
  * <mais_ident> ::= ; <argumentos> | lambda
+ * The list is recognized iteratively, as in <variaveis>.
  * @param parser initialized parser instance
  */
-void _mais_ident(Parser* parser, Node* sincTokens[]) {
+void _argumentos(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
-    if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {  // lambda
-        _sincTokensDecr(sincTokens);
-        return;
+    while (true) {
+        if (parser->lexer.tokenClass == ID) {
+            parser->errorCount += _nextToken(parser);
+        } else {
+            PANICMODE(ID, SEMICOLON, CLOSE_PAR)
+        }
+
+        if (parser->lexer.tokenClass != SEMICOLON)  // lambda
+            break;
+        parser->errorCount += _nextToken(parser);
     }
-    NEXTRULE(_argumentos, CLOSE_PAR)
 
     _sincTokensDecr(sincTokens);
 }
@@ -596,11 +901,11 @@ void _mais_ident(Parser* parser, Node* sincTokens[]) {
  * <pfalsa> ::= else <cmd> | lambda
  * @param parser initialized parser instance
  */
-void _pfalsa(Parser* parser, Node* sincTokens[]) {
+void _pfalsa(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == ELSE) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {  // lambda
         _sincTokensDecr(sincTokens);
         return;
@@ -615,33 +920,56 @@ void _pfalsa(Parser* parser, Node* sincTokens[]) {
  * <comandos> ::= <cmd> ; <comandos> | lambda
  * @param parser initialized parser instance
  */
-void _comandos(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
+void _comandos(Parser* parser, SincTokens* sincTokens) {
+    LISTRULE(_comandos_item,
+             parser->lexer.tokenClass == READ ||
+                 parser->lexer.tokenClass == WRITE ||
+                 parser->lexer.tokenClass == WHILE ||
+                 parser->lexer.tokenClass == IF ||
+                 parser->lexer.tokenClass == FOR ||
+                 parser->lexer.tokenClass == ID ||
+                 parser->lexer.tokenClass == BEGIN,
+             END)
+}
 
-    if (parser->lexer.tokenClass != READ &&
-        parser->lexer.tokenClass != WRITE &&
-        parser->lexer.tokenClass != WHILE &&
-        parser->lexer.tokenClass != IF &&
-        parser->lexer.tokenClass != FOR &&
-        parser->lexer.tokenClass != ID &&
-        parser->lexer.tokenClass != BEGIN) {  // lookahead
-        _sincTokensDecr(sincTokens);
-        return;
-    }
+/**
+ * @brief Recognizes one command of rule 19:
+ * <cmd> ;
+ * @param parser initialized parser instance
+ */
+void _comandos_item(Parser* parser, SincTokens* sincTokens) {
+    _sincTokensIncr(sincTokens);
 
     NEXTRULE(_cmd, SEMICOLON)
     if (parser->lexer.tokenClass == SEMICOLON) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(SEMICOLON, READ, WRITE, WHILE, IF, FOR, ID, BEGIN, END)
     }
-    NEXTRULE(_comandos, END)
 
     _sincTokensDecr(sincTokens);
 }
 
 /**
- * @brief Implements rule 20 of the grammar:
+ * @brief Implements rule 20 of the grammar, counting the nesting of the compound commands (while,
+ * if, for and begin). A command that would be nested deeper than MAX_NESTING is skipped.
+ * @param parser initialized parser instance
+ */
+void _cmd(Parser* parser, SincTokens* sincTokens) {
+    int tokenClass = parser->lexer.tokenClass;
+    bool compound = tokenClass == WHILE || tokenClass == IF || tokenClass == FOR || tokenClass == BEGIN;
+    if (compound && parser->nesting == MAX_NESTING) {
+        _skipNested(parser);
+        return;
+    }
+
+    parser->nesting += compound;
+    _cmd_body(parser, sincTokens);
+    parser->nesting -= compound;
+}
+
+/**
+ * @brief Recognizes the alternatives of rule 20:
  * <cmd> ::= read ( <variaveis> ) |
             write ( <variaveis> ) |
             while ( <condicao> ) do <cmd> |
@@ -651,97 +979,97 @@ void _comandos(Parser* parser, Node* sincTokens[]) {
             begin <comandos> end
  * @param parser initialized parser instance
  */
-void _cmd(Parser* parser, Node* sincTokens[]) {
+void _cmd_body(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == READ) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
         if (parser->lexer.tokenClass == OPEN_PAR) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(OPEN_PAR, ID)
         }
         NEXTRULE(_variaveis, CLOSE_PAR)
         if (parser->lexer.tokenClass == CLOSE_PAR) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(CLOSE_PAR, SEMICOLON)
         }
     } else if (parser->lexer.tokenClass == WRITE) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
         if (parser->lexer.tokenClass == OPEN_PAR) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(OPEN_PAR, ID)
         }
         NEXTRULE(_variaveis, CLOSE_PAR)
         if (parser->lexer.tokenClass == CLOSE_PAR) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(CLOSE_PAR, SEMICOLON)
         }
     } else if (parser->lexer.tokenClass == WHILE) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
         if (parser->lexer.tokenClass == OPEN_PAR) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(OPEN_PAR, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
         }
         NEXTRULE(_condicao, CLOSE_PAR)
         if (parser->lexer.tokenClass == CLOSE_PAR) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(CLOSE_PAR, DO)
         }
         if (parser->lexer.tokenClass == DO) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(DO, READ, WRITE, WHILE, IF, FOR, ID, BEGIN)
         }
         NEXTRULE(_cmd, SEMICOLON)
     } else if (parser->lexer.tokenClass == IF) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
         NEXTRULE(_condicao, THEN)
         if (parser->lexer.tokenClass == THEN) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(THEN, READ, WRITE, WHILE, IF, FOR, ID, BEGIN)
         }
         NEXTRULE(_cmd, ELSE, SEMICOLON)
         NEXTRULE(_pfalsa, SEMICOLON)
     } else if (parser->lexer.tokenClass == FOR) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
         if (parser->lexer.tokenClass == ID) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(ID, ASSIGN)
         }
         if (parser->lexer.tokenClass == ASSIGN) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(ASSIGN, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
         }
         NEXTRULE(_expressao, TO)
         if (parser->lexer.tokenClass == TO) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(TO, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
         }
         NEXTRULE(_expressao, DO)
         if (parser->lexer.tokenClass == DO) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(DO, READ, WRITE, WHILE, IF, FOR, ID, BEGIN)
         }
         NEXTRULE(_cmd, SEMICOLON)
     } else if (parser->lexer.tokenClass == ID) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
         NEXTRULE(_pos_ident, SEMICOLON)
     } else if (parser->lexer.tokenClass == BEGIN) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
         NEXTRULE(_comandos, END)
         if (parser->lexer.tokenClass == END) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
+            parser->errorCount += _nextToken(parser);
         } else {
             PANICMODE(END, SEMICOLON)
         }
@@ -757,7 +1085,7 @@ void _cmd(Parser* parser, Node* sincTokens[]) {
  * <pos_ident> ::= := <expressao> | <lista_arg>
  * @param parser initialized parser instance
  */
-void _pos_ident(Parser* parser, Node* sincTokens[]) {
+void _pos_ident(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == OPEN_PAR) {  // lookahead
@@ -765,7 +1093,7 @@ void _pos_ident(Parser* parser, Node* sincTokens[]) {
         _sincTokensDecr(sincTokens);
         return;
     } else if (parser->lexer.tokenClass == ASSIGN) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(ASSIGN, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
     }
@@ -779,12 +1107,12 @@ void _pos_ident(Parser* parser, Node* sincTokens[]) {
  * <condicao> ::= <expressao> <relacao> <expressao>
  * @param parser initialized parser instance
  */
-void _condicao(Parser* parser, Node* sincTokens[]) {
+void _condicao(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
-    NEXTRULE(_expressao, RELATION)
-    NEXTRULE(_relacao, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
-    NEXTRULE(_expressao, SEMICOLON, RELATION, CLOSE_PAR, THEN, TO, DO)
+    LAZYRULE(_expressao, RELATION)
+    LAZYRULE(_relacao, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
+    LAZYRULE(_expressao, SEMICOLON, RELATION, CLOSE_PAR, THEN, TO, DO)
 
     _sincTokensDecr(sincTokens);
 }
@@ -794,11 +1122,11 @@ void _condicao(Parser* parser, Node* sincTokens[]) {
  * <relacao> ::= = | <> | >= | <= | > | <
  * @param parser initialized parser instance
  */
-void _relacao(Parser* parser, Node* sincTokens[]) {
+void _relacao(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
     if (parser->lexer.tokenClass == RELATION) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+        parser->errorCount += _nextToken(parser);
     } else {
         PANICMODE(RELATION, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
     }
@@ -807,193 +1135,338 @@ void _relacao(Parser* parser, Node* sincTokens[]) {
 }
 
 /**
- * @brief Implements rule 23 of the grammar:
+ * @brief Implements rules 23 to 30 of the grammar by precedence climbing:
  * <expressao> ::= <termo> <outros_termos>
+ * <op_un> ::= + | - | lambda
+ * <outros_termos> ::= <op_ad> <termo> <outros_termos> | lambda
+ * <op_ad> ::= + | -
+ * <termo> ::= <op_un> <fator> <mais_fatores>
+ * <mais_fatores> ::= <op_mul> <fator> <mais_fatores> | lambda
+ * <op_mul> ::= *|/
+ * <fator> ::= ident | <numero> | (<expressao>)
+ * Terms and factors are recognized by two nested loops, only parenthesized expressions recurse
+ * (at most MAX_NESTING levels, counting the compound commands around them).
+ * The frames of the rules are still counted in the depth and their followers are deferred, nested
+ * as the rule functions and LISTRULE nest them, so errors synchronize as they did: the followers
+ * are pushed when an error is found and the panic mode leaves the frames one by one, checking the
+ * synchronization level as NEXTRULE does. <op_un>, <op_ad> and <op_mul> never fail, they have no frame.
  * @param parser initialized parser instance
  */
-void _expressao(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
+void _expressao(Parser* parser, SincTokens* sincTokens) {
+    static const int termFollowers[] = {OP_UN};
+    static const int termsFollowers[] = {SEMICOLON, RELATION, CLOSE_PAR, THEN, TO, DO};
+    static const int factorFollowers[] = {OP_MULT};
+    static const int factorsFollowers[] = {OP_UN};
+    static const int parenthesisFollowers[] = {CLOSE_PAR};
+    static const int closeFollowers[] = {OP_MULT};
+    static const int numberFollowers[] = {SEMICOLON, OP_MULT};
 
-    NEXTRULE(_termo, OP_UN)
-    NEXTRULE(_outros_termos, SEMICOLON, RELATION, CLOSE_PAR, THEN, TO, DO)
+    _sincTokensIncr(sincTokens);
+    bool addItem = false;    // the term belongs to an <outros_termos> item
+    bool addNested = false;  // LISTRULE frame of the previous <outros_termos> items
+    bool mulItem;            // the factor belongs to a <mais_fatores> item
+    bool mulNested;          // LISTRULE frame of the previous <mais_fatores> items
+    bool leave;              // the frame that just ended synchronized on a token of an enclosing rule
+
+term:  // <termo>
+    DEFER(termFollowers);
+    _sincTokensIncr(sincTokens);
+    if (parser->lexer.tokenClass == OP_UN) {
+        parser->errorCount += _nextToken(parser);
+    }
+    mulItem = false;
+    mulNested = false;
 
+factor:  // <fator>
+    DEFER(factorFollowers);
+    _sincTokensIncr(sincTokens);
+    if (parser->lexer.tokenClass == ID) {
+        parser->errorCount += _nextToken(parser);
+    } else if (parser->lexer.tokenClass == OPEN_PAR && parser->nesting == MAX_NESTING) {
+        _skipNested(parser);
+    } else if (parser->lexer.tokenClass == OPEN_PAR) {
+        parser->errorCount += _nextToken(parser);
+        DEFER(parenthesisFollowers);
+        parser->nesting++;
+        _expressao(parser, sincTokens);
+        parser->nesting--;
+        if (!_deferredReturn(parser, sincTokens)) {
+            if (parser->lexer.tokenClass == CLOSE_PAR) {
+                parser->errorCount += _nextToken(parser);
+            } else {
+                _errorAtEnd(parser, CLOSE_PAR, sincTokens, closeFollowers, sizeof(closeFollowers) / sizeof(int));
+            }
+        }
+    } else {  // <numero>
+        DEFER(numberFollowers);
+        _sincTokensIncr(sincTokens);
+        if (parser->lexer.tokenClass == N_INTEGER || parser->lexer.tokenClass == N_REAL) {
+            parser->errorCount += _nextToken(parser);
+        } else {  // multiple type
+            _errorAtEnd(parser, NUMBER, sincTokens, numberFollowers, sizeof(numberFollowers) / sizeof(int));
+        }
+        _sincTokensDecr(sincTokens);
+        _deferredReturn(parser, sincTokens);
+    }
     _sincTokensDecr(sincTokens);
-}
 
-/**
- * @brief Implements rule 24 of the grammar:
- * <op_un> ::= + | - | lambda
- * @param parser initialized parser instance
- */
-void _op_un(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
+    // end of <fator>, in <termo> or in a <mais_fatores> item
+    leave = _deferredReturn(parser, sincTokens);
+    if (mulItem) {
+        _sincTokensDecr(sincTokens);
+        if (leave)
+            goto factorsEnd;
+        if (!mulNested) {
+            _sincTokensIncr(sincTokens);
+            DEFER(factorsFollowers);
+            mulNested = true;
+        }
+    } else {
+        if (leave) {
+            _sincTokensDecr(sincTokens);
+            goto termEnd;
+        }
+        DEFER(factorsFollowers);  // <mais_fatores>
+    }
+    if (parser->lexer.tokenClass == OP_MULT) {  // <mais_fatores> item
+        _sincTokensIncr(sincTokens);
+        parser->errorCount += _nextToken(parser);
+        mulItem = true;
+        goto factor;
+    }
 
-    if (parser->lexer.tokenClass == OP_UN) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
+factorsEnd:
+    if (mulNested) {
+        if (parser->panic && _sincTokensLevel(sincTokens, parser->lexer.tokenClass) == 0)
+            parser->panic = false;
+        _sincTokensUndefer(sincTokens);
+        _sincTokensDecr(sincTokens);
     }
+    _deferredReturn(parser, sincTokens);
+    _sincTokensDecr(sincTokens);
 
+termEnd:  // end of <termo>, in <expressao> or in an <outros_termos> item
+    leave = _deferredReturn(parser, sincTokens);
+    if (addItem) {
+        _sincTokensDecr(sincTokens);
+        if (leave)
+            goto termsEnd;
+        if (!addNested) {
+            _sincTokensIncr(sincTokens);
+            DEFER(termsFollowers);
+            addNested = true;
+        }
+    } else {
+        if (leave) {
+            _sincTokensDecr(sincTokens);
+            return;
+        }
+        DEFER(termsFollowers);  // <outros_termos>
+    }
+    if (parser->lexer.tokenClass == OP_ADD) {  // <outros_termos> item
+        _sincTokensIncr(sincTokens);
+        parser->errorCount += _nextToken(parser);
+        addItem = true;
+        goto term;
+    }
+
+termsEnd:
+    if (addNested) {
+        if (parser->panic && _sincTokensLevel(sincTokens, parser->lexer.tokenClass) == 0)
+            parser->panic = false;
+        _sincTokensUndefer(sincTokens);
+        _sincTokensDecr(sincTokens);
+    }
+    _deferredReturn(parser, sincTokens);
     _sincTokensDecr(sincTokens);
 }
 
 /**
- * @brief Implements rule 25 of the grammar:
- * <outros_termos> ::= <op_ad> <termo> <outros_termos> | lambda
+ * @brief Implements rule 31 of the grammar:
+ * <numero> ::= numero_int | numero_real
  * @param parser initialized parser instance
  */
-void _outros_termos(Parser* parser, Node* sincTokens[]) {
+void _numero(Parser* parser, SincTokens* sincTokens) {
     _sincTokensIncr(sincTokens);
 
-    if (parser->lexer.tokenClass == OP_ADD) {  // lookahead
-        NEXTRULE(_op_ad, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
-        NEXTRULE(_termo, OP_UN)
-        NEXTRULE(_outros_termos, SEMICOLON, RELATION, CLOSE_PAR, THEN, TO, DO)
+    if (parser->lexer.tokenClass == N_INTEGER || parser->lexer.tokenClass == N_REAL) {
+        parser->errorCount += _nextToken(parser);
+    } else {  // multiple type
+        PANICMODE(NUMBER, SEMICOLON, OP_MULT)
     }
 
     _sincTokensDecr(sincTokens);
 }
 
 /**
- * @brief Implements rule 26 of the grammar:
- * <op_ad> ::= + | -
+ * @brief Gets the next token, from the lexer, the serialized token stream or the parallel lexer
+ *
  * @param parser initialized parser instance
+ * @return int number of lexer errors found before the token
  */
-void _op_ad(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
-
-    if (parser->lexer.tokenClass == OP_ADD) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {
-        PANICMODE(OP_ADD, OP_UN, ID, OPEN_PAR, N_INTEGER, N_REAL)
+int _nextToken(Parser* parser) {
+    if (parser->stopped)
+        return 0;
+
+    PROFILE_ENTER(PHASE_LEXER);
+    int errors;
+    if (parser->tokens != NULL)
+        errors = tokenStreamNext(parser->tokens, &parser->lexer, parser->diagnostics);
+    else if (parser->lexed != NULL)
+        errors = parallelLexerNext(parser->lexed, &parser->lexer, parser->diagnostics);
+    else
+        errors = nextToken(&parser->lexer, parser->diagnostics);
+    PROFILE_COUNT(COUNTER_TOKENS, 1);
+    PROFILE_LEAVE();
+
+    if (parser->recorded != NULL && parser->lexer.tokenClass != LAMBDA) {
+        SourcePosition position;
+        if (parser->tokens != NULL)
+            position = parser->tokens->position;
+        else
+            lexerTokenPosition(&parser->lexer, &position);
+        programTokensRecord(parser->recorded, &parser->lexer, &position);
     }
 
-    _sincTokensDecr(sincTokens);
+    if (parser->tokenLimit > 0 && parser->lexed->position > parser->tokenLimit)
+        _stop(parser);  // a speculative parse went past the next procedure
+
+    if (parser->errorLimit > 0 && parser->errorCount + errors >= parser->errorLimit)
+        _stop(parser);
+    return errors;
 }
 
 /**
- * @brief Implements rule 27 of the grammar:
- * <termo> ::= <op_un> <fator> <mais_fatores>
+ * @brief Stops the compilation once errorLimit is reached: the current token becomes EOF, so the
+ * rules unwind through the synchronization on LAMBDA without reading the rest of the input.
+ *
  * @param parser initialized parser instance
  */
-void _termo(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
-
-    NEXTRULE(_op_un, ID, OPEN_PAR, N_INTEGER, N_REAL)
-    NEXTRULE(_fator, OP_MULT)
-    NEXTRULE(_mais_fatores, OP_UN)
-
-    _sincTokensDecr(sincTokens);
+void _stop(Parser* parser) {
+    parser->stopped = true;
+    parser->lexer.tokenClass = LAMBDA;
+    parser->lexer.fscanfFlag = EOF;
+    stringOverwrite(&parser->lexer.buffer, "", 0);
 }
 
 /**
- * @brief Implements rule 28 of the grammar:
- * <mais_fatores> ::= <op_mul> <fator> <mais_fatores> | lambda
+ * @brief Outputs a parser error given an expected token class
+ *
  * @param parser initialized parser instance
+ * @param expectedTokenClass expected token class
  */
-void _mais_fatores(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
+void _error(Parser* parser, int expectedTokenClass, SincTokens* sincTokens) {
+    _reportError(parser, expectedTokenClass);
 
-    if (parser->lexer.tokenClass == OP_MULT) {  // lookahead
-        NEXTRULE(_op_mul, ID, OPEN_PAR, N_INTEGER, N_REAL)
-        NEXTRULE(_fator, OP_MULT)
-        NEXTRULE(_mais_fatores, OP_UN)
+    // Panic mode: skips tokens until one is in the synchronization mask, O(1) per token
+    while (!(sincTokens->mask & ((uint64_t)1 << parser->lexer.tokenClass))) {
+        parser->errorCount += _nextToken(parser);
+        PROFILE_COUNT(COUNTER_SKIPPED_TOKENS, 1);
     }
-
-    _sincTokensDecr(sincTokens);
 }
 
 /**
- * @brief Implements rule 29 of the grammar:
- * <op_mul> ::= *|/
+ * @brief Records a parser error given an expected token class and enables the panic mode
+ *
  * @param parser initialized parser instance
+ * @param expectedTokenClass expected token class
  */
-void _op_mul(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
-
-    if (parser->lexer.tokenClass == OP_MULT) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {
-        PANICMODE(OP_MULT, ID, OPEN_PAR, N_INTEGER, N_REAL)
+void _reportError(Parser* parser, int expectedTokenClass) {
+    if (parser->stopped) {  // errors caused by the truncated input aren't reported
+        parser->panic = true;
+        return;
     }
 
-    _sincTokensDecr(sincTokens);
+    PROFILE_ENTER(PHASE_ERROR);
+    parser->errorCount++;
+    SourcePosition position;
+    if (parser->tokens != NULL)
+        position = parser->tokens->position;
+    else
+        lexerTokenPosition(&parser->lexer, &position);
+    diagnosticsParserError(parser->diagnostics, &position, expectedTokenClass,
+                           (parser->lexer.fscanfFlag == EOF) ? NULL : lexerBuffer(&parser->lexer));
+    parser->panic = true;
+    PROFILE_LEAVE();
+
+    if (parser->errorLimit > 0 && parser->errorCount >= parser->errorLimit)
+        _stop(parser);
 }
 
 /**
- * @brief Implements rule 30 of the grammar:
- * <fator> ::= ident | <numero> | (<expressao>)
+ * @brief Panic mode at the end of a frame of _expressao: the followers are added while the tokens
+ * are skipped and, if the synchronization token belongs to the frame, the panic mode is disabled.
+ * The frame ends either way, so there is nothing else to decide.
+ *
  * @param parser initialized parser instance
+ * @param expectedTokenClass expected token class
+ * @param sincTokens synchronization tokens
+ * @param followers synchronization tokens that must be added
+ * @param size number of followers
  */
-void _fator(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
-
-    if (parser->lexer.tokenClass == ID) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else if (parser->lexer.tokenClass == OPEN_PAR) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-        NEXTRULE(_expressao, CLOSE_PAR)
-        if (parser->lexer.tokenClass == CLOSE_PAR) {
-            parser->errorCount += nextToken(&parser->lexer, parser->output);
-        } else {
-            PANICMODE(CLOSE_PAR, OP_MULT)
-        }
-    } else {
-        NEXTRULE(_numero, SEMICOLON, OP_MULT)
-    }
-
-    _sincTokensDecr(sincTokens);
+void _errorAtEnd(Parser* parser, int expectedTokenClass, SincTokens* sincTokens, const int followers[], unsigned long size) {
+    _sincTokensAdd(sincTokens, followers, size);
+    _error(parser, expectedTokenClass, sincTokens);
+    int level = _sincTokensLevel(sincTokens, parser->lexer.tokenClass);
+    _sincTokensRemove(sincTokens, followers, size);
+    if (level == 0)
+        parser->panic = false;
 }
 
 /**
- * @brief Implements rule 31 of the grammar:
- * <numero> ::= numero_int | numero_real
+ * @brief Reports a parenthesized factor or a compound command that would be nested deeper than
+ * MAX_NESTING and skips it without recursion, so that no input can overflow the stack of the
+ * recursive engine or of the passes that walk the program afterwards. A factor is skipped up to its
+ * matching ) or the first token that can't be part of an expression, a command up to the ;, end or
+ * else that follows it outside of any begin or parenthesis. The factor or command counts as
+ * recognized, so the parse goes on after it. The table engine skips the same tokens.
+ *
  * @param parser initialized parser instance
  */
-void _numero(Parser* parser, Node* sincTokens[]) {
-    _sincTokensIncr(sincTokens);
-
-    if (parser->lexer.tokenClass == N_INTEGER || parser->lexer.tokenClass == N_REAL) {
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-    } else {  // multiple type
-        PANICMODE(NUMBER, SEMICOLON, OP_MULT)
+void _skipNested(Parser* parser) {
+    static const uint64_t expressionTokens = ((uint64_t)1 << OP_UN) | ((uint64_t)1 << OP_ADD) | ((uint64_t)1 << OP_MULT) |
+                                             ((uint64_t)1 << ID) | ((uint64_t)1 << N_INTEGER) | ((uint64_t)1 << N_REAL) |
+                                             ((uint64_t)1 << OPEN_PAR) | ((uint64_t)1 << CLOSE_PAR);
+    bool factor = parser->lexer.tokenClass == OPEN_PAR;
+    _reportError(parser, NESTING);
+
+    unsigned long parentheses = 0;
+    unsigned long blocks = 0;
+    while (parser->lexer.tokenClass != LAMBDA) {
+        int tokenClass = parser->lexer.tokenClass;
+        if (factor ? !(expressionTokens & ((uint64_t)1 << tokenClass))
+                   : (parentheses == 0 && blocks == 0 && (tokenClass == SEMICOLON || tokenClass == END || tokenClass == ELSE)))
+            break;
+        if (tokenClass == OPEN_PAR)
+            parentheses++;
+        else if (tokenClass == CLOSE_PAR && parentheses > 0)
+            parentheses--;
+        else if (tokenClass == BEGIN)
+            blocks++;
+        else if (tokenClass == END)
+            blocks--;  // blocks > 0, checked above
+        parser->errorCount += _nextToken(parser);
+        PROFILE_COUNT(COUNTER_SKIPPED_TOKENS, 1);
+        if (factor && parentheses == 0)
+            break;
     }
-
-    _sincTokensDecr(sincTokens);
+    parser->panic = false;
 }
 
 /**
- * @brief Outputs a parser error given an expected token class
+ * @brief Ends a rule call whose followers were deferred, as NEXTRULE ends a call: in panic mode,
+ * the caller must return if the synchronization token belongs to an enclosing rule, otherwise the
+ * panic mode is disabled.
  *
  * @param parser initialized parser instance
- * @param expectedTokenClass expected token class
+ * @param sincTokens synchronization tokens
+ * @return true if the caller must return
+ * @return false if the caller goes on
  */
-void _error(Parser* parser, int expectedTokenClass, Node* sincTokens[]) {
-    parser->errorCount++;
-
-    // Print error
-    String errorMsg;
-    stringInit(&errorMsg);
-    stringAppendCstr(&errorMsg, "Parser error on line ");
-    stringAppendInt(&errorMsg, parser->lexer.currLine);
-    stringAppendCstr(&errorMsg, " col ");
-    stringAppendInt(&errorMsg, lexerCurrColWithoutRetreat(&parser->lexer));
-    if (parser->lexer.fscanfFlag == EOF) {
-        stringAppendCstr(&errorMsg, ": unexpected end of file (expected ");
-        stringAppendCstr(&errorMsg, lexerTokenClassUserFriendlyName(expectedTokenClass));
-        stringAppendCstr(&errorMsg, ")\n");
-    } else {
-        stringAppendCstr(&errorMsg, ": expected ");
-        stringAppendCstr(&errorMsg, lexerTokenClassUserFriendlyName(expectedTokenClass));
-        stringAppendCstr(&errorMsg, " but found ");
-        stringAppendCstr(&errorMsg, lexerBuffer(&parser->lexer));
-        stringAppendChar(&errorMsg, '\n');
-    }
-    printf("%s", errorMsg.str);
-    fprintf(parser->output, "%s", errorMsg.str);
-
-    stringDestroy(&errorMsg);
-
-    // Panic mode
-    parser->panic = true;
-    while (stackPeak(sincTokens[parser->lexer.tokenClass]) == -1)
-        parser->errorCount += nextToken(&parser->lexer, parser->output);
-}
\ No newline at end of file
+bool _deferredReturn(Parser* parser, SincTokens* sincTokens) {
+    bool leave = parser->panic && _sincTokensLevel(sincTokens, parser->lexer.tokenClass) > 0;
+    _sincTokensUndefer(sincTokens);
+    if (!leave)
+        parser->panic = false;
+    return leave;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file pmm.c
+ * @brief Embedding API implementation
+ */
+#include "../header/pmm.h"
+
+#include <setjmp.h>
+
+#include "../header/parser.h"
+
+struct _pmm {
+    PmmOptions options;
+    Diagnostics diagnostics;
+    String report;  // last rendered report
+    int errorCount;
+    bool stopped;
+};
+
+/**
+ * @brief Fills the default options: recursive engine, no limits, no callback and the C library allocator
+ *
+ * @param options options to be filled
+ */
+void pmmDefaultOptions(PmmOptions* options) {
+    options->engine = ENGINE_RECURSIVE;
+    options->maxErrors = 0;
+    options->errorLimit = 0;
+    options->onDiagnostic = NULL;
+    options->userData = NULL;
+    options->allocator = NULL;
+}
+
+/**
+ * @brief Creates a compiler instance. Its memory, and the memory of its compilations, comes
+ * from the allocator of the options.
+ *
+ * @param options compilation options (NULL for the defaults)
+ * @return Pmm* the instance or NULL if it couldn't be allocated
+ */
+Pmm* pmmCreate(const PmmOptions* options) {
+    PmmOptions defaults;
+    if (options == NULL) {
+        pmmDefaultOptions(&defaults);
+        options = &defaults;
+    }
+    return _pmmCreate(options);
+}
+
+/**
+ * @brief Destroys a compiler instance
+ *
+ * @param pmm the instance (or NULL)
+ */
+void pmmDestroy(Pmm* pmm) {
+    if (pmm == NULL)
+        return;
+
+    const Allocator* previous = memoryUse(pmm->options.allocator);
+    diagnosticsDestroy(&pmm->diagnostics);
+    stringDestroy(&pmm->report);
+    memoryFree(pmm);
+    memoryUse(previous);
+}
+
+/**
+ * @brief Compiles an in-memory source code. The diagnostics of the previous compilation are
+ * discarded and the new ones are passed to the onDiagnostic callback, in order. If an allocation
+ * fails, the compilation is abandoned and its diagnostics are discarded (some may already have
+ * been passed to the callback).
+ *
+ * @param pmm the instance
+ * @param source P-- source code (doesn't need to be '\0' terminated)
+ * @param size size of the source code in bytes
+ * @return int number of errors or -1 if the compiler couldn't be initialized or ran out of memory
+ */
+int pmmCompile(Pmm* pmm, const char* source, size_t size) {
+    const Allocator* previous = memoryUse(pmm->options.allocator);
+    jmp_buf failure;
+    jmp_buf* previousTarget = memoryOnFailure(&failure);
+    Parser* volatile parser = NULL;
+    volatile int result = -1;
+    if (setjmp(failure) == 0) {
+        diagnosticsClear(&pmm->diagnostics);
+
+        // the parser embeds the lexer tables and input buffer, too large for small thread stacks;
+        // zeroed, so that a partial initialization can be destroyed
+        parser = (Parser*)memoryCalloc(1, sizeof(Parser));
+        if (!parserInitBuffer(parser, source, size, &pmm->diagnostics)) {
+            parser->engine = pmm->options.engine;
+            parser->errorLimit = pmm->options.errorLimit;
+            compile(parser);
+            pmm->errorCount = parser->errorCount;
+            pmm->stopped = parser->stopped;
+            if (pmm->options.onDiagnostic != NULL)
+                _pmmCallback(pmm);
+            result = pmm->errorCount;
+        }
+    }
+    if (result < 0) {
+        diagnosticsClear(&pmm->diagnostics);
+        pmm->errorCount = 0;
+        pmm->stopped = false;
+    }
+
+    if (parser != NULL) {
+        parserDestroy(parser);
+        memoryFree(parser);
+    }
+    memoryOnFailure(previousTarget);
+    memoryUse(previous);
+    return result;
+}
+
+/**
+ * @brief Returns whether the last compilation stopped because it reached errorLimit
+ *
+ * @param pmm the instance
+ * @return true if it stopped early
+ * @return false otherwise
+ */
+bool pmmStopped(const Pmm* pmm) {
+    return pmm->stopped;
+}
+
+/**
+ * @brief Renders the diagnostics of the last compilation
+ *
+ * @param pmm the instance
+ * @param format DIAGNOSTIC_FORMAT
+ * @return const char* the report, valid until the next call on the instance, or NULL if it
+ * couldn't be allocated
+ */
+const char* pmmReport(Pmm* pmm, int format) {
+    const Allocator* previous = memoryUse(pmm->options.allocator);
+    jmp_buf failure;
+    jmp_buf* previousTarget = memoryOnFailure(&failure);
+    const char* report = NULL;
+    if (setjmp(failure) == 0) {
+        stringOverwrite(&pmm->report, "", 0);
+        pmm->diagnostics.format = format;
+        diagnosticsRender(&pmm->diagnostics, &pmm->report, NULL);
+        report = pmm->report.str;
+    }
+    memoryOnFailure(previousTarget);
+    memoryUse(previous);
+    return report;
+}
+
+/**
+ * @brief Compiles an in-memory source code. No file is read or written and nothing is printed,
+ * the errors are only recorded on the diagnostics (a compilation that runs out of memory may have
+ * recorded some).
+ *
+ * @param source P-- source code (doesn't need to be '\0' terminated)
+ * @param size size of the source code in bytes
+ * @param diagnostics initialized diagnostics where errors are recorded
+ * @return int number of errors or -1 if the compiler couldn't be initialized or ran out of memory
+ */
+int pmmCompileBuffer(const char* source, size_t size, Diagnostics* diagnostics) {
+    jmp_buf failure;
+    jmp_buf* previousTarget = memoryOnFailure(&failure);
+    Parser* volatile parser = NULL;
+    volatile int result = -1;
+    if (setjmp(failure) == 0) {
+        // as in pmmCompile, not on the stack of the calling thread
+        parser = (Parser*)memoryCalloc(1, sizeof(Parser));
+        if (!parserInitBuffer(parser, source, size, diagnostics)) {
+            compile(parser);
+            result = parser->errorCount;
+        }
+    }
+
+    if (parser != NULL) {
+        parserDestroy(parser);
+        memoryFree(parser);
+    }
+    memoryOnFailure(previousTarget);
+    return result;
+}
+
+/**
+ * @brief Passes the recorded diagnostics to the onDiagnostic callback
+ *
+ * @param pmm the instance
+ */
+void _pmmCallback(Pmm* pmm) {
+    String* message = &pmm->report;  // rendered again by pmmReport
+    for (unsigned long i = 0; i < pmm->diagnostics.size; i++) {
+        const Diagnostic* diagnostic = &pmm->diagnostics.list[i];
+        if (diagnostic->kind == DIAGNOSTIC_EOF)
+            continue;
+
+        stringOverwrite(message, "", 0);
+        _diagnosticsMessage(&pmm->diagnostics, diagnostic, message);
+
+        PmmDiagnostic event;
+        event.kind = diagnostic->kind;
+        event.line = diagnostic->line;
+        event.col = diagnostic->col;
+        event.offset = diagnostic->offset;
+        event.message = message->str;
+        event.found = (diagnostic->text == NO_TEXT) ? NULL : pmm->diagnostics.textPool.str + diagnostic->text;
+        pmm->options.onDiagnostic(&event, pmm->options.userData);
+    }
+}
+
+/**
+ * @brief Creates a compiler instance, see pmmCreate
+ *
+ * @param options compilation options
+ * @return Pmm* the instance or NULL if it couldn't be allocated
+ */
+Pmm* _pmmCreate(const PmmOptions* options) {
+    const Allocator* previous = memoryUse(options->allocator);
+    jmp_buf failure;
+    jmp_buf* previousTarget = memoryOnFailure(&failure);
+    Pmm* volatile pmm = NULL;
+    if (setjmp(failure) == 0) {
+        // zeroed, so that a partial initialization can be destroyed
+        pmm = (Pmm*)memoryCalloc(1, sizeof(Pmm));
+        pmm->options = *options;
+        pmm->errorCount = 0;
+        pmm->stopped = false;
+        diagnosticsInit(&pmm->diagnostics, FORMAT_TEXT, options->maxErrors);
+        stringInit(&pmm->report);
+    } else if (pmm != NULL) {
+        diagnosticsDestroy(&pmm->diagnostics);
+        stringDestroy(&pmm->report);
+        memoryFree(pmm);
+        pmm = NULL;
+    }
+    memoryOnFailure(previousTarget);
+    memoryUse(previous);
+    return pmm;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file profile.c
+ * @brief Phase timing and counters implementation
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "../header/profile.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+Profile profile;
+
+static const char* phaseName[] = {"setup", "lexer", "parser", "sync", "error", "io", "semantic", "dataflow", "optimize", "codegen", "run"};
+static const char* counterName[] = {"tokens", "characters", "allocations", "sync_pushes", "skipped_tokens", "errors"};
+
+/**
+ * @brief Returns whether the instrumentation was compiled in (PMM_PROFILE)
+ *
+ * @return true if the counters and timers are updated during the compilation
+ * @return false otherwise
+ */
+bool profileEnabled() {
+#ifdef PMM_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Clears the profiling data and starts the clock, in the setup phase
+ */
+void profileStart() {
+    memset(&profile, 0, sizeof(Profile));
+    profile.phase = PHASE_SETUP;
+    profile.start = _profileNow();
+    profile.last = profile.start;
+}
+
+/**
+ * @brief Stops the clock, accounting the remaining time to the current phase
+ */
+void profileStop() {
+    uint64_t now = _profileNow();
+    profile.phaseTime[profile.phase] += now - profile.last;
+    profile.last = now;
+    profile.total = now - profile.start;
+}
+
+/**
+ * @brief Suspends the current phase and enters a new one
+ *
+ * @param phase PROFILE_PHASE
+ */
+void profileEnter(int phase) {
+    uint64_t now = _profileNow();
+    profile.phaseTime[profile.phase] += now - profile.last;
+    profile.last = now;
+
+    if (profile.nesting < PROFILE_MAX_NESTING)
+        profile.suspended[profile.nesting] = profile.phase;
+    profile.nesting++;
+    profile.phase = phase;
+}
+
+/**
+ * @brief Leaves the current phase, resuming the suspended one
+ */
+void profileLeave() {
+    uint64_t now = _profileNow();
+    profile.phaseTime[profile.phase] += now - profile.last;
+    profile.last = now;
+
+    profile.nesting--;
+    if (profile.nesting < PROFILE_MAX_NESTING)
+        profile.phase = profile.suspended[profile.nesting];
+}
+
+/**
+ * @brief Renders the profiling data: time per phase, rates and counters
+ *
+ * @param report string where the report is appended
+ * @param format PROFILE_FORMAT
+ */
+void profileRender(String* report, int format) {
+    char line[128];
+    double seconds = profile.total / 1e9;
+    double tokensPerSecond = (seconds > 0) ? profile.counters[COUNTER_TOKENS] / seconds : 0;
+    double charsPerSecond = (seconds > 0) ? profile.counters[COUNTER_CHARS] / seconds : 0;
+
+    if (format == PROFILE_JSON) {
+        snprintf(line, sizeof(line), "{\"total_ms\":%.3f,\"phases\":{", profile.total / 1e6);
+        stringAppendCstr(report, line);
+        for (int i = 0; i < N_PHASES; i++) {
+            snprintf(line, sizeof(line), "%s\"%s_ms\":%.3f", (i > 0) ? "," : "", phaseName[i], profile.phaseTime[i] / 1e6);
+            stringAppendCstr(report, line);
+        }
+        stringAppendCstr(report, "},\"counters\":{");
+        for (int i = 0; i < N_COUNTERS; i++) {
+            snprintf(line, sizeof(line), "%s\"%s\":%llu", (i > 0) ? "," : "", counterName[i], (unsigned long long)profile.counters[i]);
+            stringAppendCstr(report, line);
+        }
+        snprintf(line, sizeof(line), "},\"tokens_per_second\":%.0f,\"characters_per_second\":%.0f,\"max_depth\":%ld}\n",
+                 tokensPerSecond, charsPerSecond, profile.maxDepth);
+        stringAppendCstr(report, line);
+        return;
+    }
+
+    snprintf(line, sizeof(line), "Profile: %.3f ms\n", profile.total / 1e6);
+    stringAppendCstr(report, line);
+    for (int i = 0; i < N_PHASES; i++) {
+        double share = (profile.total > 0) ? 100.0 * profile.phaseTime[i] / profile.total : 0;
+        snprintf(line, sizeof(line), "  %-16s %12.3f ms %6.1f%%\n", phaseName[i], profile.phaseTime[i] / 1e6, share);
+        stringAppendCstr(report, line);
+    }
+    for (int i = 0; i < N_COUNTERS; i++) {
+        snprintf(line, sizeof(line), "  %-16s %12llu\n", counterName[i], (unsigned long long)profile.counters[i]);
+        stringAppendCstr(report, line);
+    }
+    snprintf(line, sizeof(line), "  %-16s %12.0f\n  %-16s %12.0f\n  %-16s %12ld\n", "tokens/s", tokensPerSecond,
+             "characters/s", charsPerSecond, "max_depth", profile.maxDepth);
+    stringAppendCstr(report, line);
+}
+
+/**
+ * @brief Reads the monotonic clock
+ *
+ * @return uint64_t time in nanoseconds
+ */
+uint64_t _profileNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
@@ -0,0 +1,871 @@
+/**
+ * @file program.c
+ * @brief Semantic analysis implementation. The recorded tokens form a program without syntax
+ * errors, so the tree is built by a recursive descent without error recovery; the semantic
+ * errors (undeclared or misused identifiers, wrong argument counts, reals where integers are
+ * needed) are recorded as diagnostics and the construction goes on.
+ *
+ * Semantics: identifiers are declared before their use (procedures can call themselves and the
+ * procedures declared before them), local variables and parameters hide the global ones and
+ * arguments are passed by value. An integer is converted to real wherever a real is expected,
+ * the opposite is an error. Operations with a real operand are real, / on two integers is the
+ * truncated division.
+ */
+#include "../header/program.h"
+
+#include <string.h>
+
+#include "../header/memory.h"
+#include "../header/profile.h"
+
+/**
+ * @brief Initializes an empty token list
+ *
+ * @param tokens a token list
+ */
+void programTokensInit(ProgramTokens* tokens) {
+    tokens->list = NULL;
+    tokens->size = 0;
+    tokens->capacity = 0;
+    stringInit(&tokens->lexemes);
+}
+
+/**
+ * @brief Deallocates a token list
+ *
+ * @param tokens a token list
+ */
+void programTokensDestroy(ProgramTokens* tokens) {
+    memoryFree(tokens->list);
+    stringDestroy(&tokens->lexemes);
+    tokens->list = NULL;
+    tokens->size = 0;
+    tokens->capacity = 0;
+}
+
+/**
+ * @brief Appends the current token of a lexer to a token list
+ *
+ * @param tokens a token list
+ * @param lexer the lexer, on the token
+ * @param position position of the token
+ */
+void programTokensRecord(ProgramTokens* tokens, const Lexer* lexer, const SourcePosition* position) {
+    if (tokens->size == tokens->capacity) {
+        tokens->capacity = (tokens->capacity == 0) ? 256 : 2 * tokens->capacity;
+        tokens->list = (ProgramToken*)memoryRealloc(tokens->list, tokens->capacity * sizeof(ProgramToken));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+
+    ProgramToken* token = &tokens->list[tokens->size++];
+    token->tokenClass = lexer->tokenClass;
+    token->value = lexer->value;
+    token->text = tokens->lexemes.size;
+    token->position = *position;
+    stringAppend(&tokens->lexemes, lexer->buffer.str, lexer->buffer.size + 1);
+}
+
+/**
+ * @brief Appends a token recorded in other tokens (by a thread of the parallel parser)
+ *
+ * @param tokens tokens of the compilation
+ * @param from the tokens where it was recorded
+ * @param index the token in them
+ * @param position its position in the source code
+ */
+void programTokensCopy(ProgramTokens* tokens, const ProgramTokens* from, unsigned long index, const SourcePosition* position) {
+    if (tokens->size == tokens->capacity) {
+        tokens->capacity = (tokens->capacity == 0) ? 256 : 2 * tokens->capacity;
+        tokens->list = (ProgramToken*)memoryRealloc(tokens->list, tokens->capacity * sizeof(ProgramToken));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+
+    const ProgramToken* recorded = &from->list[index];
+    const char* lexeme = from->lexemes.str + recorded->text;
+    ProgramToken* token = &tokens->list[tokens->size++];
+    token->tokenClass = recorded->tokenClass;
+    token->value = recorded->value;
+    token->text = tokens->lexemes.size;
+    token->position = *position;
+    stringAppend(&tokens->lexemes, lexeme, strlen(lexeme) + 1);
+}
+
+/**
+ * @brief Builds the tree of a program from its tokens
+ *
+ * @param program the program, it must be destroyed even if there are errors
+ * @param tokens tokens of a program without lexer or syntax errors
+ * @param diagnostics diagnostics where the semantic errors are recorded
+ * @return int number of semantic errors
+ */
+int programBuild(Program* program, const ProgramTokens* tokens, Diagnostics* diagnostics) {
+    PROFILE_ENTER(PHASE_SEMANTIC);
+    program->nodes = NULL;
+    program->nodeCount = 0;
+    program->nodeCapacity = 0;
+    program->symbols = NULL;
+    program->symbolCount = 0;
+    program->symbolCapacity = 0;
+    program->procedures = NULL;
+    program->procedureCount = 0;
+    program->procedureCapacity = 0;
+    stringInit(&program->names);
+    program->globalCount = 0;
+    program->body = NO_NODE;
+    program->tableCapacity = 64;
+    program->table = (int*)memoryAlloc(program->tableCapacity * sizeof(int));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    memset(program->table, -1, program->tableCapacity * sizeof(int));
+
+    ProgramBuilder builder = {program, tokens, 0, diagnostics, 0, GLOBAL_SCOPE};
+    _programToken(&builder);  // program
+    _programToken(&builder);  // ident
+    _programToken(&builder);  // ;
+    _programDeclarations(&builder);
+    program->body = _programBlock(&builder);
+
+    PROFILE_LEAVE();
+    return builder.errors;
+}
+
+/**
+ * @brief Deallocates the tree of a program
+ *
+ * @param program a built program
+ */
+void programDestroy(Program* program) {
+    for (unsigned long i = 0; i < program->procedureCount; i++)
+        memoryFree(program->procedures[i].added);
+    memoryFree(program->nodes);
+    memoryFree(program->symbols);
+    memoryFree(program->procedures);
+    memoryFree(program->table);
+    stringDestroy(&program->names);
+}
+
+/**
+ * @brief Looks a name up: the symbols of a procedure hide the global ones
+ *
+ * @param program a program
+ * @param name the name
+ * @param scope procedure where the name is used (GLOBAL_SCOPE in the program)
+ * @return int the symbol or -1 if the name isn't declared
+ */
+int programLookup(const Program* program, const char* name, int scope) {
+    while (true) {
+        unsigned long mask = program->tableCapacity - 1;
+        for (unsigned long i = _programHash(name, scope) & mask; program->table[i] != -1; i = (i + 1) & mask) {
+            const Symbol* symbol = &program->symbols[program->table[i]];
+            if (symbol->scope == scope && !strcmp(program->names.str + symbol->name, name))
+                return program->table[i];
+        }
+        if (scope == GLOBAL_SCOPE)
+            return -1;
+        scope = GLOBAL_SCOPE;
+    }
+}
+
+/**
+ * @brief Returns the name of a symbol
+ *
+ * @param program a program
+ * @param symbol the symbol
+ * @return const char* its name
+ */
+const char* programName(const Program* program, int symbol) {
+    return program->names.str + program->symbols[symbol].name;
+}
+
+/**
+ * @brief Finds the symbol of a parameter or local variable: the declared ones are contiguous
+ * from the first parameter, the ones added by inlining are listed apart
+ *
+ * @param program a program
+ * @param procedure index of the procedure
+ * @param index index of the variable (Symbol.index)
+ * @return int its symbol
+ */
+int programVariable(const Program* program, int procedure, int index) {
+    const Procedure* declared = &program->procedures[procedure];
+    int count = declared->parameterCount + declared->localCount - declared->addedCount;
+    return (index < count) ? declared->firstParameter + index : declared->added[index - count];
+}
+
+/**
+ * @brief Returns the description of a semantic error
+ *
+ * @param code SEMANTIC_ERROR
+ * @return const char* the description
+ */
+const char* programErrorMessage(int code) {
+    static const char* messages[N_SEMANTIC_ERRORS] = {"undeclared identifier",
+                                                      "duplicate declaration of",
+                                                      "cannot assign to",
+                                                      "procedure used as a value",
+                                                      "not a procedure",
+                                                      "wrong number of arguments for",
+                                                      "real value where an integer is expected",
+                                                      "for loops need an integer variable and bounds"};
+    return (code >= 0 && code < N_SEMANTIC_ERRORS) ? messages[code] : "";
+}
+
+/**
+ * @brief Appends a node to the tree
+ *
+ * @param builder the tree construction
+ * @param kind NODE_KIND
+ * @param type TYPE of an expression
+ * @param token the token the node comes from
+ * @return int the node
+ */
+int _programNode(ProgramBuilder* builder, int kind, int type, const ProgramToken* token) {
+    Program* program = builder->program;
+    if (program->nodeCount == program->nodeCapacity) {
+        program->nodeCapacity = (program->nodeCapacity == 0) ? 256 : 2 * program->nodeCapacity;
+        program->nodes = (Node*)memoryRealloc(program->nodes, program->nodeCapacity * sizeof(Node));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+
+    Node* node = &program->nodes[program->nodeCount];
+    node->kind = (char)kind;
+    node->type = (char)type;
+    node->op = 0;
+    node->symbol = -1;
+    node->a = node->b = node->c = NO_NODE;
+    node->next = NO_NODE;
+    node->value.integer = 0;
+    node->line = token->position.line;
+    node->col = token->position.col;
+    return (int)program->nodeCount++;
+}
+
+/**
+ * @brief Declares a symbol in the current scope. Variables and parameters are numbered.
+ *
+ * @param builder the tree construction
+ * @param token the identifier
+ * @param kind SYMBOL_KIND
+ * @param type TYPE of the symbol
+ * @return int the symbol or -1 if the name was already declared in the scope
+ */
+int _programDeclare(ProgramBuilder* builder, const ProgramToken* token, int kind, int type) {
+    Program* program = builder->program;
+    const char* name = _programLexeme(builder, token);
+    int found = programLookup(program, name, builder->scope);
+    if (found != -1 && program->symbols[found].scope == builder->scope) {
+        _programError(builder, token, SEMANTIC_REDECLARED);
+        return -1;
+    }
+
+    if (program->symbolCount == program->symbolCapacity) {
+        program->symbolCapacity = (program->symbolCapacity == 0) ? 64 : 2 * program->symbolCapacity;
+        program->symbols = (Symbol*)memoryRealloc(program->symbols, program->symbolCapacity * sizeof(Symbol));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+
+    Symbol* symbol = &program->symbols[program->symbolCount];
+    symbol->name = program->names.size;
+    symbol->kind = (char)kind;
+    symbol->type = (char)type;
+    symbol->scope = builder->scope;
+    symbol->index = 0;
+    symbol->value.integer = 0;
+    stringAppend(&program->names, name, strlen(name) + 1);
+
+    if (builder->scope != GLOBAL_SCOPE) {
+        Procedure* procedure = &program->procedures[builder->scope];
+        if (kind == SYMBOL_PARAMETER)
+            symbol->index = procedure->parameterCount++;
+        else
+            symbol->index = procedure->parameterCount + procedure->localCount++;
+    } else if (kind == SYMBOL_VARIABLE) {
+        symbol->index = program->globalCount++;
+    }
+
+    // the table is kept at most half full
+    if (2 * (program->symbolCount + 1) > program->tableCapacity) {
+        memoryFree(program->table);
+        program->tableCapacity *= 2;
+        program->table = (int*)memoryAlloc(program->tableCapacity * sizeof(int));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+        memset(program->table, -1, program->tableCapacity * sizeof(int));
+        for (unsigned long i = 0; i < program->symbolCount; i++)
+            _programInsert(program, (int)i);
+    }
+    _programInsert(program, (int)program->symbolCount);
+    return (int)program->symbolCount++;
+}
+
+/**
+ * @brief Records a semantic error
+ *
+ * @param builder the tree construction
+ * @param token the offending token
+ * @param code SEMANTIC_ERROR
+ */
+void _programError(ProgramBuilder* builder, const ProgramToken* token, int code) {
+    builder->errors++;
+    diagnosticsSemanticError(builder->diagnostics, &token->position, code, _programLexeme(builder, token));
+}
+
+/**
+ * @brief Returns the current token and moves to the next one
+ *
+ * @param builder the tree construction
+ * @return const ProgramToken* the token
+ */
+const ProgramToken* _programToken(ProgramBuilder* builder) {
+    return &builder->tokens->list[builder->next++];
+}
+
+/**
+ * @brief Returns the current token
+ *
+ * @param builder the tree construction
+ * @return const ProgramToken* the token
+ */
+const ProgramToken* _programPeek(const ProgramBuilder* builder) {
+    return &builder->tokens->list[builder->next];
+}
+
+/**
+ * @brief Returns the lexeme of a token
+ *
+ * @param builder the tree construction
+ * @param token the token
+ * @return const char* its lexeme
+ */
+const char* _programLexeme(const ProgramBuilder* builder, const ProgramToken* token) {
+    return builder->tokens->lexemes.str + token->text;
+}
+
+/**
+ * @brief Hashes a name in a scope (FNV-1a)
+ *
+ * @param name the name
+ * @param scope the scope
+ * @return unsigned long the hash
+ */
+unsigned long _programHash(const char* name, int scope) {
+    unsigned long hash = 14695981039346656037ul ^ (unsigned long)(scope + 1);
+    for (; *name; name++)
+        hash = (hash ^ (unsigned char)*name) * 1099511628211ul;
+    return hash;
+}
+
+/**
+ * @brief Inserts a symbol in the table
+ *
+ * @param program a program
+ * @param symbol the symbol
+ */
+void _programInsert(Program* program, int symbol) {
+    unsigned long mask = program->tableCapacity - 1;
+    unsigned long i = _programHash(program->names.str + program->symbols[symbol].name, program->symbols[symbol].scope) & mask;
+    while (program->table[i] != -1)
+        i = (i + 1) & mask;
+    program->table[i] = symbol;
+}
+
+/**
+ * @brief Declares the constants, the variables and the procedures of the program:
+ * <dc> ::= <dc_c> <dc_v> <dc_p>
+ *
+ * @param builder the tree construction
+ */
+void _programDeclarations(ProgramBuilder* builder) {
+    while (_programPeek(builder)->tokenClass == CONST) {
+        _programToken(builder);
+        const ProgramToken* name = _programToken(builder);
+        _programToken(builder);  // =
+        const ProgramToken* number = _programToken(builder);
+        _programToken(builder);  // ;
+
+        int symbol = _programDeclare(builder, name, SYMBOL_CONSTANT, (number->tokenClass == N_REAL) ? TYPE_REAL : TYPE_INTEGER);
+        if (symbol != -1)
+            builder->program->symbols[symbol].value = number->value;
+    }
+
+    while (_programPeek(builder)->tokenClass == VAR) {
+        _programToken(builder);
+        _programVariables(builder, SYMBOL_VARIABLE);
+        _programToken(builder);  // ;
+    }
+
+    while (_programPeek(builder)->tokenClass == PROCEDURE)
+        _programProcedure(builder);
+}
+
+/**
+ * @brief Declares a list of variables or parameters of the same type:
+ * <variaveis> : <tipo_var>
+ *
+ * @param builder the tree construction
+ * @param kind SYMBOL_VARIABLE or SYMBOL_PARAMETER
+ */
+void _programVariables(ProgramBuilder* builder, int kind) {
+    unsigned long first = builder->next;
+    while (_programPeek(builder)->tokenClass != DECLARE_TYPE)
+        _programToken(builder);
+    unsigned long end = builder->next;
+    _programToken(builder);  // :
+    int type = (_programToken(builder)->tokenClass == REAL) ? TYPE_REAL : TYPE_INTEGER;
+
+    for (unsigned long i = first; i < end; i += 2)  // identifiers separated by commas
+        _programDeclare(builder, &builder->tokens->list[i], kind, type);
+}
+
+/**
+ * @brief Declares a procedure and builds its body:
+ * procedure ident <parametros> ; <dc_loc> begin <comandos> end ;
+ *
+ * @param builder the tree construction
+ */
+void _programProcedure(ProgramBuilder* builder) {
+    Program* program = builder->program;
+    _programToken(builder);  // procedure
+    const ProgramToken* name = _programToken(builder);
+    int symbol = _programDeclare(builder, name, SYMBOL_PROCEDURE, TYPE_INTEGER);
+
+    if (program->procedureCount == program->procedureCapacity) {
+        program->procedureCapacity = (program->procedureCapacity == 0) ? 16 : 2 * program->procedureCapacity;
+        program->procedures = (Procedure*)memoryRealloc(program->procedures, program->procedureCapacity * sizeof(Procedure));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    }
+    Procedure* procedure = &program->procedures[program->procedureCount];
+    procedure->symbol = symbol;
+    procedure->firstParameter = (int)program->symbolCount;
+    procedure->parameterCount = 0;
+    procedure->localCount = 0;
+    procedure->body = NO_NODE;
+    procedure->added = NULL;
+    procedure->addedCount = 0;
+    procedure->addedCapacity = 0;
+    if (symbol != -1)
+        program->symbols[symbol].index = (int)program->procedureCount;
+    builder->scope = (int)program->procedureCount++;
+
+    if (_programPeek(builder)->tokenClass == OPEN_PAR) {
+        _programToken(builder);
+        while (true) {
+            _programVariables(builder, SYMBOL_PARAMETER);
+            if (_programToken(builder)->tokenClass != SEMICOLON)  // )
+                break;
+        }
+    }
+    _programToken(builder);  // ;
+
+    while (_programPeek(builder)->tokenClass == VAR) {
+        _programToken(builder);
+        _programVariables(builder, SYMBOL_VARIABLE);
+        _programToken(builder);  // ;
+    }
+
+    int body = _programBlock(builder);
+    program->procedures[builder->scope].body = body;
+    _programToken(builder);  // ;
+    builder->scope = GLOBAL_SCOPE;
+}
+
+/**
+ * @brief Builds a list of commands:
+ * begin <comandos> end
+ *
+ * @param builder the tree construction
+ * @return int the NODE_BLOCK
+ */
+int _programBlock(ProgramBuilder* builder) {
+    int block = _programNode(builder, NODE_BLOCK, TYPE_INTEGER, _programToken(builder));
+    int last = NO_NODE;
+    while (_programPeek(builder)->tokenClass != END) {
+        int command = _programCommand(builder);
+        _programToken(builder);  // ;
+        if (command == NO_NODE)
+            continue;
+
+        if (last == NO_NODE)
+            builder->program->nodes[block].a = command;
+        else
+            builder->program->nodes[last].next = command;
+        last = command;
+    }
+    _programToken(builder);  // end
+    return block;
+}
+
+/**
+ * @brief Builds a command (rule 20 of the grammar)
+ *
+ * @param builder the tree construction
+ * @return int the node of the command or NO_NODE if it has semantic errors
+ */
+int _programCommand(ProgramBuilder* builder) {
+    Program* program = builder->program;
+    int tokenClass = _programPeek(builder)->tokenClass;
+    if (tokenClass == BEGIN)
+        return _programBlock(builder);
+
+    const ProgramToken* token = _programToken(builder);
+    int node;
+    int first = NO_NODE;
+    int last = NO_NODE;
+    switch (tokenClass) {
+        case READ:
+        case WRITE:
+            _programToken(builder);  // (
+            while (true) {
+                const ProgramToken* item = _programToken(builder);
+                int value = (tokenClass == READ) ? _programTarget(builder, item) : _programValue(builder, item);
+                if (value != NO_NODE) {
+                    if (first == NO_NODE)
+                        first = value;
+                    else
+                        program->nodes[last].next = value;
+                    last = value;
+                }
+                if (_programToken(builder)->tokenClass != COLON)  // )
+                    break;
+            }
+            if (first == NO_NODE)
+                return NO_NODE;
+            node = _programNode(builder, (tokenClass == READ) ? NODE_READ : NODE_WRITE, TYPE_INTEGER, token);
+            program->nodes[node].a = first;
+            return node;
+
+        case WHILE: {
+            _programToken(builder);  // (
+            int condition = _programCondition(builder);
+            _programToken(builder);  // )
+            _programToken(builder);  // do
+            int body = _programCommand(builder);
+            node = _programNode(builder, NODE_WHILE, TYPE_INTEGER, token);
+            program->nodes[node].a = condition;
+            program->nodes[node].b = body;
+            return node;
+        }
+
+        case IF: {
+            int condition = _programCondition(builder);
+            _programToken(builder);  // then
+            int then = _programCommand(builder);
+            int otherwise = NO_NODE;
+            if (_programPeek(builder)->tokenClass == ELSE) {
+                _programToken(builder);
+                otherwise = _programCommand(builder);
+            }
+            node = _programNode(builder, NODE_IF, TYPE_INTEGER, token);
+            program->nodes[node].a = condition;
+            program->nodes[node].b = then;
+            program->nodes[node].c = otherwise;
+            return node;
+        }
+
+        case FOR: {
+            const ProgramToken* name = _programToken(builder);
+            int variable = _programTarget(builder, name);
+            if (variable != NO_NODE && program->nodes[variable].type != TYPE_INTEGER) {
+                _programError(builder, name, SEMANTIC_FOR_INTEGER);
+                variable = NO_NODE;
+            }
+            _programToken(builder);  // :=
+            int bounds[2];
+            for (int i = 0; i < 2; i++) {
+                const ProgramToken* start = _programPeek(builder);
+                bounds[i] = _programExpression(builder);
+                if (program->nodes[bounds[i]].type != TYPE_INTEGER)
+                    _programError(builder, start, SEMANTIC_FOR_INTEGER);
+                _programToken(builder);  // to, do
+            }
+            int body = _programCommand(builder);
+            if (variable == NO_NODE)
+                return NO_NODE;
+            node = _programNode(builder, NODE_FOR, TYPE_INTEGER, token);
+            program->nodes[node].symbol = program->nodes[variable].symbol;
+            program->nodes[node].a = bounds[0];
+            program->nodes[node].b = bounds[1];
+            program->nodes[node].c = body;
+            return node;
+        }
+
+        default:  // ident <pos_ident>
+            if (_programPeek(builder)->tokenClass != ASSIGN)
+                return _programCall(builder, token);
+
+            _programToken(builder);  // :=
+            int variable = _programTarget(builder, token);
+            int value = _programExpression(builder);
+            if (variable == NO_NODE)
+                return NO_NODE;
+            if (program->nodes[variable].type == TYPE_REAL) {
+                value = _programToReal(builder, value);
+            } else if (program->nodes[value].type == TYPE_REAL) {
+                _programError(builder, token, SEMANTIC_REAL_TO_INTEGER);
+                return NO_NODE;
+            }
+            node = _programNode(builder, NODE_ASSIGN, program->nodes[variable].type, token);
+            program->nodes[node].symbol = program->nodes[variable].symbol;
+            program->nodes[node].a = value;
+            return node;
+    }
+}
+
+/**
+ * @brief Builds a procedure call:
+ * ident <lista_arg>
+ *
+ * @param builder the tree construction
+ * @param name the identifier of the procedure (already read)
+ * @return int the NODE_CALL or NO_NODE if it has semantic errors
+ */
+int _programCall(ProgramBuilder* builder, const ProgramToken* name) {
+    Program* program = builder->program;
+    int symbol = programLookup(program, _programLexeme(builder, name), builder->scope);
+    const Procedure* procedure = NULL;
+    bool valid = true;
+    if (symbol == -1) {
+        _programError(builder, name, SEMANTIC_UNDECLARED);
+        valid = false;
+    } else if (program->symbols[symbol].kind != SYMBOL_PROCEDURE) {
+        _programError(builder, name, SEMANTIC_NOT_PROCEDURE);
+        valid = false;
+    } else {
+        procedure = &program->procedures[program->symbols[symbol].index];
+    }
+
+    int count = 0;
+    int first = NO_NODE;
+    int last = NO_NODE;
+    if (_programPeek(builder)->tokenClass == OPEN_PAR) {
+        _programToken(builder);
+        while (true) {
+            const ProgramToken* argument = _programToken(builder);
+            int value = _programValue(builder, argument);
+            if (value == NO_NODE) {
+                valid = false;
+            } else if (procedure != NULL && count < procedure->parameterCount) {
+                if (program->symbols[procedure->firstParameter + count].type == TYPE_REAL) {
+                    value = _programToReal(builder, value);
+                } else if (program->nodes[value].type == TYPE_REAL) {
+                    _programError(builder, argument, SEMANTIC_REAL_TO_INTEGER);
+                    valid = false;
+                }
+            }
+            if (value != NO_NODE) {
+                if (first == NO_NODE)
+                    first = value;
+                else
+                    program->nodes[last].next = value;
+                last = value;
+            }
+            count++;
+            if (_programToken(builder)->tokenClass != SEMICOLON)  // )
+                break;
+        }
+    }
+
+    if (procedure != NULL && count != procedure->parameterCount) {
+        _programError(builder, name, SEMANTIC_ARGUMENT_COUNT);
+        valid = false;
+    }
+    if (!valid)
+        return NO_NODE;
+
+    int node = _programNode(builder, NODE_CALL, TYPE_INTEGER, name);
+    program->nodes[node].symbol = symbol;
+    program->nodes[node].a = first;
+    return node;
+}
+
+/**
+ * @brief Builds the variable assigned by read, := or for
+ *
+ * @param builder the tree construction
+ * @param name the identifier (already read)
+ * @return int the NODE_VARIABLE or NO_NODE if it isn't a variable
+ */
+int _programTarget(ProgramBuilder* builder, const ProgramToken* name) {
+    int symbol = programLookup(builder->program, _programLexeme(builder, name), builder->scope);
+    if (symbol == -1) {
+        _programError(builder, name, SEMANTIC_UNDECLARED);
+        return NO_NODE;
+    }
+    const Symbol* declared = &builder->program->symbols[symbol];
+    if (declared->kind != SYMBOL_VARIABLE && declared->kind != SYMBOL_PARAMETER) {
+        _programError(builder, name, SEMANTIC_NOT_VARIABLE);
+        return NO_NODE;
+    }
+
+    int node = _programNode(builder, NODE_VARIABLE, declared->type, name);
+    builder->program->nodes[node].symbol = symbol;
+    return node;
+}
+
+/**
+ * @brief Builds the value of an identifier: a variable or the value of a constant
+ *
+ * @param builder the tree construction
+ * @param name the identifier (already read)
+ * @return int the NODE_VARIABLE or NODE_NUMBER, NO_NODE if it has no value
+ */
+int _programValue(ProgramBuilder* builder, const ProgramToken* name) {
+    int symbol = programLookup(builder->program, _programLexeme(builder, name), builder->scope);
+    if (symbol == -1) {
+        _programError(builder, name, SEMANTIC_UNDECLARED);
+        return NO_NODE;
+    }
+    const Symbol* declared = &builder->program->symbols[symbol];
+    if (declared->kind == SYMBOL_PROCEDURE) {
+        _programError(builder, name, SEMANTIC_NOT_VALUE);
+        return NO_NODE;
+    }
+
+    TokenValue value = declared->value;
+    int kind = (declared->kind == SYMBOL_CONSTANT) ? NODE_NUMBER : NODE_VARIABLE;
+    int node = _programNode(builder, kind, declared->type, name);
+    builder->program->nodes[node].symbol = (kind == NODE_VARIABLE) ? symbol : -1;
+    builder->program->nodes[node].value = value;
+    return node;
+}
+
+/**
+ * @brief Builds a condition, the operands get the same type:
+ * <condicao> ::= <expressao> <relacao> <expressao>
+ *
+ * @param builder the tree construction
+ * @return int the NODE_COMPARE
+ */
+int _programCondition(ProgramBuilder* builder) {
+    static const char* relations[] = {"=", "<>", "<", "<=", ">", ">="};
+
+    int left = _programExpression(builder);
+    const ProgramToken* relation = _programToken(builder);
+    int right = _programExpression(builder);
+    int node = _programBinary(builder, NODE_COMPARE, left, right, relation);
+
+    const char* lexeme = _programLexeme(builder, relation);
+    for (int i = 0; i < 6; i++)
+        if (!strcmp(lexeme, relations[i]))
+            builder->program->nodes[node].op = (char)i;
+    builder->program->nodes[node].type = TYPE_INTEGER;
+    return node;
+}
+
+/**
+ * @brief Builds an expression:
+ * <expressao> ::= <termo> <outros_termos>
+ *
+ * @param builder the tree construction
+ * @return int the node of the expression
+ */
+int _programExpression(ProgramBuilder* builder) {
+    int node = _programTerm(builder);
+    while (_programPeek(builder)->tokenClass == OP_ADD) {
+        const ProgramToken* op = _programToken(builder);
+        int kind = (_programLexeme(builder, op)[0] == '+') ? NODE_ADD : NODE_SUBTRACT;
+        node = _programBinary(builder, kind, node, _programTerm(builder), op);
+    }
+    return node;
+}
+
+/**
+ * @brief Builds a term, the unary operator applies to the whole term:
+ * <termo> ::= <op_un> <fator> <mais_fatores>
+ *
+ * @param builder the tree construction
+ * @return int the node of the term
+ */
+int _programTerm(ProgramBuilder* builder) {
+    const ProgramToken* sign = NULL;
+    if (_programPeek(builder)->tokenClass == OP_UN)
+        sign = _programToken(builder);
+
+    int node = _programFactor(builder);
+    while (_programPeek(builder)->tokenClass == OP_MULT) {
+        const ProgramToken* op = _programToken(builder);
+        int kind = (_programLexeme(builder, op)[0] == '*') ? NODE_MULTIPLY : NODE_DIVIDE;
+        node = _programBinary(builder, kind, node, _programFactor(builder), op);
+    }
+
+    if (sign != NULL && _programLexeme(builder, sign)[0] == '-') {
+        int negate = _programNode(builder, NODE_NEGATE, builder->program->nodes[node].type, sign);
+        builder->program->nodes[negate].a = node;
+        node = negate;
+    }
+    return node;
+}
+
+/**
+ * @brief Builds a factor. An identifier without a value becomes the integer 0, so the
+ * construction goes on after the error.
+ * <fator> ::= ident | <numero> | ( <expressao> )
+ *
+ * @param builder the tree construction
+ * @return int the node of the factor
+ */
+int _programFactor(ProgramBuilder* builder) {
+    const ProgramToken* token = _programToken(builder);
+    if (token->tokenClass == OPEN_PAR) {
+        int node = _programExpression(builder);
+        _programToken(builder);  // )
+        return node;
+    }
+
+    int node = NO_NODE;
+    if (token->tokenClass == ID)
+        node = _programValue(builder, token);
+    if (node == NO_NODE) {
+        node = _programNode(builder, NODE_NUMBER, (token->tokenClass == N_REAL) ? TYPE_REAL : TYPE_INTEGER, token);
+        if (token->tokenClass != ID)
+            builder->program->nodes[node].value = token->value;
+    }
+    return node;
+}
+
+/**
+ * @brief Builds a binary operation, converting an integer operand to real if the other one is real
+ *
+ * @param builder the tree construction
+ * @param kind NODE_KIND
+ * @param left left operand
+ * @param right right operand
+ * @param token the operator
+ * @return int the node of the operation
+ */
+int _programBinary(ProgramBuilder* builder, int kind, int left, int right, const ProgramToken* token) {
+    int type = TYPE_INTEGER;
+    if (builder->program->nodes[left].type == TYPE_REAL || builder->program->nodes[right].type == TYPE_REAL) {
+        type = TYPE_REAL;
+        left = _programToReal(builder, left);
+        right = _programToReal(builder, right);
+    }
+
+    int node = _programNode(builder, kind, type, token);
+    builder->program->nodes[node].a = left;
+    builder->program->nodes[node].b = right;
+    return node;
+}
+
+/**
+ * @brief Converts an expression to real, if it is an integer one
+ *
+ * @param builder the tree construction
+ * @param node the expression
+ * @return int the real expression
+ */
+int _programToReal(ProgramBuilder* builder, int node) {
+    Program* program = builder->program;
+    if (program->nodes[node].type == TYPE_REAL)
+        return node;
+
+    if (program->nodes[node].kind == NODE_NUMBER) {  // the conversion is done here
+        program->nodes[node].type = TYPE_REAL;
+        program->nodes[node].value.real = (double)program->nodes[node].value.integer;
+        return node;
+    }
+
+    int conversion = _programNode(builder, NODE_TO_REAL, TYPE_REAL, &builder->tokens->list[builder->next - 1]);
+    program->nodes[conversion].a = node;
+    program->nodes[conversion].line = program->nodes[node].line;
+    program->nodes[conversion].col = program->nodes[node].col;
+    return conversion;
+}
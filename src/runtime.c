@@ -0,0 +1,719 @@
+/**
+ * @file runtime.c
+ * @brief Runtime of the executed programs implementation. read takes blank separated numbers from
+ * the input; write prints its values separated by spaces on a line, reals with the fewest digits
+ * that read back as the same value and always with a point or an exponent.
+ *
+ * The input is read into a buffer by blocks and each word is converted where it lies; the output
+ * is formatted in a buffer written when it is full and at the end of the run. Integers are read 8
+ * digits at a time and written 2 digits at a time; reals are read by numberParseReal and their
+ * shortest digits are found with integer arithmetic (Ryu, by Ulf Adams), without trying
+ * precisions with printf.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "../header/runtime.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../header/number.h"
+
+// reals are compared and classified bit for bit, which -Ofast (-ffast-math) doesn't keep
+#pragma GCC optimize("no-fast-math")
+
+#define RUNTIME_POWER_BITS 125  // bits of the entries of the tables of powers of five
+
+// powersOfFive and inversePowersOfFive, generated by tools/realgen.c
+#include "../build/realpowers.inc"
+
+// decimal digits of 0 to 99
+static const char digitPairs[201] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+/**
+ * @brief Whether a char separates the words of the input (isspace in the C locale)
+ *
+ * @param c the char
+ * @return true if it is a blank
+ */
+bool _runtimeBlank(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief Initializes a runtime
+ *
+ * @param runtime a runtime instance
+ * @param input where read takes the numbers from
+ * @param output where write prints
+ */
+void runtimeInit(Runtime* runtime, FILE* input, FILE* output) {
+    runtime->input = input;
+    runtime->output = output;
+    runtime->status = RUNTIME_OK;
+    runtime->line = 0;
+    runtime->col = 0;
+
+    // a person typing the input sees each line of the output as it is written
+    int inputFile = fileno(input);
+    int outputFile = fileno(output);
+    runtime->terminal = inputFile >= 0 && isatty(inputFile);
+    runtime->lineBuffered = outputFile >= 0 && isatty(outputFile);
+    runtime->ended = false;
+    runtime->head = 0;
+    runtime->tail = 0;
+    runtime->written = 0;
+
+    runtime->consumed = 0;
+    runtime->budget = LONG_MAX;
+    runtime->deadline = 0;
+    runtime->stackLimit = NULL;
+    _runtimeSlice(runtime);
+}
+
+/**
+ * @brief Ends a run, writing what is left of the output
+ *
+ * @param runtime a runtime instance
+ */
+void runtimeFinish(Runtime* runtime) {
+    _runtimeFlush(runtime);
+    fflush(runtime->output);
+}
+
+/**
+ * @brief Returns the description of a runtime status
+ *
+ * @param status RUNTIME_STATUS
+ * @return const char* the description
+ */
+const char* runtimeStatusMessage(int status) {
+    static const char* messages[N_RUNTIME_STATUS] = {"ok", "division by zero", "invalid number in the input",
+                                                     "unexpected end of the input", "step budget exceeded",
+                                                     "time limit exceeded", "memory limit exceeded"};
+    return (status >= 0 && status < N_RUNTIME_STATUS) ? messages[status] : "";
+}
+
+/**
+ * @brief Reads an integer (read of an integer variable): an optional sign and decimal digits
+ *
+ * @param runtime a runtime instance
+ * @param where RUNTIME_WHERE of the read command
+ * @return long the integer
+ */
+long runtimeReadInteger(Runtime* runtime, long where) {
+    unsigned long size;
+    const char* word = _runtimeWord(runtime, &size, where);
+    long value;
+    if (_runtimeParseInteger(word, size, &value))
+        runtimeFail(runtime, RUNTIME_INVALID_INPUT, where);
+    return value;
+}
+
+/**
+ * @brief Reads a real (read of a real variable). Numbers written like the reals of P-- (digits with
+ * an optional point, and a sign) are converted by numberParseReal, the others by strtod.
+ *
+ * @param runtime a runtime instance
+ * @param where RUNTIME_WHERE of the read command
+ * @return double the real
+ */
+double runtimeReadReal(Runtime* runtime, long where) {
+    unsigned long size;
+    char* word = _runtimeWord(runtime, &size, where);
+
+    unsigned long sign = (*word == '-' || *word == '+');
+    unsigned long digits = 0;
+    unsigned long points = 0;
+    for (unsigned long i = sign; i < size; i++) {
+        digits += (word[i] >= '0' && word[i] <= '9');
+        points += (word[i] == '.');
+    }
+    if (digits > 0 && points <= 1 && sign + digits + points == size) {
+        double value = numberParseReal(word + sign, size - sign);
+        return (*word == '-') ? -value : value;
+    }
+
+    char* end;
+    double value = strtod(word, &end);
+    if (end != word + size)
+        runtimeFail(runtime, RUNTIME_INVALID_INPUT, where);
+    return value;
+}
+
+/**
+ * @brief Writes an integer
+ *
+ * @param runtime a runtime instance
+ * @param value the integer
+ * @param separator char written after it (a space, or a newline after the last value of write)
+ */
+void runtimeWriteInteger(Runtime* runtime, long value, int separator) {
+    if (runtime->written + 22 > RUNTIME_BUFFER_SIZE)  // sign, 19 digits and the separator
+        _runtimeFlush(runtime);
+
+    // the digits are written from the last one into a scratch buffer, two at a time
+    char text[24];
+    char* p = text + sizeof(text);
+    unsigned long magnitude = (value < 0) ? 0ul - (unsigned long)value : (unsigned long)value;
+    while (magnitude >= 100) {
+        unsigned long pair = magnitude % 100;
+        magnitude /= 100;
+        p -= 2;
+        memcpy(p, digitPairs + 2 * pair, 2);
+    }
+    if (magnitude >= 10) {
+        p -= 2;
+        memcpy(p, digitPairs + 2 * magnitude, 2);
+    } else {
+        *--p = (char)('0' + magnitude);
+    }
+    if (value < 0)
+        *--p = '-';
+
+    unsigned long size = (unsigned long)(text + sizeof(text) - p);
+    char* out = runtime->outputBuffer + runtime->written;
+    memcpy(out, p, size);
+    out[size] = (char)separator;
+    runtime->written += size + 1;
+    if (separator == '\n' && runtime->lineBuffered)
+        _runtimeFlush(runtime);
+}
+
+/**
+ * @brief Writes a real
+ *
+ * @param runtime a runtime instance
+ * @param value the real
+ * @param separator char written after it (a space, or a newline after the last value of write)
+ */
+void runtimeWriteReal(Runtime* runtime, double value, int separator) {
+    if (runtime->written + RUNTIME_REAL_SIZE > RUNTIME_BUFFER_SIZE)
+        _runtimeFlush(runtime);
+    char* out = runtime->outputBuffer + runtime->written;
+    unsigned long size = runtimeFormatReal(value, out);
+    out[size] = (char)separator;  // replaces the NUL
+    runtime->written += size + 1;
+    if (separator == '\n' && runtime->lineBuffered)
+        _runtimeFlush(runtime);
+}
+
+/**
+ * @brief Stops the program with a runtime error
+ *
+ * @param runtime a runtime instance
+ * @param status RUNTIME_STATUS
+ * @param where RUNTIME_WHERE of the command that failed
+ */
+_Noreturn void runtimeFail(Runtime* runtime, int status, long where) {
+    runtime->status = status;
+    runtime->line = (int)(where >> 32);
+    runtime->col = (int)(where & 0xffffffff);
+    longjmp(runtime->exit, 1);
+}
+
+/**
+ * @brief Limits the steps and the time of a run, for code generated with the sandbox checks
+ *
+ * @param runtime a runtime instance, before the run
+ * @param budget steps allowed, 0 for no limit
+ * @param milliseconds wall-clock time allowed from now on, 0 for no limit
+ */
+void runtimeLimit(Runtime* runtime, long budget, long milliseconds) {
+    runtime->budget = (budget > 0) ? budget : LONG_MAX;
+    runtime->deadline = (milliseconds > 0) ? runtimeClock() + milliseconds / 1000.0 : 0;
+    _runtimeSlice(runtime);
+}
+
+/**
+ * @brief Called by the generated code when a slice of steps is over: stops the program if it
+ * went over its budget or its time, else starts the next slice
+ *
+ * @param runtime a runtime instance
+ * @param where RUNTIME_WHERE of the loop or procedure of the step
+ */
+void runtimeTick(Runtime* runtime, long where) {
+    runtime->consumed += runtime->slice;
+    runtime->slice = 0;
+    runtime->ticks = -1;
+    if (runtime->consumed > runtime->budget)
+        runtimeFail(runtime, RUNTIME_BUDGET_EXCEEDED, where);
+    if (runtime->deadline > 0 && runtimeClock() >= runtime->deadline)
+        runtimeFail(runtime, RUNTIME_TIME_LIMIT, where);
+    _runtimeSlice(runtime);
+}
+
+/**
+ * @brief Returns the steps run so far
+ *
+ * @param runtime a runtime instance
+ * @return long loop iterations and procedure calls of the sandboxed code (the one over the budget
+ * included)
+ */
+long runtimeSteps(const Runtime* runtime) {
+    return runtime->consumed + runtime->slice - 1 - runtime->ticks;
+}
+
+/**
+ * @brief Returns the time of a monotonic clock
+ *
+ * @return double the time in seconds
+ */
+double runtimeClock(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Formats a real with the fewest significant digits that read back as the same value, in
+ * positional notation from 1e-7 to 1e21 (with at least one digit after the point) and in
+ * scientific notation otherwise, e.g. 0.1, 3.0, -2.5e-8, 1e+21
+ *
+ * @param value the real
+ * @param text where the text is written, RUNTIME_REAL_SIZE chars
+ * @return unsigned long size of the text (without the NUL)
+ */
+unsigned long runtimeFormatReal(double value, char* text) {
+    char* out = text;
+    if (isnan(value) || isinf(value)) {
+        strcpy(text, isnan(value) ? "nan" : (value < 0) ? "-inf" : "inf");
+        return strlen(text);
+    }
+    if (signbit(value)) {
+        *out++ = '-';
+        value = -value;
+    }
+
+    char digits[20] = {0};
+    int exponent;
+    unsigned long shortest;
+    int count = _runtimeShortest(value, &shortest, &exponent);
+    if (count > 0) {
+        exponent += count - 1;  // of the first digit
+        for (int i = count - 1; i >= 0; i--) {
+            digits[i] = (char)('0' + shortest % 10);
+            shortest /= 10;
+        }
+    } else {
+        count = _runtimeRoundTrip(value, digits, &exponent);
+    }
+
+    if (exponent < -7 || exponent >= 21) {
+        *out++ = digits[0];
+        if (count > 1) {
+            *out++ = '.';
+            memcpy(out, digits + 1, count - 1);
+            out += count - 1;
+        }
+        *out++ = 'e';
+        *out++ = (exponent < 0) ? '-' : '+';
+        int magnitude = abs(exponent);
+        if (magnitude >= 100)
+            *out++ = (char)('0' + magnitude / 100);
+        if (magnitude >= 10)
+            *out++ = (char)('0' + magnitude / 10 % 10);
+        *out++ = (char)('0' + magnitude % 10);
+    } else if (exponent < 0) {
+        *out++ = '0';
+        *out++ = '.';
+        for (int i = 1; i < -exponent; i++)
+            *out++ = '0';
+        memcpy(out, digits, count);
+        out += count;
+    } else {
+        for (int i = 0; i <= exponent; i++)
+            *out++ = (i < count) ? digits[i] : '0';
+        *out++ = '.';
+        if (count > exponent + 1) {
+            memcpy(out, digits + exponent + 1, count - exponent - 1);
+            out += count - exponent - 1;
+        } else {
+            *out++ = '0';
+        }
+    }
+    *out = '\0';
+    return (unsigned long)(out - text);
+}
+
+/**
+ * @brief Reads the next blank separated word of the input. The word is left in the input buffer
+ * and the blank after it is replaced by a NUL; when the word reaches the end of the buffer, it is
+ * moved to the start of the buffer and more input is read after it.
+ *
+ * @param runtime a runtime instance
+ * @param size set to the length of the word, longer words than RUNTIME_WORD_SIZE - 1 chars are invalid numbers
+ * @param where RUNTIME_WHERE of the read command
+ * @return char* the word
+ */
+char* _runtimeWord(Runtime* runtime, unsigned long* size, long where) {
+    char* buffer = runtime->inputBuffer;
+    for (;;) {
+        while (runtime->head < runtime->tail && _runtimeBlank(buffer[runtime->head]))
+            runtime->head++;
+        if (runtime->head < runtime->tail)
+            break;
+        if (!_runtimeFill(runtime))
+            runtimeFail(runtime, RUNTIME_END_OF_INPUT, where);
+    }
+
+    unsigned long end = runtime->head;
+    for (;;) {
+        while (end < runtime->tail && !_runtimeBlank(buffer[end]))
+            end++;
+        if (end - runtime->head >= RUNTIME_WORD_SIZE)
+            runtimeFail(runtime, RUNTIME_INVALID_INPUT, where);
+        if (end < runtime->tail || runtime->ended)
+            break;
+        end -= runtime->head;  // the word moves to the start of the buffer
+        _runtimeFill(runtime);
+    }
+
+    char* word = buffer + runtime->head;
+    *size = end - runtime->head;
+    buffer[end] = '\0';  // the blank after the word, or the extra byte at the end of the input
+    runtime->head = (end < runtime->tail) ? end + 1 : end;
+    return word;
+}
+
+/**
+ * @brief Moves the unread bytes of the input to the start of the buffer and reads more input
+ * after them: as much as fits, or a line if the input is a terminal
+ *
+ * @param runtime a runtime instance
+ * @return true if some input was read
+ * @return false at the end of the input
+ */
+bool _runtimeFill(Runtime* runtime) {
+    char* buffer = runtime->inputBuffer;
+    unsigned long unread = runtime->tail - runtime->head;
+    memmove(buffer, buffer + runtime->head, unread);
+    runtime->head = 0;
+    runtime->tail = unread;
+    if (runtime->ended)
+        return false;
+
+    unsigned long count = 0;
+    if (runtime->terminal) {
+        int c = 0;
+        while (unread + count < RUNTIME_BUFFER_SIZE && c != '\n' && (c = getc(runtime->input)) != EOF)
+            buffer[unread + count++] = (char)c;
+    } else {
+        count = fread(buffer + unread, 1, RUNTIME_BUFFER_SIZE - unread, runtime->input);
+    }
+    runtime->tail += count;
+    runtime->ended = (count == 0);
+    return count > 0;
+}
+
+/**
+ * @brief Writes the output buffer
+ *
+ * @param runtime a runtime instance
+ */
+void _runtimeFlush(Runtime* runtime) {
+    fwrite(runtime->outputBuffer, 1, runtime->written, runtime->output);
+    runtime->written = 0;
+    if (runtime->lineBuffered)
+        fflush(runtime->output);
+}
+
+/**
+ * @brief Starts a slice of steps: the generated code decrements ticks at each step and calls
+ * runtimeTick when it goes negative, that is after slice steps. The slice ends at the first step
+ * over the budget at the latest.
+ *
+ * @param runtime a runtime instance
+ */
+void _runtimeSlice(Runtime* runtime) {
+    long left = runtime->budget - runtime->consumed;
+    runtime->slice = (left < RUNTIME_SLICE) ? left + 1 : RUNTIME_SLICE;
+    runtime->ticks = runtime->slice - 1;
+}
+
+/**
+ * @brief Converts an integer written as an optional sign and decimal digits. After the leading
+ * zeros, the digits are converted 8 at a time (_runtimeEightDigits) and the rest one at a time;
+ * a long has at most 19 digits, so the magnitude can't overflow before the range check.
+ *
+ * @param text the integer
+ * @param size its number of chars
+ * @param value set to the integer
+ * @return true if the text isn't an integer or it doesn't fit in a long
+ * @return false if it was converted
+ */
+bool _runtimeParseInteger(const char* text, unsigned long size, long* value) {
+    bool negative = size > 0 && *text == '-';
+    if (size > 0 && (*text == '-' || *text == '+')) {
+        text++;
+        size--;
+    }
+    if (size == 0)
+        return true;
+    while (size > 1 && *text == '0') {
+        text++;
+        size--;
+    }
+    if (size > 19)
+        return true;
+
+    unsigned long magnitude = 0;
+    for (; size >= 8; text += 8, size -= 8) {
+        unsigned long eight;
+        if (_runtimeEightDigits(text, &eight))
+            return true;
+        magnitude = magnitude * 100000000 + eight;
+    }
+    for (; size > 0; text++, size--) {
+        unsigned int digit = (unsigned int)(*text - '0');
+        if (digit > 9)
+            return true;
+        magnitude = magnitude * 10 + digit;
+    }
+
+    if (magnitude > (unsigned long)LONG_MAX + negative)
+        return true;
+    *value = negative ? -(long)(magnitude - 1) - 1 : (long)magnitude;
+    return false;
+}
+
+/**
+ * @brief Converts 8 decimal digits at once in a 64-bit word (on little-endian hosts, the first
+ * char is the low byte): the bytes are checked to be digits, then neighbour digits are combined
+ * into numbers of 2, 4 and 8 digits with three multiplications
+ *
+ * @param text the 8 chars
+ * @param value set to their value
+ * @return true if some char isn't a digit
+ * @return false if they were converted
+ */
+bool _runtimeEightDigits(const char* text, unsigned long* value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    memcpy(&word, text, sizeof(word));
+    // a byte is a digit if its high half is 3 and adding 6 doesn't carry into it
+    if (((word & 0xf0f0f0f0f0f0f0f0) | (((word + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) !=
+        0x3333333333333333)
+        return true;
+    word -= 0x3030303030303030;
+    word = word * 10 + (word >> 8);  // pairs of digits in the even bytes
+    word = (((word & 0x000000ff000000ff) * (100 + (1000000ull << 32))) +
+            (((word >> 16) & 0x000000ff000000ff) * (1 + (10000ull << 32)))) >>
+           32;
+    *value = (unsigned long)(uint32_t)word;
+    return false;
+#else
+    unsigned long result = 0;
+    for (int i = 0; i < 8; i++) {
+        unsigned int digit = (unsigned int)(text[i] - '0');
+        if (digit > 9)
+            return true;
+        result = result * 10 + digit;
+    }
+    *value = result;
+    return false;
+#endif
+}
+
+/**
+ * @brief Multiplies a 55-bit integer by an entry of a table of powers of five and shifts the
+ * 183-bit product to the right
+ *
+ * @param m the integer
+ * @param factor the entry, low word first
+ * @param shift bits dropped, at least 64
+ * @return unsigned long the bits of the product that are kept
+ */
+unsigned long _runtimeMultiplyShift(unsigned long m, const uint64_t* factor, int shift) {
+    unsigned __int128 low = (unsigned __int128)m * factor[0];
+    unsigned __int128 high = (unsigned __int128)m * factor[1];
+    return (unsigned long)(((low >> 64) + high) >> (shift - 64));
+}
+
+/**
+ * @brief Whether an integer is a multiple of a power of five
+ *
+ * @param value the integer, not zero
+ * @param power exponent of five
+ * @return true if 5^power divides it
+ */
+bool _runtimeMultipleOfFive(unsigned long value, unsigned int power) {
+    unsigned int count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= power;
+}
+
+/**
+ * @brief Finds the shortest decimal digits of a finite non negative double with the Ryu algorithm.
+ * The double is m * 2^e; the interval of the reals that round to it goes halfway to its
+ * neighbours (bounds included if m is even). The value and both bounds are scaled by a power of
+ * ten, with the precomputed powers of five, so that they become integers with a few more digits
+ * than needed; digits are then removed from all of them while the bounds stay different, and the
+ * value is rounded to the nearest (ties to even).
+ * Ryu would round up instead when the nearest digits are the excluded lower bound, which happens
+ * when the lower neighbour is closer (powers of two); the value then needs more digits to read
+ * back with the nearest ones and is left to _runtimeRoundTrip, as printf finds them.
+ *
+ * @param value the double
+ * @param digits set to the digits, as an integer
+ * @param exponent set to the exponent of the last digit
+ * @return int the number of digits, 0 if the nearest shortest digits don't read back as the value
+ */
+int _runtimeShortest(double value, unsigned long* digits, int* exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    unsigned long mantissa = bits & ((1ul << 52) - 1);
+    int biased = (int)(bits >> 52) & 0x7ff;
+    if (biased == 0 && mantissa == 0) {
+        *digits = 0;
+        *exponent = 0;
+        return 1;
+    }
+
+    // value = m2 * 2^e2, with two more bits to represent the halfway bounds
+    int e2 = (biased == 0) ? 1 - 1023 - 52 - 2 : biased - 1023 - 52 - 2;
+    unsigned long m2 = (biased == 0) ? mantissa : (1ul << 52) | mantissa;
+    bool acceptBounds = (m2 & 1) == 0;
+    unsigned long mv = 4 * m2;
+    unsigned int mmShift = (mantissa != 0 || biased <= 1);  // the lower neighbour is as far as the upper one
+
+    // vr, vp and vm are the value, the upper and the lower bound times 10^-e10
+    unsigned long vr, vp, vm;
+    int e10;
+    bool vmIsTrailingZeros = false;
+    bool vrIsTrailingZeros = false;
+    if (e2 >= 0) {
+        unsigned int q = (((unsigned int)e2 * 78913) >> 18) - (e2 > 3);  // about log10(2^e2)
+        e10 = (int)q;
+        int k = RUNTIME_POWER_BITS + (int)((q * 1217359) >> 19) + 1 - 1;
+        int i = -e2 + (int)q + k;
+        vr = _runtimeMultiplyShift(4 * m2, inversePowersOfFive[q], i);
+        vp = _runtimeMultiplyShift(4 * m2 + 2, inversePowersOfFive[q], i);
+        vm = _runtimeMultiplyShift(4 * m2 - 1 - mmShift, inversePowersOfFive[q], i);
+        if (q <= 21) {
+            // the scaled values are exact only if the power of five divides them
+            if (mv % 5 == 0)
+                vrIsTrailingZeros = _runtimeMultipleOfFive(mv, q);
+            else if (acceptBounds)
+                vmIsTrailingZeros = _runtimeMultipleOfFive(mv - 1 - mmShift, q);
+            else
+                vp -= _runtimeMultipleOfFive(mv + 2, q);
+        }
+    } else {
+        unsigned int q = (((unsigned int)-e2 * 732923) >> 20) - (-e2 > 1);  // about log10(5^-e2)
+        e10 = (int)q + e2;
+        int i = -e2 - (int)q;
+        int k = (int)(((unsigned int)i * 1217359) >> 19) + 1 - RUNTIME_POWER_BITS;
+        int j = (int)q - k;
+        vr = _runtimeMultiplyShift(4 * m2, powersOfFive[i], j);
+        vp = _runtimeMultiplyShift(4 * m2 + 2, powersOfFive[i], j);
+        vm = _runtimeMultiplyShift(4 * m2 - 1 - mmShift, powersOfFive[i], j);
+        if (q <= 1) {
+            // mv has at least two trailing zero bits
+            vrIsTrailingZeros = true;
+            if (acceptBounds)
+                vmIsTrailingZeros = mmShift == 1;
+            else
+                vp--;
+        } else if (q < 63) {
+            vrIsTrailingZeros = (mv & ((1ul << q) - 1)) == 0;
+        }
+    }
+
+    int removed = 0;
+    unsigned int lastRemoved = 0;
+    unsigned long output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        // rare: the value or the lower bound may be exact, the removed digits decide the ties
+        while (vp / 10 > vm / 10) {
+            vmIsTrailingZeros &= vm % 10 == 0;
+            vrIsTrailingZeros &= lastRemoved == 0;
+            lastRemoved = (unsigned int)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm % 10 == 0) {
+                vrIsTrailingZeros &= lastRemoved == 0;
+                lastRemoved = (unsigned int)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vrIsTrailingZeros && lastRemoved == 5 && vr % 2 == 0)
+            lastRemoved = 4;  // exactly halfway, to even
+        if (vr == vm && (!acceptBounds || !vmIsTrailingZeros) && lastRemoved < 5)
+            return 0;
+        output = vr + (lastRemoved >= 5);
+    } else {
+        bool roundUp = false;
+        if (vp / 100 > vm / 100) {
+            roundUp = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            roundUp = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vr == vm && !roundUp)
+            return 0;
+        output = vr + roundUp;
+    }
+
+    int count = 1;
+    for (unsigned long rest = output; rest >= 10; rest /= 10)
+        count++;
+    *digits = output;
+    *exponent = e10 + removed;
+    return count;
+}
+
+/**
+ * @brief Finds the fewest digits that read back as a double by trying each precision with printf
+ * (for the doubles _runtimeShortest leaves out)
+ *
+ * @param value the finite double, not negative
+ * @param digits where the digits are written, 17 chars
+ * @param exponent set to the exponent of the first digit
+ * @return int the number of digits
+ */
+int _runtimeRoundTrip(double value, char* digits, int* exponent) {
+    char scientific[RUNTIME_REAL_SIZE];
+    for (int precision = 1; precision <= 17; precision++) {
+        snprintf(scientific, sizeof(scientific), "%.*e", precision - 1, value);
+        double back = strtod(scientific, NULL);
+        if (!memcmp(&back, &value, sizeof(double)))
+            break;
+    }
+
+    // d[.ddd]e(+|-)xx
+    int count = 0;
+    const char* p = scientific;
+    for (; *p != 'e'; p++)
+        if (*p != '.')
+            digits[count++] = *p;
+    *exponent = atoi(p + 1);
+    return count;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file sandbox.c
+ * @brief Sandboxed runs implementation. The stack of the thread is mapped here, with a page
+ * without access at its bottom; the frames of the procedures must stay SANDBOX_STACK_RESERVE bytes
+ * above it, so that a deep recursion ends with a memory limit verdict instead of a crash. The
+ * budget and the time are checked by runtimeTick, at the end of each slice of steps.
+ */
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS
+
+#include "../header/sandbox.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../header/diagnostics.h"
+#include "../header/memory.h"
+#include "../header/profile.h"
+
+/**
+ * @brief Initializes the limits of a sandboxed run: no budget nor time limit, the default memory
+ *
+ * @param limits the limits
+ */
+void sandboxLimitsInit(SandboxLimits* limits) {
+    limits->budget = 0;
+    limits->timeLimit = SANDBOX_DEFAULT_TIME;
+    limits->memoryLimit = SANDBOX_DEFAULT_MEMORY;
+}
+
+/**
+ * @brief Compiles a program with the sandbox checks and runs it on a thread whose stack holds
+ * the memory limit, less the global variables
+ *
+ * @param program a program without errors
+ * @param limits the limits of the run
+ * @param input where read takes the numbers from
+ * @param output where write prints
+ * @param result set to the verdict of the run
+ * @return true if the code couldn't be generated or the thread couldn't be started
+ * @return false if the program ran (whatever its verdict)
+ */
+bool sandboxRun(const Program* program, const SandboxLimits* limits, FILE* input, FILE* output,
+                SandboxResult* result) {
+    memset(result, 0, sizeof(SandboxResult));
+    long globals = 8l * (program->globalCount + 1);
+    if (globals > limits->memoryLimit) {
+        result->verdict = SANDBOX_MEMORY_LIMIT;
+        result->status = RUNTIME_MEMORY_LIMIT;
+        return false;
+    }
+
+    Jit jit;
+    if (jitCompile(&jit, program, true)) {
+        jitDestroy(&jit);
+        return true;
+    }
+
+    // the guard page, the reserve for the runtime, then what the program may use
+    unsigned long page = (unsigned long)sysconf(_SC_PAGESIZE);
+    unsigned long size = page + SANDBOX_STACK_RESERVE + (unsigned long)(limits->memoryLimit - globals);
+    size = (size + page - 1) / page * page;
+    char* stack = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (stack == MAP_FAILED) {
+        printf("Error: couldn't allocate the stack of the sandbox\n");
+        jitDestroy(&jit);
+        return true;
+    }
+    mprotect(stack, page, PROT_NONE);
+
+    Runtime* runtime = (Runtime*)memoryAlloc(sizeof(Runtime));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    runtimeInit(runtime, input, output);
+    runtimeLimit(runtime, limits->budget, limits->timeLimit);
+    runtime->stackLimit = stack + page + SANDBOX_STACK_RESERVE;
+
+    SandboxRun run = {&jit, runtime, RUNTIME_OK};
+    pthread_attr_t attributes;
+    pthread_t thread;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstack(&attributes, stack, size);
+    double start = runtimeClock();
+    bool error = pthread_create(&thread, &attributes, _sandboxThread, &run) != 0;
+    if (error)
+        printf("Error: couldn't start the thread of the sandbox\n");
+    else
+        pthread_join(thread, NULL);
+    pthread_attr_destroy(&attributes);
+    runtimeFinish(runtime);
+
+    if (!error) {
+        static const int verdicts[N_RUNTIME_STATUS] = {SANDBOX_OK, SANDBOX_RUNTIME_ERROR, SANDBOX_RUNTIME_ERROR,
+                                                       SANDBOX_RUNTIME_ERROR, SANDBOX_BUDGET_EXCEEDED,
+                                                       SANDBOX_TIME_LIMIT, SANDBOX_MEMORY_LIMIT};
+        result->verdict = verdicts[run.status];
+        result->status = run.status;
+        result->line = runtime->line;
+        result->col = runtime->col;
+        result->steps = runtimeSteps(runtime);
+        result->seconds = runtimeClock() - start;
+    }
+
+    memoryFree(runtime);
+    munmap(stack, size);
+    jitDestroy(&jit);
+    return error;
+}
+
+/**
+ * @brief Prints the verdict of a run: a line of text, or a JSON object for the json and sarif formats
+ *
+ * @param result the result of sandboxRun
+ * @param format DIAGNOSTIC_FORMAT
+ * @param output where it is printed
+ */
+void sandboxPrint(const SandboxResult* result, int format, FILE* output) {
+    bool stopped = result->verdict != SANDBOX_OK;
+    if (format == FORMAT_TEXT) {
+        fprintf(output, "Verdict: %s", sandboxVerdictName(result->verdict));
+        if (stopped && result->line > 0)
+            fprintf(output, " on line %d col %d", result->line, result->col);
+        if (stopped)
+            fprintf(output, ": %s", runtimeStatusMessage(result->status));
+        fprintf(output, " (%ld steps, %.3f s)\n", result->steps, result->seconds);
+        return;
+    }
+
+    fprintf(output, "{\"verdict\":\"%s\"", sandboxVerdictName(result->verdict));
+    if (stopped)
+        fprintf(output, ",\"message\":\"%s\",\"line\":%d,\"col\":%d", runtimeStatusMessage(result->status),
+                result->line, result->col);
+    fprintf(output, ",\"steps\":%ld,\"seconds\":%.6f}\n", result->steps, result->seconds);
+}
+
+/**
+ * @brief Returns the name of a verdict
+ *
+ * @param verdict SANDBOX_VERDICT
+ * @return const char* the name
+ */
+const char* sandboxVerdictName(int verdict) {
+    static const char* names[N_SANDBOX_VERDICTS] = {"ok", "budget-exceeded", "time-limit", "memory-limit",
+                                                    "runtime-error"};
+    return (verdict >= 0 && verdict < N_SANDBOX_VERDICTS) ? names[verdict] : "";
+}
+
+/**
+ * @brief Runs the program, on the thread of the sandbox
+ *
+ * @param argument the SandboxRun
+ * @return void* NULL
+ */
+void* _sandboxThread(void* argument) {
+    SandboxRun* run = (SandboxRun*)argument;
+    run->status = jitRun(run->jit, run->runtime);
+    return NULL;
+}
@@ -3,108 +3,64 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../header/memory.h"
+#include "../header/profile.h"
+
 /**
- * @brief Creates a stack with one element in it
+ * @brief Creates an empty stack, memory is only allocated on the first push
  *
- * @return Node* Pointer to the beginning of the stack
+ * @param stack the stack
  */
-Node* stackInit() {
-    Node* head = (Node*)malloc(sizeof(Node));
-    head->depth = 0;
-    head->next = NULL;
-
-    return head;
+void stackInit(Stack* stack) {
+    stack->depths = NULL;
+    stack->size = 0;
+    stack->capacity = 0;
 }
 
 /**
  * @brief Destroy the stack
  *
- * @param head adrress of the pointer to the beginning of the stack
+ * @param stack the stack
  */
-void stackDestroy(Node** head) {
-    if (!head)
-        return;
-
-    if (!(*head))
-        return;
-
-    stackDestroy(&((*head)->next));
-    free(*head);
-    *head = NULL;
+void stackDestroy(Stack* stack) {
+    memoryFree(stack->depths);
+    stackInit(stack);
 }
 
 /**
- * @brief Pushes an element into the stack. Creates the stack if empty.
+ * @brief Pushes an element into the stack, doubling its capacity when full
  *
- * @param head adrress of the pointer to the beginning of the stack
+ * @param stack the stack
+ * @param depth value of the new element
  */
-void stackPush(Node** head) {
-    if (!head)
-        return;
-
-    if (!(*head)) {  // empty list, become head
-        *head = stackInit();
-        return;
-    }
-    if (!(*head)->next) {  // last node, push
-        (*head)->next = stackInit();
-    } else {
-        stackPush(&(*head)->next);
+void stackPush(Stack* stack, int depth) {
+    if (stack->size == stack->capacity) {
+        stack->capacity = (stack->capacity == 0) ? 4 : 2 * stack->capacity;
+        stack->depths = (int*)memoryRealloc(stack->depths, stack->capacity * sizeof(int));
+        PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
     }
+    stack->depths[stack->size++] = depth;
 }
 
 /**
  * @brief Peaks at the stack
  *
- * @param head pointer to the beginning of the stack
- * @return int depth in the last element of the stack
+ * @param stack the stack
+ * @return int value of the last element of the stack or -1 if it is empty
  */
-int stackPeak(Node* head) {
-    if (!head)
+int stackPeak(const Stack* stack) {
+    if (stack->size == 0)
         return -1;  // not a synchronization token
 
-    if (!head->next)
-        return head->depth;
-
-    return stackPeak(head->next);
+    return stack->depths[stack->size - 1];
 }
 
 /**
  * @brief Pops the stack
  *
- * @param head adrress of the pointer to the beginning of the stack
- */
-void stackPop(Node** head) {
-    if (!(*head))
-        return;
-
-    if (!(*head)->next) {
-        free(*head);
-        (*head) = NULL;
-        return;
-    }
-
-    if (!(*head)->next->next) {  // next is last element
-        free((*head)->next);
-        (*head)->next = NULL;
-    } else {
-        stackPop(&((*head)->next));
-    }
-}
-
-/**
- * @brief Adds a value to all the elements in the stack
- *
- * @param head adrress of the pointer to the beginning of the stack
- * @param toAdd value to add to all elements of the stack
+ * @param stack the stack
  */
-void stackAdd(Node** head, int toAdd) {
-    if (!head)
-        return;
-
-    if (!(*head))
-        return;
-
-    (*head)->depth += toAdd;
-    stackAdd(&((*head)->next), toAdd);
+void stackPop(Stack* stack) {
+    if (stack->size > 0)
+        stack->size--;
 }
@@ -8,6 +8,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../header/memory.h"
+#include "../header/profile.h"
+
 /**
  * @brief Allocates initial memory for a short string
  *
@@ -16,8 +19,9 @@
 void stringInit(String* s) {
     s->size = 0;
     s->capacity = 4;
-    s->str = (char*)malloc(s->capacity * sizeof(char));
+    s->str = (char*)memoryAlloc(s->capacity * sizeof(char));
     s->str[0] = '\0';
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
 }
 
 /**
@@ -26,7 +30,7 @@ void stringInit(String* s) {
  * @param s the string
  */
 void stringDestroy(String* s) {
-    free(s->str);
+    memoryFree(s->str);
 }
 
 /**
@@ -53,8 +57,26 @@ void stringAppendChar(String* s, char c) {
  * @param cstr the C string
  */
 void stringAppendCstr(String* s, const char* cstr) {
-    for (size_t i = 0; i < strlen(cstr); i++)
-        stringAppendChar(s, cstr[i]);
+    stringAppend(s, cstr, strlen(cstr));
+}
+
+/**
+ * @brief Appends size bytes to the string
+ *
+ * @param s the string
+ * @param data the bytes to append
+ * @param size number of bytes
+ */
+void stringAppend(String* s, const char* data, unsigned long size) {
+    if (s->size + size + 1 > s->capacity) {
+        unsigned long newCapacity = s->capacity * 2;
+        while (newCapacity < s->size + size + 1)
+            newCapacity *= 2;
+        _stringExpand(s, newCapacity);
+    }
+    memcpy(s->str + s->size, data, size);
+    s->size += size;
+    s->str[s->size] = '\0';
 }
 
 /**
@@ -64,11 +86,23 @@ void stringAppendCstr(String* s, const char* cstr) {
  * @param integer the integer
  */
 void stringAppendInt(String* s, int integer) {
-    static char cstrInt[12];  // INT_MIN is -2.147.483.648, so it fits in 12 bits (with signal)
+    char cstrInt[12];  // INT_MIN is -2.147.483.648, so it fits in 12 bits (with signal)
     sprintf(cstrInt, "%d", integer);
     stringAppendCstr(s, cstrInt);
 }
 
+/**
+ * @brief Appends an unsigned long integer to the string
+ *
+ * @param s the string
+ * @param integer the integer
+ */
+void stringAppendLong(String* s, unsigned long integer) {
+    char cstrLong[21];  // 2^64 - 1 has 20 digits
+    sprintf(cstrLong, "%lu", integer);
+    stringAppendCstr(s, cstrLong);
+}
+
 /**
  * @brief Overwrites string
  *
@@ -77,13 +111,49 @@ void stringAppendInt(String* s, int integer) {
  * @param size C string size
  */
 void stringOverwrite(String* s, const char cstr[], unsigned long size) {
-    if (s->capacity < size)
+    if (s->capacity < size + 1)
         _stringExpand(s, size + 1);
     memcpy(s->str, cstr, size);
     s->str[size] = '\0';
     s->size = size;
 }
 
+/**
+ * @brief Validates the UTF-8 character at the beginning of a string (no overlong encodings,
+ * surrogates or code points above U+10FFFF)
+ *
+ * @param cstr '\0' terminated string
+ * @return unsigned long number of bytes of the character or 0 if it isn't valid UTF-8
+ */
+unsigned long stringUtf8CharLength(const char* cstr) {
+    const unsigned char* c = (const unsigned char*)cstr;
+    if (c[0] < 0x80)
+        return 1;
+
+    unsigned long length;
+    unsigned char min = 0x80, max = 0xbf;  // range of the second byte
+    if (c[0] >= 0xc2 && c[0] <= 0xdf) {
+        length = 2;
+    } else if (c[0] >= 0xe0 && c[0] <= 0xef) {
+        length = 3;
+        min = (c[0] == 0xe0) ? 0xa0 : min;
+        max = (c[0] == 0xed) ? 0x9f : max;
+    } else if (c[0] >= 0xf0 && c[0] <= 0xf4) {
+        length = 4;
+        min = (c[0] == 0xf0) ? 0x90 : min;
+        max = (c[0] == 0xf4) ? 0x8f : max;
+    } else {
+        return 0;
+    }
+
+    if (c[1] < min || c[1] > max)
+        return 0;
+    for (unsigned long i = 2; i < length; i++)
+        if ((c[i] & 0xc0) != 0x80)
+            return 0;
+    return length;
+}
+
 /**
  * @brief Expands string capacity
  *
@@ -91,9 +161,10 @@ void stringOverwrite(String* s, const char cstr[], unsigned long size) {
  * @param newCapacity the desired capacity
  */
 void _stringExpand(String* s, unsigned long newCapacity) {
-    char* newBuff = (char*)malloc(newCapacity * sizeof(char));
+    char* newBuff = (char*)memoryAlloc(newCapacity * sizeof(char));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
     memcpy(newBuff, s->str, s->size + 1);
-    free(s->str);
+    memoryFree(s->str);
     s->str = newBuff;
     s->capacity = newCapacity;
 }
\ No newline at end of file
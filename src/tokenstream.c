@@ -0,0 +1,406 @@
+/**
+ * @file tokenstream.c
+ * @brief Compact binary serialization of the lexer output (token streams) implementation
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "../header/tokenstream.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../header/memory.h"
+#include "../header/parallellexer.h"
+#include "../header/profile.h"
+
+/**
+ * @brief Maps a serialized token stream in memory and decodes its lexeme table.
+ * The lexemes are not copied, they point straight into the mapping.
+ *
+ * @param stream a token stream instance
+ * @param path serialized token stream path
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool tokenStreamOpen(TokenStream* stream, const char* path) {
+    stream->data = NULL;
+    stream->lexemes = NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        printf("Error: no such file\n");
+        return true;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || info.st_size < TOKEN_STREAM_HEADER_SIZE) {
+        printf("Error: invalid token stream\n");
+        close(fd);
+        return true;
+    }
+
+    PROFILE_ENTER(PHASE_IO);
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    PROFILE_LEAVE();
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Error: couldn't map token stream\n");
+        return true;
+    }
+
+    stream->data = (const unsigned char*)data;
+    stream->size = info.st_size;
+    stream->end = stream->data + stream->size;
+    stream->cursor = stream->data + TOKEN_STREAM_HEADER_SIZE;
+    stream->position.offset = 0;
+    stream->position.lineOffset = NO_OFFSET;
+    stream->position.line = 1;
+    stream->position.col = 1;
+
+    if (memcmp(stream->data, TOKEN_STREAM_MAGIC, 4) || stream->data[4] != TOKEN_STREAM_VERSION) {
+        printf("Error: invalid token stream\n");
+        tokenStreamClose(stream);
+        return true;
+    }
+
+    unsigned long lexemeCount;
+    if (!_readVarint(stream, &lexemeCount) || !_readVarint(stream, &stream->remaining) || lexemeCount > stream->size) {
+        printf("Error: invalid token stream\n");
+        tokenStreamClose(stream);
+        return true;
+    }
+
+    // decode the lexeme table
+    stream->lexemeCount = lexemeCount;
+    stream->lexemes = (const char**)memoryAlloc((lexemeCount + 1) * sizeof(char*));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 1);
+    for (unsigned long i = 0; i < lexemeCount; i++) {
+        unsigned long length;
+        if (!_readVarint(stream, &length) || length >= (unsigned long)(stream->end - stream->cursor) || stream->cursor[length] != '\0') {
+            printf("Error: invalid token stream\n");
+            tokenStreamClose(stream);
+            return true;
+        }
+        stream->lexemes[i] = (const char*)stream->cursor;
+        stream->cursor += length + 1;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Unmaps the token stream
+ *
+ * @param stream a token stream instance
+ */
+void tokenStreamClose(TokenStream* stream) {
+    if (stream->data != NULL)
+        munmap((void*)stream->data, stream->size);
+    memoryFree(stream->lexemes);
+    stream->data = NULL;
+    stream->lexemes = NULL;
+}
+
+/**
+ * @brief Loads the next token of the stream into the lexer, as if nextToken had recognized it.
+ * Lexer errors stored in the stream are recorded in the diagnostics. Once the stream is over
+ * (or corrupted), the end of file token is returned.
+ *
+ * @param stream a token stream instance
+ * @param lexer a lexer initialized without source code
+ * @param diagnostics diagnostics where lexer errors are recorded
+ * @return int number of lexer errors found before the token
+ */
+int tokenStreamNext(TokenStream* stream, Lexer* lexer, Diagnostics* diagnostics) {
+    int errors = 0;
+    lexer->currState = 0;
+
+    while (stream->remaining > 0) {
+        unsigned long tag, lineDelta, col, offsetDelta, lexeme, state = 0;
+        if (!_readVarint(stream, &tag) || !_readVarint(stream, &lineDelta) || !_readVarint(stream, &col) ||
+            !_readVarint(stream, &offsetDelta) || !_readVarint(stream, &lexeme) || lexeme >= stream->lexemeCount ||
+            (tag == TOKEN_STREAM_LEXER_ERROR && !_readVarint(stream, &state)) || state >= NUMBER_OF_LEXER_ERROR_CODES) {
+            break;
+        }
+        stream->remaining--;
+
+        // zigzag decoding
+        stream->position.line += (lineDelta & 1) ? -(int)(lineDelta >> 1) - 1 : (int)(lineDelta >> 1);
+        stream->position.col = (int)col;
+        stream->position.offset += offsetDelta;
+
+        if (tag == TOKEN_STREAM_LEXER_ERROR) {
+            diagnosticsLexerError(diagnostics, &stream->position, stream->lexemes[lexeme], (int)state);
+            errors++;
+            continue;
+        }
+
+        int tokenClass = tag & ~TOKEN_STREAM_EOF_FLAG;
+        if (tokenClass >= N_TOKEN_CLASS)
+            break;
+        lexer->tokenClass = tokenClass;
+        lexer->fscanfFlag = (tag & TOKEN_STREAM_EOF_FLAG) ? EOF : 1;
+        stringOverwrite(&lexer->buffer, stream->lexemes[lexeme], strlen(stream->lexemes[lexeme]));
+        _convertNumber(lexer);  // an overflow is stored as a lexer error record
+        return errors;
+    }
+
+    // end of stream
+    stream->remaining = 0;
+    lexer->tokenClass = LAMBDA;
+    lexer->fscanfFlag = EOF;
+    stringOverwrite(&lexer->buffer, "", 0);
+    return errors;
+}
+
+/**
+ * @brief Lexes a P-- source code file and writes its serialized token stream.
+ *
+ * @param sourcePath P-- source code file path
+ * @param streamPath path of the serialized token stream
+ * @param jobs maximum number of lexer threads (0 uses every CPU, 1 lexes the file as a stream)
+ * @param diagnostics diagnostics where lexer errors are recorded
+ * @param errorCount incremented by the number of lexer errors
+ * @return true if there was some error
+ * @return false if there was no error
+ */
+bool tokenStreamEmit(const char* sourcePath, const char* streamPath, int jobs, Diagnostics* diagnostics, int* errorCount) {
+    Lexer lexer;
+    ParallelLexer lexed;
+    bool parallel = (jobs != 1 && strcmp(sourcePath, "-"));
+    if (lexerInit(&lexer, parallel ? NULL : sourcePath, NULL))
+        return true;
+    if (parallel) {
+        PROFILE_ENTER(PHASE_LEXER);
+        bool error = parallelLexerOpen(&lexed, sourcePath, jobs);
+        PROFILE_LEAVE();
+        if (error) {
+            lexerDestroy(&lexer);
+            return true;
+        }
+        inputOpenBuffer(&lexer.sourceCode, lexed.source, lexed.size);
+    }
+
+    // lexer errors are collected without limit so that all of them are serialized
+    Diagnostics lexerDiagnostics;
+    diagnosticsInit(&lexerDiagnostics, FORMAT_TEXT, 0);
+
+    LexemeTable lexemes;
+    _lexemeTableInit(&lexemes);
+    String tokens;
+    stringInit(&tokens);
+
+    unsigned long tokenCount = 0;
+    unsigned long recorded = 0;
+    SourcePosition last = {0, NO_OFFSET, 1, 1};
+    do {
+        PROFILE_ENTER(PHASE_LEXER);
+        *errorCount += parallel ? parallelLexerNext(&lexed, &lexer, &lexerDiagnostics) : nextToken(&lexer, &lexerDiagnostics);
+        PROFILE_COUNT(COUNTER_TOKENS, 1);
+        PROFILE_LEAVE();
+
+        for (; recorded < lexerDiagnostics.size; recorded++, tokenCount++) {
+            const Diagnostic* error = &lexerDiagnostics.list[recorded];
+            const char* lexeme = lexerDiagnostics.textPool.str + error->text;
+            SourcePosition position = {error->offset, error->lineOffset, error->line, error->col};
+            _writeToken(&tokens, &lexemes, TOKEN_STREAM_LEXER_ERROR, false, &position, &last, lexeme, error->code);
+            diagnosticsLexerError(diagnostics, &position, lexeme, error->code);
+        }
+
+        SourcePosition position;
+        lexerTokenPosition(&lexer, &position);
+        _writeToken(&tokens, &lexemes, lexer.tokenClass, lexer.fscanfFlag == EOF, &position, &last, lexer.buffer.str, 0);
+        tokenCount++;
+    } while (lexer.tokenClass != LAMBDA);
+
+    // header
+    String header;
+    stringInit(&header);
+    stringAppend(&header, TOKEN_STREAM_MAGIC, 4);
+    stringAppendChar(&header, TOKEN_STREAM_VERSION);
+    stringAppend(&header, "\0\0\0", 3);  // reserved
+    _writeVarint(&header, lexemes.count);
+    _writeVarint(&header, tokenCount);
+
+    PROFILE_ENTER(PHASE_IO);
+    bool error = false;
+    FILE* output = fopen(streamPath, "wb");
+    if (output == NULL) {
+        printf("Error: couldn't create token stream file\n");
+        error = true;
+    } else {
+        fwrite(header.str, sizeof(char), header.size, output);
+        fwrite(lexemes.table.str, sizeof(char), lexemes.table.size, output);
+        fwrite(tokens.str, sizeof(char), tokens.size, output);
+        fclose(output);
+    }
+    PROFILE_LEAVE();
+
+    stringDestroy(&header);
+    stringDestroy(&tokens);
+    _lexemeTableDestroy(&lexemes);
+    diagnosticsDestroy(&lexerDiagnostics);
+    lexerDestroy(&lexer);
+    if (parallel)
+        parallelLexerDestroy(&lexed);
+    return error;
+}
+
+/**
+ * @brief Appends an unsigned LEB128 varint
+ *
+ * @param s the string
+ * @param value value to encode
+ */
+void _writeVarint(String* s, unsigned long value) {
+    char bytes[10];
+    int size = 0;
+    while (value >= 0x80) {
+        bytes[size++] = (char)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[size++] = (char)value;
+    stringAppend(s, bytes, size);
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint from the stream
+ *
+ * @param stream a token stream instance
+ * @param value decoded value
+ * @return true if a varint was read
+ * @return false if the stream is truncated or the varint is too long
+ */
+bool _readVarint(TokenStream* stream, unsigned long* value) {
+    *value = 0;
+    for (int shift = 0; stream->cursor < stream->end && shift < 64; shift += 7) {
+        unsigned char byte = *stream->cursor++;
+        *value |= (unsigned long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Encodes a token record
+ *
+ * @param s string where the record is appended
+ * @param lexemes lexeme interning table
+ * @param tokenClass token class or TOKEN_STREAM_LEXER_ERROR
+ * @param atEOF whether the token was recognized at the end of file
+ * @param position position of the first char of the token
+ * @param last position of the previous record (updated)
+ * @param lexeme token lexeme
+ * @param state automaton state (lexer error records only)
+ */
+void _writeToken(String* s, LexemeTable* lexemes, int tokenClass, bool atEOF, const SourcePosition* position, SourcePosition* last, const char* lexeme, int state) {
+    int lineDelta = position->line - last->line;
+
+    _writeVarint(s, tokenClass | (atEOF ? TOKEN_STREAM_EOF_FLAG : 0));
+    _writeVarint(s, (lineDelta >= 0) ? (unsigned long)lineDelta << 1 : ((unsigned long)(-lineDelta - 1) << 1) | 1);
+    _writeVarint(s, position->col);
+    _writeVarint(s, position->offset - last->offset);
+    _writeVarint(s, _lexemeTableIntern(lexemes, lexeme));
+    if (tokenClass == TOKEN_STREAM_LEXER_ERROR)
+        _writeVarint(s, state);
+    *last = *position;
+}
+
+/**
+ * @brief Initializes an empty lexeme interning table
+ *
+ * @param lexemes lexeme interning table
+ */
+void _lexemeTableInit(LexemeTable* lexemes) {
+    stringInit(&lexemes->table);
+    stringInit(&lexemes->text);
+    lexemes->count = 0;
+    lexemes->capacity = 64;
+    lexemes->offsets = (unsigned long*)memoryAlloc(lexemes->capacity * sizeof(unsigned long));
+    lexemes->slots = (unsigned long*)memoryCalloc(lexemes->capacity, sizeof(unsigned long));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 2);
+}
+
+/**
+ * @brief Deallocates the lexeme interning table
+ *
+ * @param lexemes lexeme interning table
+ */
+void _lexemeTableDestroy(LexemeTable* lexemes) {
+    stringDestroy(&lexemes->table);
+    stringDestroy(&lexemes->text);
+    memoryFree(lexemes->offsets);
+    memoryFree(lexemes->slots);
+}
+
+/**
+ * @brief FNV-1a hash of a lexeme
+ *
+ * @param lexeme the lexeme
+ * @param length lexeme length
+ * @return unsigned long hash value
+ */
+unsigned long _lexemeHash(const char* lexeme, unsigned long length) {
+    unsigned long hash = 14695981039346656037UL;
+    for (unsigned long i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)lexeme[i]) * 1099511628211UL;
+    return hash;
+}
+
+/**
+ * @brief Returns the index of a lexeme, adding it to the table if it's new (linear probing)
+ *
+ * @param lexemes lexeme interning table
+ * @param lexeme the lexeme
+ * @return unsigned long lexeme index
+ */
+unsigned long _lexemeTableIntern(LexemeTable* lexemes, const char* lexeme) {
+    unsigned long length = strlen(lexeme);
+    unsigned long slot = _lexemeHash(lexeme, length) & (lexemes->capacity - 1);
+    while (lexemes->slots[slot] != 0) {
+        unsigned long index = lexemes->slots[slot] - 1;
+        if (!strcmp(lexemes->text.str + lexemes->offsets[index], lexeme))
+            return index;
+        slot = (slot + 1) & (lexemes->capacity - 1);
+    }
+
+    // new lexeme
+    unsigned long index = lexemes->count++;
+    lexemes->offsets[index] = lexemes->text.size;
+    lexemes->slots[slot] = index + 1;
+    stringAppend(&lexemes->text, lexeme, length + 1);
+
+    _writeVarint(&lexemes->table, length);
+    stringAppend(&lexemes->table, lexeme, length + 1);
+
+    if (2 * lexemes->count >= lexemes->capacity)  // keep the load factor under 1/2
+        _lexemeTableGrow(lexemes);
+    return index;
+}
+
+/**
+ * @brief Doubles the number of slots of the lexeme table and rehashes it
+ *
+ * @param lexemes lexeme interning table
+ */
+void _lexemeTableGrow(LexemeTable* lexemes) {
+    lexemes->capacity *= 2;
+    lexemes->offsets = (unsigned long*)memoryRealloc(lexemes->offsets, lexemes->capacity * sizeof(unsigned long));
+    PROFILE_COUNT(COUNTER_ALLOCATIONS, 2);
+    memoryFree(lexemes->slots);
+    lexemes->slots = (unsigned long*)memoryCalloc(lexemes->capacity, sizeof(unsigned long));
+
+    for (unsigned long index = 0; index < lexemes->count; index++) {
+        const char* lexeme = lexemes->text.str + lexemes->offsets[index];
+        unsigned long slot = _lexemeHash(lexeme, strlen(lexeme)) & (lexemes->capacity - 1);
+        while (lexemes->slots[slot] != 0)
+            slot = (slot + 1) & (lexemes->capacity - 1);
+        lexemes->slots[slot] = index + 1;
+    }
+}
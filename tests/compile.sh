@@ -0,0 +1,51 @@
+#!/bin/bash
+# Translates each program of tests/compile with --emit-c, builds it with the C compiler and checks
+# its output (NAME.out, reading NAME.in when it exists) and the ones of --run and --sandbox; programs
+# without a .out file have errors and must be rejected
+# usage: tests/compile.sh [PMM] [CC]  (compiler flags can be overridden with CFLAGS)
+PMM=${1:-./pmm}
+CC=${2:-cc}
+CFLAGS=${CFLAGS:-"-std=c17 -O2 -Wall -Wextra"}
+DIR=$(dirname "$0")/compile
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+failed=0
+for source in "$DIR"/*.txt; do
+    name=$(basename "$source" .txt)
+    expected="$DIR/$name.out"
+    input="$DIR/$name.in"
+    [ -f "$input" ] || input=/dev/null
+
+    if [ ! -f "$expected" ]; then
+        if "$PMM" --emit-c="$work/$name.c" "$source" > /dev/null || [ -f "$work/$name.c" ]; then
+            echo "FAIL $name: translated a program with errors"
+            failed=$((failed + 1))
+        else
+            echo "ok   $name (rejected)"
+        fi
+        continue
+    fi
+
+    if ! "$PMM" --emit-c="$work/$name.c" "$source" > /dev/null; then
+        echo "FAIL $name: not translated"
+        failed=$((failed + 1))
+    elif ! $CC $CFLAGS -o "$work/$name" "$work/$name.c" -lm; then
+        echo "FAIL $name: the C code doesn't compile"
+        failed=$((failed + 1))
+    elif ! "$work/$name" < "$input" | cmp -s - "$expected"; then
+        echo "FAIL $name: wrong output of the C build"
+        failed=$((failed + 1))
+    elif ! "$PMM" --run "$source" < "$input" | cmp -s - "$expected"; then
+        echo "FAIL $name: wrong output of --run"
+        failed=$((failed + 1))
+    elif ! "$PMM" --sandbox "$source" < "$input" 2> /dev/null | cmp -s - "$expected"; then
+        echo "FAIL $name: wrong output of --sandbox"
+        failed=$((failed + 1))
+    else
+        echo "ok   $name"
+    fi
+done
+
+[ "$failed" -eq 0 ] || { echo "$failed failed"; exit 1; }
@@ -0,0 +1,34 @@
+#!/bin/bash
+# Compiles the cases of tests/diagnostics and checks their output: NAME.args holds the options and the
+# source file (relative to tests/diagnostics), NAME.out the expected stdout, snippets excluded. With
+# --from-tokens the source file is written as a token stream first and the stream is compiled
+# usage: tests/diagnostics.sh [PMM]
+PMM=$(realpath "${1:-./pmm}")
+DIR=$(realpath "$(dirname "$0")/diagnostics")
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 1  # output.txt is written to the current directory
+
+failed=0
+for case in "$DIR"/*.args; do
+    name=$(basename "$case" .args)
+    arguments=()
+    for argument in $(cat "$case"); do
+        [[ "$argument" == --* ]] || argument="$DIR/$argument"
+        if [[ "$argument" != --* ]] && grep -q -- "--from-tokens" "$case"; then
+            "$PMM" --emit-tokens="$work/stream" "$argument" > /dev/null 2>&1
+            argument="$work/stream"
+        fi
+        arguments+=("$argument")
+    done
+
+    if "$PMM" --no-snippets "${arguments[@]}" 2> /dev/null | cmp -s - "$DIR/$name.out"; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name: $(cat "$case")"
+        failed=$((failed + 1))
+    fi
+done
+
+[ "$failed" -eq 0 ] || { echo "$failed failed"; exit 1; }
@@ -0,0 +1,271 @@
+/**
+ * @file lexgen.c
+ * @brief Generates the direct-coded lexer automaton (_scanDirectCoded, included by src/lexerdirect.c)
+ * from the transition matrix and the final states built by src/automaton.c, so both implementations
+ * of the lexer always describe the same automaton. The code is written to stdout.
+ *
+ * usage: lexgen > build/lexerdirect.inc
+ *
+ * Every reachable state that isn't final becomes a label. Its transitions are a switch on the char
+ * read: a transition to a state that isn't final is a goto, a transition to a final state appends
+ * the token to the buffer as _scanWithTable would and returns. Bytes that keep a state in itself are
+ * first skipped by a loop on a few ranges of chars (or by memchr when a single char leaves the state).
+ *
+ * Chars are appended to the buffer of _scanWithTable from the first char of the token on, so the
+ * token is a contiguous run of the input and it is appended in blocks. The generator checks that
+ * this holds for the automaton and fails otherwise.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../header/lexer.h"
+
+#define MAX_SELF_LOOP_RANGES 4  // self loops with more ranges of chars are left to the switch
+
+int transitionMatrix[NUMBER_OF_STATES][NUMBER_OF_CHARS];
+bool finalState[NUMBER_OF_STATES];
+char finalStateClass[NUMBER_OF_STATES];
+
+/**
+ * @brief Whether _scanWithTable appends the char that makes the automaton move to a state
+ *
+ * @param state the next state
+ * @return true if the char is appended to the buffer
+ */
+bool appends(int state) {
+    return finalStateClass[state] == -ERROR ||
+           (state != 0 && state != COMMENT_STATE && finalStateClass[state] >= 0);
+}
+
+/**
+ * @brief Writes a char as a C constant
+ *
+ * @param c the char
+ */
+void printChar(int c) {
+    if (c == '\'' || c == '\\')
+        printf("'\\%c'", c);
+    else if (c == '\t')
+        printf("'\\t'");
+    else if (c == '\n')
+        printf("'\\n'");
+    else if (c == '\r')
+        printf("'\\r'");
+    else if (c >= ' ' && c <= '~')
+        printf("'%c'", c);
+    else
+        printf("0x%02x", c);
+}
+
+/**
+ * @brief Finds which states are reachable from the initial one and whether the token has started
+ * in them (some char was appended to the buffer). Fails if the appended chars aren't contiguous.
+ *
+ * @param reachable set to whether each state is reachable
+ * @param inToken set to whether the token has started in each reachable state
+ */
+void analyse(bool reachable[NUMBER_OF_STATES], bool inToken[NUMBER_OF_STATES]) {
+    int pending[NUMBER_OF_STATES];
+    int count = 0;
+    for (int i = 0; i < NUMBER_OF_STATES; i++)
+        reachable[i] = inToken[i] = false;
+    reachable[0] = true;
+    pending[count++] = 0;
+
+    while (count > 0) {
+        int state = pending[--count];
+        for (int c = 0; c < NUMBER_OF_CHARS; c++) {
+            int next = transitionMatrix[state][c];
+            if (next < 0 || next >= NUMBER_OF_STATES) {
+                fprintf(stderr, "lexgen: state %d has no transition on %d\n", state, c);
+                exit(1);
+            }
+            if (finalState[next])
+                continue;
+
+            bool started = inToken[state] || appends(next);
+            if (inToken[state] && !appends(next)) {
+                fprintf(stderr, "lexgen: the token isn't contiguous from state %d on %d\n", state, c);
+                exit(1);
+            }
+            if (reachable[next] && inToken[next] != started) {
+                fprintf(stderr, "lexgen: state %d is reached both inside and outside a token\n", next);
+                exit(1);
+            }
+            if (!reachable[next]) {
+                reachable[next] = true;
+                inToken[next] = started;
+                pending[count++] = next;
+            }
+        }
+    }
+
+    // +/- is turned into an unary operator after the matrix lookup, it must be appended the same way
+    if (appends(OP_ADD_STATE) != appends(OP_UN_STATE) || !finalState[OP_ADD_STATE] || !finalState[OP_UN_STATE]) {
+        fprintf(stderr, "lexgen: the operator states %d and %d differ\n", OP_ADD_STATE, OP_UN_STATE);
+        exit(1);
+    }
+}
+
+/**
+ * @brief Writes the loop that skips the chars on which a state stays in itself, if they are a
+ * few ranges of chars or every char but one
+ *
+ * @param state the state
+ */
+void printSelfLoop(int state) {
+    int ranges[NUMBER_OF_CHARS][2];
+    int rangeCount = 0;
+    int exits = 0;
+    int exitChar = 0;
+    for (int c = 0; c < NUMBER_OF_CHARS; c++) {
+        if (transitionMatrix[state][c] != state) {
+            exits++;
+            exitChar = c;
+        } else if (rangeCount > 0 && ranges[rangeCount - 1][1] == c - 1) {
+            ranges[rangeCount - 1][1] = c;
+        } else {
+            ranges[rangeCount][0] = ranges[rangeCount][1] = c;
+            rangeCount++;
+        }
+    }
+
+    if (rangeCount == 0)
+        return;
+    if (exits == 1) {
+        printf("    {\n        const unsigned char* stop = memchr(p, ");
+        printChar(exitChar);
+        printf(", (size_t)(end - p));\n        p = (stop != NULL) ? stop : end;\n    }\n");
+        return;
+    }
+    if (rangeCount > MAX_SELF_LOOP_RANGES)
+        return;
+
+    printf("    while (p < end && (");
+    for (int i = 0; i < rangeCount; i++) {
+        if (i > 0)
+            printf(" || ");
+        if (ranges[i][0] == ranges[i][1]) {
+            printf("*p == ");
+            printChar(ranges[i][0]);
+        } else {
+            printf("(*p >= ");
+            printChar(ranges[i][0]);
+            printf(" && *p <= ");
+            printChar(ranges[i][1]);
+            printf(")");
+        }
+    }
+    printf("))\n        p++;\n");
+}
+
+/**
+ * @brief Writes the code of a transition
+ *
+ * @param state current state
+ * @param next next state
+ * @param inToken whether the token has started in each state
+ */
+void printTransition(int state, int next, const bool inToken[NUMBER_OF_STATES]) {
+    if (!finalState[next]) {
+        if (!inToken[state] && inToken[next])
+            printf("            token = p - 1;\n");
+        printf("            goto state%d;\n", next);
+        return;
+    }
+
+    if (next == OP_ADD_STATE)  // +/- after neither a number nor an identifier is an unary operator
+        printf("            lexer->currState = lexer->lastWasNumberOrIdent ? %d : %d;\n", OP_ADD_STATE, OP_UN_STATE);
+    else
+        printf("            lexer->currState = %d;\n", next);
+
+    if (appends(next) && inToken[state])
+        printf("            FLUSH(p);\n");
+    else if (appends(next))
+        printf("            stringAppendChar(&lexer->buffer, (char)c);\n");
+    else if (inToken[state])  // the char is retreated
+        printf("            FLUSH(p - 1);\n");
+    printf("            ACCEPT();\n");
+}
+
+/**
+ * @brief Writes the label of a state, its self loop and the switch of its transitions
+ *
+ * @param state the state
+ * @param inToken whether the token has started in each state
+ */
+void printState(int state, const bool inToken[NUMBER_OF_STATES]) {
+    // the most frequent next state is the default case
+    int frequency[NUMBER_OF_STATES] = {0};
+    int fallback = 0;
+    for (int c = 0; c < NUMBER_OF_CHARS; c++)
+        frequency[transitionMatrix[state][c]]++;
+    for (int i = 1; i < NUMBER_OF_STATES; i++)
+        if (frequency[i] > frequency[fallback])
+            fallback = i;
+
+    printf("\nstate%d:\n", state);
+    printSelfLoop(state);
+    printf("    READ(%d);\n    switch (c) {\n", state);
+    for (int next = 0; next < NUMBER_OF_STATES; next++) {
+        if (frequency[next] == 0 || next == fallback)
+            continue;
+
+        int column = 0;  // cases written on the line
+        for (int c = 0; c < NUMBER_OF_CHARS; c++) {
+            if (transitionMatrix[state][c] != next)
+                continue;
+            if (column == 8) {
+                printf("\n");
+                column = 0;
+            }
+            printf(column == 0 ? "        case " : " case ");
+            printChar(c);
+            printf(":");
+            column++;
+        }
+        printf("\n");
+        printTransition(state, next, inToken);
+    }
+    printf("        default:\n");
+    printTransition(state, fallback, inToken);
+    printf("    }\n");
+}
+
+/**
+ * @brief Writes _scanDirectCoded
+ *
+ * @return int exit status
+ */
+int main(void) {
+    _buildTransitionMatrix(transitionMatrix);
+    _buildFinalStates(finalState, finalStateClass);
+
+    bool reachable[NUMBER_OF_STATES];
+    bool inToken[NUMBER_OF_STATES];
+    analyse(reachable, inToken);
+
+    printf("// generated by tools/lexgen.c from src/automaton.c, don't edit\n\n");
+    printf("/**\n");
+    printf(" * @brief Runs the automaton from the initial state until a final state or the end of the source\n");
+    printf(" * code, with the same outcome as _scanWithTable\n");
+    printf(" *\n");
+    printf(" * @param lexer lexer instance, the buffer holds the token\n");
+    printf(" * @return true if the end of the source code was reached before a final state\n");
+    printf(" * @return false if a final state was reached\n");
+    printf(" */\n");
+    printf("bool _scanDirectCoded(Lexer* lexer) {\n");
+    printf("    Input* input = &lexer->sourceCode;\n");
+    printf("    const unsigned char* end;\n");
+    printf("    const unsigned char* p = inputSpan(input, &end);\n");
+    printf("    const unsigned char* base = p;      // char at the head of the input\n");
+    printf("    const unsigned char* token = NULL;  // first char of the token not appended yet (NULL before the token)\n");
+    printf("    unsigned char c = 0;\n");
+
+    for (int state = 0; state < NUMBER_OF_STATES; state++)
+        if (reachable[state])
+            printState(state, inToken);
+    printf("}\n");
+    return 0;
+}
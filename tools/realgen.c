@@ -0,0 +1,178 @@
+/**
+ * @file realgen.c
+ * @brief Generates the tables of powers of five used by runtimeFormatReal (included by src/runtime.c)
+ * to find the shortest digits of a double with integer arithmetic (the Ryu algorithm). The code is
+ * written to stdout.
+ *
+ * usage: realgen > build/realpowers.inc
+ *
+ * powersOfFive[i] holds the REALGEN_BITS leading bits of 5^i, inversePowersOfFive[i] the
+ * REALGEN_BITS leading bits of 1 / 5^i plus one (2^125 + 1 for i = 0), each split in two 64-bit
+ * words (low word first). They are computed exactly with integers of BIG_LIMBS 32-bit limbs.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define REALGEN_BITS 125         // bits of each entry
+#define REALGEN_POWERS 326       // entries of powersOfFive (negative decimal exponents)
+#define REALGEN_INVERSES 342     // entries of inversePowersOfFive (positive decimal exponents)
+#define BIG_LIMBS 40             // 1280 bits, room for 2^(REALGEN_BITS + bits of 5^341)
+
+typedef struct {
+    uint32_t limbs[BIG_LIMBS];  // least significant first
+} Big;
+
+/**
+ * @brief Number of significant bits of a big integer
+ *
+ * @param x the integer
+ * @return int its bit length, 0 for zero
+ */
+int bigBits(const Big* x) {
+    for (int i = BIG_LIMBS - 1; i >= 0; i--)
+        if (x->limbs[i] != 0)
+            return i * 32 + 32 - __builtin_clz(x->limbs[i]);
+    return 0;
+}
+
+/**
+ * @brief Value of a bit of a big integer
+ *
+ * @param x the integer
+ * @param bit index of the bit
+ * @return int 0 or 1
+ */
+int bigBit(const Big* x, int bit) {
+    return (x->limbs[bit / 32] >> (bit % 32)) & 1;
+}
+
+/**
+ * @brief Multiplies a big integer by a small one
+ *
+ * @param x the integer, set to the product
+ * @param factor the factor
+ */
+void bigMultiply(Big* x, uint32_t factor) {
+    uint64_t carry = 0;
+    for (int i = 0; i < BIG_LIMBS; i++) {
+        uint64_t product = (uint64_t)x->limbs[i] * factor + carry;
+        x->limbs[i] = (uint32_t)product;
+        carry = product >> 32;
+    }
+}
+
+/**
+ * @brief Shifts a big integer one bit to the left and sets its lowest bit
+ *
+ * @param x the integer
+ * @param bit value of the new lowest bit
+ */
+void bigShiftIn(Big* x, int bit) {
+    for (int i = BIG_LIMBS - 1; i > 0; i--)
+        x->limbs[i] = (x->limbs[i] << 1) | (x->limbs[i - 1] >> 31);
+    x->limbs[0] = (x->limbs[0] << 1) | (uint32_t)bit;
+}
+
+/**
+ * @brief Compares two big integers
+ *
+ * @param x the first integer
+ * @param y the second integer
+ * @return true if x >= y
+ * @return false if x < y
+ */
+bool bigNotLess(const Big* x, const Big* y) {
+    for (int i = BIG_LIMBS - 1; i >= 0; i--)
+        if (x->limbs[i] != y->limbs[i])
+            return x->limbs[i] > y->limbs[i];
+    return true;
+}
+
+/**
+ * @brief Subtracts a big integer from another one, not smaller
+ *
+ * @param x the integer, set to the difference
+ * @param y the integer subtracted
+ */
+void bigSubtract(Big* x, const Big* y) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < BIG_LIMBS; i++) {
+        uint64_t difference = (uint64_t)x->limbs[i] - y->limbs[i] - borrow;
+        x->limbs[i] = (uint32_t)difference;
+        borrow = (difference >> 32) & 1;
+    }
+}
+
+/**
+ * @brief Computes 2^exponent / divisor by binary long division
+ *
+ * @param divisor the divisor, not zero
+ * @param exponent exponent of the dividend
+ * @param quotient set to the quotient, rounded down
+ */
+void bigDivide(const Big* divisor, int exponent, Big* quotient) {
+    Big remainder;
+    memset(&remainder, 0, sizeof(remainder));
+    memset(quotient, 0, sizeof(*quotient));
+    for (int bit = exponent; bit >= 0; bit--) {
+        bigShiftIn(&remainder, bit == exponent);
+        bool set = bigNotLess(&remainder, divisor);
+        if (set)
+            bigSubtract(&remainder, divisor);
+        bigShiftIn(quotient, set);
+    }
+}
+
+/**
+ * @brief Writes the low 128 bits of a big integer shifted by shift bits to the right (to the left if
+ * negative) as an entry of a table
+ *
+ * @param x the integer
+ * @param shift bits dropped on the right
+ */
+void printEntry(const Big* x, int shift) {
+    uint64_t words[2] = {0, 0};
+    for (int bit = 0; bit < 128; bit++) {
+        int from = bit + shift;
+        if (from >= 0 && bigBit(x, from))
+            words[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+    printf("    {0x%016llxull, 0x%016llxull},\n", (unsigned long long)words[0], (unsigned long long)words[1]);
+}
+
+/**
+ * @brief Writes the tables
+ *
+ * @return int 0
+ */
+int main(void) {
+    printf("// generated by tools/realgen.c, don't edit\n\n");
+
+    Big power;
+    memset(&power, 0, sizeof(power));
+    power.limbs[0] = 1;
+    printf("// leading bits of 5^i, i from 0 on\n");
+    printf("static const uint64_t powersOfFive[%d][2] = {\n", REALGEN_POWERS);
+    for (int i = 0; i < REALGEN_POWERS; i++) {
+        printEntry(&power, bigBits(&power) - REALGEN_BITS);
+        bigMultiply(&power, 5);
+    }
+    printf("};\n\n");
+
+    memset(&power, 0, sizeof(power));
+    power.limbs[0] = 1;
+    printf("// leading bits of 1 / 5^i plus one, i from 0 on\n");
+    printf("static const uint64_t inversePowersOfFive[%d][2] = {\n", REALGEN_INVERSES);
+    for (int i = 0; i < REALGEN_INVERSES; i++) {
+        Big quotient;
+        bigDivide(&power, bigBits(&power) - 1 + REALGEN_BITS, &quotient);
+        for (int limb = 0; limb < BIG_LIMBS && ++quotient.limbs[limb] == 0; limb++)
+            ;
+        printEntry(&quotient, 0);
+        bigMultiply(&power, 5);
+    }
+    printf("};\n");
+    return 0;
+}